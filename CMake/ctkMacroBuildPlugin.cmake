@@ -371,6 +371,14 @@ macro(ctkMacroBuildPlugin)
     PREFIX "lib"
     )
 
+  # Put a copy of the manifest next to the plug-in library, so that the
+  # framework can read it without loading the library. The copy is touched
+  # after the library is linked, since an older copy is ignored.
+  add_custom_command(TARGET ${lib_name} POST_BUILD
+    COMMAND ${CMAKE_COMMAND} -E copy "${CMAKE_CURRENT_BINARY_DIR}/MANIFEST.MF" "$<TARGET_FILE:${lib_name}>.MF"
+    COMMAND ${CMAKE_COMMAND} -E touch "$<TARGET_FILE:${lib_name}>.MF"
+    )
+
   if(NOT MY_TEST_PLUGIN AND NOT MY_NO_INSTALL)
     # Install rules
     install(TARGETS ${lib_name} EXPORT CTKExports
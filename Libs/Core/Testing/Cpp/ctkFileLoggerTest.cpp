@@ -1,21 +1,240 @@
 
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QRunnable>
+#include <QStringList>
+#include <QTextStream>
+#include <QThreadPool>
+
 // CTK includes
 #include "ctkFileLogger.h"
 #include "ctkTest.h"
 
+namespace
+{
+// ----------------------------------------------------------------------------
+QStringList readLines(const QString& filePath)
+{
+  QStringList lines;
+  QFile file(filePath);
+  if (!file.open(QFile::ReadOnly))
+    {
+    return lines;
+    }
+  QTextStream stream(&file);
+  while (!stream.atEnd())
+    {
+    lines << stream.readLine();
+    }
+  return lines;
+}
+
+// ----------------------------------------------------------------------------
+class ctkFileLoggerTestRunnable : public QRunnable
+{
+public:
+  ctkFileLoggerTestRunnable(ctkFileLogger* logger, int id, int count)
+    : Logger(logger), Id(id), Count(count)
+  {}
+  void run()
+  {
+    for (int i = 0; i < this->Count; ++i)
+      {
+      this->Logger->logMessage(QString("thread %1 message %2").arg(this->Id).arg(i));
+      }
+  }
+private:
+  ctkFileLogger* Logger;
+  int Id;
+  int Count;
+};
+}
+
 // ----------------------------------------------------------------------------
 class ctkFileLoggerTester: public QObject
 {
   Q_OBJECT
 private slots:
   void initTestCase();
+  void cleanup();
 
+  void testDefaults();
+  void testSynchronousMode();
+  void testBufferedMode();
+  void testBufferedModeFlushInterval();
+  void testModeSwitchWhileLogging();
+  void testRotation();
+  void testRotation_data();
+
+private:
+  void removeLogFiles();
+  QString FilePath;
 };
 
 // ----------------------------------------------------------------------------
 void ctkFileLoggerTester::initTestCase()
 {
+  this->FilePath = QDir::tempPath() + "/ctkFileLoggerTest.log";
+  this->removeLogFiles();
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::cleanup()
+{
+  this->removeLogFiles();
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::removeLogFiles()
+{
+  QFile::remove(this->FilePath);
+  for (int i = 1; i < 10; ++i)
+    {
+    QFile::remove(QString("%1.%2").arg(this->FilePath).arg(i));
+    }
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testDefaults()
+{
+  ctkFileLogger logger;
+  QCOMPARE(logger.enabled(), true);
+  QCOMPARE(logger.mode(), ctkFileLogger::SynchronousMode);
+  QCOMPARE(logger.numberOfFilesToKeep(), 10);
+  QCOMPARE(logger.maximumFileSize(), qint64(0));
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testSynchronousMode()
+{
+  ctkFileLogger logger;
+  logger.setFilePath(this->FilePath);
+  logger.logMessage("first");
+  logger.logMessage("second");
+  QCOMPARE(readLines(this->FilePath), QStringList() << "first" << "second");
 
+  logger.setEnabled(false);
+  logger.logMessage("third");
+  QCOMPARE(readLines(this->FilePath).count(), 2);
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testBufferedMode()
+{
+  const int threadCount = 4;
+  const int messageCount = 5000;
+  {
+    ctkFileLogger logger;
+    logger.setFilePath(this->FilePath);
+    // Small buffer so that the producers have to wait for the writer
+    logger.setBufferSize(64);
+    logger.setMode(ctkFileLogger::BufferedMode);
+    QCOMPARE(logger.mode(), ctkFileLogger::BufferedMode);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threadCount);
+    for (int i = 0; i < threadCount; ++i)
+      {
+      pool.start(new ctkFileLoggerTestRunnable(&logger, i, messageCount));
+      }
+    pool.waitForDone();
+
+    logger.flush();
+    QStringList lines = readLines(this->FilePath);
+    QCOMPARE(lines.count(), threadCount * messageCount);
+
+    // Messages of a given thread are written in order
+    for (int i = 0; i < threadCount; ++i)
+      {
+      QStringList threadLines = lines.filter(QString("thread %1 ").arg(i));
+      QCOMPARE(threadLines.count(), messageCount);
+      QCOMPARE(threadLines.first(), QString("thread %1 message 0").arg(i));
+      QCOMPARE(threadLines.last(), QString("thread %1 message %2").arg(i).arg(messageCount - 1));
+      }
+
+    // Destroying the logger writes the pending messages
+    logger.logMessage("last");
+  }
+  QCOMPARE(readLines(this->FilePath).last(), QString("last"));
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testBufferedModeFlushInterval()
+{
+  ctkFileLogger logger;
+  logger.setFilePath(this->FilePath);
+  logger.setFlushInterval(10);
+  logger.setMode(ctkFileLogger::BufferedMode);
+  logger.logMessage("message");
+  for (int i = 0; i < 100 && readLines(this->FilePath).isEmpty(); ++i)
+    {
+    QTest::qWait(10);
+    }
+  QCOMPARE(readLines(this->FilePath), QStringList() << "message");
+
+  // Back to synchronous mode
+  logger.logMessage("buffered");
+  logger.setMode(ctkFileLogger::SynchronousMode);
+  logger.logMessage("synchronous");
+  QCOMPARE(readLines(this->FilePath),
+           QStringList() << "message" << "buffered" << "synchronous");
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testModeSwitchWhileLogging()
+{
+  const int threadCount = 4;
+  const int messageCount = 2000;
+  ctkFileLogger logger;
+  logger.setFilePath(this->FilePath);
+  logger.setBufferSize(64);
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(threadCount);
+  for (int i = 0; i < threadCount; ++i)
+    {
+    pool.start(new ctkFileLoggerTestRunnable(&logger, i, messageCount));
+    }
+  // The ring buffer is released while the other threads are logging
+  for (int i = 0; i < 100; ++i)
+    {
+    logger.setMode(i % 2 ? ctkFileLogger::SynchronousMode : ctkFileLogger::BufferedMode);
+    }
+  pool.waitForDone();
+  logger.setMode(ctkFileLogger::SynchronousMode);
+
+  QCOMPARE(readLines(this->FilePath).count(), threadCount * messageCount);
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testRotation()
+{
+  QFETCH(int, mode);
+  ctkFileLogger logger;
+  logger.setFilePath(this->FilePath);
+  logger.setNumberOfFilesToKeep(3);
+  // Room for two 9 bytes lines per file
+  logger.setMaximumFileSize(20);
+  logger.setMode(static_cast<ctkFileLogger::LogMode>(mode));
+  for (int i = 0; i < 10; ++i)
+    {
+    logger.logMessage(QString("message%1").arg(i));
+    }
+  logger.flush();
+
+  QCOMPARE(readLines(this->FilePath), QStringList() << "message8" << "message9");
+  QCOMPARE(readLines(this->FilePath + ".1"), QStringList() << "message6" << "message7");
+  QCOMPARE(readLines(this->FilePath + ".2"), QStringList() << "message4" << "message5");
+  QVERIFY(!QFile::exists(this->FilePath + ".3"));
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testRotation_data()
+{
+  QTest::addColumn<int>("mode");
+  QTest::newRow("synchronous") << static_cast<int>(ctkFileLogger::SynchronousMode);
+  QTest::newRow("buffered") << static_cast<int>(ctkFileLogger::BufferedMode);
 }
 
 // ----------------------------------------------------------------------------
@@ -180,39 +180,47 @@ bool ctkFDHandler::enabled()const
 // --------------------------------------------------------------------------
 void ctkFDHandler::run()
 {
+  // Read the pipe by chunks instead of one character at a time, a single
+  // read() returns all the lines written since the last one.
+  QByteArray pending;
+  char buffer[4096];
   while(true)
     {
-    char c = '\0';
-    QString line;
-    while(c != '\n')
-      {
 #ifdef Q_OS_WIN32
-      int res = _read(this->Pipe[0], &c, 1); // When used with pipe, read() is blocking
+    int res = _read(this->Pipe[0], buffer, sizeof(buffer)); // When used with pipe, read() is blocking
 #else
-      ssize_t res = read(this->Pipe[0], &c, 1); // When used with pipe, read() is blocking
+    ssize_t res = read(this->Pipe[0], buffer, sizeof(buffer)); // When used with pipe, read() is blocking
 #endif
-      if (res == -1)
-        {
-        break;
-        }
-      if (c != '\n')
-        {
-        line += c;
-        }
+    if (res > 0)
+      {
+      pending.append(buffer, static_cast<int>(res));
       }
-
-    if (!this->enabled())
+    else if (!this->enabled())
       {
       break;
       }
 
-    Q_ASSERT(this->MessageHandler);
-    this->MessageHandler->handleMessage(
-      ctk::qtHandleToString(QThread::currentThreadId()),
-      this->LogLevel,
-      this->MessageHandler->handlerPrettyName(),
-      ctkErrorLogContext(line),
-      line);
+    int newLine = pending.indexOf('\n');
+    while (newLine >= 0)
+      {
+      QString line = QString::fromLatin1(pending.constData(), newLine);
+      pending.remove(0, newLine + 1);
+
+      if (!this->enabled())
+        {
+        return;
+        }
+
+      Q_ASSERT(this->MessageHandler);
+      this->MessageHandler->handleMessage(
+        ctk::qtHandleToString(QThread::currentThreadId()),
+        this->LogLevel,
+        this->MessageHandler->handlerPrettyName(),
+        ctkErrorLogContext(line),
+        line);
+
+      newLine = pending.indexOf('\n');
+      }
     }
 }
 
@@ -19,12 +19,144 @@
 =========================================================================*/
 
 // Qt includes
+#include <QAtomicInt>
 #include <QFile>
+#include <QMutex>
 #include <QTextStream>
+#include <QThread>
+#include <QWaitCondition>
 
 // CTK includes
 #include "ctkFileLogger.h"
 
+// --------------------------------------------------------------------------
+// ctkFileLoggerRingBuffer
+
+// --------------------------------------------------------------------------
+/// \internal
+/// Bounded multiple producers / single consumer queue. Each cell carries a
+/// sequence number telling whether it is free for the producer owning the
+/// position, or filled and ready for the consumer. Producers only contend on
+/// the enqueue position and never take a lock.
+class ctkFileLoggerRingBuffer
+{
+public:
+  ctkFileLoggerRingBuffer(int size);
+  ~ctkFileLoggerRingBuffer();
+
+  /// Thread-safe. Return false if the buffer is full.
+  bool tryPush(const QString& msg);
+  /// Must only be called by one thread at a time. Return false if the
+  /// buffer is empty.
+  bool tryPop(QString& msg);
+
+private:
+  static int add(int position, int value);
+
+  struct Cell
+  {
+    QAtomicInt Sequence;
+    QString Message;
+  };
+
+  Cell* Cells;
+  int Mask;
+  QAtomicInt EnqueuePosition;
+  int DequeuePosition;
+};
+
+// --------------------------------------------------------------------------
+ctkFileLoggerRingBuffer::ctkFileLoggerRingBuffer(int size)
+{
+  int capacity = 2;
+  while (capacity < size && capacity < (1 << 24))
+    {
+    capacity <<= 1;
+    }
+  this->Cells = new Cell[capacity];
+  this->Mask = capacity - 1;
+  for (int i = 0; i < capacity; ++i)
+    {
+    this->Cells[i].Sequence.fetchAndStoreRelaxed(i);
+    }
+  this->DequeuePosition = 0;
+}
+
+// --------------------------------------------------------------------------
+ctkFileLoggerRingBuffer::~ctkFileLoggerRingBuffer()
+{
+  delete [] this->Cells;
+}
+
+// --------------------------------------------------------------------------
+int ctkFileLoggerRingBuffer::add(int position, int value)
+{
+  // Positions wrap around, avoid signed overflow
+  return static_cast<int>(static_cast<unsigned int>(position) + static_cast<unsigned int>(value));
+}
+
+// --------------------------------------------------------------------------
+bool ctkFileLoggerRingBuffer::tryPush(const QString& msg)
+{
+  int position = this->EnqueuePosition.fetchAndAddRelaxed(0);
+  Cell* cell = 0;
+  while (true)
+    {
+    cell = &this->Cells[position & this->Mask];
+    int sequence = cell->Sequence.fetchAndAddAcquire(0);
+    int diff = add(sequence, -position);
+    if (diff == 0)
+      {
+      if (this->EnqueuePosition.testAndSetRelaxed(position, add(position, 1)))
+        {
+        break;
+        }
+      }
+    else if (diff < 0)
+      {
+      return false;
+      }
+    position = this->EnqueuePosition.fetchAndAddRelaxed(0);
+    }
+  cell->Message = msg;
+  cell->Sequence.fetchAndStoreRelease(add(position, 1));
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool ctkFileLoggerRingBuffer::tryPop(QString& msg)
+{
+  int position = this->DequeuePosition;
+  Cell* cell = &this->Cells[position & this->Mask];
+  if (cell->Sequence.fetchAndAddAcquire(0) != add(position, 1))
+    {
+    return false;
+    }
+  msg = cell->Message;
+  cell->Message = QString();
+  cell->Sequence.fetchAndStoreRelease(add(position, this->Mask + 1));
+  this->DequeuePosition = add(position, 1);
+  return true;
+}
+
+// --------------------------------------------------------------------------
+// ctkFileLoggerWriter
+
+class ctkFileLoggerPrivate;
+
+// --------------------------------------------------------------------------
+/// \internal
+class ctkFileLoggerWriter : public QThread
+{
+public:
+  ctkFileLoggerWriter(ctkFileLoggerPrivate* d);
+
+protected:
+  void run();
+
+  ctkFileLoggerPrivate* const d;
+};
+
 // --------------------------------------------------------------------------
 // ctkFileLoggerPrivate
 
@@ -40,22 +172,92 @@ public:
 
   void init();
 
+  void startBuffering();
+  void stopBuffering();
+  void wakeWriter();
+
+  /// Write the messages queued in the ring buffer
+  void writePendingMessages();
+
+  /// Rename filePath to filePath.1, filePath.1 to filePath.2...
+  void rotateFiles();
+
   bool Enabled;
   QString FilePath;
   int NumberOfFilesToKeep;
+
+  ctkFileLogger::LogMode Mode;
+  int BufferSize;
+  int FlushInterval;
+  int FlushThreshold;
+  qint64 MaximumFileSize;
+
+  /// Buffer is only accessed by logMessage() while Buffering is set, and
+  /// only deleted once no logMessage() call is between the test of
+  /// Buffering and the end of its push, as counted by ActiveProducers.
+  ctkFileLoggerRingBuffer* Buffer;
+  QAtomicInt Buffering;
+  QAtomicInt ActiveProducers;
+  ctkFileLoggerWriter* Writer;
+  QAtomicInt PendingBytes;
+
+  /// Serializes the consumers of the ring buffer and the accesses to File
+  QMutex WriteMutex;
+  QFile File;
+
+  QMutex WakeMutex;
+  QWaitCondition WakeCondition;
+  bool StopRequested;
 };
 
+// --------------------------------------------------------------------------
+ctkFileLoggerWriter::ctkFileLoggerWriter(ctkFileLoggerPrivate* d)
+  : d(d)
+{
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLoggerWriter::run()
+{
+  while (true)
+    {
+    d->WakeMutex.lock();
+    if (!d->StopRequested &&
+        d->PendingBytes.fetchAndAddOrdered(0) < d->FlushThreshold)
+      {
+      d->WakeCondition.wait(&d->WakeMutex, d->FlushInterval);
+      }
+    bool stop = d->StopRequested;
+    d->WakeMutex.unlock();
+
+    d->writePendingMessages();
+    if (stop)
+      {
+      break;
+      }
+    }
+}
+
 // --------------------------------------------------------------------------
 ctkFileLoggerPrivate::ctkFileLoggerPrivate(ctkFileLogger& object)
   : q_ptr(&object)
 {
   this->Enabled = true;
   this->NumberOfFilesToKeep = 10;
+  this->Mode = ctkFileLogger::SynchronousMode;
+  this->BufferSize = 8192;
+  this->FlushInterval = 1000;
+  this->FlushThreshold = 64 * 1024;
+  this->MaximumFileSize = 0;
+  this->Buffer = 0;
+  this->Writer = 0;
+  this->StopRequested = false;
 }
 
 // --------------------------------------------------------------------------
 ctkFileLoggerPrivate::~ctkFileLoggerPrivate()
 {
+  this->stopBuffering();
 }
 
 // --------------------------------------------------------------------------
@@ -63,6 +265,127 @@ void ctkFileLoggerPrivate::init()
 {
 }
 
+// --------------------------------------------------------------------------
+void ctkFileLoggerPrivate::startBuffering()
+{
+  if (this->Buffer)
+    {
+    return;
+    }
+  this->Buffer = new ctkFileLoggerRingBuffer(this->BufferSize);
+  this->PendingBytes.fetchAndStoreOrdered(0);
+  this->StopRequested = false;
+
+  this->Writer = new ctkFileLoggerWriter(this);
+  this->Writer->start(QThread::LowPriority);
+
+  this->Buffering.fetchAndStoreOrdered(1);
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLoggerPrivate::stopBuffering()
+{
+  if (!this->Buffer)
+    {
+    return;
+    }
+  // New messages are written synchronously, wait for the ones being
+  // pushed into the ring buffer.
+  this->Buffering.fetchAndStoreOrdered(0);
+  while (this->ActiveProducers.fetchAndAddOrdered(0) != 0)
+    {
+    this->wakeWriter();
+    QThread::yieldCurrentThread();
+    }
+
+  {
+    QMutexLocker locker(&this->WakeMutex);
+    this->StopRequested = true;
+    this->WakeCondition.wakeOne();
+  }
+  this->Writer->wait();
+  delete this->Writer;
+  this->Writer = 0;
+
+  // Messages logged while the writer was stopping
+  this->writePendingMessages();
+
+  QMutexLocker locker(&this->WriteMutex);
+  this->File.close();
+  delete this->Buffer;
+  this->Buffer = 0;
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLoggerPrivate::wakeWriter()
+{
+  QMutexLocker locker(&this->WakeMutex);
+  this->WakeCondition.wakeOne();
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLoggerPrivate::writePendingMessages()
+{
+  this->WriteMutex.lock();
+  if (!this->Buffer)
+    {
+    this->WriteMutex.unlock();
+    return;
+    }
+
+  if (!this->File.isOpen())
+    {
+    this->File.setFileName(this->FilePath);
+    this->File.open(QFile::Append);
+    }
+
+  QByteArray data;
+  QString msg;
+  while (this->Buffer->tryPop(msg))
+    {
+    this->PendingBytes.fetchAndAddOrdered(-(msg.size() + 1));
+    QByteArray line = msg.toLocal8Bit();
+    line.append('\n');
+    if (this->MaximumFileSize > 0 && this->File.isOpen())
+      {
+      qint64 size = this->File.size() + data.size();
+      if (size > 0 && size + line.size() > this->MaximumFileSize)
+        {
+        this->File.write(data);
+        data.clear();
+        this->File.close();
+        this->rotateFiles();
+        this->File.open(QFile::Append);
+        }
+      }
+    data.append(line);
+    }
+
+  if (this->File.isOpen() && !data.isEmpty())
+    {
+    this->File.write(data);
+    this->File.flush();
+    }
+  this->WriteMutex.unlock();
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLoggerPrivate::rotateFiles()
+{
+  if (this->NumberOfFilesToKeep <= 1)
+    {
+    QFile::remove(this->FilePath);
+    return;
+    }
+  QFile::remove(QString("%1.%2").arg(this->FilePath).arg(this->NumberOfFilesToKeep - 1));
+  for (int i = this->NumberOfFilesToKeep - 2; i >= 1; --i)
+    {
+    QFile::rename(QString("%1.%2").arg(this->FilePath).arg(i),
+                  QString("%1.%2").arg(this->FilePath).arg(i + 1));
+    }
+  QFile::rename(this->FilePath, this->FilePath + ".1");
+}
+
 // --------------------------------------------------------------------------
 // ctkFileLogger
 
@@ -105,6 +428,10 @@ QString ctkFileLogger::filePath()const
 void ctkFileLogger::setFilePath(const QString& filePath)
 {
   Q_D(ctkFileLogger);
+  // Messages already queued go to the previous file
+  d->writePendingMessages();
+  QMutexLocker locker(&d->WriteMutex);
+  d->File.close();
   d->FilePath = filePath;
 }
 
@@ -122,6 +449,88 @@ void ctkFileLogger::setNumberOfFilesToKeep(int value)
   d->NumberOfFilesToKeep = value;
 }
 
+// --------------------------------------------------------------------------
+ctkFileLogger::LogMode ctkFileLogger::mode()const
+{
+  Q_D(const ctkFileLogger);
+  return d->Mode;
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLogger::setMode(LogMode mode)
+{
+  Q_D(ctkFileLogger);
+  if (d->Mode == mode)
+    {
+    return;
+    }
+  d->Mode = mode;
+  if (mode == BufferedMode)
+    {
+    d->startBuffering();
+    }
+  else
+    {
+    d->stopBuffering();
+    }
+}
+
+// --------------------------------------------------------------------------
+int ctkFileLogger::bufferSize()const
+{
+  Q_D(const ctkFileLogger);
+  return d->BufferSize;
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLogger::setBufferSize(int size)
+{
+  Q_D(ctkFileLogger);
+  d->BufferSize = size;
+}
+
+// --------------------------------------------------------------------------
+int ctkFileLogger::flushInterval()const
+{
+  Q_D(const ctkFileLogger);
+  return d->FlushInterval;
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLogger::setFlushInterval(int msecs)
+{
+  Q_D(ctkFileLogger);
+  d->FlushInterval = msecs;
+}
+
+// --------------------------------------------------------------------------
+int ctkFileLogger::flushThreshold()const
+{
+  Q_D(const ctkFileLogger);
+  return d->FlushThreshold;
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLogger::setFlushThreshold(int bytes)
+{
+  Q_D(ctkFileLogger);
+  d->FlushThreshold = bytes;
+}
+
+// --------------------------------------------------------------------------
+qint64 ctkFileLogger::maximumFileSize()const
+{
+  Q_D(const ctkFileLogger);
+  return d->MaximumFileSize;
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLogger::setMaximumFileSize(qint64 bytes)
+{
+  Q_D(ctkFileLogger);
+  d->MaximumFileSize = bytes;
+}
+
 // --------------------------------------------------------------------------
 void ctkFileLogger::logMessage(const QString& msg)
 {
@@ -130,7 +539,33 @@ void ctkFileLogger::logMessage(const QString& msg)
     {
     return;
     }
+  // Both operations are ordered: either stopBuffering() sees this producer
+  // or this producer sees that buffering is stopped.
+  d->ActiveProducers.ref();
+  if (d->Buffering.fetchAndAddOrdered(0))
+    {
+    while (!d->Buffer->tryPush(msg))
+      {
+      d->wakeWriter();
+      QThread::yieldCurrentThread();
+      }
+    int bytes = msg.size() + 1;
+    int pendingBytes = d->PendingBytes.fetchAndAddOrdered(bytes) + bytes;
+    // Only wake up the writer when crossing the threshold
+    if (pendingBytes >= d->FlushThreshold && pendingBytes - bytes < d->FlushThreshold)
+      {
+      d->wakeWriter();
+      }
+    d->ActiveProducers.deref();
+    return;
+    }
+  d->ActiveProducers.deref();
   QFile f(d->FilePath);
+  if (d->MaximumFileSize > 0 && f.exists() &&
+      f.size() > 0 && f.size() + msg.size() + 1 > d->MaximumFileSize)
+    {
+    d->rotateFiles();
+    }
   if (!f.open(QFile::Append))
     {
     return;
@@ -140,3 +575,9 @@ void ctkFileLogger::logMessage(const QString& msg)
   f.close();
 }
 
+// --------------------------------------------------------------------------
+void ctkFileLogger::flush()
+{
+  Q_D(ctkFileLogger);
+  d->writePendingMessages();
+}
@@ -32,11 +32,36 @@ class ctkFileLoggerPrivate;
 
 //------------------------------------------------------------------------------
 /// \ingroup Core
+/// \brief Append log messages to a file.
+///
+/// In SynchronousMode (the default), the file is opened, written and closed
+/// for every message.
+///
+/// In BufferedMode, logMessage() only pushes the message into a lock-free
+/// ring buffer and returns. A writer thread keeps the file open and writes
+/// the queued messages either when flushThreshold bytes are pending or every
+/// flushInterval milliseconds, whichever comes first. Calling flush() or
+/// destroying the logger writes everything queued so far.
+///
+/// Messages still queued when the application aborts are lost: writing them
+/// from a signal handler is not safe. Call flush() before a fatal error, as
+/// ctkErrorLogModel does when it receives a fatal Qt message.
+///
+/// When maximumFileSize is set, the log file is rotated before it grows
+/// beyond that size: \a filePath is renamed to "<filePath>.1", "<filePath>.1"
+/// to "<filePath>.2" and so on, and only numberOfFilesToKeep files are kept.
 class CTK_CORE_EXPORT ctkFileLogger : public QObject
 {
   Q_OBJECT
+  Q_ENUMS(LogMode)
   Q_PROPERTY(bool enabled READ enabled WRITE setEnabled)
   Q_PROPERTY(QString filePath READ filePath WRITE setFilePath)
+  Q_PROPERTY(int numberOfFilesToKeep READ numberOfFilesToKeep WRITE setNumberOfFilesToKeep)
+  Q_PROPERTY(LogMode mode READ mode WRITE setMode)
+  Q_PROPERTY(int bufferSize READ bufferSize WRITE setBufferSize)
+  Q_PROPERTY(int flushInterval READ flushInterval WRITE setFlushInterval)
+  Q_PROPERTY(int flushThreshold READ flushThreshold WRITE setFlushThreshold)
+  Q_PROPERTY(qint64 maximumFileSize READ maximumFileSize WRITE setMaximumFileSize)
 
 public:
   typedef QObject Superclass;
@@ -53,9 +78,46 @@ public:
   int numberOfFilesToKeep()const;
   void setNumberOfFilesToKeep(int value);
 
+  enum LogMode
+    {
+    SynchronousMode = 0,
+    BufferedMode
+    };
+
+  LogMode mode()const;
+  /// Switching from BufferedMode to SynchronousMode writes the pending
+  /// messages and stops the writer thread.
+  void setMode(LogMode mode);
+
+  /// Number of messages the ring buffer can hold, rounded up to a power of
+  /// two. When the buffer is full, logMessage() waits for the writer thread.
+  /// Default is 8192. Changes are taken into account when BufferedMode is
+  /// (re)entered.
+  int bufferSize()const;
+  void setBufferSize(int size);
+
+  /// Maximum time in milliseconds a message stays in the buffer.
+  /// Default is 1000.
+  int flushInterval()const;
+  void setFlushInterval(int msecs);
+
+  /// Number of pending bytes that triggers an early write.
+  /// Default is 64kB.
+  int flushThreshold()const;
+  void setFlushThreshold(int bytes);
+
+  /// Size in bytes above which the log file is rotated. 0 disables the
+  /// rotation, which is the default.
+  qint64 maximumFileSize()const;
+  void setMaximumFileSize(qint64 bytes);
+
 public Q_SLOTS:
   void logMessage(const QString& msg);
 
+  /// Write all the messages logged so far. In SynchronousMode, this is a
+  /// no-op.
+  void flush();
+
 protected:
   QScopedPointer<ctkFileLoggerPrivate> d_ptr;
 
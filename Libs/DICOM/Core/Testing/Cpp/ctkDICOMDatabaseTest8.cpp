@@ -0,0 +1,138 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QStringList>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+
+int ctkDICOMDatabaseTest8( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 3)
+    {
+    std::cerr << "ctkDICOMDatabaseTest8: missing dicom filePath arguments";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QStringList filePaths;
+  for (int i = 1; i < argc; ++i)
+    {
+    filePaths << QString(argv[i]);
+    }
+
+  ctkDICOMDatabase database;
+  QDir databaseDirectory = QDir::temp();
+  databaseDirectory.remove("ctkDICOMDatabase.sql");
+  databaseDirectory.remove("ctkDICOMTagCache.sql");
+
+  QFileInfo databaseFile(databaseDirectory, QString("database.test"));
+  database.openDatabase(databaseFile.absoluteFilePath());
+
+  bool res = database.initializeDatabase();
+
+  if (!res)
+    {
+    std::cerr << "ctkDICOMDatabase::initializeDatabase() failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Insert all files in a bulk session committing after every instance,
+  // so that chunk boundaries are exercised.
+  //
+  database.beginBulkInsert(1);
+  if (!database.isBulkInsertActive())
+    {
+    std::cerr << "ctkDICOMDatabase::beginBulkInsert() failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+  database.insertBatch(filePaths, false, false);
+  database.endBulkInsert();
+
+  if (database.isBulkInsertActive())
+    {
+    std::cerr << "ctkDICOMDatabase::endBulkInsert() failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (database.allFiles().count() != filePaths.count())
+    {
+    std::cerr << "ctkDICOMDatabase::insertBatch() inserted "
+              << database.allFiles().count() << " files instead of "
+              << filePaths.count() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Inserting again must reuse the existing patient, study and series rows
+  //
+  database.insertBatch(filePaths, false, false);
+
+  QStringList patients = database.patients();
+  if (patients.count() != 1)
+    {
+    std::cerr << "ctkDICOMDatabase::insertBatch() created "
+              << patients.count() << " patients instead of 1" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QStringList studies = database.studiesForPatient(patients[0]);
+  if (studies.count() != 1 || database.seriesForStudy(studies[0]).isEmpty())
+    {
+    std::cerr << "ctkDICOMDatabase::insertBatch() did not create the"
+              << " study/series hierarchy" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Rows removed during a bulk session must be inserted again
+  //
+  database.beginBulkInsert();
+  database.insertBatch(filePaths, false, false);
+  database.removePatient(patients[0]);
+  database.insertBatch(filePaths, false, false);
+  database.endBulkInsert();
+
+  patients = database.patients();
+  studies = patients.count() == 1 ? database.studiesForPatient(patients[0]) : QStringList();
+  if (studies.count() != 1 || database.seriesForStudy(studies[0]).isEmpty() ||
+      database.allFiles().count() != filePaths.count())
+    {
+    std::cerr << "ctkDICOMDatabase::insertBatch() did not restore the removed"
+              << " patient/study/series hierarchy" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Close and clean up
+  //
+  database.closeDatabase();
+
+  return EXIT_SUCCESS;
+}
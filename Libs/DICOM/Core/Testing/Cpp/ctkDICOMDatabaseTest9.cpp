@@ -0,0 +1,160 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QStringList>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+
+int ctkDICOMDatabaseTest9( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 3)
+    {
+    std::cerr << "ctkDICOMDatabaseTest9: missing dicom filePath arguments";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDICOMDatabase database;
+  QDir databaseDirectory = QDir::temp();
+  databaseDirectory.remove("ctkDICOMDatabase.sql");
+  databaseDirectory.remove("ctkDICOMTagCache.sql");
+
+  QFileInfo databaseFile(databaseDirectory, QString("database.test"));
+  database.openDatabase(databaseFile.absoluteFilePath());
+
+  if (!database.initializeDatabase())
+    {
+    std::cerr << "ctkDICOMDatabase::initializeDatabase() failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  for (int i = 1; i < argc; ++i)
+    {
+    database.insert(QString(argv[i]), false, false);
+    }
+
+  QString seriesInstanceUID = database.seriesForFile(QString(argv[1]));
+  QStringList instances = database.instancesForSeries(seriesInstanceUID);
+  if (instances.count() != argc - 1)
+    {
+    std::cerr << "ctkDICOMDatabase: expected " << argc - 1 << " instances in the series"
+              << ", got " << instances.count() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Batch lookup of uncached values: read from the files
+  //
+  QStringList tags;
+  tags << "0020,0013"  // InstanceNumber
+       << "0020,0032"  // ImagePositionPatient
+       << "0018,1020"  // SoftwareVersions
+       << "0009,0010"; // private creator, missing
+  QStringList values = database.instanceValues(instances, tags);
+  if (values.count() != instances.count() * tags.count())
+    {
+    std::cerr << "ctkDICOMDatabase::instanceValues returned " << values.count()
+              << " values instead of " << instances.count() * tags.count() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Values must match the single value lookups, which are now served from
+  // the in-process cache
+  //
+  database.resetTagCacheStatistics();
+  for (int row = 0; row < instances.count(); ++row)
+    {
+    for (int column = 0; column < tags.count(); ++column)
+      {
+      QString value = database.instanceValue(instances[row], tags[column]);
+      if (value != values[row * tags.count() + column])
+        {
+        std::cerr << "ctkDICOMDatabase::instanceValues: value of " << qPrintable(tags[column])
+                  << " is '" << qPrintable(values[row * tags.count() + column])
+                  << "' instead of '" << qPrintable(value) << "'" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  if (database.tagCacheMissCount() != 0 || database.tagCacheHitCount() == 0)
+    {
+    std::cerr << "ctkDICOMDatabase: unexpected tag cache statistics, "
+              << database.tagCacheHitCount() << " hits and "
+              << database.tagCacheMissCount() << " misses" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Once the in-process cache is dropped, values come from the TagCache table
+  //
+  database.setTagCacheMemorySize(0);
+  database.setTagCacheMemorySize(1000);
+  database.resetTagCacheStatistics();
+  if (database.instanceValues(instances, tags) != values)
+    {
+    std::cerr << "ctkDICOMDatabase::instanceValues: TagCache values differ" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (database.tagCacheMissCount() != values.count())
+    {
+    std::cerr << "ctkDICOMDatabase: expected " << values.count() << " misses, got "
+              << database.tagCacheMissCount() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Series level precache
+  //
+  QStringList seriesTags;
+  seriesTags << "0008,0008"; // ImageType
+  database.precacheSeriesTags(seriesInstanceUID, seriesTags);
+  database.resetTagCacheStatistics();
+  foreach(const QString& instance, instances)
+    {
+    if (database.cachedTag(instance, seriesTags[0]).isEmpty())
+      {
+      std::cerr << "ctkDICOMDatabase::precacheSeriesTags did not cache "
+                << qPrintable(instance) << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if (database.tagCacheMissCount() != 0)
+    {
+    std::cerr << "ctkDICOMDatabase::precacheSeriesTags did not fill the in-process cache"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  database.closeDatabase();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,184 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QSqlQuery>
+#include <QTimer>
+
+// ctkCore includes
+#include "ctkHighPrecisionTimer.h"
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMFilterProxyModel.h"
+#include "ctkDICOMModel.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+void fetchAll(QAbstractItemModel& model)
+{
+  while (model.canFetchMore(QModelIndex()))
+    {
+    model.fetchMore(QModelIndex());
+    }
+}
+
+//------------------------------------------------------------------------------
+void wait(int msec)
+{
+  QEventLoop loop;
+  QTimer::singleShot(msec, &loop, SLOT(quit()));
+  loop.exec();
+}
+
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMFilterProxyModelTest1( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  ctkDICOMDatabase database;
+  database.openDatabase(":memory:", "ctkDICOMFilterProxyModelTest1");
+
+  //
+  // 100k patients with one study each
+  //
+  const int numberOfStudies = 100000;
+  QSqlDatabase db = database.database();
+  db.transaction();
+  QSqlQuery insertPatient(db);
+  insertPatient.prepare("INSERT INTO Patients (UID, PatientsName, PatientID) VALUES (?, ?, ?)");
+  QSqlQuery insertStudy(db);
+  insertStudy.prepare("INSERT INTO Studies (StudyInstanceUID, PatientsUID, StudyDescription) VALUES (?, ?, ?)");
+  for (int i = 0; i < numberOfStudies; ++i)
+    {
+    insertPatient.addBindValue(i + 1);
+    insertPatient.addBindValue(QString("Name%1^Given").arg(i));
+    insertPatient.addBindValue(QString::number(i));
+    insertStudy.addBindValue(QString("1.2.3.%1").arg(i));
+    insertStudy.addBindValue(i + 1);
+    insertStudy.addBindValue(QString("Study %1").arg(i % 100));
+    if (!insertPatient.exec() || !insertStudy.exec())
+      {
+      std::cerr << "Could not populate the database" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  db.commit();
+
+  // matches Name123, Name1230-Name1239 and Name12300-Name12399
+  const QString searchText("Name123");
+  const int expectedRows = 111;
+
+  ctkDICOMModel model;
+  model.setDatabase(db);
+  ctkDICOMFilterProxyModel proxy;
+  proxy.setSourceModel(&model);
+
+  //
+  // Filtering the fetched rows
+  //
+  ctkHighPrecisionTimer timer;
+  timer.start();
+  fetchAll(model);
+  qint64 fetchTime = timer.elapsedMicro();
+  if (model.rowCount() != numberOfStudies)
+    {
+    std::cerr << "ctkDICOMModel fetched " << model.rowCount() << " patients instead of "
+              << numberOfStudies << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  timer.start();
+  proxy.setNameSearchText(searchText);
+  int proxyRows = proxy.rowCount();
+  qint64 proxyTime = timer.elapsedMicro();
+  if (proxyRows != expectedRows)
+    {
+    std::cerr << "ctkDICOMFilterProxyModel accepted " << proxyRows << " patients instead of "
+              << expectedRows << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Debounced filtering while typing the search text
+  //
+  proxy.setNameSearchText(QString());
+  proxy.setFilterDelay(100);
+  timer.start();
+  for (int i = 1; i <= searchText.size(); ++i)
+    {
+    proxy.setNameSearchText(searchText.left(i));
+    }
+  qint64 typingTime = timer.elapsedMicro();
+  if (proxy.rowCount() != numberOfStudies)
+    {
+    std::cerr << "ctkDICOMFilterProxyModel filtered before the filter delay" << std::endl;
+    return EXIT_FAILURE;
+    }
+  wait(300);
+  if (proxy.rowCount() != expectedRows)
+    {
+    std::cerr << "ctkDICOMFilterProxyModel did not filter after the filter delay" << std::endl;
+    return EXIT_FAILURE;
+    }
+  proxy.setFilterDelay(0);
+
+  //
+  // Filtering in the database
+  //
+  timer.start();
+  proxy.setDatabaseFiltering(true);
+  fetchAll(model);
+  int databaseRows = proxy.rowCount();
+  qint64 databaseTime = timer.elapsedMicro();
+  if (databaseRows != expectedRows || model.rowCount() != expectedRows)
+    {
+    std::cerr << "ctkDICOMFilterProxyModel accepted " << databaseRows << " patients ("
+              << model.rowCount() << " queried) instead of " << expectedRows
+              << " when filtering in the database" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  proxy.setDatabaseFiltering(false);
+  fetchAll(model);
+  if (model.rowCount() != numberOfStudies || proxy.rowCount() != expectedRows)
+    {
+    std::cerr << "ctkDICOMFilterProxyModel::setDatabaseFiltering(false) did not restore the rows"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Fetching " << numberOfStudies << " patients: " << fetchTime / 1000 << " ms" << std::endl;
+  std::cout << "Filtering the fetched patients: " << proxyTime / 1000 << " ms" << std::endl;
+  std::cout << "Typing the search text with a filter delay: " << typingTime / 1000 << " ms" << std::endl;
+  std::cout << "Filtering in the database, including fetching: " << databaseTime / 1000 << " ms" << std::endl;
+
+  return EXIT_SUCCESS;
+}
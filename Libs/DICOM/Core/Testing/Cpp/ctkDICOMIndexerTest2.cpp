@@ -0,0 +1,85 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+// Qt includes
+#include <QCoreApplication>
+#include <QStringList>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMIndexer.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+int ctkDICOMIndexerTest2( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 3)
+    {
+    std::cerr << "ctkDICOMIndexerTest2: missing dicom filePath arguments";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QStringList listOfFiles;
+  for (int i = 1; i < argc; ++i)
+    {
+    listOfFiles << QString(argv[i]);
+    }
+
+  ctkDICOMDatabase database;
+  database.openDatabase(":memory:", "ctkDICOMIndexerTest2");
+
+  ctkDICOMIndexer indexer;
+  indexer.setNumberOfReaderThreads(4);
+  if (indexer.numberOfReaderThreads() != 4)
+    {
+    std::cerr << "ctkDICOMIndexer::setNumberOfReaderThreads() failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // index the files twice, the second pass must not create duplicates
+  indexer.addListOfFiles(database, listOfFiles);
+  indexer.addListOfFiles(database, listOfFiles);
+
+  if (database.allFiles().count() != listOfFiles.count())
+    {
+    std::cerr << "ctkDICOMIndexer::addListOfFiles() with reader threads failed:"
+              << " expected " << listOfFiles.count() << " files, got "
+              << database.allFiles().count() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (database.patients().count() != 1 || database.seriesForFile(listOfFiles[0]).isEmpty())
+    {
+    std::cerr << "ctkDICOMIndexer::addListOfFiles() with reader threads"
+              << " did not create the patient/series hierarchy." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // an unreadable file must be skipped without stalling the pipeline
+  indexer.addListOfFiles(database, QStringList() << QString() << "/not/a/dicom/file");
+
+  database.closeDatabase();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,174 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+// Qt includes
+#include <QCoreApplication>
+#include <QStringList>
+
+// ctkCore includes
+#include "ctkHighPrecisionTimer.h"
+
+// ctkDICOMCore includes
+#include "ctkDICOMItem.h"
+
+// DCMTK includes
+#include <dcmtk/dcmdata/dcfilefo.h>
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+// Number of bytes covered by the parsed top-level elements of the file
+double parsedBytes(const QString& filePath, bool headerOnly, const DcmTagKey& stopTag)
+{
+  DcmFileFormat fileFormat;
+  OFCondition status = headerOnly ?
+    fileFormat.loadFileUntilTag(filePath.toLatin1().data(), EXS_Unknown, EGL_noChange,
+                                DCM_MaxReadLength, ERM_autoDetect, stopTag) :
+    fileFormat.loadFile(filePath.toLatin1().data());
+  if (status.bad())
+    {
+    return 0;
+    }
+  return fileFormat.getDataset()->getLength(EXS_LittleEndianExplicit);
+}
+
+//------------------------------------------------------------------------------
+// Parse all files \a iterations times, return the elapsed time in microseconds
+qint64 parseFiles(const QStringList& filePaths, bool headerOnly, const DcmTagKey& stopTag, int iterations)
+{
+  ctkHighPrecisionTimer timer;
+  timer.start();
+  for (int i = 0; i < iterations; ++i)
+    {
+    foreach(const QString& filePath, filePaths)
+      {
+      ctkDICOMItem dataset;
+      if (headerOnly)
+        {
+        dataset.InitializeFromFileHeader(filePath, stopTag);
+        }
+      else
+        {
+        dataset.InitializeFromFile(filePath);
+        }
+      dataset.GetElementAsString(DCM_SOPInstanceUID);
+      }
+    }
+  return timer.elapsedMicro();
+}
+
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMItemTest2( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 2)
+    {
+    std::cerr << "ctkDICOMItemTest2: missing dicom filePath arguments";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QStringList filePaths;
+  for (int i = 1; i < argc; ++i)
+    {
+    filePaths << QString(argv[i]);
+    }
+
+  // same stop tag as ctkDICOMDatabase uses without tags to precache
+  DcmTagKey stopTag(0x0020, 0x0101);
+
+  //
+  // Header only parsing must return the same indexed values and skip the
+  // pixel data
+  //
+  foreach(const QString& filePath, filePaths)
+    {
+    ctkDICOMItem fullDataset;
+    fullDataset.InitializeFromFile(filePath);
+    ctkDICOMItem headerDataset;
+    headerDataset.InitializeFromFileHeader(filePath, stopTag);
+    if (!fullDataset.IsInitialized() || !headerDataset.IsInitialized())
+      {
+      std::cerr << "ctkDICOMItem: failed to read " << qPrintable(filePath) << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    DcmTagKey indexedTags[] = { DCM_PatientName, DCM_PatientID, DCM_StudyInstanceUID,
+                                DCM_SeriesInstanceUID, DCM_SOPInstanceUID,
+                                DCM_SeriesDescription, DCM_SeriesNumber,
+                                DCM_FrameOfReferenceUID, DCM_TemporalPositionIdentifier };
+    for (size_t i = 0; i < sizeof(indexedTags) / sizeof(indexedTags[0]); ++i)
+      {
+      QString fullValue = fullDataset.GetElementAsString(indexedTags[i]);
+      QString headerValue = headerDataset.GetElementAsString(indexedTags[i]);
+      if (fullValue != headerValue)
+        {
+        std::cerr << "ctkDICOMItem::InitializeFromFileHeader() returned '"
+                  << qPrintable(headerValue) << "' instead of '" << qPrintable(fullValue)
+                  << "' for " << qPrintable(ctkDICOMItem::TagKey(indexedTags[i])) << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    DcmElement* element = 0;
+    if (headerDataset.findAndGetElement(DCM_PixelData, element).good())
+      {
+      std::cerr << "ctkDICOMItem::InitializeFromFileHeader() did not stop before the pixel data"
+                << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  //
+  // Benchmark: bytes parsed and files per second for both read modes
+  //
+  const int iterations = 20;
+  double fullBytes = 0;
+  double headerBytes = 0;
+  foreach(const QString& filePath, filePaths)
+    {
+    fullBytes += parsedBytes(filePath, false, stopTag);
+    headerBytes += parsedBytes(filePath, true, stopTag);
+    }
+  qint64 fullTime = parseFiles(filePaths, false, stopTag, iterations);
+  qint64 headerTime = parseFiles(filePaths, true, stopTag, iterations);
+  double numberOfFiles = filePaths.count() * iterations;
+
+  std::cout << "Full parse:        " << fullBytes << " bytes parsed, "
+            << (fullTime > 0 ? numberOfFiles * 1e6 / fullTime : 0) << " files/s" << std::endl;
+  std::cout << "Header only parse: " << headerBytes << " bytes parsed, "
+            << (headerTime > 0 ? numberOfFiles * 1e6 / headerTime : 0) << " files/s" << std::endl;
+
+  if (headerBytes > fullBytes)
+    {
+    std::cerr << "ctkDICOMItem::InitializeFromFileHeader() parsed more than the full file"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,241 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+
+// ctkCore includes
+#include "ctkHighPrecisionTimer.h"
+
+// ctkDICOMCore includes
+#include "ctkDICOMItem.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+// Item keeping its string serialization in memory, as a database would
+class ctkDICOMStoredItem : public ctkDICOMItem
+{
+public:
+  QString StoredSerialization;
+
+protected:
+  virtual QString GetStoredSerialization()
+  {
+    return this->StoredSerialization;
+  }
+  virtual void SetStoredSerialization(QString serializedDataset)
+  {
+    this->StoredSerialization = serializedDataset;
+  }
+};
+
+DcmTagKey checkedTags[] = { DCM_PatientName, DCM_PatientID, DCM_StudyInstanceUID,
+                            DCM_SeriesInstanceUID, DCM_SOPInstanceUID,
+                            DCM_SeriesDescription, DCM_Modality, DCM_SpecificCharacterSet };
+
+//------------------------------------------------------------------------------
+bool checkRoundTrip(const ctkDICOMItem& source, const ctkDICOMItem& copy, const char* mode)
+{
+  for (size_t i = 0; i < sizeof(checkedTags) / sizeof(checkedTags[0]); ++i)
+    {
+    QString sourceValue = source.GetElementAsString(checkedTags[i]);
+    QString copyValue = copy.GetElementAsString(checkedTags[i]);
+    if (sourceValue != copyValue)
+      {
+      std::cerr << mode << " serialization returned '" << qPrintable(copyValue)
+                << "' instead of '" << qPrintable(sourceValue) << "' for "
+                << qPrintable(ctkDICOMItem::TagKey(checkedTags[i])) << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMItemTest3( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 2)
+    {
+    std::cerr << "ctkDICOMItemTest3: missing dicom filePath arguments";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QStringList filePaths;
+  for (int i = 1; i < argc; ++i)
+    {
+    filePaths << QString(argv[i]);
+    }
+
+  const QString serializationFile = QDir::temp().filePath("ctkDICOMItemTest3.bin");
+
+  //
+  // The string, binary and memory-mapped serializations must hold the same
+  // bytes and restore the same values
+  //
+  foreach(const QString& filePath, filePaths)
+    {
+    ctkDICOMStoredItem source;
+    source.InitializeFromFileHeader(filePath);
+    if (!source.IsInitialized())
+      {
+      std::cerr << "ctkDICOMItem: failed to read " << qPrintable(filePath) << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    source.Serialize();
+    QByteArray binary = source.SerializeToByteArray();
+    if (binary.isEmpty() ||
+        QByteArray::fromBase64(source.StoredSerialization.toLatin1()) != binary)
+      {
+      std::cerr << "ctkDICOMItem::SerializeToByteArray() differs from ctkDICOMItem::Serialize()"
+                << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    ctkDICOMStoredItem stringCopy;
+    stringCopy.StoredSerialization = source.StoredSerialization;
+    stringCopy.Deserialize();
+    if (!checkRoundTrip(source, stringCopy, "String"))
+      {
+      return EXIT_FAILURE;
+      }
+
+    ctkDICOMItem binaryCopy;
+    binaryCopy.InitializeFromSerialization(binary);
+    if (!binaryCopy.IsInitialized() || !checkRoundTrip(source, binaryCopy, "Binary"))
+      {
+      return EXIT_FAILURE;
+      }
+
+    QFile file(serializationFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        file.write(binary) != binary.size())
+      {
+      std::cerr << "Could not write " << qPrintable(serializationFile) << std::endl;
+      return EXIT_FAILURE;
+      }
+    file.close();
+    ctkDICOMItem mappedCopy;
+    bool mapped = mappedCopy.InitializeFromSerializationFile(serializationFile);
+    bool restored = mapped && checkRoundTrip(source, mappedCopy, "Memory-mapped");
+    QFile::remove(serializationFile);
+    if (!restored)
+      {
+      return EXIT_FAILURE;
+      }
+
+    // Saving a lazily initialized item must write the serialized dataset
+    const QString savedFile = QDir::temp().filePath("ctkDICOMItemTest3.dcm");
+    ctkDICOMItem lazySaved;
+    lazySaved.InitializeFromSerialization(binary);
+    if (!lazySaved.SaveToFile(savedFile))
+      {
+      std::cerr << "ctkDICOMItem::SaveToFile() failed on a lazily initialized item" << std::endl;
+      return EXIT_FAILURE;
+      }
+    ctkDICOMItem savedCopy;
+    savedCopy.InitializeFromFile(savedFile);
+    restored = savedCopy.IsInitialized() && checkRoundTrip(source, savedCopy, "Saved");
+    QFile::remove(savedFile);
+    if (!restored)
+      {
+      return EXIT_FAILURE;
+      }
+
+    // An element copied into a lazily initialized item must be kept with the
+    // serialized ones
+    DcmDataset elements;
+    elements.putAndInsertString(DCM_PatientComments, "ctkDICOMItemTest3");
+    ctkDICOMItem lazyCopy;
+    lazyCopy.InitializeFromSerialization(binary);
+    if (!lazyCopy.CopyElement(&elements, DCM_PatientComments, 0x3) ||
+        lazyCopy.GetElementAsString(DCM_PatientComments) != "ctkDICOMItemTest3" ||
+        !checkRoundTrip(source, lazyCopy, "Copied"))
+      {
+      std::cerr << "ctkDICOMItem::CopyElement() failed on a lazily initialized item" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  //
+  // Benchmark: bytes allocated for the buffers and round-trip time of both
+  // serializations
+  //
+  const int iterations = 100;
+  double stringBytes = 0;
+  double binaryBytes = 0;
+  qint64 stringTime = 0;
+  qint64 binaryTime = 0;
+  ctkHighPrecisionTimer timer;
+  foreach(const QString& filePath, filePaths)
+    {
+    ctkDICOMStoredItem source;
+    source.InitializeFromFileHeader(filePath);
+
+    // Serialize(): write buffer, base64 array and UTF-16 string;
+    // Deserialize(): latin1 array and decoded buffer
+    const double size = source.SerializeToByteArray().size();
+    const double base64Size = 4 * ((size + 2) / 3);
+    stringBytes += iterations * (size + base64Size + 2 * base64Size + base64Size + size);
+    binaryBytes += iterations * size;
+
+    timer.start();
+    for (int i = 0; i < iterations; ++i)
+      {
+      source.Serialize();
+      ctkDICOMStoredItem copy;
+      copy.StoredSerialization = source.StoredSerialization;
+      copy.Deserialize();
+      copy.GetElementAsString(DCM_SOPInstanceUID);
+      }
+    stringTime += timer.elapsedMicro();
+
+    timer.start();
+    for (int i = 0; i < iterations; ++i)
+      {
+      ctkDICOMItem copy;
+      copy.InitializeFromSerialization(source.SerializeToByteArray());
+      copy.GetElementAsString(DCM_SOPInstanceUID);
+      }
+    binaryTime += timer.elapsedMicro();
+    }
+  double numberOfRoundTrips = filePaths.count() * iterations;
+
+  std::cout << "String serialization: " << stringBytes / numberOfRoundTrips << " bytes allocated, "
+            << stringTime / numberOfRoundTrips << " us per round trip" << std::endl;
+  std::cout << "Binary serialization: " << binaryBytes / numberOfRoundTrips << " bytes allocated, "
+            << binaryTime / numberOfRoundTrips << " us per round trip" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,206 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QTextCodec>
+#include <QThread>
+
+// ctkDICOMCore includes
+#include "ctkDICOMItem.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+// Examples of DICOM PS 3.5 annexes H, I and J
+struct DecodingCase
+{
+  const char* SpecificCharacterSet;
+  const char* RequiredCodec;
+  const char* Raw;
+  const char* ExpectedUtf8;
+};
+
+const DecodingCase decodingCases[] =
+{
+  { "ISO_IR 100", 0, "Smith^John", "Smith^John" },
+  { "ISO_IR 100", 0, "Buc^J\xe9r\xf4me", "Buc^J\xc3\xa9r\xc3\xb4me" },
+  { "ISO 2022 IR 100", 0, "Buc^J\xe9r\xf4me", "Buc^J\xc3\xa9r\xc3\xb4me" },
+  { "ISO_IR 126", "ISO-8859-7", "\xc4\xe9\xef\xed\xf5\xf3\xe9\xef\xf2",
+    "\xce\x94\xce\xb9\xce\xbf\xce\xbd\xcf\x85\xcf\x83\xce\xb9\xce\xbf\xcf\x82" },
+  { "ISO_IR 192", 0, "Wang^XiaoDong=\xe7\x8e\x8b^\xe5\xb0\x8f\xe6\x9d\xb1=",
+    "Wang^XiaoDong=\xe7\x8e\x8b^\xe5\xb0\x8f\xe6\x9d\xb1=" },
+  { "\\ISO 2022 IR 87", "ISO-2022-JP",
+    "Yamada^Tarou=\033$B;3ED\033(B^\033$BB@O:\033(B=\033$B$d$^$@\033(B^\033$B$?$m$&\033(B",
+    "Yamada^Tarou=\xe5\xb1\xb1\xe7\x94\xb0^\xe5\xa4\xaa\xe9\x83\x8e="
+    "\xe3\x82\x84\xe3\x81\xbe\xe3\x81\xa0^\xe3\x81\x9f\xe3\x82\x8d\xe3\x81\x86" },
+  { "ISO 2022 IR 13\\ISO 2022 IR 87", "Shift_JIS",
+    "\xd4\xcf\xc0\xde^\xc0\xdb\xb3=\033$B;3ED\033(J^\033$BB@O:\033(J="
+    "\033$B$d$^$@\033(J^\033$B$?$m$&\033(J",
+    "\xef\xbe\x94\xef\xbe\x8f\xef\xbe\x80\xef\xbe\x9e^\xef\xbe\x80\xef\xbe\x9b\xef\xbd\xb3="
+    "\xe5\xb1\xb1\xe7\x94\xb0^\xe5\xa4\xaa\xe9\x83\x8e="
+    "\xe3\x82\x84\xe3\x81\xbe\xe3\x81\xa0^\xe3\x81\x9f\xe3\x82\x8d\xe3\x81\x86" },
+  // JIS X 0201 Romaji is the initial G0 set of ISO 2022 IR 13
+  { "ISO 2022 IR 13", "Shift_JIS", "Yamada~\xd4\xcf\xc0\xde",
+    "Yamada\xe2\x80\xbe\xef\xbe\x94\xef\xbe\x8f\xef\xbe\x80\xef\xbe\x9e" },
+  { "ISO 2022 IR 13", 0, "Tarou~", "Tarou\xe2\x80\xbe" },
+  { "\\ISO 2022 IR 149", "EUC-KR",
+    "Hong^Gildong=\033$)C\373\363^\033$)C\321\316\324\327=\033$)C\310\253^\033$)C\261\346\265\277",
+    "Hong^Gildong=\xe6\xb4\xaa^\xe5\x90\x89\xe6\xb4\x9e=\xed\x99\x8d^\xea\xb8\xb8\xeb\x8f\x99" }
+};
+
+const int decodingCaseCount = sizeof(decodingCases) / sizeof(decodingCases[0]);
+
+//------------------------------------------------------------------------------
+// Datasets holding the patient names of the cases whose codec is available
+QList<ctkDICOMItem*> createDatasets(QStringList& expected, bool verbose)
+{
+  QList<ctkDICOMItem*> datasets;
+  for (int i = 0; i < decodingCaseCount; ++i)
+    {
+    const DecodingCase& decodingCase = decodingCases[i];
+    if (decodingCase.RequiredCodec && !QTextCodec::codecForName(decodingCase.RequiredCodec))
+      {
+      if (verbose)
+        {
+        std::cout << "Skipping " << decodingCase.SpecificCharacterSet << ": "
+                  << decodingCase.RequiredCodec << " codec not available" << std::endl;
+        }
+      continue;
+      }
+
+    DcmDataset* dataset = new DcmDataset();
+    dataset->putAndInsertString(DCM_SpecificCharacterSet, decodingCase.SpecificCharacterSet);
+    dataset->putAndInsertString(DCM_PatientName, decodingCase.Raw);
+    ctkDICOMItem* item = new ctkDICOMItem;
+    item->InitializeFromItem(dataset, true);
+    datasets << item;
+    expected << QString::fromUtf8(decodingCase.ExpectedUtf8);
+    }
+  return datasets;
+}
+
+//------------------------------------------------------------------------------
+// Decodes the patient names of its own datasets many times, counting the errors
+class DecodingThread : public QThread
+{
+public:
+  DecodingThread()
+    : Errors(0)
+  {
+    this->Datasets = createDatasets(this->Expected, false);
+  }
+
+  ~DecodingThread()
+  {
+    qDeleteAll(this->Datasets);
+  }
+
+  virtual void run()
+  {
+    for (int i = 0; i < 1000; ++i)
+      {
+      for (int j = 0; j < this->Datasets.size(); ++j)
+        {
+        if (this->Datasets[j]->GetElementAsString(DCM_PatientName) != this->Expected[j])
+          {
+          ++this->Errors;
+          }
+        }
+      }
+  }
+
+  QList<ctkDICOMItem*> Datasets;
+  QStringList Expected;
+  int Errors;
+};
+
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMItemTest4( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  int result = EXIT_SUCCESS;
+  QStringList expected;
+  QList<ctkDICOMItem*> datasets = createDatasets(expected, true);
+
+  for (int i = 0; i < datasets.size(); ++i)
+    {
+    QString decoded = datasets[i]->GetElementAsString(DCM_PatientName);
+    if (decoded != expected[i])
+      {
+      std::cerr << "ctkDICOMItem::Decode() returned '" << decoded.toUtf8().constData()
+                << "' instead of '" << expected[i].toUtf8().constData() << "'" << std::endl;
+      result = EXIT_FAILURE;
+      }
+    }
+
+  //
+  // In a text, the backslash of JIS X 0201 Romaji is the yen sign
+  //
+  if (QTextCodec::codecForName("Shift_JIS"))
+    {
+    DcmDataset* dataset = new DcmDataset();
+    dataset->putAndInsertString(DCM_SpecificCharacterSet, "ISO 2022 IR 13");
+    dataset->putAndInsertString(DCM_AdditionalPatientHistory, "\xd4\xcf\xc0\xde \\5000");
+    ctkDICOMItem item;
+    item.InitializeFromItem(dataset, true);
+    QString decoded = item.GetElementAsString(DCM_AdditionalPatientHistory);
+    QString expectedText = QString::fromUtf8(
+      "\xef\xbe\x94\xef\xbe\x8f\xef\xbe\x80\xef\xbe\x9e \xc2\xa5" "5000");
+    if (decoded != expectedText)
+      {
+      std::cerr << "ctkDICOMItem::Decode() returned '" << decoded.toUtf8().constData()
+                << "' instead of '" << expectedText.toUtf8().constData() << "'" << std::endl;
+      result = EXIT_FAILURE;
+      }
+    }
+
+  //
+  // Datasets must be decoded concurrently, each one in its thread
+  //
+  QList<DecodingThread*> threads;
+  for (int i = 0; i < 4; ++i)
+    {
+    threads << new DecodingThread;
+    threads.back()->start();
+    }
+  foreach(DecodingThread* thread, threads)
+    {
+    thread->wait();
+    if (thread->Errors > 0)
+      {
+      std::cerr << "ctkDICOMItem::Decode() failed " << thread->Errors
+                << " times when run concurrently" << std::endl;
+      result = EXIT_FAILURE;
+      }
+    }
+
+  qDeleteAll(threads);
+  qDeleteAll(datasets);
+  return result;
+}
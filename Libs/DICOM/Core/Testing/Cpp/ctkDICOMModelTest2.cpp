@@ -0,0 +1,217 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariantList>
+
+// ctkCore includes
+#include "ctkHighPrecisionTimer.h"
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMModel.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+namespace
+{
+
+// Number of rows displayed by a typical view
+const int VisibleRowCount = 40;
+
+//------------------------------------------------------------------------------
+bool populateDatabase(ctkDICOMDatabase& database, int patientCount, int imageCount)
+{
+  QSqlDatabase db = database.database();
+  db.transaction();
+  QSqlQuery query(db);
+
+  QVariantList patientUIDs, names, studyUIDs, seriesUIDs;
+  for (int i = 1; i <= patientCount; ++i)
+    {
+    patientUIDs << i;
+    names << QString("Patient^%1").arg(i);
+    studyUIDs << QString("1.2.3.%1").arg(i);
+    seriesUIDs << QString("1.2.3.%1.1").arg(i);
+    }
+  query.prepare("INSERT INTO Patients (UID, PatientsName, PatientID) VALUES (?, ?, ?)");
+  query.addBindValue(patientUIDs);
+  query.addBindValue(names);
+  query.addBindValue(names);
+  bool res = query.execBatch();
+  query.prepare("INSERT INTO Studies (StudyInstanceUID, PatientsUID, StudyDescription) VALUES (?, ?, ?)");
+  query.addBindValue(studyUIDs);
+  query.addBindValue(patientUIDs);
+  query.addBindValue(names);
+  res = res && query.execBatch();
+  query.prepare("INSERT INTO Series (SeriesInstanceUID, StudyInstanceUID, SeriesDescription) VALUES (?, ?, ?)");
+  query.addBindValue(seriesUIDs);
+  query.addBindValue(studyUIDs);
+  query.addBindValue(names);
+  res = res && query.execBatch();
+
+  // All the images are in the series of the first patient
+  QVariantList imageUIDs, fileNames, imageSeriesUIDs, timestamps;
+  for (int i = 0; i < imageCount; ++i)
+    {
+    imageUIDs << QString("1.2.3.1.1.%1").arg(i);
+    fileNames << QString("/data/%1.dcm").arg(i);
+    imageSeriesUIDs << seriesUIDs[0];
+    timestamps << QString("0");
+    }
+  query.prepare("INSERT INTO Images (SOPInstanceUID, Filename, SeriesInstanceUID, InsertTimestamp) VALUES (?, ?, ?, ?)");
+  query.addBindValue(imageUIDs);
+  query.addBindValue(fileNames);
+  query.addBindValue(imageSeriesUIDs);
+  query.addBindValue(timestamps);
+  res = res && query.execBatch();
+  db.commit();
+  return res;
+}
+
+//------------------------------------------------------------------------------
+// Access the data a view needs to display the rows [firstRow, firstRow + VisibleRowCount[
+QStringList paint(ctkDICOMModel& model, const QModelIndex& parent, int firstRow, int rowCount)
+{
+  QStringList uids;
+  int lastRow = qMin(firstRow + VisibleRowCount, rowCount);
+  for (int row = firstRow; row < lastRow; ++row)
+    {
+    for (int column = 0; column < model.columnCount(); ++column)
+      {
+      model.data(model.index(row, column, parent));
+      }
+    QModelIndex index = model.index(row, 0, parent);
+    model.hasChildren(index);
+    uids << model.data(index, ctkDICOMModel::UIDRole).toString();
+    }
+  return uids;
+}
+
+//------------------------------------------------------------------------------
+// Measure time to first paint and scroll latency, return the UIDs of the
+// painted rows to compare the fetching modes.
+QStringList benchmark(ctkDICOMModel& model, const QSqlDatabase& db,
+                      int patientCount, int imageCount)
+{
+  ctkHighPrecisionTimer timer;
+  QStringList uids;
+
+  timer.start();
+  model.setDatabase(db);
+  model.rowCount();
+  uids << paint(model, QModelIndex(), 0, patientCount);
+  qint64 firstPaint = timer.elapsedMicro();
+
+  // jump to the middle and the end of the list
+  timer.start();
+  uids << paint(model, QModelIndex(), patientCount / 2, patientCount);
+  uids << paint(model, QModelIndex(), patientCount - VisibleRowCount, patientCount);
+  qint64 scroll = timer.elapsedMicro() / 2;
+
+  // expand the series of the first patient
+  QModelIndex series = model.index(0, 0, model.index(0, 0, model.index(0, 0)));
+  timer.start();
+  model.fetchMore(series);
+  uids << paint(model, series, 0, imageCount);
+  qint64 seriesFirstPaint = timer.elapsedMicro();
+
+  timer.start();
+  for (int firstRow = 0; firstRow < imageCount; firstRow += imageCount / 10)
+    {
+    uids << paint(model, series, firstRow, imageCount);
+    }
+  qint64 seriesScroll = timer.elapsedMicro() / 10;
+
+  std::cout << (model.windowedFetching() ? "windowed" : "default ")
+            << ": first paint " << firstPaint << "us"
+            << ", scroll " << scroll << "us"
+            << ", series first paint " << seriesFirstPaint << "us"
+            << ", series scroll " << seriesScroll << "us" << std::endl;
+  return uids;
+}
+
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMModelTest2( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  int patientCount = argc > 1 ? QString(argv[1]).toInt() : 10000;
+  int imageCount = argc > 2 ? QString(argv[2]).toInt() : 10000;
+  if (patientCount < VisibleRowCount || imageCount < VisibleRowCount)
+    {
+    std::cerr << "Usage: ctkDICOMModelTest2 [patientCount] [imageCount]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDICOMDatabase database;
+  QDir databaseDirectory = QDir::temp();
+  databaseDirectory.remove("ctkDICOMModelTest2.sql");
+  QFileInfo databaseFile(databaseDirectory, QString("ctkDICOMModelTest2.sql"));
+  database.openDatabase(databaseFile.absoluteFilePath());
+  if (!database.initializeDatabase())
+    {
+    std::cerr << "ctkDICOMDatabase::initializeDatabase() failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!populateDatabase(database, patientCount, imageCount))
+    {
+    std::cerr << "Failed to populate the database." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDICOMModel model;
+  QStringList uids = benchmark(model, database.database(), patientCount, imageCount);
+
+  ctkDICOMModel windowedModel;
+  windowedModel.setWindowedFetching(true);
+  windowedModel.setBlockSize(128);
+  windowedModel.setCachedBlockCount(8);
+  QStringList windowedUIDs = benchmark(windowedModel, database.database(), patientCount, imageCount);
+
+  if (windowedModel.rowCount() != patientCount)
+    {
+    std::cerr << "Windowed model has " << windowedModel.rowCount()
+              << " rows instead of " << patientCount << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (windowedModel.canFetchMore(QModelIndex()))
+    {
+    std::cerr << "Windowed model should not need fetchMore()" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (uids != windowedUIDs)
+    {
+    std::cerr << "Windowed model rows differ from the default model rows" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  database.closeDatabase();
+  return EXIT_SUCCESS;
+}
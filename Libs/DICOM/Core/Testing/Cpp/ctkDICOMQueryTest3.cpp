@@ -0,0 +1,139 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QStringList>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMQuery.h"
+#include "ctkDICOMTester.h"
+
+// STD includes
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void setupQuery(ctkDICOMQuery& query, int port)
+{
+  query.setCallingAETitle("CTK_AE");
+  query.setCalledAETitle("CTK_AE");
+  query.setHost("localhost");
+  query.setPort(port);
+}
+
+//----------------------------------------------------------------------------
+QStringList seriesInDatabase(ctkDICOMDatabase& database)
+{
+  QStringList series;
+  foreach(const QString& patient, database.patients())
+    {
+    foreach(const QString& study, database.studiesForPatient(patient))
+      {
+      series << database.seriesForStudy(study);
+      }
+    }
+  series.sort();
+  return series;
+}
+
+}
+
+// Compare the streaming query with the default one on a real local database
+int ctkDICOMQueryTest3( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  QStringList arguments = app.arguments();
+  arguments.pop_front(); // remove application name
+  arguments.pop_front(); // remove test name
+  if (!arguments.count())
+    {
+    std::cerr << "Usage: ctkDICOMQueryTest3 images" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDICOMTester tester;
+  tester.startDCMQRSCP();
+  tester.storeData(arguments);
+
+  ctkDICOMDatabase database;
+  database.openDatabase(":memory:", "QUERY-DB");
+  ctkDICOMQuery query;
+  setupQuery(query, tester.dcmqrscpPort());
+  if (!query.query(database))
+    {
+    std::cerr << "ctkDICOMQuery::query() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDICOMDatabase streamingDatabase;
+  streamingDatabase.openDatabase(":memory:", "STREAMING-QUERY-DB");
+  ctkDICOMQuery streamingQuery;
+  setupQuery(streamingQuery, tester.dcmqrscpPort());
+  streamingQuery.setStreaming(true);
+  streamingQuery.setMaximumSeriesAssociations(2);
+  if (!streamingQuery.streaming() || streamingQuery.maximumSeriesAssociations() != 2)
+    {
+    std::cerr << "ctkDICOMQuery streaming properties failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!streamingQuery.query(streamingDatabase))
+    {
+    std::cerr << "ctkDICOMQuery::query() failed in streaming mode" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QStringList studies = query.studyInstanceUIDQueried();
+  QStringList streamedStudies = streamingQuery.studyInstanceUIDQueried();
+  studies.sort();
+  streamedStudies.sort();
+  if (studies.isEmpty() || studies != streamedStudies)
+    {
+    std::cerr << "Streaming query found " << streamedStudies.count()
+              << " studies instead of " << studies.count() << std::endl;
+    return EXIT_FAILURE;
+    }
+  QStringList series = seriesInDatabase(database);
+  if (series.isEmpty() || series != seriesInDatabase(streamingDatabase))
+    {
+    std::cerr << "Streaming query didn't insert the same series" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A canceled query stops before sending anything
+  ctkDICOMDatabase canceledDatabase;
+  canceledDatabase.openDatabase(":memory:", "CANCELED-QUERY-DB");
+  ctkDICOMQuery canceledQuery;
+  setupQuery(canceledQuery, tester.dcmqrscpPort());
+  canceledQuery.setStreaming(true);
+  canceledQuery.cancel();
+  if (canceledQuery.query(canceledDatabase)
+      || !canceledQuery.studyInstanceUIDQueried().isEmpty())
+    {
+    std::cerr << "Canceled streaming query returned results" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
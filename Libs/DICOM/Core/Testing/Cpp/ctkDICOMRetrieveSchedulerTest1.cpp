@@ -0,0 +1,144 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QStringList>
+
+// ctkCore includes
+#include "ctkUtils.h"
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMQuery.h"
+#include "ctkDICOMRetrieveScheduler.h"
+#include "ctkDICOMTester.h"
+
+// STD includes
+#include <iostream>
+
+// Retrieve the studies stored in a local dcmqrscp over several associations
+int ctkDICOMRetrieveSchedulerTest1( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  QStringList arguments = app.arguments();
+  arguments.pop_front(); // remove application name
+  arguments.pop_front(); // remove test name
+  if (!arguments.count())
+    {
+    std::cerr << "Usage: ctkDICOMRetrieveSchedulerTest1 images" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDICOMTester tester;
+  tester.startDCMQRSCP();
+  tester.storeData(arguments);
+
+  ctkDICOMDatabase queryDatabase;
+  ctkDICOMQuery query;
+  query.setCallingAETitle("CTK_AE");
+  query.setCalledAETitle("CTK_AE");
+  query.setHost("localhost");
+  query.setPort(tester.dcmqrscpPort());
+  if (!query.query(queryDatabase) || query.studyInstanceUIDQueried().count() == 0)
+    {
+    std::cerr << "ctkDICOMQuery::query() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QDir storageDirectory(QDir::tempPath() + "/ctkDICOMRetrieveSchedulerTest1");
+  ctk::removeDirRecursively(storageDirectory.absolutePath());
+
+  QSharedPointer<ctkDICOMDatabase> retrieveDatabase(new ctkDICOMDatabase);
+  retrieveDatabase->openDatabase(":memory:");
+
+  ctkDICOMRetrieveScheduler scheduler;
+  scheduler.setCallingAETitle("CTK_AE");
+  scheduler.setCalledAETitle("CTK_AE");
+  scheduler.setHost("localhost");
+  scheduler.setPort(tester.dcmqrscpPort());
+  scheduler.setMaximumAssociations(2);
+  scheduler.setStorageDirectory(storageDirectory.absolutePath());
+  scheduler.setDatabase(retrieveDatabase);
+
+  foreach(const QString& study, query.studyInstanceUIDQueried())
+    {
+    if (!scheduler.getStudy(study))
+      {
+      std::cerr << "ctkDICOMRetrieveScheduler::getStudy() failed for "
+                << qPrintable(study) << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (scheduler.getStudy(study))
+      {
+      std::cerr << "ctkDICOMRetrieveScheduler::getStudy() should fail "
+                << "while a retrieve is in progress" << std::endl;
+      return EXIT_FAILURE;
+      }
+    scheduler.waitForFinished();
+    if (scheduler.isRunning() || scheduler.failedSeries() != 0)
+      {
+      std::cerr << "Retrieve of " << qPrintable(study) << " failed: "
+                << scheduler.failedSeries() << " failed series" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (scheduler.receivedInstances() == 0 || scheduler.receivedBytes() == 0)
+      {
+      std::cerr << "No instance received for " << qPrintable(study) << std::endl;
+      return EXIT_FAILURE;
+      }
+    std::cout << qPrintable(study) << ": "
+              << scheduler.receivedInstances() << " instances, "
+              << scheduler.megabytesPerSecond() << " MB/s, "
+              << scheduler.instancesPerSecond() << " instances/s" << std::endl;
+    }
+
+  int instanceCount = 0;
+  foreach(const QString& patient, retrieveDatabase->patients())
+    {
+    foreach(const QString& study, retrieveDatabase->studiesForPatient(patient))
+      {
+      foreach(const QString& series, retrieveDatabase->seriesForStudy(study))
+        {
+        foreach(const QString& file, retrieveDatabase->filesForSeries(series))
+          {
+          if (!file.startsWith(storageDirectory.absolutePath()))
+            {
+            std::cerr << "File not in the storage directory: "
+                      << qPrintable(file) << std::endl;
+            return EXIT_FAILURE;
+            }
+          ++instanceCount;
+          }
+        }
+      }
+    }
+  if (instanceCount != arguments.count())
+    {
+    std::cerr << "Expected " << arguments.count() << " indexed instances, got "
+              << instanceCount << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctk::removeDirRecursively(storageDirectory.absolutePath());
+  return EXIT_SUCCESS;
+}
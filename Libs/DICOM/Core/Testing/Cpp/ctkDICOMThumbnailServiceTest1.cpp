@@ -0,0 +1,155 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+
+// ctkDICOMCore includes
+#include "ctkDICOMAbstractThumbnailGenerator.h"
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMThumbnailService.h"
+
+// DCMTK includes
+#include <dcmtk/dcmimgle/dcmimage.h>
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+class ctkDICOMDummyThumbnailGenerator : public ctkDICOMAbstractThumbnailGenerator
+{
+public:
+  virtual bool generateThumbnail(DicomImage* dcmImage, const QString& path)
+  {
+    if (dcmImage->getStatus() != EIS_Normal)
+      {
+      return false;
+      }
+    QFile thumbnail(path);
+    return thumbnail.open(QIODevice::WriteOnly);
+  }
+};
+
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMThumbnailServiceTest1( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 3)
+    {
+    std::cerr << "ctkDICOMThumbnailServiceTest1: missing dicom filePath arguments";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QStringList filePaths;
+  for (int i = 1; i < argc; ++i)
+    {
+    filePaths << QString(argv[i]);
+    }
+
+  // Use a new directory so that no thumbnail exists yet
+  QDir databaseDirectory = QDir::temp();
+  QString directoryName = QString("ctkDICOMThumbnailServiceTest1-%1")
+    .arg(QCoreApplication::applicationPid());
+  databaseDirectory.mkdir(directoryName);
+  databaseDirectory.cd(directoryName);
+
+  ctkDICOMDatabase database;
+  ctkDICOMDummyThumbnailGenerator generator;
+  database.setThumbnailGenerator(&generator);
+  database.setDeferThumbnailGeneration(true);
+
+  QFileInfo databaseFile(databaseDirectory, QString("database.test"));
+  database.openDatabase(databaseFile.absoluteFilePath());
+  if (!database.initializeDatabase())
+    {
+    std::cerr << "ctkDICOMDatabase::initializeDatabase() failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Inserting only records the jobs
+  //
+  ctkDICOMThumbnailService service(&database);
+  service.setBackgroundProcessing(false);
+  service.setMaximumThreadCount(2);
+
+  foreach(const QString& filePath, filePaths)
+    {
+    database.insert(filePath, false, true);
+    }
+  if (service.pendingJobCount() != filePaths.count())
+    {
+    std::cerr << "ctkDICOMDatabase::insert() recorded "
+              << service.pendingJobCount() << " thumbnail jobs instead of "
+              << filePaths.count() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Without background processing, only the priority series are rendered
+  //
+  service.start();
+  service.waitForDone();
+  if (service.pendingJobCount() != filePaths.count())
+    {
+    std::cerr << "ctkDICOMThumbnailService rendered non priority series" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QString studyInstanceUID = database.studiesForPatient(database.patients()[0])[0];
+  QString seriesInstanceUID = database.seriesForStudy(studyInstanceUID)[0];
+  service.requestSeries(seriesInstanceUID);
+  service.waitForDone();
+
+  if (service.pendingJobCount() != 0)
+    {
+    std::cerr << "ctkDICOMThumbnailService left "
+              << service.pendingJobCount() << " jobs" << std::endl;
+    return EXIT_FAILURE;
+    }
+  foreach(const QString& instanceUID, database.instancesForSeries(seriesInstanceUID))
+    {
+    QString thumbnailPath = databaseDirectory.absolutePath() + "/thumbs/"
+      + studyInstanceUID + "/" + seriesInstanceUID + "/" + instanceUID + ".png";
+    if (!QFileInfo(thumbnailPath).exists())
+      {
+      std::cerr << "ctkDICOMThumbnailService did not generate "
+                << qPrintable(thumbnailPath) << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  service.stop();
+  database.closeDatabase();
+
+  return EXIT_SUCCESS;
+}
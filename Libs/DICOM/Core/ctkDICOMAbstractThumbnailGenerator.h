@@ -34,6 +34,11 @@ class DicomImage;
 ///
 /// \brief Abstract thumbnail generator class
 ///
+/// generateThumbnail() must be reentrant: ctkDICOMThumbnailService calls the
+/// generator of the database from all the threads of its pool at the same
+/// time, each call with its own image. Implementations must not keep per-call
+/// state (image, scaling buffer...) in members without protecting it.
+///
 class CTK_DICOM_CORE_EXPORT ctkDICOMAbstractThumbnailGenerator : public QObject
 {
   Q_OBJECT
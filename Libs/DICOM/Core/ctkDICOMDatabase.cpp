@@ -21,17 +21,20 @@
 #include <stdexcept>
 
 // Qt includes
+#include <QCache>
 #include <QDate>
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
 #include <QFileSystemWatcher>
+#include <QHash>
 #include <QSet>
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QSqlRecord>
 #include <QStringList>
 #include <QVariant>
+#include <QVector>
 
 // ctkDICOM includes
 #include "ctkDICOMDatabase.h"
@@ -94,6 +97,31 @@ public:
   void beginTransaction();
   void endTransaction();
 
+  ///
+  /// \brief returns a prepared statement for \a sql
+  /// While a bulk insert session is open, statements are prepared once and
+  /// reused for every subsequent insert.
+  ///
+  QSqlQuery preparedStatement(const QString& sql);
+
+  ///
+  /// \brief bulk insert session state, see ctkDICOMDatabase::beginBulkInsert
+  ///
+  int BulkInsertDepth;
+  int BulkInsertChunkSize;
+  int BulkInsertUncommitted;
+  QHash<QString, QSqlQuery> BulkInsertStatements;
+  /// existing patients keyed by patientID and patientsName
+  QHash<QString, int> BulkInsertPatients;
+  QSet<QString> BulkInsertStudies;
+  QSet<QString> BulkInsertSeries;
+  /// fill the existence caches from the current database content
+  void seedBulkInsertCaches();
+  /// commit the current chunk if it reached BulkInsertChunkSize
+  void commitBulkInsertChunkIfNeeded();
+  void beginBulkInsertTransaction();
+  void endBulkInsertTransaction();
+
   // dataset must be set always
   // filePath has to be set if this is an import of an actual file
   void insert ( const ctkDICOMItem& ctkDataset, const QString& filePath, bool storeFile = true, bool generateThumbnail = true);
@@ -141,7 +169,40 @@ public:
   QSqlDatabase TagCacheDatabase;
   QString TagCacheDatabaseFilename;
   QStringList TagsToPrecache;
-  void precacheTags( const QString sopInstanceUID );
+  void precacheTags( const ctkDICOMItem& dataset, const QString sopInstanceUID );
+
+  ///
+  /// \brief in-process read-through cache in front of the TagCache table
+  /// Values are stored the way cachedTag() returns them.
+  ///
+  QCache<QString, QString> TagValueCache;
+  int TagValueCacheHits;
+  int TagValueCacheMisses;
+  static QString tagValueCacheKey(const QString& sopInstanceUID, const QString& tag);
+  void rememberTagValue(const QString& sopInstanceUID, const QString& tag, const QString& value);
+  void clearTagValueCache();
+
+  ///
+  /// \brief tag values precached during a bulk insert session
+  /// They are written to the TagCache table as a single batch when the
+  /// current chunk is committed.
+  ///
+  QStringList PendingTagCacheUIDs;
+  QStringList PendingTagCacheTags;
+  QStringList PendingTagCacheValues;
+  void flushPendingTagCache();
+
+  void beginTagCacheTransaction();
+  void endTagCacheTransaction();
+
+  bool HeaderOnlyParsing;
+
+  bool DeferThumbnailGeneration;
+  /// ThumbnailJobs table has been created in the current database
+  bool ThumbnailJobsTableVerified;
+  /// record a deferred thumbnail job, see ctkDICOMThumbnailService
+  void addThumbnailJob(const QString& seriesInstanceUID, const QString& fileName,
+                       const QString& thumbnailPath);
 
   int insertPatient(const ctkDICOMItem& ctkDataset);
   void insertStudy(const ctkDICOMItem& ctkDataset, int dbPatientID);
@@ -157,6 +218,15 @@ ctkDICOMDatabasePrivate::ctkDICOMDatabasePrivate(ctkDICOMDatabase& o): q_ptr(&o)
   this->thumbnailGenerator = NULL;
   this->LoggedExecVerbose = false;
   this->TagCacheVerified = false;
+  this->HeaderOnlyParsing = false;
+  this->DeferThumbnailGeneration = false;
+  this->ThumbnailJobsTableVerified = false;
+  this->BulkInsertDepth = 0;
+  this->BulkInsertChunkSize = 500;
+  this->BulkInsertUncommitted = 0;
+  this->TagValueCache.setMaxCost(100000);
+  this->TagValueCacheHits = 0;
+  this->TagValueCacheMisses = 0;
   this->resetLastInsertedValues();
 }
 
@@ -270,6 +340,159 @@ void ctkDICOMDatabasePrivate::endTransaction()
   transaction.exec();
 }
 
+//------------------------------------------------------------------------------
+QSqlQuery ctkDICOMDatabasePrivate::preparedStatement(const QString& sql)
+{
+  if (this->BulkInsertDepth > 0)
+    {
+    QHash<QString, QSqlQuery>::const_iterator it = this->BulkInsertStatements.constFind(sql);
+    if (it != this->BulkInsertStatements.constEnd())
+      {
+      // copies of a QSqlQuery share the same prepared statement
+      return it.value();
+      }
+    }
+  QSqlQuery query(this->Database);
+  query.prepare(sql);
+  if (this->BulkInsertDepth > 0)
+    {
+    this->BulkInsertStatements.insert(sql, query);
+    }
+  return query;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::seedBulkInsertCaches()
+{
+  this->BulkInsertPatients.clear();
+  this->BulkInsertStudies.clear();
+  this->BulkInsertSeries.clear();
+
+  QSqlQuery query(this->Database);
+  if (loggedExec(query, "SELECT UID, PatientID, PatientsName FROM Patients"))
+    {
+    while (query.next())
+      {
+      QString key = query.value(1).toString() + QLatin1Char('\n') + query.value(2).toString();
+      this->BulkInsertPatients.insert(key, query.value(0).toInt());
+      }
+    }
+  if (loggedExec(query, "SELECT StudyInstanceUID FROM Studies"))
+    {
+    while (query.next())
+      {
+      this->BulkInsertStudies.insert(query.value(0).toString());
+      }
+    }
+  if (loggedExec(query, "SELECT SeriesInstanceUID FROM Series"))
+    {
+    while (query.next())
+      {
+      this->BulkInsertSeries.insert(query.value(0).toString());
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::beginBulkInsertTransaction()
+{
+  this->beginTransaction();
+  if (this->TagCacheDatabase.isOpen())
+    {
+    QSqlQuery transaction( this->TagCacheDatabase );
+    transaction.exec( "BEGIN TRANSACTION" );
+    }
+  this->BulkInsertUncommitted = 0;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::endBulkInsertTransaction()
+{
+  this->flushPendingTagCache();
+  this->endTransaction();
+  if (this->TagCacheDatabase.isOpen())
+    {
+    QSqlQuery transaction( this->TagCacheDatabase );
+    transaction.exec( "END TRANSACTION" );
+    }
+  this->BulkInsertUncommitted = 0;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::beginTagCacheTransaction()
+{
+  // a bulk insert session already groups the tag cache writes
+  if (this->BulkInsertDepth == 0 && this->TagCacheDatabase.isOpen())
+    {
+    QSqlQuery transaction( this->TagCacheDatabase );
+    transaction.exec( "BEGIN TRANSACTION" );
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::endTagCacheTransaction()
+{
+  if (this->BulkInsertDepth == 0 && this->TagCacheDatabase.isOpen())
+    {
+    QSqlQuery transaction( this->TagCacheDatabase );
+    transaction.exec( "END TRANSACTION" );
+    }
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMDatabasePrivate::tagValueCacheKey(const QString& sopInstanceUID, const QString& tag)
+{
+  return sopInstanceUID + QLatin1Char('|') + tag;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::rememberTagValue(const QString& sopInstanceUID,
+                                               const QString& tag, const QString& value)
+{
+  this->TagValueCache.insert(tagValueCacheKey(sopInstanceUID, tag), new QString(value));
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::clearTagValueCache()
+{
+  this->TagValueCache.clear();
+  this->PendingTagCacheUIDs.clear();
+  this->PendingTagCacheTags.clear();
+  this->PendingTagCacheValues.clear();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::flushPendingTagCache()
+{
+  Q_Q(ctkDICOMDatabase);
+  if (this->PendingTagCacheUIDs.isEmpty())
+    {
+    return;
+    }
+  QStringList sopInstanceUIDs = this->PendingTagCacheUIDs;
+  QStringList tags = this->PendingTagCacheTags;
+  QStringList values = this->PendingTagCacheValues;
+  this->PendingTagCacheUIDs.clear();
+  this->PendingTagCacheTags.clear();
+  this->PendingTagCacheValues.clear();
+  q->cacheTags(sopInstanceUIDs, tags, values);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::commitBulkInsertChunkIfNeeded()
+{
+  if (this->BulkInsertDepth == 0)
+    {
+    return;
+    }
+  ++this->BulkInsertUncommitted;
+  if (this->BulkInsertUncommitted >= this->BulkInsertChunkSize)
+    {
+    this->endBulkInsertTransaction();
+    this->beginBulkInsertTransaction();
+    }
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMDatabasePrivate::createBackupFileList()
 {
@@ -292,6 +515,8 @@ void ctkDICOMDatabase::openDatabase(const QString databaseFile, const QString& c
 {
   Q_D(ctkDICOMDatabase);
   d->DatabaseFileName = databaseFile;
+  d->ThumbnailJobsTableVerified = false;
+  d->clearTagValueCache();
   d->Database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
   d->Database.setDatabaseName(databaseFile);
   if ( ! (d->Database.open()) )
@@ -401,6 +626,49 @@ ctkDICOMAbstractThumbnailGenerator* ctkDICOMDatabase::thumbnailGenerator(){
   return d->thumbnailGenerator;
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::setDeferThumbnailGeneration(bool defer)
+{
+  Q_D(ctkDICOMDatabase);
+  d->DeferThumbnailGeneration = defer;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabase::deferThumbnailGeneration() const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->DeferThumbnailGeneration;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::addThumbnailJob(const QString& seriesInstanceUID,
+                                              const QString& fileName,
+                                              const QString& thumbnailPath)
+{
+  Q_Q(ctkDICOMDatabase);
+  if (!this->ThumbnailJobsTableVerified)
+    {
+    QSqlQuery createTable(this->Database);
+    this->ThumbnailJobsTableVerified = loggedExec(createTable,
+      "CREATE TABLE IF NOT EXISTS ThumbnailJobs ("
+      " 'ThumbnailPath' VARCHAR(1024) NOT NULL,"
+      " 'SeriesInstanceUID' VARCHAR(64) NOT NULL,"
+      " 'Filename' VARCHAR(1024) NOT NULL,"
+      " PRIMARY KEY ('ThumbnailPath') )");
+    loggedExec(createTable,
+      "CREATE INDEX IF NOT EXISTS 'ThumbnailJobsSeriesIndex' ON 'ThumbnailJobs' ('SeriesInstanceUID')");
+    }
+  QSqlQuery insertJob = this->preparedStatement(
+    "INSERT OR REPLACE INTO ThumbnailJobs ('ThumbnailPath', 'SeriesInstanceUID', 'Filename') VALUES ( ?, ?, ? )");
+  insertJob.bindValue(0, thumbnailPath);
+  insertJob.bindValue(1, seriesInstanceUID);
+  insertJob.bindValue(2, fileName);
+  if (loggedExec(insertJob))
+    {
+    emit q->thumbnailJobAdded(seriesInstanceUID);
+    }
+}
+
 //------------------------------------------------------------------------------
 bool ctkDICOMDatabasePrivate::executeScript(const QString script) {
   QFile scriptFile(script);
@@ -463,7 +731,13 @@ bool ctkDICOMDatabase::initializeDatabase(const char* sqlFileName)
   // old schema should be loaded for testing.
   QSqlQuery dropSchemaInfo(d->Database);
   d->loggedExec( dropSchemaInfo, QString("DROP TABLE IF EXISTS 'SchemaInfo';") );
-  return d->executeScript(sqlFileName);
+  bool success = d->executeScript(sqlFileName);
+  if (d->BulkInsertDepth > 0)
+    {
+    d->BulkInsertStatements.clear();
+    d->seedBulkInsertCaches();
+    }
+  return success;
 }
 
 //------------------------------------------------------------------------------
@@ -552,6 +826,12 @@ bool ctkDICOMDatabase::updateSchema(const char* schemaFile)
 void ctkDICOMDatabase::closeDatabase()
 {
   Q_D(ctkDICOMDatabase);
+  if (d->BulkInsertDepth > 0)
+    {
+    d->BulkInsertDepth = 1;
+    this->endBulkInsert();
+    }
+  d->clearTagValueCache();
   d->Database.close();
   d->TagCacheDatabase.close();
 }
@@ -1072,7 +1352,14 @@ void ctkDICOMDatabase::insert ( const QString& filePath, bool storeFile, bool ge
   DcmFileFormat fileformat;
   ctkDICOMItem ctkDataset;
 
-  ctkDataset.InitializeFromFile(filePath);
+  if (d->HeaderOnlyParsing)
+    {
+      ctkDataset.InitializeFromFileHeader(filePath, this->headerOnlyParsingStopTag());
+    }
+  else
+    {
+      ctkDataset.InitializeFromFile(filePath);
+    }
   if ( ctkDataset.IsInitialized() )
     {
       d->insert( ctkDataset, filePath, storeFile, generateThumbnail );
@@ -1083,6 +1370,19 @@ void ctkDICOMDatabase::insert ( const QString& filePath, bool storeFile, bool ge
     }
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::insert ( const ctkDICOMItem& ctkDataset, const QString& filePath, bool storeFile, bool generateThumbnail)
+{
+  Q_D(ctkDICOMDatabase);
+  if ( !ctkDataset.IsInitialized() )
+    {
+      logger.warn(QString("Could not read DICOM file:") + filePath);
+      return;
+    }
+  logger.debug( "Processing " + filePath );
+  d->insert( ctkDataset, filePath, storeFile, generateThumbnail );
+}
+
 //------------------------------------------------------------------------------
 int ctkDICOMDatabasePrivate::insertPatient(const ctkDICOMItem& ctkDataset)
 {
@@ -1094,19 +1394,35 @@ int ctkDICOMDatabasePrivate::insertPatient(const ctkDICOMItem& ctkDataset)
   QString patientsName(ctkDataset.GetElementAsString(DCM_PatientName) );
   QString patientsBirthDate(ctkDataset.GetElementAsString(DCM_PatientBirthDate) );
 
-  QSqlQuery checkPatientExistsQuery(Database);
-  checkPatientExistsQuery.prepare ( "SELECT * FROM Patients WHERE PatientID = ? AND PatientsName = ?" );
-  checkPatientExistsQuery.bindValue ( 0, patientID );
-  checkPatientExistsQuery.bindValue ( 1, patientsName );
-  loggedExec(checkPatientExistsQuery);
-
-  if (checkPatientExistsQuery.next())
+  // In a bulk insert session the patients table is mirrored in memory
+  bool patientExists = false;
+  QString bulkInsertKey = patientID + QLatin1Char('\n') + patientsName;
+  if (this->BulkInsertDepth > 0)
     {
+    QHash<QString, int>::const_iterator it = this->BulkInsertPatients.constFind(bulkInsertKey);
+    if (it != this->BulkInsertPatients.constEnd())
+      {
+      dbPatientID = it.value();
+      patientExists = true;
+      }
+    }
+  else
+    {
+    QSqlQuery checkPatientExistsQuery(Database);
+    checkPatientExistsQuery.prepare ( "SELECT * FROM Patients WHERE PatientID = ? AND PatientsName = ?" );
+    checkPatientExistsQuery.bindValue ( 0, patientID );
+    checkPatientExistsQuery.bindValue ( 1, patientsName );
+    loggedExec(checkPatientExistsQuery);
+    if (checkPatientExistsQuery.next())
+      {
       // we found him
       dbPatientID = checkPatientExistsQuery.value(checkPatientExistsQuery.record().indexOf("UID")).toInt();
       qDebug() << "Found patient in the database as UId: " << dbPatientID;
+      patientExists = true;
+      }
     }
-  else
+
+  if (!patientExists)
     {
       // Insert it
 
@@ -1115,8 +1431,7 @@ int ctkDICOMDatabasePrivate::insertPatient(const ctkDICOMItem& ctkDataset)
       QString patientsAge(ctkDataset.GetElementAsString(DCM_PatientAge) );
       QString patientComments(ctkDataset.GetElementAsString(DCM_PatientComments) );
 
-      QSqlQuery insertPatientStatement ( Database );
-      insertPatientStatement.prepare ( "INSERT INTO Patients ('UID', 'PatientsName', 'PatientID', 'PatientsBirthDate', 'PatientsBirthTime', 'PatientsSex', 'PatientsAge', 'PatientsComments' ) values ( NULL, ?, ?, ?, ?, ?, ?, ? )" );
+      QSqlQuery insertPatientStatement = preparedStatement ( "INSERT INTO Patients ('UID', 'PatientsName', 'PatientID', 'PatientsBirthDate', 'PatientsBirthTime', 'PatientsSex', 'PatientsAge', 'PatientsComments' ) values ( NULL, ?, ?, ?, ?, ?, ?, ? )" );
       insertPatientStatement.bindValue ( 0, patientsName );
       insertPatientStatement.bindValue ( 1, patientID );
       insertPatientStatement.bindValue ( 2, QDate::fromString ( patientsBirthDate, "yyyyMMdd" ) );
@@ -1130,6 +1445,10 @@ int ctkDICOMDatabasePrivate::insertPatient(const ctkDICOMItem& ctkDataset)
       dbPatientID = insertPatientStatement.lastInsertId().toInt();
       logger.debug ( "New patient inserted: " + QString().setNum ( dbPatientID ) );
       qDebug() << "New patient inserted as : " << dbPatientID;
+      if (this->BulkInsertDepth > 0)
+        {
+        this->BulkInsertPatients.insert(bulkInsertKey, dbPatientID);
+        }
     }
     return dbPatientID;
 }
@@ -1138,11 +1457,20 @@ int ctkDICOMDatabasePrivate::insertPatient(const ctkDICOMItem& ctkDataset)
 void ctkDICOMDatabasePrivate::insertStudy(const ctkDICOMItem& ctkDataset, int dbPatientID)
 {
   QString studyInstanceUID(ctkDataset.GetElementAsString(DCM_StudyInstanceUID) );
-  QSqlQuery checkStudyExistsQuery (Database);
-  checkStudyExistsQuery.prepare ( "SELECT * FROM Studies WHERE StudyInstanceUID = ?" );
-  checkStudyExistsQuery.bindValue ( 0, studyInstanceUID );
-  checkStudyExistsQuery.exec();
-  if(!checkStudyExistsQuery.next())
+  bool studyExists;
+  if (this->BulkInsertDepth > 0)
+    {
+    studyExists = this->BulkInsertStudies.contains(studyInstanceUID);
+    }
+  else
+    {
+    QSqlQuery checkStudyExistsQuery (Database);
+    checkStudyExistsQuery.prepare ( "SELECT * FROM Studies WHERE StudyInstanceUID = ?" );
+    checkStudyExistsQuery.bindValue ( 0, studyInstanceUID );
+    checkStudyExistsQuery.exec();
+    studyExists = checkStudyExistsQuery.next();
+    }
+  if(!studyExists)
     {
       qDebug() << "Need to insert new study: " << studyInstanceUID;
 
@@ -1156,8 +1484,7 @@ void ctkDICOMDatabasePrivate::insertStudy(const ctkDICOMItem& ctkDataset, int db
       QString referringPhysician(ctkDataset.GetElementAsString(DCM_ReferringPhysicianName) );
       QString studyDescription(ctkDataset.GetElementAsString(DCM_StudyDescription) );
 
-      QSqlQuery insertStudyStatement ( Database );
-      insertStudyStatement.prepare ( "INSERT INTO Studies ( 'StudyInstanceUID', 'PatientsUID', 'StudyID', 'StudyDate', 'StudyTime', 'AccessionNumber', 'ModalitiesInStudy', 'InstitutionName', 'ReferringPhysician', 'PerformingPhysiciansName', 'StudyDescription' ) VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ? )" );
+      QSqlQuery insertStudyStatement = preparedStatement ( "INSERT INTO Studies ( 'StudyInstanceUID', 'PatientsUID', 'StudyID', 'StudyDate', 'StudyTime', 'AccessionNumber', 'ModalitiesInStudy', 'InstitutionName', 'ReferringPhysician', 'PerformingPhysiciansName', 'StudyDescription' ) VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ? )" );
       insertStudyStatement.bindValue ( 0, studyInstanceUID );
       insertStudyStatement.bindValue ( 1, dbPatientID );
       insertStudyStatement.bindValue ( 2, studyID );
@@ -1176,6 +1503,10 @@ void ctkDICOMDatabasePrivate::insertStudy(const ctkDICOMItem& ctkDataset, int db
       else
         {
           LastStudyInstanceUID = studyInstanceUID;
+          if (this->BulkInsertDepth > 0)
+            {
+            this->BulkInsertStudies.insert(studyInstanceUID);
+            }
         }
     }
   else
@@ -1188,12 +1519,21 @@ void ctkDICOMDatabasePrivate::insertStudy(const ctkDICOMItem& ctkDataset, int db
 void ctkDICOMDatabasePrivate::insertSeries(const ctkDICOMItem& ctkDataset, QString studyInstanceUID)
 {
   QString seriesInstanceUID(ctkDataset.GetElementAsString(DCM_SeriesInstanceUID) );
-  QSqlQuery checkSeriesExistsQuery (Database);
-  checkSeriesExistsQuery.prepare ( "SELECT * FROM Series WHERE SeriesInstanceUID = ?" );
-  checkSeriesExistsQuery.bindValue ( 0, seriesInstanceUID );
-  logger.warn ( "Statement: " + checkSeriesExistsQuery.lastQuery() );
-  checkSeriesExistsQuery.exec();
-  if(!checkSeriesExistsQuery.next())
+  bool seriesExists;
+  if (this->BulkInsertDepth > 0)
+    {
+    seriesExists = this->BulkInsertSeries.contains(seriesInstanceUID);
+    }
+  else
+    {
+    QSqlQuery checkSeriesExistsQuery (Database);
+    checkSeriesExistsQuery.prepare ( "SELECT * FROM Series WHERE SeriesInstanceUID = ?" );
+    checkSeriesExistsQuery.bindValue ( 0, seriesInstanceUID );
+    logger.warn ( "Statement: " + checkSeriesExistsQuery.lastQuery() );
+    checkSeriesExistsQuery.exec();
+    seriesExists = checkSeriesExistsQuery.next();
+    }
+  if(!seriesExists)
     {
       qDebug() << "Need to insert new series: " << seriesInstanceUID;
 
@@ -1210,8 +1550,7 @@ void ctkDICOMDatabasePrivate::insertSeries(const ctkDICOMItem& ctkDataset, QStri
       long echoNumber(ctkDataset.GetElementAsInteger(DCM_EchoNumbers) );
       long temporalPosition(ctkDataset.GetElementAsInteger(DCM_TemporalPositionIdentifier) );
 
-      QSqlQuery insertSeriesStatement ( Database );
-      insertSeriesStatement.prepare ( "INSERT INTO Series ( 'SeriesInstanceUID', 'StudyInstanceUID', 'SeriesNumber', 'SeriesDate', 'SeriesTime', 'SeriesDescription', 'Modality', 'BodyPartExamined', 'FrameOfReferenceUID', 'AcquisitionNumber', 'ContrastAgent', 'ScanningSequence', 'EchoNumber', 'TemporalPosition' ) VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ? )" );
+      QSqlQuery insertSeriesStatement = preparedStatement ( "INSERT INTO Series ( 'SeriesInstanceUID', 'StudyInstanceUID', 'SeriesNumber', 'SeriesDate', 'SeriesTime', 'SeriesDescription', 'Modality', 'BodyPartExamined', 'FrameOfReferenceUID', 'AcquisitionNumber', 'ContrastAgent', 'ScanningSequence', 'EchoNumber', 'TemporalPosition' ) VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ? )" );
       insertSeriesStatement.bindValue ( 0, seriesInstanceUID );
       insertSeriesStatement.bindValue ( 1, studyInstanceUID );
       insertSeriesStatement.bindValue ( 2, static_cast<int>(seriesNumber) );
@@ -1236,6 +1575,10 @@ void ctkDICOMDatabasePrivate::insertSeries(const ctkDICOMItem& ctkDataset, QStri
       else
         {
           LastSeriesInstanceUID = seriesInstanceUID;
+          if (this->BulkInsertDepth > 0)
+            {
+            this->BulkInsertSeries.insert(seriesInstanceUID);
+            }
         }
     }
   else
@@ -1259,14 +1602,49 @@ const QStringList ctkDICOMDatabase::tagsToPrecache()
 }
 
 //------------------------------------------------------------------------------
-void ctkDICOMDatabasePrivate::precacheTags( const QString sopInstanceUID )
+void ctkDICOMDatabase::setHeaderOnlyParsing(bool enabled)
 {
-  Q_Q(ctkDICOMDatabase);
+  Q_D(ctkDICOMDatabase);
+  d->HeaderOnlyParsing = enabled;
+}
 
-  ctkDICOMItem dataset;
-  QString fileName = q->fileForInstance(sopInstanceUID);
-  dataset.InitializeFromFile(fileName);
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabase::headerOnlyParsing() const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->HeaderOnlyParsing;
+}
 
+//------------------------------------------------------------------------------
+DcmTagKey ctkDICOMDatabase::headerOnlyParsingStopTag()
+{
+  Q_D(ctkDICOMDatabase);
+  // last top-level attribute read by insert() to fill the database tables
+  DcmTagKey lastTag = DCM_TemporalPositionIdentifier;
+  foreach (const QString& tag, d->TagsToPrecache)
+    {
+    unsigned short group, element;
+    if (this->tagToGroupElement(tag, group, element) && DcmTagKey(group, element) > lastTag)
+      {
+      lastTag = DcmTagKey(group, element);
+      }
+    }
+  if (lastTag.getElement() == 0xffff)
+    {
+    return DcmTagKey(lastTag.getGroup() + 1, 0);
+    }
+  return DcmTagKey(lastTag.getGroup(), lastTag.getElement() + 1);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::precacheTags( const ctkDICOMItem& dataset, const QString sopInstanceUID )
+{
+  Q_Q(ctkDICOMDatabase);
+
+  if (this->TagsToPrecache.isEmpty())
+    {
+    return;
+    }
 
   QStringList sopInstanceUIDs, tags, values;
   foreach (const QString &tag, this->TagsToPrecache)
@@ -1280,6 +1658,20 @@ void ctkDICOMDatabasePrivate::precacheTags( const QString sopInstanceUID )
     values << value;
     }
 
+  // in a bulk insert session, the values of all the instances of the chunk
+  // are written at once when it is committed
+  if (this->BulkInsertDepth > 0)
+    {
+    for (int i = 0; i < values.count(); ++i)
+      {
+      this->rememberTagValue(sopInstanceUID, tags[i],
+                             values[i].isEmpty() ? TagNotInInstance : values[i]);
+      }
+    this->PendingTagCacheUIDs << sopInstanceUIDs;
+    this->PendingTagCacheTags << tags;
+    this->PendingTagCacheValues << values;
+    return;
+    }
   this->beginTransaction();
   q->cacheTags(sopInstanceUIDs, tags, values);
   this->endTransaction();
@@ -1302,8 +1694,7 @@ void ctkDICOMDatabasePrivate::insert( const ctkDICOMItem& ctkDataset, const QStr
 
   QString sopInstanceUID ( ctkDataset.GetElementAsString(DCM_SOPInstanceUID) );
 
-  QSqlQuery fileExistsQuery ( Database );
-  fileExistsQuery.prepare("SELECT InsertTimestamp,Filename FROM Images WHERE SOPInstanceUID == :sopInstanceUID");
+  QSqlQuery fileExistsQuery = preparedStatement("SELECT InsertTimestamp,Filename FROM Images WHERE SOPInstanceUID == :sopInstanceUID");
   fileExistsQuery.bindValue(":sopInstanceUID",sopInstanceUID);
   {
   bool success = fileExistsQuery.exec();
@@ -1332,8 +1723,7 @@ void ctkDICOMDatabasePrivate::insert( const ctkDICOMItem& ctkDataset, const QStr
         }
       else
         {
-        QSqlQuery deleteFile ( Database );
-        deleteFile.prepare("DELETE FROM Images WHERE SOPInstanceUID == :sopInstanceUID");
+        QSqlQuery deleteFile = preparedStatement("DELETE FROM Images WHERE SOPInstanceUID == :sopInstanceUID");
         deleteFile.bindValue(":sopInstanceUID",sopInstanceUID);
         bool success = deleteFile.exec();
         if (!success)
@@ -1463,15 +1853,13 @@ void ctkDICOMDatabasePrivate::insert( const ctkDICOMItem& ctkDataset, const QStr
       //
       if ( !filename.isEmpty() && !seriesInstanceUID.isEmpty() )
         {
-          QSqlQuery checkImageExistsQuery (Database);
-          checkImageExistsQuery.prepare ( "SELECT * FROM Images WHERE Filename = ?" );
+          QSqlQuery checkImageExistsQuery = preparedStatement ( "SELECT * FROM Images WHERE Filename = ?" );
           checkImageExistsQuery.bindValue ( 0, filename );
           checkImageExistsQuery.exec();
           qDebug() << "Maybe add Instance";
           if(!checkImageExistsQuery.next())
             {
-              QSqlQuery insertImageStatement ( Database );
-              insertImageStatement.prepare ( "INSERT INTO Images ( 'SOPInstanceUID', 'Filename', 'SeriesInstanceUID', 'InsertTimestamp' ) VALUES ( ?, ?, ?, ? )" );
+              QSqlQuery insertImageStatement = preparedStatement ( "INSERT INTO Images ( 'SOPInstanceUID', 'Filename', 'SeriesInstanceUID', 'InsertTimestamp' ) VALUES ( ?, ?, ?, ? )" );
               insertImageStatement.bindValue ( 0, sopInstanceUID );
               insertImageStatement.bindValue ( 1, filename );
               insertImageStatement.bindValue ( 2, seriesInstanceUID );
@@ -1479,11 +1867,13 @@ void ctkDICOMDatabasePrivate::insert( const ctkDICOMItem& ctkDataset, const QStr
               insertImageStatement.exec();
 
               // insert was needed, so cache any application-requested tags
-              this->precacheTags(sopInstanceUID);
+              this->precacheTags(ctkDataset, sopInstanceUID);
 
               // let users of this class track when things happen
               emit q->instanceAdded(sopInstanceUID);
               qDebug() << "Instance Added";
+
+              this->commitBulkInsertChunkIfNeeded();
             }
         }
 
@@ -1499,8 +1889,15 @@ void ctkDICOMDatabasePrivate::insert( const ctkDICOMItem& ctkDataset, const QStr
                 && (thumbnailInfo.lastModified() > QFileInfo(filename).lastModified())))
             {
               QDir(q->databaseDirectory() + "/thumbs/").mkpath(studySeriesDirectory);
-              DicomImage dcmImage(QDir::toNativeSeparators(filename).toLatin1());
-              thumbnailGenerator->generateThumbnail(&dcmImage, thumbnailPath);
+              if (this->DeferThumbnailGeneration)
+                {
+                this->addThumbnailJob(seriesInstanceUID, filename, thumbnailPath);
+                }
+              else
+                {
+                DicomImage dcmImage(QDir::toNativeSeparators(filename).toLatin1());
+                thumbnailGenerator->generateThumbnail(&dcmImage, thumbnailPath);
+                }
             }
         }
 
@@ -1521,8 +1918,7 @@ bool ctkDICOMDatabase::fileExistsAndUpToDate(const QString& filePath)
   Q_D(ctkDICOMDatabase);
   bool result(false);
 
-  QSqlQuery check_filename_query(database());
-  check_filename_query.prepare("SELECT InsertTimestamp FROM Images WHERE Filename == ?");
+  QSqlQuery check_filename_query = d->preparedStatement("SELECT InsertTimestamp FROM Images WHERE Filename == ?");
   check_filename_query.bindValue(0,filePath);
   d->loggedExec(check_filename_query);
   if (
@@ -1536,6 +1932,73 @@ bool ctkDICOMDatabase::fileExistsAndUpToDate(const QString& filePath)
   return result;
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::beginBulkInsert(int chunkSize)
+{
+  Q_D(ctkDICOMDatabase);
+  d->BulkInsertChunkSize = qMax(1, chunkSize);
+  if (d->BulkInsertDepth++ > 0)
+    {
+    return;
+    }
+  d->seedBulkInsertCaches();
+  d->beginBulkInsertTransaction();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::endBulkInsert()
+{
+  Q_D(ctkDICOMDatabase);
+  if (d->BulkInsertDepth == 0)
+    {
+    logger.warn("endBulkInsert called without matching beginBulkInsert");
+    return;
+    }
+  if (--d->BulkInsertDepth > 0)
+    {
+    return;
+    }
+  d->endBulkInsertTransaction();
+  d->BulkInsertStatements.clear();
+  d->BulkInsertPatients.clear();
+  d->BulkInsertStudies.clear();
+  d->BulkInsertSeries.clear();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabase::isBulkInsertActive() const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->BulkInsertDepth > 0;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::insertBatch(const QList<ctkDICOMItem*>& datasets, bool storeFile, bool generateThumbnail)
+{
+  Q_D(ctkDICOMDatabase);
+  this->beginBulkInsert(d->BulkInsertChunkSize);
+  foreach(ctkDICOMItem* dataset, datasets)
+    {
+    if (dataset)
+      {
+      d->insert(*dataset, QString(), storeFile, generateThumbnail);
+      }
+    }
+  this->endBulkInsert();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::insertBatch(const QStringList& filePaths, bool storeFile, bool generateThumbnail)
+{
+  Q_D(ctkDICOMDatabase);
+  this->beginBulkInsert(d->BulkInsertChunkSize);
+  foreach(const QString& filePath, filePaths)
+    {
+    this->insert(filePath, storeFile, generateThumbnail);
+    }
+  this->endBulkInsert();
+}
+
 
 //------------------------------------------------------------------------------
 bool ctkDICOMDatabase::isOpen() const
@@ -1632,10 +2095,47 @@ bool ctkDICOMDatabase::removeSeries(const QString& seriesInstanceUID)
 bool ctkDICOMDatabase::cleanup()
 {
   Q_D(ctkDICOMDatabase);
+  const QString emptySeries("WHERE ( SELECT COUNT(*) FROM Images WHERE Images.SeriesInstanceUID = Series.SeriesInstanceUID ) = 0;");
+  const QString emptyStudies("WHERE ( SELECT COUNT(*) FROM Series WHERE Series.StudyInstanceUID = Studies.StudyInstanceUID ) = 0;");
+  const QString emptyPatients("WHERE ( SELECT COUNT(*) FROM Studies WHERE Studies.PatientsUID = Patients.UID ) = 0;");
+
+  // In a bulk insert session, the removed rows are also erased from the
+  // in-memory mirror of the tables
   QSqlQuery seriesCleanup ( d->Database );
-  seriesCleanup.exec("DELETE FROM Series WHERE ( SELECT COUNT(*) FROM Images WHERE Images.SeriesInstanceUID = Series.SeriesInstanceUID ) = 0;");
-  seriesCleanup.exec("DELETE FROM Studies WHERE ( SELECT COUNT(*) FROM Series WHERE Series.StudyInstanceUID = Studies.StudyInstanceUID ) = 0;");
-  seriesCleanup.exec("DELETE FROM Patients WHERE ( SELECT COUNT(*) FROM Studies WHERE Studies.PatientsUID = Patients.UID ) = 0;");
+  if (d->BulkInsertDepth > 0 &&
+      seriesCleanup.exec("SELECT SeriesInstanceUID FROM Series " + emptySeries))
+    {
+    while (seriesCleanup.next())
+      {
+      d->BulkInsertSeries.remove(seriesCleanup.value(0).toString());
+      }
+    }
+  seriesCleanup.exec("DELETE FROM Series " + emptySeries);
+
+  if (d->BulkInsertDepth > 0 &&
+      seriesCleanup.exec("SELECT StudyInstanceUID FROM Studies " + emptyStudies))
+    {
+    while (seriesCleanup.next())
+      {
+      d->BulkInsertStudies.remove(seriesCleanup.value(0).toString());
+      }
+    }
+  seriesCleanup.exec("DELETE FROM Studies " + emptyStudies);
+
+  if (d->BulkInsertDepth > 0 &&
+      seriesCleanup.exec("SELECT UID, PatientID, PatientsName FROM Patients " + emptyPatients))
+    {
+    while (seriesCleanup.next())
+      {
+      QString key = seriesCleanup.value(1).toString() + QLatin1Char('\n') + seriesCleanup.value(2).toString();
+      QHash<QString, int>::iterator it = d->BulkInsertPatients.find(key);
+      if (it != d->BulkInsertPatients.end() && it.value() == seriesCleanup.value(0).toInt())
+        {
+        d->BulkInsertPatients.erase(it);
+        }
+      }
+    }
+  seriesCleanup.exec("DELETE FROM Patients " + emptyPatients);
   return true;
 }
 
@@ -1748,6 +2248,7 @@ bool ctkDICOMDatabase::initializeTagCache()
   if ( this->tagCacheExists() )
     {
     qDebug() << "TagCacheDatabase drop existing table\n";
+    d->clearTagValueCache();
     QSqlQuery dropCacheTable( d->TagCacheDatabase );
     dropCacheTable.prepare( "DROP TABLE TagCache" );
     d->loggedExec(dropCacheTable);
@@ -1771,6 +2272,13 @@ bool ctkDICOMDatabase::initializeTagCache()
 QString ctkDICOMDatabase::cachedTag(const QString sopInstanceUID, const QString tag)
 {
   Q_D(ctkDICOMDatabase);
+  QString* cachedValue = d->TagValueCache.object(d->tagValueCacheKey(sopInstanceUID, tag));
+  if (cachedValue)
+    {
+    ++d->TagValueCacheHits;
+    return *cachedValue;
+    }
+  ++d->TagValueCacheMisses;
   if ( !this->tagCacheExists() )
     {
     if ( !this->initializeTagCache() )
@@ -1778,6 +2286,7 @@ QString ctkDICOMDatabase::cachedTag(const QString sopInstanceUID, const QString
       return( "" );
       }
     }
+  d->flushPendingTagCache();
   QSqlQuery selectValue( d->TagCacheDatabase );
   selectValue.prepare( "SELECT Value FROM TagCache WHERE SOPInstanceUID = :sopInstanceUID AND Tag = :tag" );
   selectValue.bindValue(":sopInstanceUID",sopInstanceUID);
@@ -1791,6 +2300,7 @@ QString ctkDICOMDatabase::cachedTag(const QString sopInstanceUID, const QString
       {
       result = ValueIsEmptyString;
       }
+    d->rememberTagValue(sopInstanceUID, tag, result);
     }
   return( result );
 }
@@ -1827,6 +2337,12 @@ bool ctkDICOMDatabase::cacheTags(const QStringList sopInstanceUIDs, const QStrin
       }
     }
 
+  // write-through the in-process cache
+  for (int index = 0; index < values.count(); ++index)
+    {
+    d->rememberTagValue(sopInstanceUIDs[index], tags[index], values[index]);
+    }
+
   QSqlQuery insertTags( d->TagCacheDatabase );
   insertTags.prepare( "INSERT OR REPLACE INTO TagCache VALUES(?,?,?)" );
   insertTags.addBindValue(sopInstanceUIDs);
@@ -1834,3 +2350,263 @@ bool ctkDICOMDatabase::cacheTags(const QStringList sopInstanceUIDs, const QStrin
   insertTags.addBindValue(values);
   return d->loggedExecBatch(insertTags);
 }
+
+//------------------------------------------------------------------------------
+QStringList ctkDICOMDatabase::instanceValues(const QStringList& sopInstanceUIDs, const QStringList& tags)
+{
+  Q_D(ctkDICOMDatabase);
+  const int tagCount = tags.count();
+  // a null string marks a value that has not been found yet
+  QVector<QString> table(sopInstanceUIDs.count() * tagCount);
+
+  // rows of each instance, an instance may be requested more than once
+  QHash<QString, QList<int> > instanceRows;
+  for (int row = 0; row < sopInstanceUIDs.count(); ++row)
+    {
+    instanceRows[sopInstanceUIDs[row]] << row;
+    }
+  QHash<QString, int> tagColumns;
+  for (int column = 0; column < tagCount; ++column)
+    {
+    tagColumns.insert(tags[column], column);
+    }
+
+  //
+  // In-process cache
+  //
+  QStringList missingInstances;
+  QSet<QString> missingInstanceSet;
+  for (int row = 0; row < sopInstanceUIDs.count(); ++row)
+    {
+    bool missing = false;
+    for (int column = 0; column < tagCount; ++column)
+      {
+      QString* cachedValue = d->TagValueCache.object(
+        d->tagValueCacheKey(sopInstanceUIDs[row], tags[column]));
+      if (cachedValue)
+        {
+        ++d->TagValueCacheHits;
+        table[row * tagCount + column] = *cachedValue;
+        }
+      else
+        {
+        ++d->TagValueCacheMisses;
+        missing = true;
+        }
+      }
+    if (missing && !missingInstanceSet.contains(sopInstanceUIDs[row]))
+      {
+      missingInstanceSet.insert(sopInstanceUIDs[row]);
+      missingInstances << sopInstanceUIDs[row];
+      }
+    }
+
+  //
+  // TagCache table, by chunks to stay below the maximum number of host
+  // parameters of SQLite (999)
+  //
+  const int instanceChunkSize = 500;
+  const int tagChunkSize = 400;
+  if (!missingInstances.isEmpty() && (this->tagCacheExists() || this->initializeTagCache()))
+    {
+    d->flushPendingTagCache();
+    for (int tagStart = 0; tagStart < tagCount; tagStart += tagChunkSize)
+      {
+      QStringList tagChunk = tags.mid(tagStart, tagChunkSize);
+      for (int start = 0; start < missingInstances.count(); start += instanceChunkSize)
+        {
+        QStringList instanceChunk = missingInstances.mid(start, instanceChunkSize);
+        QStringList instancePlaceholders, tagPlaceholders;
+        for (int i = 0; i < instanceChunk.count(); ++i)
+          {
+          instancePlaceholders << "?";
+          }
+        for (int i = 0; i < tagChunk.count(); ++i)
+          {
+          tagPlaceholders << "?";
+          }
+        QSqlQuery selectValues( d->TagCacheDatabase );
+        selectValues.setForwardOnly(true);
+        selectValues.prepare(QString(
+          "SELECT SOPInstanceUID, Tag, Value FROM TagCache WHERE SOPInstanceUID IN (%1) AND Tag IN (%2)")
+          .arg(instancePlaceholders.join(",")).arg(tagPlaceholders.join(",")));
+        foreach(const QString& sopInstanceUID, instanceChunk)
+          {
+          selectValues.addBindValue(sopInstanceUID);
+          }
+        foreach(const QString& tag, tagChunk)
+          {
+          selectValues.addBindValue(tag);
+          }
+        if (!d->loggedExec(selectValues))
+          {
+          continue;
+          }
+        while (selectValues.next())
+          {
+          QString sopInstanceUID = selectValues.value(0).toString();
+          QString tag = selectValues.value(1).toString();
+          QString value = selectValues.value(2).toString();
+          if (value.isEmpty())
+            {
+            value = ValueIsEmptyString;
+            }
+          d->rememberTagValue(sopInstanceUID, tag, value);
+          int column = tagColumns.value(tag);
+          foreach(int row, instanceRows.value(sopInstanceUID))
+            {
+            table[row * tagCount + column] = value;
+            }
+          }
+        }
+      }
+    }
+
+  //
+  // Files, each file is parsed once for all its missing tags and the new
+  // values are cached in a single transaction
+  //
+  QStringList uncachedInstances;
+  foreach(const QString& sopInstanceUID, missingInstances)
+    {
+    int row = instanceRows.value(sopInstanceUID).first();
+    for (int column = 0; column < tagCount; ++column)
+      {
+      if (table[row * tagCount + column].isNull())
+        {
+        uncachedInstances << sopInstanceUID;
+        break;
+        }
+      }
+    }
+  if (!uncachedInstances.isEmpty())
+    {
+    QHash<QString, QString> instanceFiles;
+    for (int start = 0; start < uncachedInstances.count(); start += instanceChunkSize)
+      {
+      QStringList instanceChunk = uncachedInstances.mid(start, instanceChunkSize);
+      QStringList placeholders;
+      for (int i = 0; i < instanceChunk.count(); ++i)
+        {
+        placeholders << "?";
+        }
+      QSqlQuery selectFiles( d->Database );
+      selectFiles.setForwardOnly(true);
+      selectFiles.prepare(QString("SELECT SOPInstanceUID, Filename FROM Images WHERE SOPInstanceUID IN (%1)")
+                          .arg(placeholders.join(",")));
+      foreach(const QString& sopInstanceUID, instanceChunk)
+        {
+        selectFiles.addBindValue(sopInstanceUID);
+        }
+      if (d->loggedExec(selectFiles))
+        {
+        while (selectFiles.next())
+          {
+          instanceFiles.insert(selectFiles.value(0).toString(), selectFiles.value(1).toString());
+          }
+        }
+      }
+
+    QStringList newInstances, newTags, newValues;
+    foreach(const QString& sopInstanceUID, uncachedInstances)
+      {
+      if (!instanceFiles.contains(sopInstanceUID))
+        {
+        // instanceValue() does not cache anything for unknown instances
+        continue;
+        }
+      ctkDICOMItem dataset;
+      dataset.InitializeFromFile(instanceFiles.value(sopInstanceUID));
+      const QList<int> rows = instanceRows.value(sopInstanceUID);
+      for (int column = 0; column < tagCount; ++column)
+        {
+        if (!table[rows.first() * tagCount + column].isNull())
+          {
+          continue;
+          }
+        QString value = TagNotInInstance;
+        unsigned short group, element;
+        if (dataset.IsInitialized() && this->tagToGroupElement(tags[column], group, element))
+          {
+          value = dataset.GetAllElementValuesAsString(DcmTagKey(group, element));
+          }
+        newInstances << sopInstanceUID;
+        newTags << tags[column];
+        newValues << value;
+        foreach(int row, rows)
+          {
+          table[row * tagCount + column] = value;
+          }
+        }
+      }
+    if (!newInstances.isEmpty())
+      {
+      d->beginTagCacheTransaction();
+      this->cacheTags(newInstances, newTags, newValues);
+      d->endTagCacheTransaction();
+      }
+    }
+
+  QStringList result;
+  result.reserve(table.count());
+  foreach(const QString& value, table)
+    {
+    if (value == TagNotInInstance || value == ValueIsEmptyString)
+      {
+      result << QString("");
+      }
+    else
+      {
+      result << value;
+      }
+    }
+  return result;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::precacheSeriesTags(const QString& seriesInstanceUID, const QStringList& tags)
+{
+  Q_D(ctkDICOMDatabase);
+  QStringList tagsToCache = tags.isEmpty() ? d->TagsToPrecache : tags;
+  if (tagsToCache.isEmpty())
+    {
+    return;
+    }
+  this->instanceValues(this->instancesForSeries(seriesInstanceUID), tagsToCache);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMDatabase::tagCacheHitCount() const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->TagValueCacheHits;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMDatabase::tagCacheMissCount() const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->TagValueCacheMisses;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::resetTagCacheStatistics()
+{
+  Q_D(ctkDICOMDatabase);
+  d->TagValueCacheHits = 0;
+  d->TagValueCacheMisses = 0;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::setTagCacheMemorySize(int entries)
+{
+  Q_D(ctkDICOMDatabase);
+  d->TagValueCache.setMaxCost(qMax(0, entries));
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMDatabase::tagCacheMemorySize() const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->TagValueCache.maxCost();
+}
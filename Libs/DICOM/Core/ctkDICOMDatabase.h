@@ -57,6 +57,8 @@ class CTK_DICOM_CORE_EXPORT ctkDICOMDatabase : public QObject
   Q_PROPERTY(QString lastError READ lastError)
   Q_PROPERTY(QString databaseFilename READ databaseFilename)
   Q_PROPERTY(QStringList tagsToPrecache READ tagsToPrecache WRITE setTagsToPrecache)
+  Q_PROPERTY(bool headerOnlyParsing READ headerOnlyParsing WRITE setHeaderOnlyParsing)
+  Q_PROPERTY(bool deferThumbnailGeneration READ deferThumbnailGeneration WRITE setDeferThumbnailGeneration)
 
 public:
   explicit ctkDICOMDatabase(QObject *parent = 0);
@@ -92,6 +94,15 @@ public:
   /// get thumbnail genrator object
   ctkDICOMAbstractThumbnailGenerator* thumbnailGenerator();
 
+  ///
+  /// \brief defer thumbnail generation to a ctkDICOMThumbnailService
+  /// If enabled, insert() does not render thumbnails anymore but records a
+  /// job in the ThumbnailJobs table of the database and emits
+  /// thumbnailJobAdded(). The jobs are processed by ctkDICOMThumbnailService.
+  /// Disabled by default.
+  void setDeferThumbnailGeneration(bool defer);
+  bool deferThumbnailGeneration() const;
+
   ///
   /// open the SQLite database in @param databaseFile . If the file does not
   /// exist, a new database is created and initialized with the
@@ -170,6 +181,19 @@ public:
   void setTagsToPrecache(const QStringList tags);
   const QStringList tagsToPrecache();
 
+  ///
+  /// \brief only parse the part of the files needed for indexing
+  /// If enabled, insert(filePath) stops parsing a file at the first element
+  /// following all the attributes stored in the database tables and the
+  /// tagsToPrecache, so that pixel data and large trailing sequences (e.g.
+  /// the functional groups of enhanced multi-frame images) are skipped.
+  /// Disabled by default.
+  /// \sa headerOnlyParsingStopTag()
+  void setHeaderOnlyParsing(bool enabled);
+  bool headerOnlyParsing() const;
+  /// Tag at which parsing stops when headerOnlyParsing is enabled.
+  DcmTagKey headerOnlyParsingStopTag();
+
   /// Insert into the database if not already exsting.
   /// @param dataset The dataset to store into the database. Usually, this is
   ///                is a complete DICOM object, like a complete image. However
@@ -193,6 +217,31 @@ public:
                             bool storeFile = true, bool generateThumbnail = true,
                             bool createHierarchy = true,
                             const QString& destinationDirectoryName = QString() );
+  /// Insert a dataset that has already been read from \a filePath.
+  /// This is the counterpart of insert(filePath, ...) for callers that
+  /// parse the file themselves, e.g. on a worker thread. The caller is
+  /// responsible for checking fileExistsAndUpToDate() beforehand.
+  void insert ( const ctkDICOMItem& ctkDataset, const QString& filePath,
+                bool storeFile = true, bool generateThumbnail = true );
+
+  ///
+  /// \brief Bulk insert session
+  /// Between beginBulkInsert() and endBulkInsert(), inserts reuse prepared
+  /// statements, resolve patient/study/series existence from in-memory
+  /// caches seeded at session start and are grouped into transactions of
+  /// \a chunkSize instances. Sessions can be nested, only the outermost
+  /// pair opens and commits the session.
+  /// \note Other connections only see the inserted data once a chunk is committed.
+  Q_INVOKABLE void beginBulkInsert(int chunkSize = 500);
+  Q_INVOKABLE void endBulkInsert();
+  bool isBulkInsertActive() const;
+
+  /// Insert several datasets or files within a single bulk insert session.
+  /// \sa beginBulkInsert()
+  void insertBatch(const QList<ctkDICOMItem*>& datasets,
+                   bool storeFile = true, bool generateThumbnail = true);
+  Q_INVOKABLE void insertBatch(const QStringList& filePaths,
+                               bool storeFile = true, bool generateThumbnail = true);
 
   /// Check if file is already in database and up-to-date
   bool fileExistsAndUpToDate(const QString& filePath);
@@ -241,6 +290,29 @@ public:
   /// Insert lists of tags into the cache as a batch query operation
   Q_INVOKABLE bool cacheTags (const QStringList sopInstanceUIDs, const QStringList tags, const QStringList values);
 
+  ///
+  /// \brief batch version of instanceValue()
+  /// Return a dense row-major table: the value of tags[j] for
+  /// sopInstanceUIDs[i] is at index i * tags.count() + j.
+  /// The tag cache is queried with a few statements instead of one per
+  /// value, each file is parsed at most once for all its uncached tags and
+  /// the new values are cached in a single transaction.
+  Q_INVOKABLE QStringList instanceValues (const QStringList& sopInstanceUIDs, const QStringList& tags);
+  /// Cache \a tags (tagsToPrecache if empty) for all the instances of the
+  /// series in a single transaction.
+  Q_INVOKABLE void precacheSeriesTags (const QString& seriesInstanceUID, const QStringList& tags = QStringList());
+
+  ///
+  /// \brief in-process cache in front of the tag cache table
+  /// Lookups served from memory are counted as hits, the ones that need to
+  /// query the tag cache table as misses.
+  int tagCacheHitCount() const;
+  int tagCacheMissCount() const;
+  Q_INVOKABLE void resetTagCacheStatistics();
+  /// Maximum number of values kept in memory (100000 by default)
+  void setTagCacheMemorySize(int entries);
+  int tagCacheMemorySize() const;
+
 
 Q_SIGNALS:
   /// Things inserted to database.
@@ -260,6 +332,9 @@ Q_SIGNALS:
   /// instanceAdded arguments:
   ///  - instanceUID (unique)
   void instanceAdded(QString);
+  /// Indicates that a thumbnail job has been recorded for the series
+  /// \sa setDeferThumbnailGeneration()
+  void thumbnailJobAdded(QString);
   /// Indicates that an in-memory database has been updated
   void databaseChanged();
   /// Indicates that the schema is about to be updated and how many files will be processed
@@ -22,6 +22,9 @@
 
 #include "ctkDICOMModel.h"
 
+// Qt includes
+#include <QTimer>
+
 //logger
 #include <ctkLogger.h>
 static ctkLogger logger("org.commontk.DICOM.Core.ctkDICOMFilterProxyModel");
@@ -37,22 +40,60 @@ protected:
 public:
   ctkDICOMFilterProxyModelPrivate(ctkDICOMFilterProxyModel* parent = 0);
 
+  void init();
+  void scheduleFilterUpdate();
+  ctkDICOMModel* dicomModel()const;
+
   QString searchTextName;
   QString searchTextStudy;
   QString searchTextSeries;
   QString searchTextID;
+
+  // compiled once per change of the search texts
+  QRegExp regExpName;
+  QRegExp regExpStudy;
+  QRegExp regExpSeries;
+
+  QTimer filterTimer;
+  bool databaseFiltering;
 };
 
 //----------------------------------------------------------------------------
 ctkDICOMFilterProxyModelPrivate::ctkDICOMFilterProxyModelPrivate(ctkDICOMFilterProxyModel* parent): q_ptr(parent){
+    this->databaseFiltering = false;
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMFilterProxyModelPrivate::init(){
+    Q_Q(ctkDICOMFilterProxyModel);
+    this->filterTimer.setSingleShot(true);
+    this->filterTimer.setInterval(0);
+    QObject::connect(&this->filterTimer, SIGNAL(timeout()), q, SLOT(updateFilter()));
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMFilterProxyModelPrivate::scheduleFilterUpdate(){
+    Q_Q(ctkDICOMFilterProxyModel);
+    if(this->filterTimer.interval() > 0){
+        // restarts the timer if it is already running
+        this->filterTimer.start();
+    }else{
+        q->updateFilter();
+    }
+}
 
+//----------------------------------------------------------------------------
+ctkDICOMModel* ctkDICOMFilterProxyModelPrivate::dicomModel()const{
+    Q_Q(const ctkDICOMFilterProxyModel);
+    return const_cast<ctkDICOMModel*>(qobject_cast<const ctkDICOMModel*>(q->sourceModel()));
 }
 
 //----------------------------------------------------------------------------
 ctkDICOMFilterProxyModel::ctkDICOMFilterProxyModel(QObject *parent):Superclass(parent),
     d_ptr(new ctkDICOMFilterProxyModelPrivate(this))
 {
-
+    Q_D(ctkDICOMFilterProxyModel);
+    d->init();
 }
 
 //----------------------------------------------------------------------------
@@ -60,63 +101,121 @@ ctkDICOMFilterProxyModel::~ctkDICOMFilterProxyModel(){
 
 }
 
+//----------------------------------------------------------------------------
+int ctkDICOMFilterProxyModel::filterDelay()const{
+    Q_D(const ctkDICOMFilterProxyModel);
+    return d->filterTimer.interval();
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMFilterProxyModel::setFilterDelay(int msec){
+    Q_D(ctkDICOMFilterProxyModel);
+    d->filterTimer.setInterval(qMax(0, msec));
+}
+
+//----------------------------------------------------------------------------
+bool ctkDICOMFilterProxyModel::databaseFiltering()const{
+    Q_D(const ctkDICOMFilterProxyModel);
+    return d->databaseFiltering;
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMFilterProxyModel::setDatabaseFiltering(bool enabled){
+    Q_D(ctkDICOMFilterProxyModel);
+    if(d->databaseFiltering == enabled){
+        return;
+    }
+    ctkDICOMModel* model = d->dicomModel();
+    if(!enabled && model){
+        // the rows excluded by the database must be queried again
+        QMap<QString, QVariant> parameters = model->searchParameters();
+        parameters.remove("Name");
+        parameters.remove("Study");
+        parameters.remove("Series");
+        parameters.remove("ID");
+        model->setSearchParameters(parameters);
+    }
+    d->databaseFiltering = enabled;
+    this->updateFilter();
+}
+
 //----------------------------------------------------------------------------
 void ctkDICOMFilterProxyModel::setNameSearchText(const QString &text){
     Q_D(ctkDICOMFilterProxyModel);
     d->searchTextName = text;
-    this->invalidateFilter();
+    d->regExpName = QRegExp(text);
+    d->scheduleFilterUpdate();
 }
 
 //----------------------------------------------------------------------------
 void ctkDICOMFilterProxyModel::setStudySearchText(const QString &text){
     Q_D(ctkDICOMFilterProxyModel);
     d->searchTextStudy = text;
-    this->invalidateFilter();
+    d->regExpStudy = QRegExp(text);
+    d->scheduleFilterUpdate();
 }
 
 //----------------------------------------------------------------------------
 void ctkDICOMFilterProxyModel::setSeriesSearchText(const QString &text){
     Q_D(ctkDICOMFilterProxyModel);
     d->searchTextSeries = text;
-    this->invalidateFilter();
+    d->regExpSeries = QRegExp(text);
+    d->scheduleFilterUpdate();
 }
 
 //----------------------------------------------------------------------------
 void ctkDICOMFilterProxyModel::setIdSearchText(const QString &text){
     Q_D(ctkDICOMFilterProxyModel);
     d->searchTextID = text;
+    d->scheduleFilterUpdate();
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMFilterProxyModel::updateFilter(){
+    Q_D(ctkDICOMFilterProxyModel);
+    d->filterTimer.stop();
+
+    ctkDICOMModel* model = d->dicomModel();
+    if(d->databaseFiltering && model){
+        QMap<QString, QVariant> parameters = model->searchParameters();
+        parameters["Name"] = d->searchTextName;
+        parameters["Study"] = d->searchTextStudy;
+        parameters["Series"] = d->searchTextSeries;
+        parameters["ID"] = d->searchTextID;
+        if(parameters != model->searchParameters()){
+            model->setSearchParameters(parameters);
+        }
+    }
     this->invalidateFilter();
 }
 
+//----------------------------------------------------------------------------
 bool ctkDICOMFilterProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const{
     Q_D(const ctkDICOMFilterProxyModel);
 
-    ctkDICOMModel* model = const_cast<ctkDICOMModel*>(qobject_cast<const ctkDICOMModel*>(this->sourceModel()));
+    ctkDICOMModel* model = d->dicomModel();
 
-    if(model){
+    if(model && !d->databaseFiltering){
         QModelIndex index = model->index(source_row, 0, source_parent);
-        if(model->data(index, ctkDICOMModel::TypeRole) == static_cast<int>(ctkDICOMModel::PatientType)){
-            QRegExp regExp = QRegExp(d->searchTextName);
-            if(model->data(index, Qt::DisplayRole).toString().contains(regExp)){
-                return true;
-            }else{
-                return false;
-            }
-        }else if(model->data(index, ctkDICOMModel::TypeRole) == static_cast<int>(ctkDICOMModel::StudyType)){
-            QRegExp regExp = QRegExp(d->searchTextStudy);
-            if(model->data(index, Qt::DisplayRole).toString().contains(regExp)){
-                return true;
-            }else{
-                return false;
-            }
-        }else if(model->data(index, ctkDICOMModel::TypeRole) == static_cast<int>(ctkDICOMModel::SeriesType)){
-            QRegExp regExp = QRegExp(d->searchTextSeries);
-            if(model->data(index, Qt::DisplayRole).toString().contains(regExp)){
-                return true;
-            }else{
-                return false;
-            }
+        const QRegExp* regExp = 0;
+        switch(model->data(index, ctkDICOMModel::TypeRole).toInt()){
+        case ctkDICOMModel::PatientType:
+            regExp = &d->regExpName;
+            break;
+        case ctkDICOMModel::StudyType:
+            regExp = &d->regExpStudy;
+            break;
+        case ctkDICOMModel::SeriesType:
+            regExp = &d->regExpSeries;
+            break;
+        default:
+            return true;
+        }
+        // an empty expression matches all the rows, no need to fetch their data
+        if(regExp->isEmpty()){
+            return true;
         }
+        return model->data(index, Qt::DisplayRole).toString().contains(*regExp);
     }
 
     return true;
@@ -29,8 +29,22 @@
 class ctkDICOMFilterProxyModelPrivate;
 
 /// \ingroup DICOM_Core
+///
+/// Filters the patients, studies and series of a ctkDICOMModel with the
+/// regular expressions given by the search texts. The regular expressions
+/// are compiled once, when the search texts are set.
 class CTK_DICOM_CORE_EXPORT ctkDICOMFilterProxyModel : public QSortFilterProxyModel{
     Q_OBJECT
+    /// Time in milliseconds to wait after the last change of a search text
+    /// before filtering again, so that typing a search text filters only
+    /// once. 0 (the default) filters immediately.
+    Q_PROPERTY(int filterDelay READ filterDelay WRITE setFilterDelay)
+    /// If true, the search texts are given to the source ctkDICOMModel as
+    /// search parameters, so that only the matching rows are queried from
+    /// the database, instead of filtering the fetched rows. The search texts
+    /// are then matched as substrings and not as regular expressions.
+    /// False by default.
+    Q_PROPERTY(bool databaseFiltering READ databaseFiltering WRITE setDatabaseFiltering)
 
 public:
     typedef QSortFilterProxyModel Superclass;
@@ -39,6 +53,16 @@ public:
 
     virtual bool filterAcceptsRow ( int source_row, const QModelIndex & source_parent ) const;
 
+    int filterDelay()const;
+    void setFilterDelay(int msec);
+
+    bool databaseFiltering()const;
+    void setDatabaseFiltering(bool enabled);
+
+protected Q_SLOTS:
+    /// Filter again with the current search texts
+    void updateFilter();
+
 protected:
     QScopedPointer<ctkDICOMFilterProxyModelPrivate> d_ptr;
 
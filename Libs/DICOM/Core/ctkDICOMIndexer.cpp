@@ -30,12 +30,14 @@
 #include <QDirIterator>
 #include <QFileInfo>
 #include <QDebug>
+#include <QThreadPool>
 
 // ctkDICOM includes
 #include "ctkLogger.h"
 #include "ctkDICOMIndexer.h"
 #include "ctkDICOMIndexer_p.h"
 #include "ctkDICOMDatabase.h"
+#include "ctkDICOMItem.h"
 
 // DCMTK includes
 #include <dcmtk/dcmdata/dcfilefo.h>
@@ -55,11 +57,140 @@ static ctkLogger logger("org.commontk.dicom.DICOMIndexer" );
 //------------------------------------------------------------------------------
 
 
+//------------------------------------------------------------------------------
+// ctkDICOMIndexerParsedFileQueue methods
+
+//------------------------------------------------------------------------------
+ctkDICOMIndexerParsedFileQueue::ctkDICOMIndexerParsedFileQueue(int capacity, int numberOfProducers)
+  : Capacity(qMax(1, capacity))
+  , ActiveProducers(numberOfProducers)
+  , Aborted(false)
+{
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMIndexerParsedFileQueue::~ctkDICOMIndexerParsedFileQueue()
+{
+  while (!this->Queue.isEmpty())
+    {
+    delete this->Queue.dequeue().Dataset;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMIndexerParsedFileQueue::push(const ctkDICOMIndexerParsedFile& parsedFile)
+{
+  QMutexLocker lock(&this->Mutex);
+  while (this->Queue.size() >= this->Capacity && !this->Aborted)
+    {
+    this->NotFull.wait(&this->Mutex);
+    }
+  if (this->Aborted)
+    {
+    delete parsedFile.Dataset;
+    return false;
+    }
+  this->Queue.enqueue(parsedFile);
+  this->NotEmpty.wakeOne();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMIndexerParsedFileQueue::pop(ctkDICOMIndexerParsedFile& parsedFile)
+{
+  QMutexLocker lock(&this->Mutex);
+  while (this->Queue.isEmpty() && this->ActiveProducers > 0 && !this->Aborted)
+    {
+    this->NotEmpty.wait(&this->Mutex);
+    }
+  if (this->Aborted || this->Queue.isEmpty())
+    {
+    return false;
+    }
+  parsedFile = this->Queue.dequeue();
+  this->NotFull.wakeOne();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMIndexerParsedFileQueue::producerFinished()
+{
+  QMutexLocker lock(&this->Mutex);
+  --this->ActiveProducers;
+  this->NotEmpty.wakeAll();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMIndexerParsedFileQueue::abort()
+{
+  QMutexLocker lock(&this->Mutex);
+  this->Aborted = true;
+  this->NotEmpty.wakeAll();
+  this->NotFull.wakeAll();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMIndexerParsedFileQueue::isAborted() const
+{
+  QMutexLocker lock(&this->Mutex);
+  return this->Aborted;
+}
+
+//------------------------------------------------------------------------------
+// ctkDICOMIndexerReader methods
+
+//------------------------------------------------------------------------------
+ctkDICOMIndexerReader::ctkDICOMIndexerReader(const QStringList& files,
+                                             QAtomicInt& nextFileIndex,
+                                             ctkDICOMIndexerParsedFileQueue& queue,
+                                             const DcmTagKey& stopParsingAtElement)
+  : Files(files)
+  , StopParsingAtElement(stopParsingAtElement)
+  , NextFileIndex(nextFileIndex)
+  , Queue(queue)
+{
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMIndexerReader::run()
+{
+  while (!this->Queue.isAborted())
+    {
+    int fileIndex = this->NextFileIndex.fetchAndAddOrdered(1);
+    if (fileIndex >= this->Files.size())
+      {
+      break;
+      }
+    ctkDICOMIndexerParsedFile parsedFile;
+    parsedFile.FilePath = this->Files.at(fileIndex);
+    parsedFile.Dataset = new ctkDICOMItem;
+    if (this->StopParsingAtElement != DCM_UndefinedTagKey)
+      {
+      parsedFile.Dataset->InitializeFromFileHeader(parsedFile.FilePath, this->StopParsingAtElement);
+      }
+    else
+      {
+      parsedFile.Dataset->InitializeFromFile(parsedFile.FilePath);
+      }
+    if (!parsedFile.Dataset->IsInitialized())
+      {
+      delete parsedFile.Dataset;
+      parsedFile.Dataset = 0;
+      }
+    if (!this->Queue.push(parsedFile))
+      {
+      break;
+      }
+    }
+  this->Queue.producerFinished();
+}
+
 //------------------------------------------------------------------------------
 // ctkDICOMIndexerPrivate methods
 
 //------------------------------------------------------------------------------
-ctkDICOMIndexerPrivate::ctkDICOMIndexerPrivate(ctkDICOMIndexer& o) : q_ptr(&o), Canceled(false)
+ctkDICOMIndexerPrivate::ctkDICOMIndexerPrivate(ctkDICOMIndexer& o)
+  : q_ptr(&o), Canceled(false), NumberOfReaderThreads(1)
 {
 }
 
@@ -68,6 +199,83 @@ ctkDICOMIndexerPrivate::~ctkDICOMIndexerPrivate()
 {
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMIndexerPrivate::addListOfFilesParallel(ctkDICOMDatabase& database,
+                                                    const QStringList& listOfFiles,
+                                                    const QString& destinationDirectoryName)
+{
+  Q_Q(ctkDICOMIndexer);
+  if (!destinationDirectoryName.isEmpty())
+    {
+    logger.warn("Ignoring destinationDirectoryName parameter, just taking it as indication we should copy!");
+    }
+  bool storeFile = !destinationDirectoryName.isEmpty();
+
+  // The up-to-date check needs the database connection, which belongs to
+  // this thread, so it is done here before any file is handed to a reader.
+  QStringList filesToParse;
+  foreach(const QString& filePath, listOfFiles)
+    {
+    if (database.fileExistsAndUpToDate(filePath))
+      {
+      logger.debug( "File " + filePath + " already added.");
+      }
+    else
+      {
+      filesToParse << filePath;
+      }
+    }
+
+  int currentFileIndex = listOfFiles.size() - filesToParse.size();
+  if (filesToParse.isEmpty())
+    {
+    return;
+    }
+
+  int numberOfReaders = qMin(this->NumberOfReaderThreads, filesToParse.size());
+  // Keep a few parsed headers per reader in flight so the readers do not
+  // stall on the writer, while bounding the memory held by the queue.
+  ctkDICOMIndexerParsedFileQueue queue(4 * numberOfReaders, numberOfReaders);
+  QAtomicInt nextFileIndex(0);
+  DcmTagKey stopParsingAtElement = DCM_UndefinedTagKey;
+  if (database.headerOnlyParsing())
+    {
+    stopParsingAtElement = database.headerOnlyParsingStopTag();
+    }
+
+  QThreadPool readerPool;
+  readerPool.setMaxThreadCount(numberOfReaders);
+  for (int i = 0; i < numberOfReaders; ++i)
+    {
+    readerPool.start(new ctkDICOMIndexerReader(filesToParse, nextFileIndex, queue, stopParsingAtElement));
+    }
+
+  // All database accesses stay on this thread.
+  ctkDICOMIndexerParsedFile parsedFile;
+  while (queue.pop(parsedFile))
+    {
+    int percent = ( 100 * currentFileIndex ) / listOfFiles.size();
+    emit q->progress(percent);
+    emit q->indexingFilePath(parsedFile.FilePath);
+    if (parsedFile.Dataset)
+      {
+      database.insert(*parsedFile.Dataset, parsedFile.FilePath, storeFile, true);
+      delete parsedFile.Dataset;
+      }
+    else
+      {
+      logger.warn(QString("Could not read DICOM file:") + parsedFile.FilePath);
+      }
+    currentFileIndex++;
+
+    if (this->Canceled)
+      {
+      queue.abort();
+      }
+    }
+  readerPool.waitForDone();
+}
+
 //------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
@@ -131,6 +339,14 @@ void ctkDICOMIndexer::addListOfFiles(ctkDICOMDatabase& ctkDICOMDatabase,
 {
   Q_D(ctkDICOMIndexer);
   d->Canceled = false;
+  ctkDICOMDatabase.beginBulkInsert();
+  if (d->NumberOfReaderThreads > 1 && listOfFiles.size() > 1)
+  {
+    d->addListOfFilesParallel(ctkDICOMDatabase, listOfFiles, destinationDirectoryName);
+    ctkDICOMDatabase.endBulkInsert();
+    emit this->indexingComplete();
+    return;
+  }
   int CurrentFileIndex = 0;
   foreach(QString filePath, listOfFiles)
   {
@@ -144,6 +360,7 @@ void ctkDICOMIndexer::addListOfFiles(ctkDICOMDatabase& ctkDICOMDatabase,
       break;
       }
   }
+  ctkDICOMDatabase.endBulkInsert();
   emit this->indexingComplete();
 }
 
@@ -277,6 +494,20 @@ void ctkDICOMIndexer::refreshDatabase(ctkDICOMDatabase& dicomDatabase, const QSt
   */
   }
 
+//------------------------------------------------------------------------------
+void ctkDICOMIndexer::setNumberOfReaderThreads(int numberOfThreads)
+{
+  Q_D(ctkDICOMIndexer);
+  d->NumberOfReaderThreads = qMax(1, numberOfThreads);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMIndexer::numberOfReaderThreads() const
+{
+  Q_D(const ctkDICOMIndexer);
+  return d->NumberOfReaderThreads;
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMIndexer::waitForImportFinished()
 {
@@ -83,6 +83,17 @@ public:
 
   Q_INVOKABLE void refreshDatabase(ctkDICOMDatabase& database, const QString& directoryName);
 
+  ///
+  /// \brief Number of threads used to parse DICOM headers in addListOfFiles.
+  ///
+  /// With more than one thread, files are read on a thread pool and the
+  /// parsed datasets are passed through a bounded queue to the calling
+  /// thread, which remains the only one writing to the database.
+  /// The default (1) parses and inserts each file on the calling thread.
+  ///
+  void setNumberOfReaderThreads(int numberOfThreads);
+  int numberOfReaderThreads() const;
+
   ///
   /// \brief Deprecated - no op.
   /// \deprecated
@@ -21,10 +21,83 @@
 #ifndef CTKDICOMINDEXERPRIVATE_H
 #define CTKDICOMINDEXERPRIVATE_H
 
+#include <QAtomicInt>
+#include <QMutex>
 #include <QObject>
+#include <QQueue>
+#include <QRunnable>
+#include <QStringList>
+#include <QWaitCondition>
 
 #include "ctkDICOMIndexer.h"
 
+// DCMTK includes
+#include <dcmtk/dcmdata/dctagkey.h>
+
+class ctkDICOMItem;
+
+//------------------------------------------------------------------------------
+struct ctkDICOMIndexerParsedFile
+{
+  QString FilePath;
+  /// NULL if the file could not be read
+  ctkDICOMItem* Dataset;
+};
+
+//------------------------------------------------------------------------------
+/// \internal
+/// Bounded queue handing parsed datasets from the reader threads over to the
+/// (single) database writer thread.
+class ctkDICOMIndexerParsedFileQueue
+{
+public:
+  ctkDICOMIndexerParsedFileQueue(int capacity, int numberOfProducers);
+  ~ctkDICOMIndexerParsedFileQueue();
+
+  /// Blocks while the queue is full. If the queue has been aborted, the
+  /// dataset is deleted and false is returned.
+  bool push(const ctkDICOMIndexerParsedFile& parsedFile);
+
+  /// Blocks while the queue is empty and some producers are still running.
+  /// Returns false once all producers are finished and the queue is drained,
+  /// or if the queue has been aborted.
+  bool pop(ctkDICOMIndexerParsedFile& parsedFile);
+
+  void producerFinished();
+  void abort();
+  bool isAborted() const;
+
+private:
+  mutable QMutex Mutex;
+  QWaitCondition NotEmpty;
+  QWaitCondition NotFull;
+  QQueue<ctkDICOMIndexerParsedFile> Queue;
+  int Capacity;
+  int ActiveProducers;
+  bool Aborted;
+};
+
+//------------------------------------------------------------------------------
+/// \internal
+/// Parses DICOM headers of a shared file list on a pool thread. Readers
+/// pick files through a shared atomic index until the list is exhausted.
+/// Parsing stops at \a stopParsingAtElement unless it is DCM_UndefinedTagKey.
+class ctkDICOMIndexerReader : public QRunnable
+{
+public:
+  ctkDICOMIndexerReader(const QStringList& files, QAtomicInt& nextFileIndex,
+                        ctkDICOMIndexerParsedFileQueue& queue,
+                        const DcmTagKey& stopParsingAtElement);
+
+  void run();
+
+private:
+  QStringList Files;
+  DcmTagKey StopParsingAtElement;
+  QAtomicInt& NextFileIndex;
+  ctkDICOMIndexerParsedFileQueue& Queue;
+};
+
 //------------------------------------------------------------------------------
 class ctkDICOMIndexerPrivate : public QObject
 {
@@ -39,9 +112,15 @@ public:
   ctkDICOMIndexerPrivate(ctkDICOMIndexer&);
   ~ctkDICOMIndexerPrivate();
 
+  /// Parse the files on NumberOfReaderThreads threads and insert them into
+  /// the database from the calling thread.
+  void addListOfFilesParallel(ctkDICOMDatabase& database, const QStringList& listOfFiles,
+                              const QString& destinationDirectoryName);
+
 public:
   ctkDICOMAbstractThumbnailGenerator* thumbnailGenerator;
   bool                    Canceled;
+  int                     NumberOfReaderThreads;
 };
 
 
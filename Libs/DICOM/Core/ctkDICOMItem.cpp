@@ -28,19 +28,205 @@
 #include <stdexcept>
 
 
+namespace
+{
+
+/// A character set that DICOM designates with the ISO 2022 code extension technique
+struct ctkDICOMCodeElement
+{
+  const char* Term;      ///< defined term of the Specific Character Set attribute
+  const char* Escape;    ///< escape sequence designating the character set
+  bool G1;               ///< designated to G1 (bytes >= 0x80) instead of G0
+  const char* CodecName; ///< Qt codec decoding the bytes, 0 for ASCII
+};
+
+/// See DICOM PS 3.3 C.12.1.1.2 (Specific Character Set)
+const ctkDICOMCodeElement ctkDICOMCodeElements[] =
+{
+  { "ISO 2022 IR 6",   "\x1b(B",  false, 0 },
+  { "ISO 2022 IR 100", "\x1b-A",  true,  "ISO-8859-1" },
+  { "ISO 2022 IR 101", "\x1b-B",  true,  "ISO-8859-2" },
+  { "ISO 2022 IR 109", "\x1b-C",  true,  "ISO-8859-3" },
+  { "ISO 2022 IR 110", "\x1b-D",  true,  "ISO-8859-4" },
+  { "ISO 2022 IR 144", "\x1b-L",  true,  "ISO-8859-5" },
+  { "ISO 2022 IR 127", "\x1b-G",  true,  "ISO-8859-6" },
+  { "ISO 2022 IR 126", "\x1b-F",  true,  "ISO-8859-7" },
+  { "ISO 2022 IR 138", "\x1b-H",  true,  "ISO-8859-8" },
+  { "ISO 2022 IR 148", "\x1b-M",  true,  "ISO-8859-9" },
+  { "ISO 2022 IR 166", "\x1b-T",  true,  "TIS-620" },
+  { "ISO 2022 IR 13",  "\x1b)I",  true,  "Shift_JIS" },   // JIS X 0201 Katakana
+  { "ISO 2022 IR 13",  "\x1b(J",  false, 0 },             // JIS X 0201 Romaji
+  { "ISO 2022 IR 87",  "\x1b$B",  false, "ISO-2022-JP" }, // JIS X 0208 Kanji
+  { "ISO 2022 IR 159", "\x1b$(D", false, "ISO-2022-JP" }, // JIS X 0212 supplementary Kanji
+  { "ISO 2022 IR 149", "\x1b$)C", true,  "EUC-KR" },      // KS X 1001 Hangul and Hanja
+  { "ISO 2022 IR 58",  "\x1b$)A", true,  "GB2312" }       // GB 2312 simplified Chinese
+};
+
+const int ctkDICOMCodeElementCount = sizeof(ctkDICOMCodeElements) / sizeof(ctkDICOMCodeElements[0]);
+
+/// Codecs of the DICOM character sets, created once and only read afterwards,
+/// so that datasets can be decoded concurrently.
+class ctkDICOMCharacterSets
+{
+public:
+  ctkDICOMCharacterSets()
+  {
+    // Encoding names that might be named in DICOM files. For each encoding we store
+    // the codec Qt uses for the same encoding. This is because there is not yet a
+    // standard naming scheme but lots of aliases out in the real world:
+    // e.g. http://www.openi18n.org/subgroups/sa/locnameguide/final/CodesetAliasTable.html
+
+    // use all names that Qt knows by itself
+    foreach( QByteArray c, QTextCodec::availableCodecs() )
+    {
+      this->Codecs.insert( c.constData(), QTextCodec::codecForName(c) );
+    }
+
+                                   //    DICOM        Qt
+    this->insertCodec("ISO_IR 6", "UTF-8"); // actually ASCII, but ok
+    this->insertCodec("ISO_IR 100", "ISO-8859-1");
+    this->insertCodec("ISO_IR 101", "ISO-8859-2");
+    this->insertCodec("ISO_IR 109", "ISO-8859-3");
+    this->insertCodec("ISO_IR 110", "ISO-8859-4");
+    this->insertCodec("ISO_IR 144", "ISO-8859-5");
+    this->insertCodec("ISO_IR 127", "ISO-8859-6");
+    this->insertCodec("ISO_IR 126", "ISO-8859-7");
+    this->insertCodec("ISO_IR 138", "ISO-8859-8");
+    this->insertCodec("ISO_IR 148", "ISO-8859-9");
+    this->insertCodec("ISO_IR 179", "ISO-8859-13");
+    this->insertCodec("ISO_IR 166", "TIS-620");
+    this->insertCodec("ISO_IR 13", "Shift_JIS");
+    this->insertCodec("ISO_IR 192", "UTF-8");
+    this->insertCodec("GB18030", "GB18030");
+    this->insertCodec("GBK", "GBK");
+
+    this->RomajiCodeElement = -1;
+    for (int i = 0; i < ctkDICOMCodeElementCount; ++i)
+    {
+      this->CodeElementCodecs[i] = ctkDICOMCodeElements[i].CodecName ?
+        QTextCodec::codecForName(ctkDICOMCodeElements[i].CodecName) : 0;
+      if (qstrcmp(ctkDICOMCodeElements[i].Escape, "\x1b(J") == 0)
+      {
+        this->RomajiCodeElement = i;
+      }
+    }
+  }
+
+  /// Codec of a character set used without code extensions, 0 if unknown
+  QTextCodec* codec(const QString& term) const
+  {
+    return this->Codecs.value(term);
+  }
+
+  /// Index of the code element of a defined term designated to G1 or G0,
+  /// -1 if unknown. ISO 2022 IR 13 designates a character set to both.
+  int codeElement(const QString& term, bool g1) const
+  {
+    for (int i = 0; i < ctkDICOMCodeElementCount; ++i)
+    {
+      if (ctkDICOMCodeElements[i].G1 == g1 &&
+          term == QLatin1String(ctkDICOMCodeElements[i].Term)) return i;
+    }
+    return -1;
+  }
+
+  /// Return true for the code element of JIS X 0201 Romaji, which has no codec
+  bool isRomaji(int codeElement) const
+  {
+    return codeElement >= 0 && codeElement == this->RomajiCodeElement;
+  }
+
+  /// Index of the code element designated by the escape sequence starting
+  /// at \a data, -1 if unknown
+  int escapedCodeElement(const char* data, int length, int& escapeLength) const
+  {
+    for (int i = 0; i < ctkDICOMCodeElementCount; ++i)
+    {
+      const char* escape = ctkDICOMCodeElements[i].Escape;
+      const int size = static_cast<int>(qstrlen(escape));
+      if (size <= length && qstrncmp(data, escape, size) == 0)
+      {
+        escapeLength = size;
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  QTextCodec* codeElementCodec(int codeElement) const
+  {
+    return codeElement < 0 ? 0 : this->CodeElementCodecs[codeElement];
+  }
+
+private:
+  void insertCodec(const char* term, const char* codecName)
+  {
+    this->Codecs.insert( term, QTextCodec::codecForName(codecName) );
+  }
+
+  QHash<QString, QTextCodec*> Codecs;
+  QTextCodec* CodeElementCodecs[ctkDICOMCodeElementCount];
+  int RomajiCodeElement;
+};
+
+Q_GLOBAL_STATIC(ctkDICOMCharacterSets, ctkDICOMCharacterSetsInstance)
+
+/// Characters resetting the code extensions to their initial state (PS 3.5 6.1.2.5.3)
+bool ctkDICOMIsDelimiter(char c)
+{
+  return c == '\\' || c == '^' || c == '=' || c == '\r' || c == '\n' || c == '\f' || c == '\t';
+}
+
+/// JIS X 0201 Romaji is ASCII but for the yen sign and the overline
+QString ctkDICOMDecodeRomaji(const char* data, int length)
+{
+  QString result = QString::fromLatin1(data, length);
+  result.replace(QLatin1Char('\\'), QChar(0x00A5));
+  result.replace(QLatin1Char('~'), QChar(0x203E));
+  return result;
+}
+
+}
+
+
 class ctkDICOMItemPrivate
 {
   public:
 
-    ctkDICOMItemPrivate() : m_DcmItem(0), m_TakeOwnership(true) {}
+    ctkDICOMItemPrivate()
+      : m_Codec(0), m_CodeExtensions(false), m_InitialG0(-1), m_InitialG1(-1),
+        m_ASCIIInitialG0(true),
+        m_DcmItem(0), m_TakeOwnership(true) {}
+
+    /// Resolve the decoding of m_SpecificCharacterSet, done once per dataset
+    void resolveCharacterSet();
+
+    /// Decode a value using the ISO 2022 escape sequences. The backslash is
+    /// a delimiter unless the value is a text (LT, ST, UT).
+    QString decodeCodeExtensions(const char* data, int length, bool backslashDelimiter) const;
 
     QString m_SpecificCharacterSet;
 
+    /// Codec of the character set if it does not use code extensions, 0 for Latin1
+    QTextCodec* m_Codec;
+    /// The character set uses the ISO 2022 code extensions
+    bool m_CodeExtensions;
+    /// Code elements designated at the beginning of a value, -1 for ASCII in G0
+    int m_InitialG0;
+    int m_InitialG1;
+    /// Bytes below 0x80 are ASCII until the first escape sequence
+    bool m_ASCIIInitialG0;
+
     bool m_DICOMDataSetInitialized;
     bool m_StrictErrorHandling;
 
     DcmItem* m_DcmItem;
     bool m_TakeOwnership;
+
+    /// File mapped by InitializeFromSerializationFile, must outlive m_PendingSerialization
+    QScopedPointer<QFile> m_MappedFile;
+    /// Serialized dataset not parsed yet, null if there is none
+    QByteArray m_PendingSerialization;
 };
 
 
@@ -68,6 +254,10 @@ void ctkDICOMItem::InitializeFromItem(DcmItem *dataset, bool takeOwnership)
 {
   Q_D(ctkDICOMItem);
 
+  // replaces any serialized dataset not parsed yet
+  d->m_PendingSerialization = QByteArray();
+  d->m_MappedFile.reset();
+
   if(d->m_DcmItem != dataset)
   {
     if (d->m_TakeOwnership)
@@ -85,10 +275,11 @@ void ctkDICOMItem::InitializeFromItem(DcmItem *dataset, bool takeOwnership)
     {
       d->m_DICOMDataSetInitialized = true;
       OFString encoding;
-      if ( CheckCondition( dataset->findAndGetOFString(DCM_SpecificCharacterSet, encoding) ) )
+      if ( CheckCondition( dataset->findAndGetOFStringArray(DCM_SpecificCharacterSet, encoding) ) )
       {
         d->m_SpecificCharacterSet = encoding.c_str();
       }
+      d->resolveCharacterSet();
       }
       if (d->m_SpecificCharacterSet.isEmpty())
       {
@@ -128,42 +319,171 @@ void ctkDICOMItem::InitializeFromFile(const QString& filename,
   InitializeFromItem(dataset, true);
 }
 
+void ctkDICOMItem::InitializeFromFileHeader(const QString& filename,
+                                            const DcmTagKey& stopParsingAtElement,
+                                            const E_TransferSyntax readXfer,
+                                            const E_GrpLenEncoding groupLength,
+                                            const Uint32 maxReadLength,
+                                            const E_FileReadMode readMode)
+{
+  DcmDataset *dataset;
+
+  DcmFileFormat fileformat;
+  OFCondition status = fileformat.loadFileUntilTag(filename.toLatin1().data(), readXfer, groupLength,
+                                                   maxReadLength, readMode, stopParsingAtElement);
+  dataset = fileformat.getAndRemoveDataset();
+
+  if (!status.good())
+  {
+    qDebug() << "Could not load " << filename << "\nDCMTK says: " << status.text();
+    delete dataset;
+    return;
+  }
+
+  InitializeFromItem(dataset, true);
+}
+
 void ctkDICOMItem::Serialize()
 {
-  Q_D(ctkDICOMItem);
+  // base64 keeps the string free of encoding conversions made by QString or the database
+  this->SetStoredSerialization( QString::fromLatin1( this->SerializeToByteArray().toBase64() ) );
+}
+
+QByteArray ctkDICOMItem::SerializeToByteArray() const
+{
+  Q_D(const ctkDICOMItem);
   EnsureDcmDataSetIsInitialized();
 
-  // store content of current DcmDataset (our parent) as QByteArray into m_ctkDICOMItem
-  Uint32 buffersize = 1024*1024; // reserve 1MB
-  char* writebuffer = new char[buffersize];
+  // size the buffer for the whole dataset, so that it is usually written in a single pass
+  Uint32 buffersize = d->m_DcmItem->calcElementLength(EXS_LittleEndianImplicit, EET_UndefinedLength);
+  if (buffersize == DCM_UndefinedLength || buffersize > 0x10000000)
+  {
+    buffersize = 1024*1024;
+  }
+  buffersize += 16;
+
+  QByteArray writebuffer;
+  writebuffer.resize(buffersize);
+  DcmOutputBufferStream dcmbuffer(writebuffer.data(), buffersize);
 
-  // write into buffer
-  DcmOutputBufferStream dcmbuffer(writebuffer, buffersize);
+  QByteArray serialization;
+  bool singlePass = true;
   d->m_DcmItem->transferInit();
-  OFCondition condition = d->m_DcmItem->write(dcmbuffer, EXS_LittleEndianImplicit, EET_UndefinedLength, NULL );
+  while (true)
+  {
+    OFCondition condition = d->m_DcmItem->write(dcmbuffer, EXS_LittleEndianImplicit, EET_UndefinedLength, NULL );
+
+    // get written contents of buffer
+    offile_off_t datasetsize = 0;
+    void* readbuffer = NULL;
+    dcmbuffer.flushBuffer(readbuffer, datasetsize);
+
+    if (condition == EC_StreamNotifyClient)
+    {
+      // the buffer is full, keep its contents and let DCMTK write the next part
+      singlePass = false;
+      serialization.append(static_cast<const char*>(readbuffer), static_cast<int>(datasetsize));
+      continue;
+    }
+    if ( condition.bad() )
+    {
+      std::cerr << "Could not DcmDataset::write(..): " << condition.text() << std::endl;
+    }
+    if (singlePass)
+    {
+      // no copy: the write buffer becomes the serialization
+      writebuffer.resize(static_cast<int>(datasetsize));
+      serialization = writebuffer;
+    }
+    else
+    {
+      serialization.append(static_cast<const char*>(readbuffer), static_cast<int>(datasetsize));
+    }
+    break;
+  }
   d->m_DcmItem->transferEnd();
-  if ( condition.bad() )
+
+  return serialization;
+}
+
+void ctkDICOMItem::InitializeFromSerialization(const QByteArray& serializedDataset)
+{
+  Q_D(ctkDICOMItem);
+  d->m_PendingSerialization = serializedDataset;
+  if (d->m_PendingSerialization.isNull())
+  {
+    // an empty dataset, as for an empty stored serialization in Deserialize()
+    d->m_PendingSerialization = QByteArray("");
+  }
+  d->m_MappedFile.reset();
+  d->m_DICOMDataSetInitialized = false;
+}
+
+bool ctkDICOMItem::InitializeFromSerializationFile(const QString& filename)
+{
+  Q_D(ctkDICOMItem);
+
+  QScopedPointer<QFile> file(new QFile(filename));
+  if (!file->open(QIODevice::ReadOnly))
+  {
+    qDebug() << "Could not open " << filename << ": " << file->errorString();
+    return false;
+  }
+
+  QByteArray serializedDataset;
+  if (file->size() > 0)
   {
-    std::cerr << "Could not DcmDataset::write(..): " << condition.text() << std::endl;
+    uchar* data = file->map(0, file->size());
+    if (!data)
+    {
+      qDebug() << "Could not map " << filename << ": " << file->errorString();
+      return false;
+    }
+    serializedDataset = QByteArray::fromRawData(reinterpret_cast<const char*>(data), static_cast<int>(file->size()));
   }
 
-  // get written contents of buffer
-  offile_off_t datasetsize = 0;
-  void* readbuffer = NULL;
-  dcmbuffer.flushBuffer(readbuffer, datasetsize);
+  this->InitializeFromSerialization(serializedDataset);
+  d->m_MappedFile.reset(file.take());
+  return true;
+}
 
-  //std::cerr << "** " << (void*)this << " ctkDICOMItem: Serializing Dataset into " << datasetsize << " bytes" << std::endl;
+void ctkDICOMItem::ParsePendingSerialization()
+{
+  Q_D(ctkDICOMItem);
+
+  QByteArray qtArray = d->m_PendingSerialization;
+  d->m_PendingSerialization = QByteArray();
 
-  // construct Qt type from that contents
-  QByteArray qtArray = QByteArray::fromRawData( static_cast<const char*>(readbuffer), datasetsize );
-  //std::cerr << "** Buffer size: " << qtArray.size() << std::endl;
-  QString stringbuffer = QString::fromLatin1(qtArray.toBase64());
+  DcmInputBufferStream dcmbuffer;
+  dcmbuffer.setBuffer( qtArray.constData(), qtArray.size() );
+  dcmbuffer.setEos();
 
-  //std::cerr << "** String of size " << stringbuffer.size() << " looks like this:\n" << stringbuffer.toStdString() << std::endl << std::endl;
+  DcmDataset* dataset = new DcmDataset();
+  dataset->transferInit();
+  OFCondition condition = qtArray.isEmpty() ? EC_Normal : dataset->read( dcmbuffer, EXS_LittleEndianImplicit );
+  dataset->transferEnd();
 
-  this->SetStoredSerialization( stringbuffer );
+  // the parsed elements do not refer to the buffer anymore, release it
+  qtArray.clear();
+  d->m_MappedFile.reset();
 
-  delete[] writebuffer;
+  // do this in all cases, even when reading reported an error
+  d->m_DICOMDataSetInitialized = false;
+  d->m_SpecificCharacterSet.clear();
+  this->InitializeFromItem(dataset, true);
+
+  if ( condition.bad() )
+  {
+    std::cerr << "** Condition code of Dataset::read() is "
+              << condition.code() << std::endl;
+    std::cerr << "** Buffer state: " << dcmbuffer.status().code()
+              << " " <<  dcmbuffer.good()
+              << " " << dcmbuffer.eos()
+              << " tell " << dcmbuffer.tell()
+              << " avail " << dcmbuffer.avail() << std::endl;
+    std::cerr << "Could not DcmDataset::read(..): "
+              << condition.text() << std::endl;
+  }
 }
 
 void ctkDICOMItem::MarkForInitialization()
@@ -174,15 +494,20 @@ void ctkDICOMItem::MarkForInitialization()
 bool ctkDICOMItem::IsInitialized() const
 {
   Q_D(const ctkDICOMItem);
-  return d->m_DICOMDataSetInitialized;
+  return d->m_DICOMDataSetInitialized || !d->m_PendingSerialization.isNull();
 }
 void ctkDICOMItem::EnsureDcmDataSetIsInitialized() const
 {
+  Q_D(const ctkDICOMItem);
+  if ( !d->m_PendingSerialization.isNull() )
+  {
+    // lazy parsing of the dataset given to InitializeFromSerialization
+    const_cast<ctkDICOMItem*>(this)->ParsePendingSerialization();
+  }
   if ( ! this->IsInitialized() )
   {
       throw std::logic_error("Calling methods on uninitialized ctkDICOMItem");
   }
-  // const_cast<ctkDICOMItem*>(this)->Deserialize();
 }
 
 void ctkDICOMItem::Deserialize()
@@ -192,8 +517,7 @@ void ctkDICOMItem::Deserialize()
   // construct a DcmDataset from it
   // calls InitializeData(DcmDataset*)
 
-  // this method can be called both from sub-classes when they get the InitializeData signal from the persistence framework
-  // and from EnsureDcmDataSetIsInitialized() when a GetElement.. or SetElement.. method is called.
+  // this method can be called from sub-classes when they get the InitializeData signal from the persistence framework
 
   if (d->m_DICOMDataSetInitialized) return; // only need to do this once
 
@@ -204,45 +528,18 @@ void ctkDICOMItem::Deserialize()
     return; // TODO nicer: hold three states: newly created / loaded but not initialized / restored from DB
   }
 
-
-  //std::cerr << "** " << (void*)this << " ctkDICOMItem: Deserialize Dataset from string of size " << stringbuffer.size() << "\n" << stringbuffer.toStdString() << std::endl;
-
-  QByteArray qtArray = QByteArray::fromBase64( stringbuffer.toLatin1() );
-  //std::cerr << "** " << (void*)this << " ctkDICOMItem: Deserialize Dataset from byte array of size " << qtArray.size() << std::endl;
-
-  DcmInputBufferStream dcmbuffer;
-  dcmbuffer.setBuffer( qtArray.data(), qtArray.size() );
-  //std::cerr << "** Buffer state: " << dcmbuffer.status().code() << " " <<  dcmbuffer.good() << " " << dcmbuffer.eos() << " tell " << dcmbuffer.tell() << " avail " << dcmbuffer.avail() << std::endl;
-
-  DcmDataset dataset;
-  dataset.transferInit();
-  //std::cerr << "** Dataset state: " << dataset.transferState() << std::endl << std::endl;
-  OFCondition condition = dataset.read( dcmbuffer, EXS_LittleEndianImplicit );
-  dataset.transferEnd();
-
-  // do this in all cases, even when reading reported an error
-  this->InitializeFromItem(&dataset);
-
-  if ( condition.bad() )
-  {
-    std::cerr << "** Condition code of Dataset::read() is "
-              << condition.code() << std::endl;
-    std::cerr << "** Buffer state: " << dcmbuffer.status().code()
-              << " " <<  dcmbuffer.good()
-              << " " << dcmbuffer.eos()
-              << " tell " << dcmbuffer.tell()
-              << " avail " << dcmbuffer.avail() << std::endl;
-    std::cerr << "** Dataset state: "
-              << static_cast<int>(dataset.transferState()) << std::endl;
-    std::cerr << "Could not DcmDataset::read(..): "
-              << condition.text() << std::endl;
-    //throw std::invalid_argument( std::string("Could not DcmDataset::read(..): ") + condition.text() );
-  }
+  this->InitializeFromSerialization( QByteArray::fromBase64( stringbuffer.toLatin1() ) );
+  this->ParsePendingSerialization();
 }
 
 DcmItem& ctkDICOMItem::GetDcmItem() const
 {
   const Q_D(ctkDICOMItem);
+  if ( !d->m_PendingSerialization.isNull() )
+  {
+    // the dataset is replaced by the parsed one
+    const_cast<ctkDICOMItem*>(this)->ParsePendingSerialization();
+  }
   return *d->m_DcmItem;
 }
 
@@ -272,7 +569,6 @@ bool ctkDICOMItem::CheckCondition(const OFCondition& condition)
 
 bool ctkDICOMItem::CopyElement( DcmDataset* dataset, const DcmTagKey& tag, int type )
 {
-  Q_D(ctkDICOMItem);
   switch (type)
   {
     case 0x1:
@@ -292,7 +588,8 @@ bool ctkDICOMItem::CopyElement( DcmDataset* dataset, const DcmTagKey& tag, int t
   bool copied(true);
 
   if (!dataset) return false;
-  if (dataset == d->m_DcmItem)
+  DcmItem& item = this->GetDcmItem();
+  if (dataset == &item)
   {
     throw std::logic_error("Trying to copy tag to yourself. Please check application logic!"); 
   }
@@ -316,7 +613,7 @@ bool ctkDICOMItem::CopyElement( DcmDataset* dataset, const DcmTagKey& tag, int t
     dataset->findAndGetElement( tag, element, OFFalse, OFTrue ); // OFTrue is important (copies element), DcmDataset takes ownership and deletes elements on its own destruction
     if (element)
     {
-      copied = CheckCondition( d->m_DcmItem->insert(element) );
+      copied = CheckCondition( item.insert(element) );
     }
   }
 
@@ -333,94 +630,171 @@ bool ctkDICOMItem::CopyElement( DcmDataset* dataset, const DcmTagKey& tag, int t
   return !missing && copied;
 }
 
-QString ctkDICOMItem::Decode( const DcmTag& tag, const OFString& raw ) const
+void ctkDICOMItemPrivate::resolveCharacterSet()
 {
-  Q_D(const ctkDICOMItem);
-  // decode for types LO, LT, PN, SH, ST, UT
-  QString vr = TagVR(tag);
-  if ( !d->m_SpecificCharacterSet.isEmpty()
-    && (vr == "LO" ||
-        vr == "LT" ||
-        vr == "PN" ||
-        vr == "SH" ||
-        vr == "ST" ||
-        vr == "UT" ) )
-  {
-    //std::cout << "Decode from encoding " << d->m_SpecificCharacterSet.toStdString() << std::endl;
-    static QMap<QString, QTextDecoder*> decoders;
-    static QMap<QString, QString> qtEncodingNamesForDICOMEncodingNames;
-
-    if (qtEncodingNamesForDICOMEncodingNames.isEmpty())
+  const ctkDICOMCharacterSets* characterSets = ctkDICOMCharacterSetsInstance();
+
+  m_Codec = 0;
+  m_CodeExtensions = false;
+  m_InitialG0 = -1;
+  m_InitialG1 = -1;
+  m_ASCIIInitialG0 = true;
+  if (m_SpecificCharacterSet.isEmpty())
+  {
+    return;
+  }
+
+  // multi-valued character sets, the first value (possibly empty for ASCII) is
+  // the one designated at the beginning of each value
+  QStringList terms = m_SpecificCharacterSet.split('\\');
+  for (int i = 0; i < terms.size(); ++i)
+  {
+    terms[i] = terms[i].trimmed();
+    if (terms[i].startsWith("ISO 2022"))
     {
-      // runs only once and fills up a map of encoding names that might be named in DICOM files.
-      // for each encoding we store the name that Qt uses for the same encoding.
-      // This is because there is not yet a standard naming scheme but lots of aliases
-      // out in the real world: e.g. http://www.openi18n.org/subgroups/sa/locnameguide/final/CodesetAliasTable.html
-
-                                              //    DICOM        Qt
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 6", "UTF-8"); // actually ASCII, but ok
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 100", "ISO-8859-1");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 101", "ISO-8859-2");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 109", "ISO-8859-3");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 110", "ISO-8859-4");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 144", "ISO-8859-5");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 127", "ISO-8859-6");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 126", "ISO-8859-7");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 138", "ISO-8859-8");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 148", "ISO-8859-9");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 179", "ISO-8859-13");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 192", "UTF-8");
-      // japanese
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO 2022 IR 13", "ISO 2022-JP"); // Single byte charset, JIS X 0201: Katakana, Romaji
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO 2022 IR 87", "ISO 2022-JP"); // Multi byte charset, JIS X 0208: Kanji, Kanji set
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO 2022 IR 159", "ISO 2022-JP");
-      // korean
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO 2022 IR 149", "EUC-KR"); // Multi byte charset, KS X 1001: Hangul, Hanja
-
-      // use all names that Qt knows by itself
-      foreach( QByteArray c, QTextCodec::availableCodecs() )
+      m_CodeExtensions = true;
+    }
+  }
+
+  if (m_CodeExtensions)
+  {
+    m_InitialG0 = characterSets->codeElement(terms.front(), false);
+    m_InitialG1 = characterSets->codeElement(terms.front(), true);
+    m_ASCIIInitialG0 = !characterSets->codeElementCodec(m_InitialG0)
+      && !characterSets->isRomaji(m_InitialG0);
+    return;
+  }
+
+  m_Codec = characterSets->codec(terms.front());
+  if (!m_Codec)
+  {
+    std::cerr << "DICOM dataset contains some encoding that we never thought we would see(" << m_SpecificCharacterSet.toStdString() << "). Using default encoding." << std::endl;
+  }
+}
+
+QString ctkDICOMItemPrivate::decodeCodeExtensions(const char* data, int length,
+                                                  bool backslashDelimiter) const
+{
+  const ctkDICOMCharacterSets* characterSets = ctkDICOMCharacterSetsInstance();
+
+  QString result;
+  result.reserve(length);
+
+  int g0 = m_InitialG0;
+  int g1 = m_InitialG1;
+  int i = 0;
+  while (i < length)
+  {
+    if (data[i] == '\x1b')
+    {
+      int escapeLength = 0;
+      int codeElement = characterSets->escapedCodeElement(data + i, length - i, escapeLength);
+      if (codeElement < 0)
+      {
+        // unknown escape sequence, skip the escape character
+        ++i;
+        continue;
+      }
+      if (ctkDICOMCodeElements[codeElement].G1)
       {
-        qtEncodingNamesForDICOMEncodingNames.insert( c.constData(), c.constData() );
+        g1 = codeElement;
       }
+      else
+      {
+        g0 = codeElement;
+      }
+      i += escapeLength;
+      continue;
+    }
 
+    // the bytes of multi-byte G0 character sets may have the value of delimiters
+    const bool high = static_cast<unsigned char>(data[i]) >= 0x80;
+    QTextCodec* codec = characterSets->codeElementCodec(high ? g1 : g0);
+    const bool multiByteG0 = !high && codec;
+    if (!high && !multiByteG0 && ctkDICOMIsDelimiter(data[i])
+        && (backslashDelimiter || data[i] != '\\'))
+    {
+      result += QLatin1Char(data[i]);
+      g0 = m_InitialG0;
+      g1 = m_InitialG1;
+      ++i;
+      continue;
     }
 
-    if ( qtEncodingNamesForDICOMEncodingNames.contains(d->m_SpecificCharacterSet) )
+    // decode the run of bytes of the same code element at once
+    int end = i + 1;
+    while (end < length && data[end] != '\x1b'
+           && (static_cast<unsigned char>(data[end]) >= 0x80) == high
+           && (high || multiByteG0 || !ctkDICOMIsDelimiter(data[end])
+               || (!backslashDelimiter && data[end] == '\\')))
     {
-      QString encodingName( qtEncodingNamesForDICOMEncodingNames[d->m_SpecificCharacterSet] );
-      if ( !decoders.contains( encodingName ) )
-      {
-        QTextCodec* codec = QTextCodec::codecForName( encodingName.toLatin1() );
-        if (!codec)
-        {
-          std::cerr << "Could not create QTextCodec object for '" << encodingName.toStdString() << "'. Using default encoding instead." << std::endl;
-          decoders.insert( encodingName, QTextCodec::codecForName("UTF-8")->makeDecoder() ); // uses Latin1
-        }
-        else
-        {
-          // initialize a QTextDecoder for given encoding
-          decoders.insert( encodingName, codec->makeDecoder() );
-          // We are responsible for deleting the QTextDecoder objects
-          // created by makeDecoder(). BUT as these objects are stored
-          // in a static map that lives until application end AND
-          // nothing application relevant happens during their
-          // destruction, we just let them be destructed by C++ on
-          // application exit.
-          // Any potential leaks that are found by this behavior can
-          // be suppressed.
-        }
-      }
+      ++end;
+    }
 
-      //std::cout << "Decode '" <<  raw.c_str() << "' to '" << decoders[encodingName]->toUnicode( raw.c_str() ).toLocal8Bit().constData() << "'" << std::endl;
-      return decoders[encodingName]->toUnicode( raw.c_str() );
+    if (!codec && !high && characterSets->isRomaji(g0))
+    {
+      result += ctkDICOMDecodeRomaji(data + i, end - i);
+    }
+    else if (!codec)
+    {
+      result += QString::fromLatin1(data + i, end - i);
+    }
+    else if (multiByteG0)
+    {
+      // stateful codec, designate the character set before the bytes
+      QByteArray bytes(ctkDICOMCodeElements[g0].Escape);
+      bytes.append(data + i, end - i);
+      result += codec->toUnicode(bytes);
     }
     else
     {
-      std::cerr << "DICOM dataset contains some encoding that we never thought we would see(" << d->m_SpecificCharacterSet.toStdString() << "). Using default encoding." << std::endl;
+      result += codec->toUnicode(data + i, end - i);
+    }
+    i = end;
+  }
+
+  return result;
+}
+
+QString ctkDICOMItem::Decode( const DcmTag& tag, const OFString& raw ) const
+{
+  Q_D(const ctkDICOMItem);
+
+  const char* data = raw.c_str();
+  const int length = static_cast<int>(qstrlen(data));
+
+  // ASCII is common to all the character sets used by DICOM, it does not need any codec
+  bool ascii = true;
+  for (int i = 0; i < length && ascii; ++i)
+  {
+    ascii = static_cast<unsigned char>(data[i]) < 0x80 && data[i] != '\x1b';
+  }
+  if (ascii && d->m_ASCIIInitialG0)
+  {
+    return QString::fromLatin1(data, length);
+  }
+
+  // decode for types LO, LT, PN, SH, ST, UT
+  const DcmEVR vr = tag.getEVR();
+  if ( !d->m_SpecificCharacterSet.isEmpty()
+    && (vr == EVR_LO ||
+        vr == EVR_LT ||
+        vr == EVR_PN ||
+        vr == EVR_SH ||
+        vr == EVR_ST ||
+        vr == EVR_UT ) )
+  {
+    if (d->m_CodeExtensions)
+    {
+      return d->decodeCodeExtensions(data, length, vr != EVR_LT && vr != EVR_ST && vr != EVR_UT);
+    }
+    if (d->m_Codec)
+    {
+      return d->m_Codec->toUnicode(data, length);
     }
   }
 
-  return QString::fromLatin1(raw.c_str()); // Latin1 is ISO 8859, which is the default character set of DICOM (PS 3.5-2008, Page 18)
+  return QString::fromLatin1(data, length); // Latin1 is ISO 8859, which is the default character set of DICOM (PS 3.5-2008, Page 18)
 
 }
 
@@ -983,13 +1357,12 @@ void ctkDICOMItem::SetStoredSerialization(QString serializedDataset)
 
 bool ctkDICOMItem::SaveToFile(const QString& filePath) const
 {
-  Q_D(const ctkDICOMItem);
-
-  if (! dynamic_cast<DcmDataset*>(d->m_DcmItem) )
+  DcmDataset* dataset = dynamic_cast<DcmDataset*>(&this->GetDcmItem());
+  if (! dataset )
   {
     return false;
   }
-  DcmFileFormat* fileformat = new DcmFileFormat ( dynamic_cast<DcmDataset*>(d->m_DcmItem) );
+  DcmFileFormat* fileformat = new DcmFileFormat ( dataset );
   OFCondition status = fileformat->saveFile ( qPrintable(QDir::toNativeSeparators( filePath)) );
   delete fileformat;
   return status.good();
@@ -26,6 +26,7 @@
 #include "ctkDICOMPersonName.h"
 
 #include <dcmtk/dcmdata/dcdatset.h> // DCMTK DcmDataset
+#include <dcmtk/dcmdata/dcdeftag.h> // DCMTK DCM_PixelData
 
 #include <QtCore>
 
@@ -59,6 +60,8 @@ class ctkDICOMItemPrivate;
 ///  A subclass could possibly want to store the internal DcmDataset.
 ///  For this purpose, the internal DcmDataset is serialized into a memory buffer using DcmDataset::write(..). This buffer
 ///  is stored in a base64 encoded string. For deserialization we decode the string and use DcmDataset::read(..).
+///  When the serialized dataset does not need to be stored as a string, SerializeToByteArray() and
+///  InitializeFromSerialization() exchange the memory buffer itself.
 class ctkDICOMItem;
 
 typedef ctkDICOMItem ctkDICOMItem;
@@ -93,6 +96,20 @@ public:
                     const Uint32 maxReadLength = DCM_MaxReadLength,
                     const E_FileReadMode readMode = ERM_autoDetect);
 
+    ///
+    /// \brief For initialization from the header part of a file only.
+    ///
+    /// Parsing stops at the first top-level element whose tag is greater than
+    /// or equal to \a stopParsingAtElement (the pixel data by default), so that
+    /// the remainder of the file is neither read nor parsed.
+    ///
+    virtual void InitializeFromFileHeader(const QString& filename,
+                    const DcmTagKey& stopParsingAtElement = DCM_PixelData,
+                    const E_TransferSyntax readXfer = EXS_Unknown,
+                    const E_GrpLenEncoding groupLength = EGL_noChange,
+                    const Uint32 maxReadLength = DCM_MaxReadLength,
+                    const E_FileReadMode readMode = ERM_autoDetect);
+
 
 
     /// \brief Save dataset to file
@@ -114,6 +131,27 @@ public:
     /// the internal DcmDataset is created using DcmDataset::read(..).
     void Deserialize();
 
+    /// \brief Serialize the internal DcmDataset into a binary buffer.
+    ///
+    /// The buffer holds the same bytes as the ones Serialize() encodes in base64, but
+    /// avoids the base64 and QString conversions. It is implicitly shared, so it can
+    /// be passed around and stored without being copied.
+    QByteArray SerializeToByteArray() const;
+
+    /// \brief For initialization from a buffer returned by SerializeToByteArray().
+    ///
+    /// The buffer is shared, not copied, and is only parsed on the first access
+    /// to the dataset (Get/Set methods, Serialize, ...).
+    virtual void InitializeFromSerialization(const QByteArray& serializedDataset);
+
+    /// \brief For initialization from a file containing a buffer returned by SerializeToByteArray().
+    ///
+    /// The file is memory-mapped and only parsed on the first access to the
+    /// dataset. It is unmapped once parsed.
+    ///
+    /// \returns false if the file could not be opened or mapped.
+    virtual bool InitializeFromSerializationFile(const QString& filename);
+
 
     /// \brief To be called from InitializeData, flags status as dirty.
     ///
@@ -147,6 +185,10 @@ public:
     /// If so, all attributes of types Long String (LO), Long Text (LT), Person Name (PN), Short String (SH),
     /// Short Text (ST), Unlimited Text (UT) should be interpreted as encoded with a special set.
     ///
+    /// The decoding is resolved once per dataset, when it is initialized. Multi-valued
+    /// character sets using the ISO 2022 code extensions (escape sequences) are supported.
+    /// ASCII strings are converted without any codec. This method is thread safe.
+    ///
     /// See implementation for details.
     QString Decode(const DcmTag& tag, const OFString& raw) const;
 
@@ -257,6 +299,9 @@ protected:
   DcmItem& GetDcmItem() const;
 
 private:
+  /// Parse the buffer given to InitializeFromSerialization... into the internal DcmDataset.
+  void ParsePendingSerialization();
+
   Q_DECLARE_PRIVATE(ctkDICOMItem);
 };
 
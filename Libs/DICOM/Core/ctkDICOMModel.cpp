@@ -19,6 +19,8 @@
 =========================================================================*/
 
 // Qt includes
+#include <QCache>
+#include <QPair>
 #include <QStringList>
 #include <QSqlDriver>
 #include <QSqlError>
@@ -42,6 +44,14 @@ struct Node;
 Q_DECLARE_METATYPE(Qt::CheckState);
 Q_DECLARE_METATYPE(QStringList);
 
+//------------------------------------------------------------------------------
+// Rows of a node fetched at once in windowed mode
+struct Block
+{
+  QVector<QVector<QVariant> > Rows;
+};
+typedef QPair<Node*, int> BlockKey;
+
 //------------------------------------------------------------------------------
 class ctkDICOMModelPrivate
 {
@@ -65,6 +75,16 @@ public:
   QVariant value(const QModelIndex& indexValue, int row, int field)const;
   QString  generateQuery(const QString& fields, const QString& table, const QString& conditions = QString())const;
   void updateQueries(Node* node)const;
+  /// Condition matching the rows whose column contains the text
+  QString likeCondition(const QString& column, const QString& text)const;
+  /// Index of the column in the record of the children of parentNode
+  int field(Node* parentNode, int row, const QString& columnName)const;
+
+  // windowed fetching
+  int childCount(Node* node)const;
+  Block* block(Node* node, int blockIndex)const;
+  QVariant windowedValue(Node* parentNode, int row, int field)const;
+  void clearNodes();
 
   Node*        RootNode;
   QSqlDatabase DataBase;
@@ -74,6 +94,10 @@ public:
 
   ctkDICOMModel::IndexType StartLevel;
   ctkDICOMModel::IndexType EndLevel;
+
+  bool Windowed;
+  int BlockSize;
+  mutable QCache<BlockKey, Block> BlockCache;
 };
 
 //------------------------------------------------------------------------------
@@ -99,6 +123,18 @@ struct Node
   bool                            AtEnd;
   bool                            Fetching;
   QMap<int, QVariant>             Data;
+
+  // windowed fetching: the query is split so that it can be counted and
+  // fetched by blocks
+  QString                         Fields;
+  QString                         Table;
+  QString                         Conditions;
+  // -1 until the children have been counted
+  int                             TotalCount;
+  QStringList                     FieldNames;
+  QHash<int, Node*>               ChildrenByRow;
+  // rowid of the last row of each fetched block
+  QMap<int, qlonglong>            BlockLastKeys;
 };
 
 //------------------------------------------------------------------------------
@@ -107,11 +143,22 @@ ctkDICOMModelPrivate::ctkDICOMModelPrivate(ctkDICOMModel& o):q_ptr(&o)
   this->RootNode     = 0;
   this->StartLevel = ctkDICOMModel::RootType;
   this->EndLevel = ctkDICOMModel::ImageType;
+  this->Windowed = false;
+  this->BlockSize = 256;
+  this->BlockCache.setMaxCost(64);
 }
 
 //------------------------------------------------------------------------------
 ctkDICOMModelPrivate::~ctkDICOMModelPrivate()
 {
+  this->clearNodes();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMModelPrivate::clearNodes()
+{
+  // blocks are indexed by node
+  this->BlockCache.clear();
   delete this->RootNode;
   this->RootNode = 0;
 }
@@ -235,6 +282,7 @@ Node* ctkDICOMModelPrivate::createNode(int row, const QModelIndex& parentValue)c
     {
     nodeParent = this->nodeFromIndex(parentValue);
     nodeParent->Children.push_back(node);
+    nodeParent->ChildrenByRow[row] = node;
     node->Parent = nodeParent;
     node->Type = ctkDICOMModel::IndexType(nodeParent->Type + 1);
     }
@@ -251,6 +299,7 @@ Node* ctkDICOMModelPrivate::createNode(int row, const QModelIndex& parentValue)c
   node->RowCount = 0;
   node->AtEnd = false;
   node->Fetching = false;
+  node->TotalCount = -1;
 
   this->updateQueries(node);
 
@@ -261,6 +310,10 @@ Node* ctkDICOMModelPrivate::createNode(int row, const QModelIndex& parentValue)c
 QVariant ctkDICOMModelPrivate::value(const QModelIndex& parentValue, int row, int column) const
 {
   Node* node = this->nodeFromIndex(parentValue);
+  if (this->Windowed)
+    {
+    return this->windowedValue(node, row, column);
+    }
   if (row >= node->RowCount)
     {
     const_cast<ctkDICOMModelPrivate *>(this)->fetch(parentValue, row + 256);
@@ -303,11 +356,20 @@ QString ctkDICOMModelPrivate::generateQuery(const QString& fields, const QString
   return res;
 }
 
+//------------------------------------------------------------------------------
+QString ctkDICOMModelPrivate::likeCondition(const QString& column, const QString& text)const
+{
+  QString escapedText = text;
+  escapedText.replace('\'', "''");
+  return column + " LIKE '%" + escapedText + "%'";
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMModelPrivate::updateQueries(Node* node)const
 {
   // are you kidding me, it should be virtualized here :-)
-  QString query;
+  QString fields;
+  QString table;
   QString condition;
   switch(node->Type)
     {
@@ -317,16 +379,16 @@ void ctkDICOMModelPrivate::updateQueries(Node* node)const
     case ctkDICOMModel::RootType:
       //query = QString("SELECT  FROM ");
       if(this->SearchParameters["Name"].toString() != ""){
-        condition.append("PatientsName LIKE \"%" + this->SearchParameters["Name"].toString() + "%\"");
+        condition.append(this->likeCondition("PatientsName", this->SearchParameters["Name"].toString()));
       }
-      query = this->generateQuery("UID as UID, PatientsName as Name, PatientsAge as Age, PatientsBirthDate as Date, PatientID as \"Subject ID\"","Patients", condition);
-      logger.debug ( "ctkDICOMModelPrivate::updateQueries for Root: query is: " + query );
+      fields = "UID as UID, PatientsName as Name, PatientsAge as Age, PatientsBirthDate as Date, PatientID as \"Subject ID\"";
+      table = "Patients";
       break;
     case ctkDICOMModel::PatientType:
       //query = QString("SELECT  FROM Studies WHERE PatientsUID='%1'").arg(node->UID);
       if(this->SearchParameters["Study"].toString() != "")
         {
-        condition.append("StudyDescription LIKE \"%" + this->SearchParameters["Study"].toString() + "%\"" + " AND ");
+        condition.append(this->likeCondition("StudyDescription", this->SearchParameters["Study"].toString()) + " AND ");
         }
       if(this->SearchParameters["Modalities"].value<QStringList>().count() > 0)
         {
@@ -338,31 +400,52 @@ void ctkDICOMModelPrivate::updateQueries(Node* node)const
           condition.append(" ( StudyDate BETWEEN \'" + QDate::fromString(this->SearchParameters["StartDate"].toString(), "yyyyMMdd").toString("yyyy-MM-dd")
                            + "\' AND \'" + QDate::fromString(this->SearchParameters["EndDate"].toString(), "yyyyMMdd").toString("yyyy-MM-dd") + "\' ) AND ");
         }
-      query = this->generateQuery("StudyInstanceUID as UID, StudyDescription as Name, ModalitiesInStudy as Scan, StudyDate as Date, AccessionNumber as Number, InstitutionName as Institution, ReferringPhysician as Referrer, PerformingPhysiciansName as Performer", "Studies", condition + QString("PatientsUID='%1'").arg(node->UID));
-      logger.debug ( "ctkDICOMModelPrivate::updateQueries for Patient: query is: " + query );
+      fields = "StudyInstanceUID as UID, StudyDescription as Name, ModalitiesInStudy as Scan, StudyDate as Date, AccessionNumber as Number, InstitutionName as Institution, ReferringPhysician as Referrer, PerformingPhysiciansName as Performer";
+      table = "Studies";
+      condition.append(QString("PatientsUID='%1'").arg(node->UID));
       break;
     case ctkDICOMModel::StudyType:
       //query = QString("SELECT SeriesInstanceUID as UID, SeriesDescription as Name, BodyPartExamined as Scan, SeriesDate as Date, AcquisitionNumber as Number FROM Series WHERE StudyInstanceUID='%1'").arg(node->UID);
       if(this->SearchParameters["Series"].toString() != "")
         {
-        condition.append("SeriesDescription LIKE \"%" + this->SearchParameters["Series"].toString() + "%\"" + " AND ");
+        condition.append(this->likeCondition("SeriesDescription", this->SearchParameters["Series"].toString()) + " AND ");
         }
-      query = this->generateQuery("SeriesInstanceUID as UID, SeriesDescription as Name, Modality as Age, SeriesNumber as Scan, BodyPartExamined as \"Subject ID\", SeriesDate as Date, AcquisitionNumber as Number","Series",condition + QString("StudyInstanceUID='%1'").arg(node->UID));
-      logger.debug ( "ctkDICOMModelPrivate::updateQueries for Study: query is: " + query );
+      fields = "SeriesInstanceUID as UID, SeriesDescription as Name, Modality as Age, SeriesNumber as Scan, BodyPartExamined as \"Subject ID\", SeriesDate as Date, AcquisitionNumber as Number";
+      table = "Series";
+      condition.append(QString("StudyInstanceUID='%1'").arg(node->UID));
       break;
     case ctkDICOMModel::SeriesType:
       if(this->SearchParameters["ID"].toString() != "")
         {
-        condition.append("SOPInstanceUID LIKE \"%" + this->SearchParameters["ID"].toString() + "%\"" + " AND ");
+        condition.append(this->likeCondition("SOPInstanceUID", this->SearchParameters["ID"].toString()) + " AND ");
         }
       //query = QString("SELECT Filename as UID, Filename as Name, SeriesInstanceUID as Date FROM Images WHERE SeriesInstanceUID='%1'").arg(node->UID);
-      query = this->generateQuery("SOPInstanceUID as UID, Filename as Name, SeriesInstanceUID as Date", "Images", condition + QString("SeriesInstanceUID='%1'").arg(node->UID));
-      logger.debug ( "ctkDICOMModelPrivate::updateQueries for Series: query is: " + query );
+      fields = "SOPInstanceUID as UID, Filename as Name, SeriesInstanceUID as Date";
+      table = "Images";
+      condition.append(QString("SeriesInstanceUID='%1'").arg(node->UID));
       break;
     case ctkDICOMModel::ImageType:
       break;
     }
-  node->Query = QSqlQuery(query, this->DataBase);
+  if (this->Windowed)
+    {
+    // the query is run lazily, by blocks
+    node->Fields = fields;
+    node->Table = table;
+    node->Conditions = condition;
+    node->TotalCount = -1;
+    node->FieldNames.clear();
+    node->BlockLastKeys.clear();
+    }
+  else
+    {
+    QString query;
+    if (!table.isEmpty())
+      {
+      query = this->generateQuery(fields, table, condition);
+      }
+    node->Query = QSqlQuery(query, this->DataBase);
+    }
   foreach(Node* child, node->Children)
     {
     this->updateQueries(child);
@@ -374,6 +457,12 @@ void ctkDICOMModelPrivate::fetch(const QModelIndex& indexValue, int limit)
 {
   Q_Q(ctkDICOMModel);
   Node* node = this->nodeFromIndex(indexValue);
+  if (this->Windowed)
+    {
+    // all the rows are available, they are fetched when accessed
+    this->childCount(node);
+    return;
+    }
   if (node->AtEnd || limit <= node->RowCount || node->Fetching/*|| bottom.column() == -1*/)
     {
     return;
@@ -421,6 +510,147 @@ void ctkDICOMModelPrivate::fetch(const QModelIndex& indexValue, int limit)
 
 
 
+//------------------------------------------------------------------------------
+int ctkDICOMModelPrivate::field(Node* parentNode, int row, const QString& columnName)const
+{
+  if (!this->Windowed)
+    {
+    return parentNode->Query.record().indexOf(columnName);
+    }
+  if (parentNode->FieldNames.isEmpty())
+    {
+    // the field names are known once a block has been fetched
+    this->block(parentNode, row / this->BlockSize);
+    }
+  return parentNode->FieldNames.indexOf(columnName);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMModelPrivate::childCount(Node* node)const
+{
+  if (node->TotalCount >= 0)
+    {
+    return node->TotalCount;
+    }
+  node->TotalCount = 0;
+  if (!node->Table.isEmpty())
+    {
+    // Children are always selected on an indexed key, counting them does not
+    // require to scan the rows.
+    QString countQuery = QString("SELECT COUNT(*) FROM ") + node->Table;
+    if (!node->Conditions.isEmpty())
+      {
+      countQuery += QString(" WHERE ") + node->Conditions;
+      }
+    QSqlQuery query(this->DataBase);
+    if (query.exec(countQuery) && query.next())
+      {
+      node->TotalCount = query.value(0).toInt();
+      }
+    else
+      {
+      logger.error("ctkDICOMModelPrivate::childCount: " + query.lastError().text());
+      }
+    }
+  node->RowCount = node->TotalCount;
+  node->AtEnd = true;
+  return node->TotalCount;
+}
+
+//------------------------------------------------------------------------------
+Block* ctkDICOMModelPrivate::block(Node* node, int blockIndex)const
+{
+  BlockKey key(node, blockIndex);
+  Block* cachedBlock = this->BlockCache.object(key);
+  if (cachedBlock)
+    {
+    return cachedBlock;
+    }
+
+  QString blockQuery = QString("SELECT ") + node->Fields
+    + QString(", rowid as ctkRowKey FROM ") + node->Table;
+  QStringList conditions;
+  if (!node->Conditions.isEmpty())
+    {
+    conditions << QString("(") + node->Conditions + QString(")");
+    }
+  // Keyset pagination: without sorting, rows are ordered by rowid and the
+  // block can be fetched from the last rowid of the previous block.
+  bool keyset = this->Sort.isEmpty()
+    && (blockIndex == 0 || node->BlockLastKeys.contains(blockIndex - 1));
+  if (keyset && blockIndex > 0)
+    {
+    conditions << QString("rowid > %1").arg(node->BlockLastKeys[blockIndex - 1]);
+    }
+  if (!conditions.isEmpty())
+    {
+    blockQuery += QString(" WHERE ") + conditions.join(" AND ");
+    }
+  blockQuery += QString(" ORDER BY ");
+  if (!this->Sort.isEmpty())
+    {
+    blockQuery += this->Sort + QString(", ");
+    }
+  blockQuery += QString("rowid LIMIT %1").arg(this->BlockSize);
+  if (!keyset)
+    {
+    blockQuery += QString(" OFFSET %1").arg(blockIndex * this->BlockSize);
+    }
+
+  QSqlQuery query(this->DataBase);
+  query.setForwardOnly(true);
+  if (!query.exec(blockQuery))
+    {
+    logger.error("ctkDICOMModelPrivate::block: " + query.lastError().text());
+    return 0;
+    }
+  QSqlRecord record = query.record();
+  const int fieldCount = record.count();
+  if (node->FieldNames.isEmpty())
+    {
+    for (int i = 0; i < fieldCount; ++i)
+      {
+      node->FieldNames << record.fieldName(i);
+      }
+    }
+  Block* newBlock = new Block;
+  newBlock->Rows.reserve(this->BlockSize);
+  qlonglong lastKey = 0;
+  while (query.next())
+    {
+    QVector<QVariant> row(fieldCount);
+    for (int i = 0; i < fieldCount; ++i)
+      {
+      row[i] = query.value(i);
+      }
+    lastKey = row[fieldCount - 1].toLongLong();
+    newBlock->Rows.push_back(row);
+    }
+  if (!newBlock->Rows.isEmpty())
+    {
+    node->BlockLastKeys[blockIndex] = lastKey;
+    }
+  this->BlockCache.insert(key, newBlock);
+  return newBlock;
+}
+
+//------------------------------------------------------------------------------
+QVariant ctkDICOMModelPrivate::windowedValue(Node* parentNode, int row, int column)const
+{
+  if (row < 0 || column < 0 || !parentNode || row >= this->childCount(parentNode))
+    {
+    return QVariant();
+    }
+  Block* rowBlock = this->block(parentNode, row / this->BlockSize);
+  int blockRow = row % this->BlockSize;
+  if (!rowBlock || blockRow >= rowBlock->Rows.size()
+      || column >= rowBlock->Rows[blockRow].size())
+    {
+    return QVariant();
+    }
+  return rowBlock->Rows[blockRow][column];
+}
+
 //------------------------------------------------------------------------------
 ctkDICOMModel::ctkDICOMModel(QObject* parentObject)
   : Superclass(parentObject)
@@ -440,6 +670,10 @@ bool ctkDICOMModel::canFetchMore ( const QModelIndex & parentValue ) const
 {
   Q_D(const ctkDICOMModel);
   Node* node = d->nodeFromIndex(parentValue);
+  if (node && d->Windowed)
+    {
+    return false;
+    }
   return node ? !node->AtEnd : false;
 }
 
@@ -487,12 +721,12 @@ QVariant ctkDICOMModel::data ( const QModelIndex & dataIndex, int role ) const
     }
   QModelIndex parentIndex = this->parent(dataIndex);
   Node* parentNode = d->nodeFromIndex(parentIndex);
-  if (dataIndex.row() >= parentNode->RowCount)
+  if (!d->Windowed && dataIndex.row() >= parentNode->RowCount)
     {
     const_cast<ctkDICOMModelPrivate *>(d)->fetch(dataIndex, dataIndex.row());
     }
   QString columnName = d->Headers[dataIndex.column()][Qt::DisplayRole].toString();
-  int field = parentNode->Query.record().indexOf(columnName);
+  int field = d->field(parentNode, dataIndex.row(), columnName);
   if (field < 0)
     {
     // Not all the columns are in the record, it's ok to have no field here.
@@ -606,6 +840,11 @@ bool ctkDICOMModel::hasChildren ( const QModelIndex & parentIndex ) const
   // We want to show only until EndLevel
   if(node->Type >= d->EndLevel)return false;
 
+  if (d->Windowed)
+    {
+    return d->childCount(node) > 0;
+    }
+
   // It's not because we don't have row that we don't have children, maybe it
   // just means that the children haven't been fetched yet
   if (node->RowCount == 0 && !node->AtEnd)
@@ -653,6 +892,20 @@ QModelIndex ctkDICOMModel::index ( int row, int column, const QModelIndex & pare
     return QModelIndex();
     }
   Node* parentNode = d->nodeFromIndex(parentIndex);
+  if (d->Windowed)
+    {
+    // rows don't move until the model is reset
+    if (row < 0 || row >= d->childCount(parentNode))
+      {
+      return QModelIndex();
+      }
+    Node* node = parentNode->ChildrenByRow.value(row);
+    if (node == 0)
+      {
+      node = d->createNode(row, parentIndex);
+      }
+    return this->createIndex(row, column, node);
+    }
   int field = 0;// always 0//parentNode->Query.record().indexOf("UID");
   QString uid = d->value(parentIndex, row, field).toString();
   Node* node = 0;
@@ -720,6 +973,10 @@ int ctkDICOMModel::rowCount ( const QModelIndex & parentValue ) const
     }
   Node* node = d->nodeFromIndex(parentValue);
   Q_ASSERT(node);
+  if (node && d->Windowed)
+    {
+    return d->childCount(node);
+    }
   // Returns the amount of rows currently cached on the client.
   return node ? node->RowCount : 0;
 }
@@ -849,8 +1106,7 @@ void ctkDICOMModel::setDatabase(const QSqlDatabase &db)
   this->beginResetModel();
   d->DataBase = db;
 
-  delete d->RootNode;
-  d->RootNode = 0;
+  d->clearNodes();
 
   if (d->DataBase.tables().empty())
     {
@@ -863,6 +1119,12 @@ void ctkDICOMModel::setDatabase(const QSqlDatabase &db)
 
   this->endResetModel();
 
+  if (d->Windowed)
+    {
+    // rows are counted and fetched on demand
+    return;
+    }
+
   // TODO, use hasQuerySize everywhere, not only in setDataBase()
   bool hasQuerySize = d->RootNode->Query.driver()->hasFeature(QSqlDriver::QuerySize);
   if (hasQuerySize && d->RootNode->Query.size() > 0)
@@ -876,6 +1138,20 @@ void ctkDICOMModel::setDatabase(const QSqlDatabase &db)
   d->fetch(QModelIndex(), 256);
 }
 
+//------------------------------------------------------------------------------
+QMap<QString, QVariant> ctkDICOMModel::searchParameters()const
+{
+  Q_D(const ctkDICOMModel);
+  return d->SearchParameters;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMModel::setSearchParameters(const QMap<QString, QVariant>& parameters)
+{
+  Q_D(ctkDICOMModel);
+  this->setDatabase(d->DataBase, parameters);
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMModel::setDatabase(const QSqlDatabase &db,const QMap<QString, QVariant>& parameters)
 {
@@ -885,8 +1161,7 @@ void ctkDICOMModel::setDatabase(const QSqlDatabase &db,const QMap<QString, QVari
   d->DataBase = db;
   d->SearchParameters = parameters;
 
-  delete d->RootNode;
-  d->RootNode = 0;
+  d->clearNodes();
 
   if (d->DataBase.tables().empty())
     {
@@ -899,6 +1174,12 @@ void ctkDICOMModel::setDatabase(const QSqlDatabase &db,const QMap<QString, QVari
 
   this->endResetModel();
 
+  if (d->Windowed)
+    {
+    // rows are counted and fetched on demand
+    return;
+    }
+
   // TODO, use hasQuerySize everywhere, not only in setDataBase()
   bool hasQuerySize = d->RootNode->Query.driver()->hasFeature(QSqlDriver::QuerySize);
   if (hasQuerySize && d->RootNode->Query.size() > 0)
@@ -926,6 +1207,65 @@ void ctkDICOMModel::setEndLevel(ctkDICOMModel::IndexType level)
   d->EndLevel = level;
 }
 
+//------------------------------------------------------------------------------
+bool ctkDICOMModel::windowedFetching()const
+{
+  Q_D(const ctkDICOMModel);
+  return d->Windowed;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMModel::setWindowedFetching(bool windowed)
+{
+  Q_D(ctkDICOMModel);
+  d->Windowed = windowed;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMModel::blockSize()const
+{
+  Q_D(const ctkDICOMModel);
+  return d->BlockSize;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMModel::setBlockSize(int size)
+{
+  Q_D(ctkDICOMModel);
+  if (size <= 0 || size == d->BlockSize)
+    {
+    return;
+    }
+  if (!d->Windowed)
+    {
+    d->BlockSize = size;
+    return;
+    }
+  // cached blocks and keys are only valid for a given block size
+  this->beginResetModel();
+  d->clearNodes();
+  d->BlockSize = size;
+  if (!d->DataBase.tables().empty())
+    {
+    d->RootNode = d->createNode(-1, QModelIndex());
+    }
+  this->endResetModel();
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMModel::cachedBlockCount()const
+{
+  Q_D(const ctkDICOMModel);
+  return d->BlockCache.maxCost();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMModel::setCachedBlockCount(int count)
+{
+  Q_D(ctkDICOMModel);
+  d->BlockCache.setMaxCost(qMax(1, count));
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMModel::reset()
 {
@@ -954,8 +1294,7 @@ void ctkDICOMModel::sort(int column, Qt::SortOrder order)
   emit layoutChanged();
   */
   this->beginResetModel();
-  delete d->RootNode;
-  d->RootNode = 0;
+  d->clearNodes();
   d->Sort = QString("\"%1\" %2")
     .arg(d->Headers[column][Qt::DisplayRole].toString())
     .arg(order == Qt::AscendingOrder ? "ASC" : "DESC");
@@ -41,6 +41,12 @@ class CTK_DICOM_CORE_EXPORT ctkDICOMModel
   Q_ENUMS(IndexType)
   /// startLevel contains the hierarchy depth the model contains
   Q_PROPERTY(IndexType endLevel READ endLevel WRITE setEndLevel);
+  /// Fetch only the rows being displayed, see setWindowedFetching()
+  Q_PROPERTY(bool windowedFetching READ windowedFetching WRITE setWindowedFetching);
+  /// Number of rows fetched at once in windowed mode
+  Q_PROPERTY(int blockSize READ blockSize WRITE setBlockSize);
+  /// Number of blocks of rows kept in memory in windowed mode
+  Q_PROPERTY(int cachedBlockCount READ cachedBlockCount WRITE setCachedBlockCount);
 public:
 
   enum {
@@ -62,10 +68,36 @@ public:
   void setDatabase(const QSqlDatabase& dataBase);
   void setDatabase(const QSqlDatabase& dataBase, const QMap<QString,QVariant>& parameters);
 
+  /// Parameters restricting the rows queried from the database: "Name",
+  /// "Study", "Series" and "ID" are matched as substrings of the patient
+  /// name, study description, series description and SOP instance UID,
+  /// "Modalities", "StartDate" and "EndDate" restrict the studies.
+  /// Setting them queries the database again.
+  QMap<QString,QVariant> searchParameters()const;
+  void setSearchParameters(const QMap<QString,QVariant>& parameters);
+
   /// Set it before populating the model
   ctkDICOMModel::IndexType endLevel()const;
   void setEndLevel(ctkDICOMModel::IndexType level);
 
+  /// By default, each node runs its query as soon as it is created and keeps
+  /// all the fetched rows in memory, which does not scale to large databases.
+  /// In windowed mode, the number of children is obtained with a COUNT query
+  /// and rows are fetched by blocks of blockSize rows, only when they are
+  /// accessed. The most recently used blocks are kept in a LRU cache of
+  /// cachedBlockCount blocks. Without sorting, blocks are fetched using the
+  /// rowid of the previous block instead of an OFFSET so that scrolling to
+  /// the end of a large list does not scan all the preceding rows.
+  /// Set it before populating the model.
+  bool windowedFetching()const;
+  void setWindowedFetching(bool windowed);
+
+  int blockSize()const;
+  void setBlockSize(int size);
+
+  int cachedBlockCount()const;
+  void setCachedBlockCount(int count);
+
   virtual bool canFetchMore ( const QModelIndex & parent ) const;
   virtual int columnCount ( const QModelIndex & parent = QModelIndex() ) const;
   virtual QVariant data ( const QModelIndex & index, int role = Qt::DisplayRole ) const;
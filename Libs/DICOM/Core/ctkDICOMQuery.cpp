@@ -29,6 +29,12 @@
 #include <QDirIterator>
 #include <QFileInfo>
 #include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 // ctkDICOMCore includes
 #include "ctkDICOMQuery.h"
@@ -67,28 +73,49 @@ public:
   ~ctkDICOMQuerySCUPrivate() {};
   virtual OFCondition handleFINDResponse(const T_ASC_PresentationContextID  presID,
                                          QRResponse *response,
-                                         OFBool &waitForNextResponse)
-    {
-      if (this->query)
-        {
-        logger.debug ( "FIND RESPONSE" );
-        emit this->query->debug("Got a find response!");
-        return this->DcmSCU::handleFINDResponse(presID, response, waitForNextResponse);
-        }
-      return DIMSE_NULLKEY;
-    };
+                                         OFBool &waitForNextResponse);
+};
+
+//------------------------------------------------------------------------------
+struct ctkDICOMQuerySeriesResult
+{
+  QString StudyInstanceUID;
+  /// Series response, 0 once all the series of the study have been received
+  DcmDataset* Dataset;
 };
 
 //------------------------------------------------------------------------------
 class ctkDICOMQueryPrivate
 {
+  Q_DECLARE_PUBLIC( ctkDICOMQuery );
+
+protected:
+  ctkDICOMQuery* const q_ptr;
+
 public:
-  ctkDICOMQueryPrivate();
+  ctkDICOMQueryPrivate(ctkDICOMQuery& obj);
   ~ctkDICOMQueryPrivate();
 
   /// Add a StudyInstanceUID to be queried
   void addStudyInstanceUIDAndDataset(const QString& StudyInstanceUID, DcmDataset* dataset );
 
+  /// Streaming mode: study level C-FIND on SCU, series level C-FIND on
+  /// the worker associations
+  bool streamingQuery(ctkDICOMDatabase& database, const QString& seriesDescription);
+  /// Called for each study response, on the thread running the query
+  void streamStudyResponse(DcmDataset* dataset);
+  void enqueueSeriesQuery(const QString& studyInstanceUID);
+  /// Insert the series responses received so far into the database.
+  /// If wait is true, return only when all the series queries are done.
+  void processSeriesResults(bool wait);
+  void insertSeriesResult(const ctkDICOMQuerySeriesResult& result);
+
+  // Called from the series workers
+  bool takeSeriesQuery(QString& studyInstanceUID);
+  void pushSeriesResult(const QString& studyInstanceUID, DcmDataset* dataset);
+  void seriesWorkerFinished();
+  bool seriesQueriesStopped();
+
   QString                 CallingAETitle;
   QString                 CalledAETitle;
   QString                 Host;
@@ -100,24 +127,193 @@ public:
   QStringList             StudyInstanceUIDList;
   QList<DcmDataset*>      StudyDatasetList;
   bool                    Canceled;
+
+  bool                    Streaming;
+  int                     MaximumSeriesAssociations;
+  bool                    CancelSent;
+  ctkDICOMDatabase*       StreamingDatabase;
+  /// Series level keys, copied by each series worker
+  DcmDataset*             SeriesQuery;
+  /// Study datasets owned by the query in streaming mode
+  QList<DcmDataset*>      StreamedDatasets;
+  int                     CompletedSeriesQueries;
+  QThreadPool             SeriesThreadPool;
+
+  // Shared with the series workers
+  QMutex                  SeriesMutex;
+  QWaitCondition          StudyAvailable;
+  QWaitCondition          SeriesResultAvailable;
+  QQueue<QString>         PendingStudies;
+  QQueue<ctkDICOMQuerySeriesResult> SeriesResults;
+  bool                    StudiesComplete;
+  bool                    StopSeriesQueries;
+  int                     RunningSeriesWorkers;
+};
+
+//------------------------------------------------------------------------------
+// Series level C-FIND on a worker association. The responses are copied
+// and handed to the thread running the query as they come in.
+class ctkDICOMQuerySeriesSCU : public DcmSCU
+{
+public:
+  ctkDICOMQuerySeriesSCU(ctkDICOMQueryPrivate* queryPrivate)
+    : QueryPrivate(queryPrivate)
+    , CancelSent(false)
+    {
+    }
+
+  virtual OFCondition handleFINDResponse(const T_ASC_PresentationContextID  presID,
+                                         QRResponse *response,
+                                         OFBool &waitForNextResponse)
+    {
+    if (response->m_dataset)
+      {
+      this->QueryPrivate->pushSeriesResult(this->StudyInstanceUID,
+                                           new DcmDataset(*response->m_dataset));
+      }
+    if (!this->CancelSent && this->QueryPrivate->seriesQueriesStopped())
+      {
+      this->sendCANCELRequest(presID);
+      this->CancelSent = true;
+      }
+    return this->DcmSCU::handleFINDResponse(presID, response, waitForNextResponse);
+    }
+
+  ctkDICOMQueryPrivate* QueryPrivate;
+  QString StudyInstanceUID;
+  bool CancelSent;
+};
+
+//------------------------------------------------------------------------------
+class ctkDICOMQuerySeriesWorker : public QRunnable
+{
+public:
+  ctkDICOMQuerySeriesWorker(ctkDICOMQueryPrivate* queryPrivate)
+    : QueryPrivate(queryPrivate)
+    , CallingAETitle(queryPrivate->CallingAETitle)
+    , CalledAETitle(queryPrivate->CalledAETitle)
+    , Host(queryPrivate->Host)
+    , Port(queryPrivate->Port)
+    , Query(*queryPrivate->SeriesQuery)
+    {
+    }
+
+  virtual void run()
+    {
+    ctkDICOMQuerySeriesSCU scu(this->QueryPrivate);
+    scu.setAETitle ( OFString(this->CallingAETitle.toStdString().c_str()) );
+    scu.setPeerAETitle ( OFString(this->CalledAETitle.toStdString().c_str()) );
+    scu.setPeerHostName ( OFString(this->Host.toStdString().c_str()) );
+    scu.setPeerPort ( this->Port );
+    OFList<OFString> transferSyntaxes;
+    transferSyntaxes.push_back ( UID_LittleEndianExplicitTransferSyntax );
+    transferSyntaxes.push_back ( UID_BigEndianExplicitTransferSyntax );
+    transferSyntaxes.push_back ( UID_LittleEndianImplicitTransferSyntax );
+    scu.addPresentationContext ( UID_FINDStudyRootQueryRetrieveInformationModel, transferSyntaxes );
+
+    T_ASC_PresentationContextID presID = 0;
+    if ( scu.initNetwork().good() && scu.negotiateAssociation().good() )
+      {
+      presID = scu.findPresentationContextID ( UID_FINDStudyRootQueryRetrieveInformationModel, "" );
+      }
+    if ( presID == 0 )
+      {
+      logger.error ( "Error negotiating the association for the series queries" );
+      }
+
+    QString studyInstanceUID;
+    while (this->QueryPrivate->takeSeriesQuery(studyInstanceUID))
+      {
+      // Studies are still consumed without association so that the query
+      // doesn't wait for them
+      if ( presID != 0 )
+        {
+        DcmDataset query(this->Query);
+        query.putAndInsertString ( DCM_StudyInstanceUID, studyInstanceUID.toStdString().c_str() );
+        scu.StudyInstanceUID = studyInstanceUID;
+        scu.CancelSent = false;
+        OFList<QRResponse *> responses;
+        OFCondition status = scu.sendFINDRequest ( presID, &query, &responses );
+        for ( OFListIterator(QRResponse*) it = responses.begin(); it != responses.end(); it++ )
+          {
+          delete *it;
+          }
+        if ( !status.good() )
+          {
+          logger.error ( "Find on Series level failed for Study: " + studyInstanceUID );
+          }
+        }
+      this->QueryPrivate->pushSeriesResult(studyInstanceUID, 0);
+      }
+
+    if ( scu.isConnected() )
+      {
+      scu.closeAssociation ( DCMSCU_RELEASE_ASSOCIATION );
+      }
+    this->QueryPrivate->seriesWorkerFinished();
+    }
+
+  ctkDICOMQueryPrivate* QueryPrivate;
+  QString CallingAETitle;
+  QString CalledAETitle;
+  QString Host;
+  int Port;
+  DcmDataset Query;
 };
 
+//------------------------------------------------------------------------------
+OFCondition ctkDICOMQuerySCUPrivate::handleFINDResponse(const T_ASC_PresentationContextID  presID,
+                                                        QRResponse *response,
+                                                        OFBool &waitForNextResponse)
+{
+  if (this->query)
+    {
+    logger.debug ( "FIND RESPONSE" );
+    emit this->query->debug("Got a find response!");
+    ctkDICOMQueryPrivate* d = this->query->d_func();
+    if (d->Streaming)
+      {
+      d->streamStudyResponse(response->m_dataset);
+      if (d->Canceled && !d->CancelSent)
+        {
+        // the remaining responses are discarded by the peer
+        this->sendCANCELRequest(presID);
+        d->CancelSent = true;
+        }
+      }
+    return this->DcmSCU::handleFINDResponse(presID, response, waitForNextResponse);
+    }
+  return DIMSE_NULLKEY;
+}
+
 //------------------------------------------------------------------------------
 // ctkDICOMQueryPrivate methods
 
 //------------------------------------------------------------------------------
-ctkDICOMQueryPrivate::ctkDICOMQueryPrivate()
+ctkDICOMQueryPrivate::ctkDICOMQueryPrivate(ctkDICOMQuery& obj)
+  : q_ptr(&obj)
 {
   this->Query = new DcmDataset();
   this->Port = 0;
   this->Canceled = false;
   this->PreferCGET = false;
+  this->Streaming = false;
+  this->MaximumSeriesAssociations = 4;
+  this->CancelSent = false;
+  this->StreamingDatabase = 0;
+  this->SeriesQuery = new DcmDataset();
+  this->CompletedSeriesQueries = 0;
+  this->StudiesComplete = false;
+  this->StopSeriesQueries = false;
+  this->RunningSeriesWorkers = 0;
 }
 
 //------------------------------------------------------------------------------
 ctkDICOMQueryPrivate::~ctkDICOMQueryPrivate()
 {
   delete this->Query;
+  delete this->SeriesQuery;
+  qDeleteAll(this->StreamedDatasets);
 }
 
 //------------------------------------------------------------------------------
@@ -127,13 +323,224 @@ void ctkDICOMQueryPrivate::addStudyInstanceUIDAndDataset( const QString& s, DcmD
   this->StudyDatasetList.append ( dataset );
 }
 
+//------------------------------------------------------------------------------
+bool ctkDICOMQueryPrivate::streamingQuery(ctkDICOMDatabase& database,
+                                          const QString& seriesDescription)
+{
+  Q_Q(ctkDICOMQuery);
+
+  this->StreamingDatabase = &database;
+  this->CancelSent = false;
+  this->CompletedSeriesQueries = 0;
+  this->StudyDatasetList.clear();
+  qDeleteAll(this->StreamedDatasets);
+  this->StreamedDatasets.clear();
+
+  this->SeriesQuery->clear();
+  this->SeriesQuery->insertEmptyElement ( DCM_SeriesNumber );
+  this->SeriesQuery->insertEmptyElement ( DCM_SeriesDescription );
+  this->SeriesQuery->insertEmptyElement ( DCM_SeriesInstanceUID );
+  this->SeriesQuery->insertEmptyElement ( DCM_SeriesDate );
+  this->SeriesQuery->insertEmptyElement ( DCM_SeriesTime );
+  this->SeriesQuery->insertEmptyElement ( DCM_Modality );
+  this->SeriesQuery->insertEmptyElement ( DCM_NumberOfSeriesRelatedInstances ); // Number of images in the series
+  this->SeriesQuery->putAndInsertOFStringArray(DCM_SeriesDescription, seriesDescription.toLatin1().data());
+  this->SeriesQuery->putAndInsertString ( DCM_QueryRetrieveLevel, "SERIES" );
+
+  {
+    QMutexLocker locker(&this->SeriesMutex);
+    this->PendingStudies.clear();
+    this->SeriesResults.clear();
+    this->StudiesComplete = false;
+    this->StopSeriesQueries = false;
+  }
+  this->SeriesThreadPool.setMaxThreadCount(qMax(1, this->MaximumSeriesAssociations));
+
+  Uint16 presentationContext = this->SCU.findPresentationContextID (
+    UID_FINDStudyRootQueryRetrieveInformationModel, "");
+  OFCondition status = DIMSE_NOVALIDPRESENTATIONCONTEXTID;
+  if ( presentationContext == 0 )
+    {
+    logger.error ( "Failed to find acceptable presentation context" );
+    emit q->progress("Failed to find acceptable presentation context");
+    }
+  else
+    {
+    emit q->progress(40);
+    // the study responses are processed as they arrive by streamStudyResponse()
+    OFList<QRResponse *> responses;
+    status = this->SCU.sendFINDRequest ( presentationContext, this->Query, &responses );
+    for ( OFListIterator(QRResponse*) it = responses.begin(); it != responses.end(); it++ )
+      {
+      delete *it;
+      }
+    }
+
+  {
+    QMutexLocker locker(&this->SeriesMutex);
+    this->StudiesComplete = true;
+    this->StudyAvailable.wakeAll();
+  }
+  this->processSeriesResults(true);
+  this->SeriesThreadPool.waitForDone();
+  this->StreamingDatabase = 0;
+
+  if ( !status.good() )
+    {
+    logger.error ( "Find failed" );
+    emit q->progress("Find failed");
+    return false;
+    }
+  return !this->Canceled;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMQueryPrivate::streamStudyResponse(DcmDataset* dataset)
+{
+  Q_Q(ctkDICOMQuery);
+  this->processSeriesResults(false);
+  if ( dataset == NULL || this->Canceled ) // the last response is always empty
+    {
+    return;
+    }
+  this->StreamingDatabase->insert ( dataset, false /* do not store to disk*/, false /* no thumbnail*/);
+  OFString studyInstanceUID;
+  dataset->findAndGetOFString ( DCM_StudyInstanceUID, studyInstanceUID );
+  // the response is deleted once handled, keep a copy for the series
+  DcmDataset* studyDataset = new DcmDataset(*dataset);
+  this->StreamedDatasets.append(studyDataset);
+  this->addStudyInstanceUIDAndDataset ( studyInstanceUID.c_str(), studyDataset );
+  emit q->studyFound(QString(studyInstanceUID.c_str()));
+  this->enqueueSeriesQuery(QString(studyInstanceUID.c_str()));
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMQueryPrivate::enqueueSeriesQuery(const QString& studyInstanceUID)
+{
+  QMutexLocker locker(&this->SeriesMutex);
+  this->PendingStudies.enqueue(studyInstanceUID);
+  // associations are opened on demand, up to MaximumSeriesAssociations
+  if (this->RunningSeriesWorkers < this->MaximumSeriesAssociations)
+    {
+    ++this->RunningSeriesWorkers;
+    this->SeriesThreadPool.start(new ctkDICOMQuerySeriesWorker(this));
+    }
+  this->StudyAvailable.wakeOne();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMQueryPrivate::processSeriesResults(bool wait)
+{
+  while (true)
+    {
+    ctkDICOMQuerySeriesResult result;
+    {
+      QMutexLocker locker(&this->SeriesMutex);
+      if (this->Canceled && !this->StopSeriesQueries)
+        {
+        this->StopSeriesQueries = true;
+        this->StudyAvailable.wakeAll();
+        }
+      while (wait && this->SeriesResults.isEmpty() && this->RunningSeriesWorkers > 0)
+        {
+        this->SeriesResultAvailable.wait(&this->SeriesMutex);
+        }
+      if (this->SeriesResults.isEmpty())
+        {
+        return;
+        }
+      result = this->SeriesResults.dequeue();
+    }
+    this->insertSeriesResult(result);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMQueryPrivate::insertSeriesResult(const ctkDICOMQuerySeriesResult& result)
+{
+  Q_Q(ctkDICOMQuery);
+  if (!result.Dataset)
+    {
+    ++this->CompletedSeriesQueries;
+    emit q->progress(QString("Find succeded on Series level for Study: ") + result.StudyInstanceUID);
+    emit q->progress(50 + (50 * this->CompletedSeriesQueries)
+                     / qMax(1, this->StudyInstanceUIDList.count() + 1));
+    return;
+    }
+  if (!this->Canceled)
+    {
+    int studyIndex = this->StudyInstanceUIDList.indexOf(result.StudyInstanceUID);
+    if (studyIndex >= 0)
+      {
+      // add the patient elements not provided for the series level query
+      DcmDataset* studyDataset = this->StudyDatasetList[studyIndex];
+      DcmElement* element = 0;
+      if (studyDataset->findAndGetElement(DCM_PatientName, element).good())
+        {
+        result.Dataset->insert(dynamic_cast<DcmElement*>(element->clone()), true);
+        }
+      if (studyDataset->findAndGetElement(DCM_PatientID, element).good())
+        {
+        result.Dataset->insert(dynamic_cast<DcmElement*>(element->clone()), true);
+        }
+      }
+    this->StreamingDatabase->insert ( result.Dataset, false /* do not store */, false /* no thumbnail */ );
+    OFString seriesInstanceUID;
+    result.Dataset->findAndGetOFString ( DCM_SeriesInstanceUID, seriesInstanceUID );
+    emit q->seriesFound(result.StudyInstanceUID, QString(seriesInstanceUID.c_str()));
+    }
+  delete result.Dataset;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMQueryPrivate::takeSeriesQuery(QString& studyInstanceUID)
+{
+  QMutexLocker locker(&this->SeriesMutex);
+  while (this->PendingStudies.isEmpty() && !this->StudiesComplete && !this->StopSeriesQueries)
+    {
+    this->StudyAvailable.wait(&this->SeriesMutex);
+    }
+  if (this->StopSeriesQueries || this->PendingStudies.isEmpty())
+    {
+    return false;
+    }
+  studyInstanceUID = this->PendingStudies.dequeue();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMQueryPrivate::pushSeriesResult(const QString& studyInstanceUID, DcmDataset* dataset)
+{
+  QMutexLocker locker(&this->SeriesMutex);
+  ctkDICOMQuerySeriesResult result;
+  result.StudyInstanceUID = studyInstanceUID;
+  result.Dataset = dataset;
+  this->SeriesResults.enqueue(result);
+  this->SeriesResultAvailable.wakeAll();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMQueryPrivate::seriesWorkerFinished()
+{
+  QMutexLocker locker(&this->SeriesMutex);
+  --this->RunningSeriesWorkers;
+  this->SeriesResultAvailable.wakeAll();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMQueryPrivate::seriesQueriesStopped()
+{
+  QMutexLocker locker(&this->SeriesMutex);
+  return this->StopSeriesQueries;
+}
+
 //------------------------------------------------------------------------------
 // ctkDICOMQuery methods
 
 //------------------------------------------------------------------------------
 ctkDICOMQuery::ctkDICOMQuery(QObject* parentObject)
   : QObject(parentObject)
-  , d_ptr(new ctkDICOMQueryPrivate)
+  , d_ptr(new ctkDICOMQueryPrivate(*this))
 {
   Q_D(ctkDICOMQuery);
   d->SCU.query = this; // give the dcmtk level access to this for emitting signals
@@ -215,6 +622,34 @@ bool ctkDICOMQuery::preferCGET()const
   return d->PreferCGET;
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMQuery::setStreaming ( bool streaming )
+{
+  Q_D(ctkDICOMQuery);
+  d->Streaming = streaming;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMQuery::streaming()const
+{
+  Q_D(const ctkDICOMQuery);
+  return d->Streaming;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMQuery::setMaximumSeriesAssociations ( int count )
+{
+  Q_D(ctkDICOMQuery);
+  d->MaximumSeriesAssociations = qMax(1, count);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMQuery::maximumSeriesAssociations()const
+{
+  Q_D(const ctkDICOMQuery);
+  return d->MaximumSeriesAssociations;
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMQuery::setFilters( const QMap<QString,QVariant>& filters )
 {
@@ -381,6 +816,14 @@ bool ctkDICOMQuery::query(ctkDICOMDatabase& database )
   emit progress(30);
   if (d->Canceled) {return false;}
 
+  if (d->Streaming)
+    {
+    bool success = d->streamingQuery(database, seriesDescription);
+    d->SCU.closeAssociation ( DCMSCU_RELEASE_ASSOCIATION );
+    emit progress(100);
+    return success;
+    }
+
   OFList<QRResponse *> responses;
 
   Uint16 presentationContext = 0;
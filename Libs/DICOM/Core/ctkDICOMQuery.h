@@ -44,6 +44,8 @@ class CTK_DICOM_CORE_EXPORT ctkDICOMQuery : public QObject
   Q_PROPERTY(QString host READ host WRITE setHost);
   Q_PROPERTY(int port READ port WRITE setPort);
   Q_PROPERTY(bool preferCGET READ preferCGET WRITE setPreferCGET);
+  Q_PROPERTY(bool streaming READ streaming WRITE setStreaming);
+  Q_PROPERTY(int maximumSeriesAssociations READ maximumSeriesAssociations WRITE setMaximumSeriesAssociations);
 
 public:
   explicit ctkDICOMQuery(QObject* parent = 0);
@@ -69,6 +71,19 @@ public:
   void setPreferCGET ( bool preferCGET );
   bool preferCGET()const;
 
+  /// In streaming mode, each C-FIND response is inserted into the database
+  /// and reported with studyFound()/seriesFound() as soon as it is received.
+  /// The series of the studies are queried while the study responses are
+  /// still coming in, over up to maximumSeriesAssociations associations.
+  /// cancel() is honored between two responses by sending a C-CANCEL.
+  /// false by default
+  void setStreaming ( bool streaming );
+  bool streaming()const;
+  /// Number of associations used to query the series in streaming mode.
+  /// 4 by default
+  void setMaximumSeriesAssociations ( int count );
+  int maximumSeriesAssociations()const;
+
   /// Query a remote DICOM Image Store SCP
   /// You must at least set the host and port before calling query()
   bool query(ctkDICOMDatabase& database);
@@ -111,6 +126,12 @@ Q_SIGNALS:
   /// Signal is emitted inside the query() function when finished with value 
   /// true for success or false for error
   void done(const bool& error);
+  /// Signal is emitted in streaming mode when a study response has been
+  /// inserted into the database
+  void studyFound(const QString& studyInstanceUID);
+  /// Signal is emitted in streaming mode when a series response has been
+  /// inserted into the database
+  void seriesFound(const QString& studyInstanceUID, const QString& seriesInstanceUID);
 
 public Q_SLOTS:
   void cancel();
@@ -0,0 +1,866 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QTime>
+
+// ctkDICOMCore includes
+#include "ctkDICOMRetrieveScheduler.h"
+#include "ctkLogger.h"
+
+// DCMTK includes
+#include "dcmtk/dcmnet/dimse.h"
+#include "dcmtk/dcmnet/diutil.h"
+#include "dcmtk/dcmnet/scu.h"
+
+#include <dcmtk/dcmdata/dcfilefo.h>
+#include <dcmtk/dcmdata/dcdeftag.h>
+#include <dcmtk/dcmdata/dcdatset.h>
+#include <dcmtk/ofstd/ofcond.h>
+#include <dcmtk/ofstd/ofstring.h>
+
+#include <dcmtk/dcmjpeg/djdecode.h>  /* for dcmjpeg decoders */
+#include <dcmtk/dcmjpeg/djencode.h>  /* for dcmjpeg encoders */
+#include <dcmtk/dcmdata/dcrledrg.h>  /* for DcmRLEDecoderRegistration */
+#include <dcmtk/dcmdata/dcrleerg.h>  /* for DcmRLEEncoderRegistration */
+
+static ctkLogger logger("org.commontk.dicom.DICOMRetrieveScheduler");
+
+//------------------------------------------------------------------------------
+/// Connection parameters of a retrieve, copied when it starts so that the
+/// workers never read the scheduler properties.
+struct ctkDICOMRetrieveSchedulerParameters
+{
+  QString CallingAETitle;
+  QString CalledAETitle;
+  QString Host;
+  int Port;
+  QString MoveDestinationAETitle;
+  QString StorageDirectory;
+  bool Move;
+};
+
+//------------------------------------------------------------------------------
+struct ctkDICOMRetrieveSubRequest
+{
+  QString StudyInstanceUID;
+  /// Empty for a study level request
+  QString SeriesInstanceUID;
+};
+
+//------------------------------------------------------------------------------
+class ctkDICOMRetrieveSchedulerPrivate
+{
+public:
+  ctkDICOMRetrieveSchedulerPrivate();
+
+  /// Thread safe, return false when there is nothing left to do
+  bool takeSubRequest(ctkDICOMRetrieveSubRequest& request);
+  bool wasCanceled();
+
+  /// List the series of a study with a SERIES level C-FIND
+  bool listSeries(const QString& studyInstanceUID, QStringList& seriesInstanceUIDs);
+  bool start(ctkDICOMRetrieveScheduler* scheduler, const QString& studyInstanceUID,
+             const QStringList& seriesInstanceUIDs, bool move);
+  QString resolvedStorageDirectory() const;
+
+  QString CallingAETitle;
+  QString CalledAETitle;
+  QString Host;
+  int Port;
+  QString MoveDestinationAETitle;
+  QString StorageDirectory;
+  int MaximumAssociations;
+  QSharedPointer<ctkDICOMDatabase> Database;
+
+  QThreadPool ThreadPool;
+
+  // Shared with the workers
+  QMutex Mutex;
+  QQueue<ctkDICOMRetrieveSubRequest> SubRequests;
+  QAtomicInt Canceled;
+
+  // Only accessed from the thread owning the scheduler
+  bool Running;
+  bool Move;
+  int ActiveWorkers;
+  int TotalSubRequests;
+  int CompletedSubRequests;
+  int FailedSubRequests;
+  qint64 ReceivedBytes;
+  int ReceivedInstances;
+  QTime Timer;
+  int LastThroughputTime;
+  QStringList FilesToIndex;
+  bool IndexingPending;
+};
+
+//------------------------------------------------------------------------------
+// A DcmSCU writing the C-GET datasets to disk as they come in and
+// forwarding the written files to the scheduler thread.
+class ctkDICOMRetrieveSchedulerSCU : public DcmSCU
+{
+public:
+  ctkDICOMRetrieveSchedulerSCU(ctkDICOMRetrieveScheduler* scheduler,
+                               ctkDICOMRetrieveSchedulerPrivate* schedulerPrivate,
+                               const QString& storageDirectory)
+    : Scheduler(scheduler)
+    , SchedulerPrivate(schedulerPrivate)
+    , StorageDirectory(storageDirectory)
+    {
+    }
+
+  virtual OFCondition handleSTORERequest(const T_ASC_PresentationContextID presID,
+                                         DcmDataset *incomingObject,
+                                         OFBool& continueCGETSession,
+                                         Uint16& cStoreReturnStatus)
+    {
+    Q_UNUSED(presID);
+    continueCGETSession = !this->SchedulerPrivate->wasCanceled();
+
+    OFString instanceUID;
+    OFString seriesUID;
+    OFString studyUID;
+    incomingObject->findAndGetOFString(DCM_SOPInstanceUID, instanceUID);
+    incomingObject->findAndGetOFString(DCM_SeriesInstanceUID, seriesUID);
+    incomingObject->findAndGetOFString(DCM_StudyInstanceUID, studyUID);
+    if (instanceUID.empty())
+      {
+      logger.error("Received a dataset without SOP Instance UID");
+      cStoreReturnStatus = STATUS_STORE_Error_CannotUnderstand;
+      return EC_Normal;
+      }
+
+    QString directory = this->StorageDirectory
+      + "/" + QString(studyUID.c_str()) + "/" + QString(seriesUID.c_str());
+    QString filePath = directory + "/" + QString(instanceUID.c_str()) + ".dcm";
+    if (!QDir().mkpath(directory))
+      {
+      logger.error("Can't create directory " + directory);
+      cStoreReturnStatus = STATUS_STORE_Refused_OutOfResources;
+      return EC_Normal;
+      }
+
+    // Keep the transfer syntax the dataset was received with
+    DcmFileFormat fileFormat(incomingObject);
+    OFCondition status = fileFormat.saveFile(
+      QDir::toNativeSeparators(filePath).toLocal8Bit().constData(), EXS_Unknown);
+    if (status.bad())
+      {
+      logger.error("Can't write " + filePath + ": " + QString(status.text()));
+      cStoreReturnStatus = STATUS_STORE_Refused_OutOfResources;
+      return EC_Normal;
+      }
+
+    cStoreReturnStatus = STATUS_Success;
+    QMetaObject::invokeMethod(this->Scheduler, "onInstanceStored", Qt::QueuedConnection,
+                              Q_ARG(QString, filePath),
+                              Q_ARG(qlonglong, QFileInfo(filePath).size()));
+    return EC_Normal;
+    }
+
+  virtual OFCondition handleCGETResponse(const T_ASC_PresentationContextID presID,
+                                         RetrieveResponse* response,
+                                         OFBool& continueCGETSession)
+    {
+    continueCGETSession = !this->SchedulerPrivate->wasCanceled();
+    return this->DcmSCU::handleCGETResponse(presID, response, continueCGETSession);
+    }
+
+  ctkDICOMRetrieveScheduler* Scheduler;
+  ctkDICOMRetrieveSchedulerPrivate* SchedulerPrivate;
+  QString StorageDirectory;
+};
+
+//------------------------------------------------------------------------------
+static void ctkDICOMRetrieveSchedulerInitializeSCU(DcmSCU& scu,
+  const ctkDICOMRetrieveSchedulerParameters& parameters, bool storage)
+{
+  scu.setAETitle(OFString(parameters.CallingAETitle.toStdString().c_str()));
+  scu.setPeerAETitle(OFString(parameters.CalledAETitle.toStdString().c_str()));
+  scu.setPeerHostName(OFString(parameters.Host.toStdString().c_str()));
+  scu.setPeerPort(parameters.Port);
+
+  OFList<OFString> transferSyntaxes;
+  transferSyntaxes.push_back ( UID_LittleEndianExplicitTransferSyntax );
+  transferSyntaxes.push_back ( UID_BigEndianExplicitTransferSyntax );
+  transferSyntaxes.push_back ( UID_LittleEndianImplicitTransferSyntax );
+  if (!storage)
+    {
+    scu.addPresentationContext(UID_FINDStudyRootQueryRetrieveInformationModel, transferSyntaxes);
+    return;
+    }
+  scu.addPresentationContext(UID_MOVEStudyRootQueryRetrieveInformationModel, transferSyntaxes);
+  scu.addPresentationContext(UID_GETStudyRootQueryRetrieveInformationModel, transferSyntaxes);
+  if (!parameters.Move)
+    {
+    for (Uint16 i = 0; i < numberOfDcmLongSCUStorageSOPClassUIDs; i++)
+      {
+      scu.addPresentationContext(dcmLongSCUStorageSOPClassUIDs[i],
+        transferSyntaxes, ASC_SC_ROLE_SCP);
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Owns one association and processes sub-requests until none is left
+class ctkDICOMRetrieveSchedulerWorker : public QRunnable
+{
+public:
+  ctkDICOMRetrieveSchedulerWorker(ctkDICOMRetrieveScheduler* scheduler,
+                                  ctkDICOMRetrieveSchedulerPrivate* schedulerPrivate,
+                                  const ctkDICOMRetrieveSchedulerParameters& parameters)
+    : Scheduler(scheduler)
+    , SchedulerPrivate(schedulerPrivate)
+    , Parameters(parameters)
+    {
+    }
+
+  virtual void run()
+    {
+    ctkDICOMRetrieveSchedulerSCU scu(this->Scheduler, this->SchedulerPrivate,
+                                     this->Parameters.StorageDirectory);
+    ctkDICOMRetrieveSchedulerInitializeSCU(scu, this->Parameters, true);
+    bool networkInitialized = scu.initNetwork().good();
+    if (!networkInitialized)
+      {
+      logger.error("Error initializing the network");
+      }
+
+    ctkDICOMRetrieveSubRequest request;
+    while (networkInitialized && this->SchedulerPrivate->takeSubRequest(request))
+      {
+      int completedInstances = 0;
+      bool success = this->retrieve(scu, request, completedInstances);
+      QMetaObject::invokeMethod(this->Scheduler, "onSubRequestFinished", Qt::QueuedConnection,
+                                Q_ARG(QString, request.SeriesInstanceUID),
+                                Q_ARG(bool, success),
+                                Q_ARG(int, completedInstances));
+      if (!success && !scu.isConnected())
+        {
+        // the peer dropped the association, the remaining sub-requests are
+        // left to the other workers
+        break;
+        }
+      }
+
+    if (scu.isConnected())
+      {
+      scu.closeAssociation(DCMSCU_RELEASE_ASSOCIATION);
+      }
+    QMetaObject::invokeMethod(this->Scheduler, "onWorkerFinished", Qt::QueuedConnection);
+    }
+
+  bool retrieve(ctkDICOMRetrieveSchedulerSCU& scu, const ctkDICOMRetrieveSubRequest& request,
+                int& completedInstances)
+    {
+    if (!scu.isConnected() && !scu.negotiateAssociation().good())
+      {
+      logger.error("Error negotiating association");
+      return false;
+      }
+
+    DcmDataset retrieveParameters;
+    if (request.SeriesInstanceUID.isEmpty())
+      {
+      retrieveParameters.putAndInsertString(DCM_QueryRetrieveLevel, "STUDY");
+      }
+    else
+      {
+      retrieveParameters.putAndInsertString(DCM_QueryRetrieveLevel, "SERIES");
+      retrieveParameters.putAndInsertString(DCM_SeriesInstanceUID,
+                                            request.SeriesInstanceUID.toStdString().c_str());
+      }
+    // Always required to send all higher level unique keys (Study Root)
+    retrieveParameters.putAndInsertString(DCM_StudyInstanceUID,
+                                          request.StudyInstanceUID.toStdString().c_str());
+
+    const char* abstractSyntax = this->Parameters.Move ?
+      UID_MOVEStudyRootQueryRetrieveInformationModel : UID_GETStudyRootQueryRetrieveInformationModel;
+    T_ASC_PresentationContextID presID = scu.findPresentationContextID(abstractSyntax, "");
+    if (presID == 0)
+      {
+      logger.error(QString("No valid Study Root %1 Presentation Context available")
+                   .arg(this->Parameters.Move ? "MOVE" : "GET"));
+      return false;
+      }
+
+    OFList<RetrieveResponse*> responses;
+    OFCondition status = this->Parameters.Move ?
+      scu.sendMOVERequest(presID, this->Parameters.MoveDestinationAETitle.toStdString().c_str(),
+                          &retrieveParameters, &responses) :
+      scu.sendCGETRequest(presID, &retrieveParameters, &responses);
+
+    bool success = status.good() && responses.begin() != responses.end();
+    if (success)
+      {
+      // the final response holds the sub-operation counts of the request
+      RetrieveResponse* finalResponse = responses.back();
+      success = finalResponse->m_status == STATUS_Success;
+      completedInstances = finalResponse->m_numberOfCompletedSubops;
+      }
+    else
+      {
+      logger.error(QString("Retrieve of %1 failed: %2")
+                   .arg(request.SeriesInstanceUID.isEmpty() ?
+                          request.StudyInstanceUID : request.SeriesInstanceUID)
+                   .arg(status.text()));
+      }
+    for (OFListIterator(RetrieveResponse*) it = responses.begin(); it != responses.end(); ++it)
+      {
+      delete *it;
+      }
+    return success;
+    }
+
+  ctkDICOMRetrieveScheduler* Scheduler;
+  ctkDICOMRetrieveSchedulerPrivate* SchedulerPrivate;
+  ctkDICOMRetrieveSchedulerParameters Parameters;
+};
+
+//------------------------------------------------------------------------------
+// ctkDICOMRetrieveSchedulerPrivate methods
+
+//------------------------------------------------------------------------------
+ctkDICOMRetrieveSchedulerPrivate::ctkDICOMRetrieveSchedulerPrivate()
+{
+  this->Port = 0;
+  this->MaximumAssociations = 4;
+  this->Running = false;
+  this->Move = false;
+  this->ActiveWorkers = 0;
+  this->TotalSubRequests = 0;
+  this->CompletedSubRequests = 0;
+  this->FailedSubRequests = 0;
+  this->ReceivedBytes = 0;
+  this->ReceivedInstances = 0;
+  this->LastThroughputTime = 0;
+  this->IndexingPending = false;
+
+  // Register the JPEG libraries in case we need them
+  // (registration only happens once, so it's okay to call repeatedly)
+  DJDecoderRegistration::registerCodecs();
+  DJEncoderRegistration::registerCodecs();
+  DcmRLEEncoderRegistration::registerCodecs();
+  DcmRLEDecoderRegistration::registerCodecs();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMRetrieveSchedulerPrivate::takeSubRequest(ctkDICOMRetrieveSubRequest& request)
+{
+  QMutexLocker locker(&this->Mutex);
+  if (this->wasCanceled() || this->SubRequests.isEmpty())
+    {
+    return false;
+    }
+  request = this->SubRequests.dequeue();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMRetrieveSchedulerPrivate::wasCanceled()
+{
+  return this->Canceled.fetchAndAddOrdered(0) != 0;
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMRetrieveSchedulerPrivate::resolvedStorageDirectory() const
+{
+  if (!this->StorageDirectory.isEmpty())
+    {
+    return this->StorageDirectory;
+    }
+  if (this->Database)
+    {
+    return this->Database->databaseDirectory() + "/dicom";
+    }
+  return QString();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMRetrieveSchedulerPrivate::listSeries(const QString& studyInstanceUID,
+                                                  QStringList& seriesInstanceUIDs)
+{
+  ctkDICOMRetrieveSchedulerParameters parameters;
+  parameters.CallingAETitle = this->CallingAETitle;
+  parameters.CalledAETitle = this->CalledAETitle;
+  parameters.Host = this->Host;
+  parameters.Port = this->Port;
+  parameters.Move = false;
+
+  DcmSCU scu;
+  ctkDICOMRetrieveSchedulerInitializeSCU(scu, parameters, false);
+  if (!scu.initNetwork().good() || !scu.negotiateAssociation().good())
+    {
+    logger.error("Error negotiating the series C-FIND association");
+    return false;
+    }
+  T_ASC_PresentationContextID presID =
+    scu.findPresentationContextID(UID_FINDStudyRootQueryRetrieveInformationModel, "");
+  if (presID == 0)
+    {
+    logger.error("No valid Study Root FIND Presentation Context available");
+    scu.closeAssociation(DCMSCU_RELEASE_ASSOCIATION);
+    return false;
+    }
+
+  DcmDataset query;
+  query.putAndInsertString(DCM_QueryRetrieveLevel, "SERIES");
+  query.putAndInsertString(DCM_StudyInstanceUID, studyInstanceUID.toStdString().c_str());
+  query.insertEmptyElement(DCM_SeriesInstanceUID);
+
+  OFList<QRResponse*> responses;
+  OFCondition status = scu.sendFINDRequest(presID, &query, &responses);
+  scu.closeAssociation(DCMSCU_RELEASE_ASSOCIATION);
+  for (OFListIterator(QRResponse*) it = responses.begin(); it != responses.end(); ++it)
+    {
+    DcmDataset* dataset = (*it)->m_dataset;
+    OFString seriesInstanceUID;
+    if (dataset != NULL // the last response is always empty
+        && dataset->findAndGetOFString(DCM_SeriesInstanceUID, seriesInstanceUID).good()
+        && !seriesInstanceUID.empty())
+      {
+      seriesInstanceUIDs << QString(seriesInstanceUID.c_str());
+      }
+    delete *it;
+    }
+  seriesInstanceUIDs.removeDuplicates();
+  return status.good();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMRetrieveSchedulerPrivate::start(ctkDICOMRetrieveScheduler* scheduler,
+                                             const QString& studyInstanceUID,
+                                             const QStringList& seriesInstanceUIDs,
+                                             bool move)
+{
+  if (this->Running)
+    {
+    logger.warn("A retrieve is already in progress");
+    return false;
+    }
+
+  ctkDICOMRetrieveSchedulerParameters parameters;
+  parameters.CallingAETitle = this->CallingAETitle;
+  parameters.CalledAETitle = this->CalledAETitle;
+  parameters.Host = this->Host;
+  parameters.Port = this->Port;
+  parameters.MoveDestinationAETitle = this->MoveDestinationAETitle;
+  parameters.StorageDirectory = this->resolvedStorageDirectory();
+  parameters.Move = move;
+  if (!move && parameters.StorageDirectory.isEmpty())
+    {
+    logger.error("C-GET requires a storage directory or a database");
+    return false;
+    }
+
+  QStringList series = seriesInstanceUIDs;
+  if (series.isEmpty() && !this->listSeries(studyInstanceUID, series))
+    {
+    logger.warn("Can't list the series of study " + studyInstanceUID
+                + ", retrieving it with a single request");
+    series.clear();
+    }
+
+  this->SubRequests.clear();
+  ctkDICOMRetrieveSubRequest request;
+  request.StudyInstanceUID = studyInstanceUID;
+  if (series.isEmpty())
+    {
+    this->SubRequests.enqueue(request);
+    }
+  foreach(const QString& seriesInstanceUID, series)
+    {
+    request.SeriesInstanceUID = seriesInstanceUID;
+    this->SubRequests.enqueue(request);
+    }
+
+  this->Canceled.fetchAndStoreOrdered(0);
+  this->Running = true;
+  this->Move = move;
+  this->TotalSubRequests = this->SubRequests.count();
+  this->CompletedSubRequests = 0;
+  this->FailedSubRequests = 0;
+  this->ReceivedBytes = 0;
+  this->ReceivedInstances = 0;
+  this->LastThroughputTime = 0;
+  this->Timer.start();
+
+  int workerCount = qMin(this->MaximumAssociations, this->TotalSubRequests);
+  this->ThreadPool.setMaxThreadCount(this->MaximumAssociations);
+  this->ActiveWorkers = workerCount;
+  for (int i = 0; i < workerCount; ++i)
+    {
+    this->ThreadPool.start(new ctkDICOMRetrieveSchedulerWorker(scheduler, this, parameters));
+    }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// ctkDICOMRetrieveScheduler methods
+
+//------------------------------------------------------------------------------
+ctkDICOMRetrieveScheduler::ctkDICOMRetrieveScheduler(QObject* parent)
+  : QObject(parent)
+  , d_ptr(new ctkDICOMRetrieveSchedulerPrivate)
+{
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMRetrieveScheduler::~ctkDICOMRetrieveScheduler()
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  // the workers hold a pointer to this object
+  this->cancel();
+  d->ThreadPool.waitForDone();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveScheduler::setCallingAETitle( const QString& callingAETitle )
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  d->CallingAETitle = callingAETitle;
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMRetrieveScheduler::callingAETitle() const
+{
+  Q_D(const ctkDICOMRetrieveScheduler);
+  return d->CallingAETitle;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveScheduler::setCalledAETitle( const QString& calledAETitle )
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  d->CalledAETitle = calledAETitle;
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMRetrieveScheduler::calledAETitle() const
+{
+  Q_D(const ctkDICOMRetrieveScheduler);
+  return d->CalledAETitle;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveScheduler::setHost( const QString& host )
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  d->Host = host;
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMRetrieveScheduler::host() const
+{
+  Q_D(const ctkDICOMRetrieveScheduler);
+  return d->Host;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveScheduler::setPort ( int port )
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  d->Port = port;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMRetrieveScheduler::port() const
+{
+  Q_D(const ctkDICOMRetrieveScheduler);
+  return d->Port;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveScheduler::setMoveDestinationAETitle( const QString& moveDestinationAETitle )
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  d->MoveDestinationAETitle = moveDestinationAETitle;
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMRetrieveScheduler::moveDestinationAETitle() const
+{
+  Q_D(const ctkDICOMRetrieveScheduler);
+  return d->MoveDestinationAETitle;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveScheduler::setMaximumAssociations(int count)
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  d->MaximumAssociations = qMax(1, count);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMRetrieveScheduler::maximumAssociations() const
+{
+  Q_D(const ctkDICOMRetrieveScheduler);
+  return d->MaximumAssociations;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveScheduler::setStorageDirectory(const QString& directory)
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  d->StorageDirectory = directory;
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMRetrieveScheduler::storageDirectory() const
+{
+  Q_D(const ctkDICOMRetrieveScheduler);
+  return d->resolvedStorageDirectory();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveScheduler::setDatabase(QSharedPointer<ctkDICOMDatabase> dicomDatabase)
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  d->Database = dicomDatabase;
+}
+
+//------------------------------------------------------------------------------
+QSharedPointer<ctkDICOMDatabase> ctkDICOMRetrieveScheduler::database() const
+{
+  Q_D(const ctkDICOMRetrieveScheduler);
+  return d->Database;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMRetrieveScheduler::isRunning() const
+{
+  Q_D(const ctkDICOMRetrieveScheduler);
+  return d->Running;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveScheduler::waitForFinished()
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  while (d->Running)
+    {
+    d->ThreadPool.waitForDone();
+    // the worker notifications are queued to this thread
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    }
+  this->indexPendingFiles();
+}
+
+//------------------------------------------------------------------------------
+qint64 ctkDICOMRetrieveScheduler::receivedBytes() const
+{
+  Q_D(const ctkDICOMRetrieveScheduler);
+  return d->ReceivedBytes;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMRetrieveScheduler::receivedInstances() const
+{
+  Q_D(const ctkDICOMRetrieveScheduler);
+  return d->ReceivedInstances;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMRetrieveScheduler::completedSeries() const
+{
+  Q_D(const ctkDICOMRetrieveScheduler);
+  return d->CompletedSubRequests;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMRetrieveScheduler::failedSeries() const
+{
+  Q_D(const ctkDICOMRetrieveScheduler);
+  return d->FailedSubRequests;
+}
+
+//------------------------------------------------------------------------------
+double ctkDICOMRetrieveScheduler::megabytesPerSecond() const
+{
+  Q_D(const ctkDICOMRetrieveScheduler);
+  if (!d->Timer.isValid())
+    {
+    return 0.;
+    }
+  int elapsed = qMax(1, d->Timer.elapsed());
+  return (d->ReceivedBytes / (1024. * 1024.)) / (elapsed / 1000.);
+}
+
+//------------------------------------------------------------------------------
+double ctkDICOMRetrieveScheduler::instancesPerSecond() const
+{
+  Q_D(const ctkDICOMRetrieveScheduler);
+  if (!d->Timer.isValid())
+    {
+    return 0.;
+    }
+  int elapsed = qMax(1, d->Timer.elapsed());
+  return d->ReceivedInstances / (elapsed / 1000.);
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMRetrieveScheduler::getStudy(const QString& studyInstanceUID)
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  return d->start(this, studyInstanceUID, QStringList(), false);
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMRetrieveScheduler::getSeries(const QString& studyInstanceUID,
+                                          const QStringList& seriesInstanceUIDs)
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  if (seriesInstanceUIDs.isEmpty())
+    {
+    return false;
+    }
+  return d->start(this, studyInstanceUID, seriesInstanceUIDs, false);
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMRetrieveScheduler::moveStudy(const QString& studyInstanceUID)
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  return d->start(this, studyInstanceUID, QStringList(), true);
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMRetrieveScheduler::moveSeries(const QString& studyInstanceUID,
+                                           const QStringList& seriesInstanceUIDs)
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  if (seriesInstanceUIDs.isEmpty())
+    {
+    return false;
+    }
+  return d->start(this, studyInstanceUID, seriesInstanceUIDs, true);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveScheduler::cancel()
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  d->Canceled.fetchAndStoreOrdered(1);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveScheduler::onInstanceStored(const QString& filePath, qlonglong bytes)
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  d->ReceivedBytes += bytes;
+  ++d->ReceivedInstances;
+  d->FilesToIndex << filePath;
+  emit instanceStored(filePath);
+
+  // Index the files received in the meantime in one bulk insert, once the
+  // pending worker notifications have been processed
+  if (!d->IndexingPending)
+    {
+    d->IndexingPending = true;
+    QMetaObject::invokeMethod(this, "indexPendingFiles", Qt::QueuedConnection);
+    }
+
+  // Don't flood the receivers with throughput updates
+  int elapsed = d->Timer.elapsed();
+  if (elapsed - d->LastThroughputTime >= 250)
+    {
+    d->LastThroughputTime = elapsed;
+    emit throughputChanged(this->megabytesPerSecond(), this->instancesPerSecond());
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveScheduler::onSubRequestFinished(const QString& seriesInstanceUID,
+                                                     bool success, int completedInstances)
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  if (success)
+    {
+    ++d->CompletedSubRequests;
+    }
+  else
+    {
+    ++d->FailedSubRequests;
+    }
+  if (d->Move)
+    {
+    // C-MOVE: the instances are not received here, only counted
+    d->ReceivedInstances += completedInstances;
+    }
+  emit seriesRetrieved(seriesInstanceUID, success);
+  emit progress(d->TotalSubRequests ?
+    100 * (d->CompletedSubRequests + d->FailedSubRequests) / d->TotalSubRequests : 100);
+  emit throughputChanged(this->megabytesPerSecond(), this->instancesPerSecond());
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveScheduler::onWorkerFinished()
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  if (--d->ActiveWorkers > 0)
+    {
+    return;
+    }
+
+  // Sub-requests left over by canceled or disconnected workers
+  QList<ctkDICOMRetrieveSubRequest> remaining;
+  {
+    QMutexLocker locker(&d->Mutex);
+    remaining = d->SubRequests;
+    d->SubRequests.clear();
+  }
+  foreach(const ctkDICOMRetrieveSubRequest& request, remaining)
+    {
+    this->onSubRequestFinished(request.SeriesInstanceUID, false, 0);
+    }
+
+  this->indexPendingFiles();
+  d->Running = false;
+  emit throughputChanged(this->megabytesPerSecond(), this->instancesPerSecond());
+  emit finished(d->FailedSubRequests == 0 && !d->wasCanceled());
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveScheduler::indexPendingFiles()
+{
+  Q_D(ctkDICOMRetrieveScheduler);
+  d->IndexingPending = false;
+  if (d->FilesToIndex.isEmpty())
+    {
+    return;
+    }
+  QStringList files = d->FilesToIndex;
+  d->FilesToIndex.clear();
+  if (!d->Database || !d->Database->isOpen())
+    {
+    return;
+    }
+  // The files are already in the storage directory, don't copy them again
+  d->Database->insertBatch(files, false, true);
+}
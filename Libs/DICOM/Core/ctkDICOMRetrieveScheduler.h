@@ -0,0 +1,151 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkDICOMRetrieveScheduler_h
+#define __ctkDICOMRetrieveScheduler_h
+
+// Qt includes
+#include <QObject>
+#include <QSharedPointer>
+#include <QStringList>
+
+#include "ctkDICOMCoreExport.h"
+#include "ctkDICOMDatabase.h"
+
+class ctkDICOMRetrieveSchedulerPrivate;
+
+/// \ingroup DICOM_Core
+///
+/// \brief Retrieves studies over several concurrent associations
+///
+/// A study retrieve is split into one sub-request per series. The
+/// sub-requests are shared by up to maximumAssociations workers, each of
+/// them owning its own association with the peer. With C-GET, the received
+/// datasets are written to storageDirectory as soon as they come in and the
+/// written files are indexed into the database in batches, on the thread
+/// owning the scheduler. With C-MOVE, the datasets are sent to the move
+/// destination and only the number of completed sub-operations is known.
+///
+/// Retrieves are asynchronous: getStudy() and moveStudy() return once the
+/// series list is known and finished() is emitted when all the sub-requests
+/// are done. If the series of the study can't be listed with a C-FIND, the
+/// study is retrieved with a single study level request.
+///
+class CTK_DICOM_CORE_EXPORT ctkDICOMRetrieveScheduler : public QObject
+{
+  Q_OBJECT
+  Q_PROPERTY(QString callingAETitle READ callingAETitle WRITE setCallingAETitle);
+  Q_PROPERTY(QString calledAETitle READ calledAETitle WRITE setCalledAETitle);
+  Q_PROPERTY(QString host READ host WRITE setHost);
+  Q_PROPERTY(int port READ port WRITE setPort);
+  Q_PROPERTY(QString moveDestinationAETitle READ moveDestinationAETitle WRITE setMoveDestinationAETitle);
+  Q_PROPERTY(int maximumAssociations READ maximumAssociations WRITE setMaximumAssociations);
+  Q_PROPERTY(QString storageDirectory READ storageDirectory WRITE setStorageDirectory);
+
+public:
+  explicit ctkDICOMRetrieveScheduler(QObject* parent = 0);
+  virtual ~ctkDICOMRetrieveScheduler();
+
+  /// Set methods for connectivity
+  void setCallingAETitle( const QString& callingAETitle );
+  QString callingAETitle() const;
+  void setCalledAETitle( const QString& calledAETitle );
+  QString calledAETitle() const;
+  void setHost( const QString& host );
+  QString host() const;
+  void setPort ( int port );
+  int port() const;
+  void setMoveDestinationAETitle( const QString& moveDestinationAETitle );
+  QString moveDestinationAETitle() const;
+
+  /// Number of associations opened in parallel with the peer. Default is 4.
+  /// Changes are taken into account by the next retrieve.
+  void setMaximumAssociations(int count);
+  int maximumAssociations() const;
+
+  /// Directory where the C-GET datasets are written, as
+  /// <storageDirectory>/<study>/<series>/<instance>.dcm.
+  /// Default is the "dicom" subdirectory of the database directory, which
+  /// is where the database stores its own files.
+  void setStorageDirectory(const QString& directory);
+  QString storageDirectory() const;
+
+  /// Database the retrieved files are indexed into.
+  void setDatabase(QSharedPointer<ctkDICOMDatabase> dicomDatabase);
+  QSharedPointer<ctkDICOMDatabase> database() const;
+
+  /// Return true while a retrieve is in progress
+  bool isRunning() const;
+
+  /// Block until the current retrieve is finished and all the received
+  /// files are indexed.
+  Q_INVOKABLE void waitForFinished();
+
+  /// Statistics of the current (or last) retrieve
+  qint64 receivedBytes() const;
+  int receivedInstances() const;
+  int completedSeries() const;
+  int failedSeries() const;
+
+  /// Average throughput since the start of the current (or last) retrieve
+  double megabytesPerSecond() const;
+  double instancesPerSecond() const;
+
+public Q_SLOTS:
+  /// Retrieve the study with C-GET. Return false if a retrieve is already
+  /// in progress or if the request could not be started.
+  bool getStudy(const QString& studyInstanceUID);
+  /// Retrieve the given series of a study with C-GET.
+  bool getSeries(const QString& studyInstanceUID, const QStringList& seriesInstanceUIDs);
+  /// Retrieve the study with C-MOVE to moveDestinationAETitle.
+  bool moveStudy(const QString& studyInstanceUID);
+  /// Retrieve the given series of a study with C-MOVE.
+  bool moveSeries(const QString& studyInstanceUID, const QStringList& seriesInstanceUIDs);
+
+  /// Don't start new sub-requests and stop the C-GET sessions in progress.
+  void cancel();
+
+Q_SIGNALS:
+  /// Emitted when a dataset has been written to disk
+  void instanceStored(const QString& filePath);
+  /// Emitted when a sub-request is done. The series UID is empty for
+  /// study level requests.
+  void seriesRetrieved(const QString& seriesInstanceUID, bool success);
+  /// Aggregated throughput of all the associations
+  void throughputChanged(double megabytesPerSecond, double instancesPerSecond);
+  /// Percentage of completed sub-requests
+  void progress(int);
+  void finished(bool success);
+
+protected Q_SLOTS:
+  void onInstanceStored(const QString& filePath, qlonglong bytes);
+  void onSubRequestFinished(const QString& seriesInstanceUID, bool success, int completedInstances);
+  void onWorkerFinished();
+  void indexPendingFiles();
+
+protected:
+  QScopedPointer<ctkDICOMRetrieveSchedulerPrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(ctkDICOMRetrieveScheduler);
+  Q_DISABLE_COPY(ctkDICOMRetrieveScheduler);
+};
+
+#endif
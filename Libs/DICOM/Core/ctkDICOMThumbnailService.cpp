@@ -0,0 +1,377 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QSet>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QThread>
+#include <QThreadPool>
+#include <QVariant>
+
+// ctkDICOM includes
+#include "ctkLogger.h"
+#include "ctkDICOMAbstractThumbnailGenerator.h"
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMThumbnailService.h"
+
+// DCMTK includes
+#include <dcmtk/dcmimgle/dcmimage.h>  /* for class DicomImage */
+#include <dcmtk/dcmimage/diregist.h>  /* include support for color images */
+
+//------------------------------------------------------------------------------
+static ctkLogger logger("org.commontk.dicom.DICOMThumbnailService" );
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+class ctkDICOMThumbnailServiceJob : public QRunnable
+{
+public:
+  ctkDICOMThumbnailServiceJob(ctkDICOMThumbnailService* service,
+                              ctkDICOMAbstractThumbnailGenerator* generator,
+                              const QString& thumbnailPath,
+                              const QString& seriesInstanceUID,
+                              const QString& fileName)
+    : Service(service)
+    , Generator(generator)
+    , ThumbnailPath(thumbnailPath)
+    , SeriesInstanceUID(seriesInstanceUID)
+    , FileName(fileName)
+  {
+  }
+
+  virtual void run()
+  {
+    bool success = false;
+    DicomImage dcmImage(QDir::toNativeSeparators(this->FileName).toLatin1());
+    if (dcmImage.getStatus() == EIS_Normal)
+      {
+      success = this->Generator->generateThumbnail(&dcmImage, this->ThumbnailPath);
+      }
+    QMetaObject::invokeMethod(this->Service, "onJobFinished", Qt::QueuedConnection,
+                              Q_ARG(QString, this->ThumbnailPath),
+                              Q_ARG(QString, this->SeriesInstanceUID),
+                              Q_ARG(QString, this->FileName),
+                              Q_ARG(bool, success));
+  }
+
+private:
+  ctkDICOMThumbnailService* Service;
+  ctkDICOMAbstractThumbnailGenerator* Generator;
+  QString ThumbnailPath;
+  QString SeriesInstanceUID;
+  QString FileName;
+};
+
+//------------------------------------------------------------------------------
+class ctkDICOMThumbnailServicePrivate
+{
+public:
+  ctkDICOMThumbnailServicePrivate();
+
+  /// Return false if no job has ever been recorded in the database
+  bool hasJobTable() const;
+  /// Start the jobs returned by the query, return the number of started jobs
+  int startJobs(ctkDICOMThumbnailService* service, QSqlQuery& query, int maxCount);
+
+  ctkDICOMDatabase* Database;
+  QThreadPool ThreadPool;
+  bool Running;
+  bool BackgroundProcessing;
+  bool SchedulePending;
+  QStringList PrioritySeries;
+  /// Thumbnail paths of the jobs in progress
+  QSet<QString> InFlight;
+};
+
+//------------------------------------------------------------------------------
+ctkDICOMThumbnailServicePrivate::ctkDICOMThumbnailServicePrivate()
+{
+  this->Database = 0;
+  this->Running = false;
+  this->BackgroundProcessing = true;
+  this->SchedulePending = false;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMThumbnailServicePrivate::hasJobTable() const
+{
+  return this->Database && this->Database->isOpen()
+    && this->Database->database().tables().contains("ThumbnailJobs");
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMThumbnailServicePrivate::startJobs(ctkDICOMThumbnailService* service,
+                                               QSqlQuery& query, int maxCount)
+{
+  ctkDICOMAbstractThumbnailGenerator* generator = this->Database->thumbnailGenerator();
+  int started = 0;
+  while (started < maxCount && query.next())
+    {
+    QString thumbnailPath = query.value(0).toString();
+    if (this->InFlight.contains(thumbnailPath))
+      {
+      continue;
+      }
+    this->InFlight.insert(thumbnailPath);
+    this->ThreadPool.start(new ctkDICOMThumbnailServiceJob(service, generator, thumbnailPath,
+      query.value(1).toString(), query.value(2).toString()));
+    ++started;
+    }
+  return started;
+}
+
+//------------------------------------------------------------------------------
+// ctkDICOMThumbnailService methods
+
+//------------------------------------------------------------------------------
+ctkDICOMThumbnailService::ctkDICOMThumbnailService(ctkDICOMDatabase* database, QObject* parent)
+  : QObject(parent)
+  , d_ptr(new ctkDICOMThumbnailServicePrivate)
+{
+  Q_D(ctkDICOMThumbnailService);
+  d->Database = database;
+  d->ThreadPool.setMaxThreadCount(QThread::idealThreadCount());
+  connect(database, SIGNAL(thumbnailJobAdded(QString)),
+          this, SLOT(onThumbnailJobAdded()));
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMThumbnailService::~ctkDICOMThumbnailService()
+{
+  Q_D(ctkDICOMThumbnailService);
+  d->Running = false;
+  d->ThreadPool.waitForDone();
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMDatabase* ctkDICOMThumbnailService::database() const
+{
+  Q_D(const ctkDICOMThumbnailService);
+  return d->Database;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::setMaximumThreadCount(int count)
+{
+  Q_D(ctkDICOMThumbnailService);
+  d->ThreadPool.setMaxThreadCount(qMax(1, count));
+  this->scheduleJobs();
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMThumbnailService::maximumThreadCount() const
+{
+  Q_D(const ctkDICOMThumbnailService);
+  return d->ThreadPool.maxThreadCount();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::setBackgroundProcessing(bool enabled)
+{
+  Q_D(ctkDICOMThumbnailService);
+  d->BackgroundProcessing = enabled;
+  this->scheduleJobs();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMThumbnailService::backgroundProcessing() const
+{
+  Q_D(const ctkDICOMThumbnailService);
+  return d->BackgroundProcessing;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::setPrioritySeries(const QStringList& seriesInstanceUIDs)
+{
+  Q_D(ctkDICOMThumbnailService);
+  d->PrioritySeries = seriesInstanceUIDs;
+  this->scheduleJobs();
+}
+
+//------------------------------------------------------------------------------
+QStringList ctkDICOMThumbnailService::prioritySeries() const
+{
+  Q_D(const ctkDICOMThumbnailService);
+  return d->PrioritySeries;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::requestSeries(const QString& seriesInstanceUID)
+{
+  Q_D(ctkDICOMThumbnailService);
+  d->PrioritySeries.removeAll(seriesInstanceUID);
+  d->PrioritySeries.prepend(seriesInstanceUID);
+  this->scheduleJobs();
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMThumbnailService::pendingJobCount() const
+{
+  Q_D(const ctkDICOMThumbnailService);
+  if (!d->hasJobTable())
+    {
+    return 0;
+    }
+  QSqlQuery query(d->Database->database());
+  if (!query.exec("SELECT COUNT(*) FROM ThumbnailJobs") || !query.next())
+    {
+    logger.error("Counting thumbnail jobs failed: " + query.lastError().text());
+    return 0;
+    }
+  return query.value(0).toInt();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMThumbnailService::isRunning() const
+{
+  Q_D(const ctkDICOMThumbnailService);
+  return d->Running;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::start()
+{
+  Q_D(ctkDICOMThumbnailService);
+  d->Running = true;
+  this->scheduleJobs();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::stop()
+{
+  Q_D(ctkDICOMThumbnailService);
+  d->Running = false;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::waitForDone()
+{
+  Q_D(ctkDICOMThumbnailService);
+  do
+    {
+    // completion notifications are queued to this thread, deliver them so
+    // that the next jobs get scheduled
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    d->ThreadPool.waitForDone();
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    }
+  while (!d->InFlight.isEmpty());
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::onThumbnailJobAdded()
+{
+  Q_D(ctkDICOMThumbnailService);
+  // Coalesce the notifications of a whole indexing run
+  if (!d->SchedulePending)
+    {
+    d->SchedulePending = true;
+    QMetaObject::invokeMethod(this, "scheduleJobs", Qt::QueuedConnection);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::scheduleJobs()
+{
+  Q_D(ctkDICOMThumbnailService);
+  d->SchedulePending = false;
+  if (!d->Running || !d->hasJobTable() || !d->Database->thumbnailGenerator())
+    {
+    return;
+    }
+  // Keep a few jobs queued in the pool so that the threads never starve,
+  // but not too many so that a priority change is honored quickly.
+  int freeSlots = 2 * d->ThreadPool.maxThreadCount() - d->InFlight.count();
+
+  if (freeSlots > 0 && !d->PrioritySeries.isEmpty())
+    {
+    QSqlQuery query(d->Database->database());
+    query.prepare("SELECT ThumbnailPath, SeriesInstanceUID, Filename FROM ThumbnailJobs"
+                  " WHERE SeriesInstanceUID = ?");
+    foreach(const QString& seriesInstanceUID, d->PrioritySeries)
+      {
+      if (freeSlots <= 0)
+        {
+        break;
+        }
+      query.bindValue(0, seriesInstanceUID);
+      if (!query.exec())
+        {
+        logger.error("Selecting thumbnail jobs failed: " + query.lastError().text());
+        return;
+        }
+      freeSlots -= d->startJobs(this, query, freeSlots);
+      }
+    }
+
+  if (freeSlots > 0 && d->BackgroundProcessing)
+    {
+    QSqlQuery query(d->Database->database());
+    query.prepare("SELECT ThumbnailPath, SeriesInstanceUID, Filename FROM ThumbnailJobs LIMIT ?");
+    query.bindValue(0, freeSlots + d->InFlight.count());
+    if (!query.exec())
+      {
+      logger.error("Selecting thumbnail jobs failed: " + query.lastError().text());
+      return;
+      }
+    freeSlots -= d->startJobs(this, query, freeSlots);
+    }
+
+  if (d->InFlight.isEmpty())
+    {
+    emit queueEmpty();
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::onJobFinished(const QString& thumbnailPath,
+                                             const QString& seriesInstanceUID,
+                                             const QString& fileName,
+                                             bool success)
+{
+  Q_D(ctkDICOMThumbnailService);
+  d->InFlight.remove(thumbnailPath);
+  if (d->Database && d->Database->isOpen())
+    {
+    // Failed jobs are dropped as well, retrying would fail the same way.
+    // A job replaced by another file while in progress is kept.
+    QSqlQuery query(d->Database->database());
+    query.prepare("DELETE FROM ThumbnailJobs WHERE ThumbnailPath = ? AND Filename = ?");
+    query.bindValue(0, thumbnailPath);
+    query.bindValue(1, fileName);
+    if (!query.exec())
+      {
+      logger.error("Removing thumbnail job failed: " + query.lastError().text());
+      }
+    }
+  if (success)
+    {
+    emit thumbnailGenerated(seriesInstanceUID, thumbnailPath);
+    }
+  else
+    {
+    logger.warn("Could not generate thumbnail " + thumbnailPath);
+    }
+  this->scheduleJobs();
+}
@@ -0,0 +1,111 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkDICOMThumbnailService_h
+#define __ctkDICOMThumbnailService_h
+
+// Qt includes
+#include <QObject>
+#include <QStringList>
+
+#include "ctkDICOMCoreExport.h"
+
+class ctkDICOMDatabase;
+class ctkDICOMThumbnailServicePrivate;
+
+/// \ingroup DICOM_Core
+///
+/// \brief Generates the thumbnails of a ctkDICOMDatabase in a worker pool
+///
+/// When ctkDICOMDatabase::deferThumbnailGeneration is enabled, inserting an
+/// instance only records a (series, file) job in the ThumbnailJobs table of
+/// the database. The service renders these jobs with the database thumbnail
+/// generator in its own thread pool. Jobs of the priority series are always
+/// rendered first; the remaining jobs are rendered only if
+/// backgroundProcessing is enabled, otherwise they stay queued until their
+/// series is requested. As the queue is stored in the database, jobs left
+/// over from a previous session are picked up by start().
+///
+/// The database itself is only accessed from the thread owning the service.
+/// The database thumbnail generator is called concurrently from the pool
+/// threads, it must be reentrant (see ctkDICOMAbstractThumbnailGenerator).
+///
+class CTK_DICOM_CORE_EXPORT ctkDICOMThumbnailService : public QObject
+{
+  Q_OBJECT
+  Q_PROPERTY(int maximumThreadCount READ maximumThreadCount WRITE setMaximumThreadCount)
+  Q_PROPERTY(bool backgroundProcessing READ backgroundProcessing WRITE setBackgroundProcessing)
+  Q_PROPERTY(QStringList prioritySeries READ prioritySeries WRITE setPrioritySeries)
+public:
+  explicit ctkDICOMThumbnailService(ctkDICOMDatabase* database, QObject* parent = 0);
+  virtual ~ctkDICOMThumbnailService();
+
+  ctkDICOMDatabase* database() const;
+
+  /// Number of threads used to render thumbnails. Default is
+  /// QThread::idealThreadCount().
+  void setMaximumThreadCount(int count);
+  int maximumThreadCount() const;
+
+  /// If enabled (default), jobs of non priority series are also rendered.
+  void setBackgroundProcessing(bool enabled);
+  bool backgroundProcessing() const;
+
+  /// Series whose thumbnails are rendered before any other,
+  /// typically the series currently displayed.
+  void setPrioritySeries(const QStringList& seriesInstanceUIDs);
+  QStringList prioritySeries() const;
+
+  /// Number of jobs waiting in the database, including the ones in progress.
+  Q_INVOKABLE int pendingJobCount() const;
+
+  bool isRunning() const;
+
+  /// Block until no job is in progress anymore. Jobs scheduled while waiting
+  /// are processed as well.
+  Q_INVOKABLE void waitForDone();
+
+public Q_SLOTS:
+  void start();
+  /// Stop scheduling new jobs, jobs in progress are completed.
+  void stop();
+  /// Render the thumbnails of the series before any other.
+  void requestSeries(const QString& seriesInstanceUID);
+
+Q_SIGNALS:
+  void thumbnailGenerated(const QString& seriesInstanceUID, const QString& thumbnailPath);
+  /// Emitted when there is no more job to schedule
+  void queueEmpty();
+
+protected Q_SLOTS:
+  void scheduleJobs();
+  void onThumbnailJobAdded();
+  void onJobFinished(const QString& thumbnailPath, const QString& seriesInstanceUID,
+                     const QString& fileName, bool success);
+
+protected:
+  QScopedPointer<ctkDICOMThumbnailServicePrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(ctkDICOMThumbnailService);
+  Q_DISABLE_COPY(ctkDICOMThumbnailService);
+};
+
+#endif
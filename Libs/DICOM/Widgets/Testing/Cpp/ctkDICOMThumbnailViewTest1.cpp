@@ -0,0 +1,111 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QDir>
+#include <QTimer>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMModel.h"
+#include "ctkDICOMThumbnailView.h"
+
+// STD includes
+#include <iostream>
+
+int ctkDICOMThumbnailViewTest1( int argc, char * argv [] )
+{
+  QApplication app(argc, argv);
+
+  if (argc <= 2)
+    {
+    std::cerr << "Warning, no sql file given. Test stops" << std::endl;
+    std::cerr << "Usage: ctkDICOMThumbnailViewTest1 <scratch.db> <dumpfile.sql>" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QFileInfo databasePath;
+  databasePath.setFile(argv[1]);
+  ctkDICOMDatabase myCTK( databasePath.absoluteFilePath() );
+
+  if (!myCTK.initializeDatabase(argv[2]))
+    {
+    std::cerr << "Error when initializing the data base: " << argv[2]
+              << " error: " << myCTK.lastError().toStdString();
+    }
+
+  ctkDICOMModel model;
+  model.setDatabase(myCTK.database());
+
+  ctkDICOMThumbnailView view;
+  view.setDatabaseDirectory(databasePath.absolutePath());
+
+  // One thumbnail per study of the patient
+  QModelIndex patientIndex = model.index(0, 0);
+  view.addThumbnails(patientIndex);
+  model.fetchMore(patientIndex);
+  const int studyCount = model.rowCount(patientIndex);
+  if (studyCount == 0 || view.model()->rowCount() != studyCount)
+    {
+    std::cerr << "ctkDICOMThumbnailView::addThumbnails() added "
+              << view.model()->rowCount() << " thumbnails instead of "
+              << studyCount << " for the patient" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The thumbnails refer to the ctkDICOMModel indexes
+  QModelIndex studyIndex = model.index(studyCount - 1, 0, patientIndex);
+  view.selectThumbnailFromIndex(studyIndex);
+  if (view.currentIndex().data(ctkDICOMThumbnailView::SourceIndexRole)
+        .value<QPersistentModelIndex>() != studyIndex)
+    {
+    std::cerr << "ctkDICOMThumbnailView::selectThumbnailFromIndex() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // An index which is not displayed does not change the selection
+  view.selectThumbnailFromIndex(patientIndex);
+  if (view.currentIndex().data(ctkDICOMThumbnailView::SourceIndexRole)
+        .value<QPersistentModelIndex>() != studyIndex)
+    {
+    std::cerr << "ctkDICOMThumbnailView::selectThumbnailFromIndex() selected "
+              << "an index which is not displayed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // One thumbnail per series of the study
+  view.addThumbnails(studyIndex);
+  model.fetchMore(studyIndex);
+  if (view.model()->rowCount() != model.rowCount(studyIndex))
+    {
+    std::cerr << "ctkDICOMThumbnailView::addThumbnails() added "
+              << view.model()->rowCount() << " thumbnails instead of "
+              << model.rowCount(studyIndex) << " for the study" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  view.show();
+  if (argc <= 3 || QString(argv[3]) != "-I")
+    {
+    QTimer::singleShot(200, &app, SLOT(quit()));
+    }
+  return app.exec();
+}
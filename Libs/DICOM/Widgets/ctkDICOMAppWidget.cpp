@@ -52,6 +52,7 @@
 // ctkDICOMWidgets includes
 #include "ctkDICOMAppWidget.h"
 #include "ctkDICOMThumbnailGenerator.h"
+#include "ctkDICOMThumbnailView.h"
 #include "ctkThumbnailLabel.h"
 #include "ctkDICOMQueryResultsTabWidget.h"
 #include "ctkDICOMQueryRetrieveWidget.h"
@@ -303,8 +304,8 @@ ctkDICOMAppWidget::ctkDICOMAppWidget(QWidget* _parent):Superclass(_parent),
   connect(d->TreeView, SIGNAL(clicked(QModelIndex)), d->ImagePreview, SLOT(onModelSelected(QModelIndex)));
   connect(d->TreeView, SIGNAL(clicked(QModelIndex)), this, SLOT(onModelSelected(QModelIndex)));
 
-  connect(d->ThumbnailsWidget, SIGNAL(selected(ctkThumbnailLabel)), this, SLOT(onThumbnailSelected(ctkThumbnailLabel)));
-  connect(d->ThumbnailsWidget, SIGNAL(doubleClicked(ctkThumbnailLabel)), this, SLOT(onThumbnailDoubleClicked(ctkThumbnailLabel)));
+  connect(d->ThumbnailsWidget, SIGNAL(thumbnailSelected(QModelIndex)), this, SLOT(onThumbnailSelected(QModelIndex)));
+  connect(d->ThumbnailsWidget, SIGNAL(thumbnailDoubleClicked(QModelIndex)), this, SLOT(onThumbnailDoubleClicked(QModelIndex)));
   connect(d->ImportDialog, SIGNAL(fileSelected(QString)),this,SLOT(onImportDirectory(QString)));
 
   connect(d->QueryRetrieveWidget, SIGNAL(canceled()), d->QueryRetrieveWidget, SLOT(hide()) );
@@ -593,9 +594,14 @@ void ctkDICOMAppWidget::resetModel()
 //----------------------------------------------------------------------------
 void ctkDICOMAppWidget::onThumbnailSelected(const ctkThumbnailLabel& widget)
 {
-    Q_D(ctkDICOMAppWidget);
+  this->onThumbnailSelected(widget.property("sourceIndex").value<QPersistentModelIndex>());
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMAppWidget::onThumbnailSelected(const QModelIndex& index)
+{
+  Q_D(ctkDICOMAppWidget);
 
-  QModelIndex index = widget.property("sourceIndex").value<QPersistentModelIndex>();
   if(index.isValid())
     {
     d->ImagePreview->onModelSelected(index);
@@ -605,9 +611,13 @@ void ctkDICOMAppWidget::onThumbnailSelected(const ctkThumbnailLabel& widget)
 //----------------------------------------------------------------------------
 void ctkDICOMAppWidget::onThumbnailDoubleClicked(const ctkThumbnailLabel& widget)
 {
-    Q_D(ctkDICOMAppWidget);
+  this->onThumbnailDoubleClicked(widget.property("sourceIndex").value<QPersistentModelIndex>());
+}
 
-    QModelIndex index = widget.property("sourceIndex").value<QPersistentModelIndex>();
+//----------------------------------------------------------------------------
+void ctkDICOMAppWidget::onThumbnailDoubleClicked(const QModelIndex& index)
+{
+    Q_D(ctkDICOMAppWidget);
 
     if(!index.isValid())
       {
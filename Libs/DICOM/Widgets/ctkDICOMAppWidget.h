@@ -119,9 +119,13 @@ protected Q_SLOTS:
 
     /// To be called when a thumbnail in thumbnail list widget is selected
     void onThumbnailSelected(const ctkThumbnailLabel& widget);
+    /// To be called with the ctkDICOMModel index of the selected thumbnail
+    void onThumbnailSelected(const QModelIndex& sourceIndex);
 
     /// To be called when a thumbnail in thumbnail list widget is double-clicked
     void onThumbnailDoubleClicked(const ctkThumbnailLabel& widget);
+    /// To be called with the ctkDICOMModel index of the double-clicked thumbnail
+    void onThumbnailDoubleClicked(const QModelIndex& sourceIndex);
 
     /// To be called when previous and next buttons are clicked
     void onNextImage();
@@ -24,6 +24,7 @@
 #include <QMessageBox>
 #include <QProgressDialog>
 #include <QSettings>
+#include <QTime>
 #include <QTreeView>
 #include <QTabBar>
 
@@ -70,6 +71,8 @@ public:
   QProgressDialog*                  ProgressDialog;
   QString                           CurrentServer;
     bool                              UseProgressDialog;
+  /// Time since the tables were last refreshed with streamed query results
+  QTime                             LastResultsUpdate;
 };
 
 //----------------------------------------------------------------------------
@@ -81,6 +84,7 @@ ctkDICOMQueryRetrieveWidgetPrivate::ctkDICOMQueryRetrieveWidgetPrivate(
   : q_ptr(&obj)
 {
   this->ProgressDialog = 0;
+  this->CurrentQuery = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -176,6 +180,11 @@ void ctkDICOMQueryRetrieveWidget::query()
   progress.setMinimumDuration(0);
   progress.setValue(0);
   progress.show();
+
+  // The results are streamed into the database, show them as they come
+  d->dicomTableManager->setDICOMDatabase(&(d->QueryResultDatabase));
+  d->LastResultsUpdate.start();
+
   foreach (d->CurrentServer, d->ServerNodeWidget->selectedServerNodes())
     {
     if (progress.wasCanceled())
@@ -194,6 +203,7 @@ void ctkDICOMQueryRetrieveWidget::query()
     query->setHost(parameters["Address"].toString());
     query->setPort(parameters["Port"].toInt());
     query->setPreferCGET(parameters["CGET"].toBool());
+    query->setStreaming(true);
 
     // populate the query with the current search options
     query->setFilters( d->QueryWidget->parameters() );
@@ -205,6 +215,10 @@ void ctkDICOMQueryRetrieveWidget::query()
               progressLabel, SLOT(setText(QString)));
       connect(query, SIGNAL(progress(int)),
               this, SLOT(onQueryProgressChanged(int)));
+      connect(query, SIGNAL(studyFound(QString)),
+              this, SLOT(onQueryResultFound(QString)));
+      connect(query, SIGNAL(seriesFound(QString,QString)),
+              this, SLOT(onQueryResultFound(QString)));
 
       // run the query against the selected server and put results in database
       query->query ( d->QueryResultDatabase );
@@ -213,6 +227,10 @@ void ctkDICOMQueryRetrieveWidget::query()
                  progressLabel, SLOT(setText(QString)));
       disconnect(query, SIGNAL(progress(int)),
                  this, SLOT(onQueryProgressChanged(int)));
+      disconnect(query, SIGNAL(studyFound(QString)),
+                 this, SLOT(onQueryResultFound(QString)));
+      disconnect(query, SIGNAL(seriesFound(QString,QString)),
+                 this, SLOT(onQueryResultFound(QString)));
       disconnect(&progress, SIGNAL(canceled()), query, SLOT(cancel()));
       }
     catch (std::exception e)
@@ -233,9 +251,8 @@ void ctkDICOMQueryRetrieveWidget::query()
   if (!progress.wasCanceled())
     {
     d->Model.setDatabase(d->QueryResultDatabase.database());
-    
-    d->dicomTableManager->setDICOMDatabase(&(d->QueryResultDatabase));
     }
+  d->dicomTableManager->updateTableViews();
   d->RetrieveButton->setEnabled(d->QueriesByStudyUID.keys().size() != 0);
 
   progress.setValue(progress.maximum());
@@ -409,6 +426,26 @@ void ctkDICOMQueryRetrieveWidget::onQueryProgressChanged(int value)
   QApplication::processEvents();
 }
 
+//----------------------------------------------------------------------------
+void ctkDICOMQueryRetrieveWidget::onQueryResultFound(const QString& studyInstanceUID)
+{
+  Q_D(ctkDICOMQueryRetrieveWidget);
+  if (d->CurrentQuery)
+    {
+    d->QueriesByStudyUID[studyInstanceUID] = d->CurrentQuery;
+    }
+  // Refreshing the tables requeries the whole result database, don't do it
+  // for every response
+  if (d->LastResultsUpdate.elapsed() < 200)
+    {
+    return;
+    }
+  d->dicomTableManager->updateTableViews();
+  d->LastResultsUpdate.start();
+  // Give a chance to the user to cancel between two responses
+  QApplication::processEvents();
+}
+
 //----------------------------------------------------------------------------
 void ctkDICOMQueryRetrieveWidget::updateRetrieveProgress(int value)
 {
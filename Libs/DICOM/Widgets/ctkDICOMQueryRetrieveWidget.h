@@ -70,6 +70,7 @@ Q_SIGNALS:
 
 protected Q_SLOTS:
   void onQueryProgressChanged(int value);
+  void onQueryResultFound(const QString& studyInstanceUID);
   void updateRetrieveProgress(int value);
 
 protected:
@@ -23,8 +23,11 @@
 #include "ui_ctkDICOMTableView.h"
 
 // Qt includes
+#include <QDebug>
 #include <QMouseEvent>
 #include <QSortFilterProxyModel>
+#include <QSqlError>
+#include <QSqlQuery>
 #include <QSqlQueryModel>
 
 //------------------------------------------------------------------------------
@@ -49,6 +52,11 @@ public:
 
   QString queryTableName() const;
 
+  /// Return a "column IN (...)" condition whose values are stored in a
+  /// temporary table instead of being concatenated into the query string.
+  QString inCondition(const QString& column, const QStringList& values, int filterIndex);
+  void dropFilterTables();
+
   ctkDICOMDatabase* dicomDatabase;
   QSqlQueryModel dicomSQLModel;
   QSortFilterProxyModel* dicomSQLFilterModel;
@@ -57,6 +65,8 @@ public:
   QStringList currentSelection;
   //Key = QString for columns, Values = QStringList
   QHash<QString, QStringList> sqlWhereConditions;
+  // Temporary tables holding the values of the IN conditions
+  QStringList filterTables;
 
 };
 
@@ -149,6 +159,55 @@ QString ctkDICOMTableViewPrivate::queryTableName() const
   return this->lblTableName->text();
 }
 
+//----------------------------------------------------------------------------
+QString ctkDICOMTableViewPrivate::inCondition(const QString& column, const QStringList& values,
+                                              int filterIndex)
+{
+  Q_Q(ctkDICOMTableView);
+  QSqlDatabase database = this->dicomDatabase->database();
+  QString tableName = QString("ctkDICOMTableView_%1_%2")
+    .arg(reinterpret_cast<quintptr>(q), 0, 16).arg(filterIndex);
+  QSqlQuery query(database);
+  if (!this->filterTables.contains(tableName))
+    {
+    // untyped column: values are compared with the affinity of the column
+    if (!query.exec(QString("CREATE TEMP TABLE IF NOT EXISTS %1 (Value PRIMARY KEY)").arg(tableName)))
+      {
+      qWarning() << "ctkDICOMTableView: " << query.lastError().text();
+      }
+    this->filterTables << tableName;
+    }
+  query.exec(QString("DELETE FROM temp.%1").arg(tableName));
+  // a transaction fails if the database is already in one (bulk insert)
+  bool transaction = database.transaction();
+  query.prepare(QString("INSERT OR IGNORE INTO temp.%1 VALUES (?)").arg(tableName));
+  query.addBindValue(values);
+  if (!query.execBatch())
+    {
+    qWarning() << "ctkDICOMTableView: " << query.lastError().text();
+    }
+  if (transaction)
+    {
+    database.commit();
+    }
+  return column + QString(" IN (SELECT Value FROM temp.%1)").arg(tableName);
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMTableViewPrivate::dropFilterTables()
+{
+  if (this->filterTables.isEmpty() || !this->dicomDatabase || !this->dicomDatabase->isOpen())
+    {
+    return;
+    }
+  QSqlQuery query(this->dicomDatabase->database());
+  foreach(const QString& tableName, this->filterTables)
+    {
+    query.exec(QString("DROP TABLE IF EXISTS temp.%1").arg(tableName));
+    }
+  this->filterTables.clear();
+}
+
 //----------------------------------------------------------------------------
 void ctkDICOMTableViewPrivate::showFilterActiveWarning(bool showWarning)
 {
@@ -212,6 +271,9 @@ void ctkDICOMTableView::setDicomDataBase(ctkDICOMDatabase *dicomDatabase)
   if (!dicomDatabase)
     return;
 
+  // The temporary tables belong to the connection of the previous database.
+  // The ones that are not dropped go away when the connection is closed.
+  d->dropFilterTables();
   d->dicomDatabase = dicomDatabase;
   //Create connections for new database
   QObject::connect(d->dicomDatabase, SIGNAL(instanceAdded(const QString&)),
@@ -317,13 +379,22 @@ bool ctkDICOMTableView::eventFilter(QObject *obj, QEvent *event)
 void ctkDICOMTableView::setQuery(const QStringList &uids)
 {
   Q_D(ctkDICOMTableView);
-  QString query = ("select distinct %1.* from Patients, Series, Studies where "
-                   "Patients.UID = Studies.PatientsUID and Studies.StudyInstanceUID = Series.StudyInstanceUID");
-
+  if (d->dicomDatabase == 0 || !d->dicomDatabase->isOpen())
+    {
+    return;
+    }
+  // Explicit joins on the indexed keys (StudiesPatientIndex and
+  // SeriesStudyIndex), grouping on the rowid of the displayed table is much
+  // cheaper than a DISTINCT on all its columns.
+  QString query = ("select %1.* from Patients"
+                   " inner join Studies on Patients.UID = Studies.PatientsUID"
+                   " inner join Series on Studies.StudyInstanceUID = Series.StudyInstanceUID");
+
+  QStringList conditions;
+  int filterIndex = 0;
   if (!uids.empty() && d->queryForeignKey.length() != 0)
     {
-      query += " and %1."+d->queryForeignKey+" in ( '";
-      query.append(uids.join("','")).append("')");
+      conditions << d->inCondition("%1." + d->queryForeignKey, uids, filterIndex++);
     }
   if (!d->sqlWhereConditions.empty())
     {
@@ -332,16 +403,17 @@ void ctkDICOMTableView::setQuery(const QStringList &uids)
         {
           if (!i.value().empty())
             {
-              query += " and "+i.key()+" in ( '";
-              query.append(i.value().join("','")).append("')");
+              conditions << d->inCondition(i.key(), i.value(), filterIndex++);
             }
           ++i;
         }
     }
-  if (d->dicomDatabase != 0 && d->dicomDatabase->isOpen())
+  if (!conditions.empty())
     {
-    d->dicomSQLModel.setQuery(query.arg(d->queryTableName()), d->dicomDatabase->database());
+      query += " where " + conditions.join(" and ");
     }
+  query += " group by %1.rowid";
+  d->dicomSQLModel.setQuery(query.arg(d->queryTableName()), d->dicomDatabase->database());
 }
 
 void ctkDICOMTableView::addSqlWhereCondition(const std::pair<QString, QStringList> &condition)
@@ -25,6 +25,7 @@
 
 // Qt includes
 #include <QImage>
+#include <QVector>
 
 // DCMTK includes
 #include "dcmtk/dcmimgle/dcmimage.h"
@@ -96,41 +97,40 @@ bool ctkDICOMThumbnailGenerator::generateThumbnail(DicomImage *dcmImage, const Q
           dcmImage->setMinMaxWindow(OFTrue /* ignore extreme values */);
         }
     }
-    /* get image extension and prepare image header */
+    /* get image extension and prepare output buffer */
     const unsigned long width = dcmImage->getWidth();
     const unsigned long height = dcmImage->getHeight();
-    unsigned long offset = 0;
-    unsigned long length = 0;
-    QString header;
+    const int samplesPerPixel = dcmImage->isMonochrome() ? 1 : 3 /* RGB */;
+    const unsigned long length = width * height * samplesPerPixel;
 
+    /* render pixel data to buffer */
+    QByteArray buffer;
+    buffer.resize(length);
+    if (!dcmImage->getOutputData(static_cast<void *>(buffer.data()), length, 8, 0))
+    {
+      logger.error("Rendering of DICOM image failed for thumbnail");
+      return false;
+    }
+    /* wrap the rendered pixels, no need to encode and decode a PGM/PPM stream */
+    const uchar* pixels = reinterpret_cast<const uchar*>(buffer.constData());
     if (dcmImage->isMonochrome())
     {
-      // write PGM header (binary monochrome image format)
-      header = QString("P5 %1 %2 255\n").arg(width).arg(height);
-      offset = header.length();
-      length = width * height + offset;
+      image = QImage(pixels, width, height, width, QImage::Format_Indexed8);
+      QVector<QRgb> grayTable(256);
+      for (int i = 0; i < 256; ++i)
+      {
+        grayTable[i] = qRgb(i, i, i);
+      }
+      image.setColorTable(grayTable);
     }
     else
     {
-      // write PPM header (binary color image format)
-      header = QString("P6 %1 %2 255\n").arg(width).arg(height);
-      offset = header.length();
-      length = width * height * 3 /* RGB */ + offset;
+      image = QImage(pixels, width, height, width * 3, QImage::Format_RGB888);
     }
-    /* create output buffer for DicomImage class */
-    QByteArray buffer;
-    /* copy header to output buffer and resize it for pixel data */
-    buffer.append(header);
-    buffer.resize(length);
-
-    /* render pixel data to buffer */
-    if (dcmImage->getOutputData(static_cast<void *>(buffer.data() + offset), length - offset, 8, 0))
-    {  
-      if (!image.loadFromData( buffer ))
-        {
-            logger.error("QImage couldn't created");
-            return false;
-        }
+    if (image.isNull())
+    {
+      logger.error("QImage couldn't created");
+      return false;
     }
     image.scaled(128,128,Qt::KeepAspectRatio).save(path,"PNG");
     return true;
@@ -33,6 +33,8 @@ class DicomImage;
 ///
 /// \brief  thumbnail generator class
 ///
+/// generateThumbnail() only uses local state, it can be called concurrently.
+///
 class CTK_DICOM_WIDGETS_EXPORT ctkDICOMThumbnailGenerator : public ctkDICOMAbstractThumbnailGenerator
 {
   Q_OBJECT
@@ -27,6 +27,7 @@
 #include <QMetaType>
 #include <QPersistentModelIndex>
 #include <QPixmap>
+#include <QPointer>
 #include <QPushButton>
 #include <QResizeEvent>
 
@@ -42,6 +43,7 @@
 #include "ctkDICOMDatabase.h"
 #include "ctkDICOMFilterProxyModel.h"
 #include "ctkDICOMModel.h"
+#include "ctkDICOMThumbnailService.h"
 
 // ctkDICOMWidgets includes
 #include "ctkDICOMThumbnailListWidget.h"
@@ -68,6 +70,9 @@ public:
 
   QString DatabaseDirectory;
   QModelIndex CurrentSelectedModel;
+  QPointer<ctkDICOMThumbnailService> ThumbnailService;
+  /// Series having thumbnails displayed
+  QStringList DisplayedSeries;
 
   void addThumbnailWidget(const QModelIndex &imageIndex, const QModelIndex& sourceIndex, const QString& text);
 
@@ -180,26 +185,40 @@ void ctkDICOMThumbnailListWidgetPrivate
     }
   QModelIndex seriesIndex = imageIndex.parent();
   QModelIndex studyIndex = seriesIndex.parent();
+  QString seriesInstanceUID = model->data(seriesIndex ,ctkDICOMModel::UIDRole).toString();
 
   QString thumbnailPath = this->DatabaseDirectory +
                           "/thumbs/" + model->data(studyIndex ,ctkDICOMModel::UIDRole).toString() + "/" +
-                          model->data(seriesIndex ,ctkDICOMModel::UIDRole).toString() + "/" +
+                          seriesInstanceUID + "/" +
                           model->data(imageIndex, ctkDICOMModel::UIDRole).toString() + ".png";
-  if(!QFileInfo(thumbnailPath).exists())
+  bool thumbnailExists = QFileInfo(thumbnailPath).exists();
+  if(!thumbnailExists && !this->ThumbnailService)
     {
     return;
     }
+  if(!this->DisplayedSeries.contains(seriesInstanceUID))
+    {
+    this->DisplayedSeries << seriesInstanceUID;
+    }
   ctkThumbnailLabel* widget = new ctkThumbnailLabel(this->ScrollAreaContentWidget);
 
   QString widgetLabel = text;
   widget->setText( widgetLabel );
-  QPixmap pix(thumbnailPath);
-  logger.debug("Setting pixmap to " + thumbnailPath);
   if(this->ThumbnailSize.isValid())
     {
     widget->setFixedSize(this->ThumbnailSize);
     }
-  widget->setPixmap(pix);
+  if(thumbnailExists)
+    {
+    QPixmap pix(thumbnailPath);
+    logger.debug("Setting pixmap to " + thumbnailPath);
+    widget->setPixmap(pix);
+    }
+  else
+    {
+    // placeholder, the pixmap is set when the service has rendered it
+    widget->setProperty("thumbnailPath", thumbnailPath);
+    }
 
   QVariant var;
   var.setValue(QPersistentModelIndex(sourceIndex));
@@ -231,6 +250,55 @@ void ctkDICOMThumbnailListWidget::setDatabaseDirectory(const QString &directory)
   d->DatabaseDirectory = directory;
 }
 
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailListWidget::setThumbnailService(ctkDICOMThumbnailService* service)
+{
+  Q_D(ctkDICOMThumbnailListWidget);
+  if (d->ThumbnailService == service)
+    {
+    return;
+    }
+  if (d->ThumbnailService)
+    {
+    disconnect(d->ThumbnailService, SIGNAL(thumbnailGenerated(QString,QString)),
+               this, SLOT(onThumbnailGenerated(QString,QString)));
+    }
+  d->ThumbnailService = service;
+  if (service)
+    {
+    connect(service, SIGNAL(thumbnailGenerated(QString,QString)),
+            this, SLOT(onThumbnailGenerated(QString,QString)));
+    }
+}
+
+//----------------------------------------------------------------------------
+ctkDICOMThumbnailService* ctkDICOMThumbnailListWidget::thumbnailService() const
+{
+  Q_D(const ctkDICOMThumbnailListWidget);
+  return d->ThumbnailService;
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailListWidget::onThumbnailGenerated(const QString& seriesInstanceUID,
+                                                       const QString& thumbnailPath)
+{
+  Q_D(ctkDICOMThumbnailListWidget);
+  if (!d->DisplayedSeries.contains(seriesInstanceUID))
+    {
+    return;
+    }
+  int count = d->ScrollAreaContentWidget->layout()->count();
+  for(int i=0; i<count; i++)
+    {
+    ctkThumbnailLabel* thumbnailWidget = qobject_cast<ctkThumbnailLabel*>(d->ScrollAreaContentWidget->layout()->itemAt(i)->widget());
+    if(thumbnailWidget && thumbnailWidget->property("thumbnailPath").toString() == thumbnailPath)
+      {
+      thumbnailWidget->setPixmap(QPixmap(thumbnailPath));
+      thumbnailWidget->setProperty("thumbnailPath", QVariant());
+      }
+    }
+}
+
 //----------------------------------------------------------------------------
 void ctkDICOMThumbnailListWidget::selectThumbnailFromIndex(const QModelIndex &index){
   Q_D(ctkDICOMThumbnailListWidget);
@@ -272,6 +340,7 @@ void ctkDICOMThumbnailListWidget::addThumbnails(const QModelIndex &index)
   Q_D(ctkDICOMThumbnailListWidget);
 
   this->clearThumbnails();
+  d->DisplayedSeries.clear();
 
   ctkDICOMModel* model = const_cast<ctkDICOMModel*>(qobject_cast<const ctkDICOMModel*>(index.model()));
 
@@ -295,5 +364,10 @@ void ctkDICOMThumbnailListWidget::addThumbnails(const QModelIndex &index)
       }
     }
 
+  if (d->ThumbnailService)
+    {
+    d->ThumbnailService->setPrioritySeries(d->DisplayedSeries);
+    }
+
   this->setCurrentThumbnail(0);
 }
@@ -26,9 +26,11 @@
 
 class QModelIndex;
 class ctkDICOMThumbnailListWidgetPrivate;
+class ctkDICOMThumbnailService;
 class ctkThumbnailWidget;
 
 /// \ingroup DICOM_Widgets
+/// \sa ctkDICOMThumbnailView
 class CTK_DICOM_WIDGETS_EXPORT ctkDICOMThumbnailListWidget : public ctkThumbnailListWidget
 {
   Q_OBJECT
@@ -41,12 +43,20 @@ public:
 
   void selectThumbnailFromIndex(const QModelIndex& index);
 
+  /// If set, the thumbnails not rendered yet are displayed as placeholders
+  /// and the displayed series are rendered first by the service.
+  void setThumbnailService(ctkDICOMThumbnailService* service);
+  ctkDICOMThumbnailService* thumbnailService() const;
+
 private:
   Q_DECLARE_PRIVATE(ctkDICOMThumbnailListWidget);
   Q_DISABLE_COPY(ctkDICOMThumbnailListWidget);
 
 public Q_SLOTS:
   void addThumbnails(const QModelIndex& index);
+
+protected Q_SLOTS:
+  void onThumbnailGenerated(const QString& seriesInstanceUID, const QString& thumbnailPath);
 };
 
 #endif
@@ -0,0 +1,308 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt include
+#include <QItemSelectionModel>
+#include <QMetaType>
+#include <QPersistentModelIndex>
+#include <QPointer>
+#include <QStandardItemModel>
+
+// ctkDICOMCore includes
+#include "ctkDICOMModel.h"
+#include "ctkDICOMThumbnailService.h"
+
+// ctkDICOMWidgets includes
+#include "ctkDICOMThumbnailView.h"
+
+Q_DECLARE_METATYPE(QPersistentModelIndex);
+
+//----------------------------------------------------------------------------
+class ctkDICOMThumbnailViewPrivate
+{
+  Q_DECLARE_PUBLIC(ctkDICOMThumbnailView);
+protected:
+  ctkDICOMThumbnailView* const q_ptr;
+
+public:
+  ctkDICOMThumbnailViewPrivate(ctkDICOMThumbnailView& object);
+
+  void init();
+
+  void addPatientThumbnails(ctkDICOMModel* model, const QModelIndex& patientIndex);
+  void addStudyThumbnails(ctkDICOMModel* model, const QModelIndex& studyIndex);
+  void addSeriesThumbnails(ctkDICOMModel* model, const QModelIndex& seriesIndex);
+  void addThumbnail(ctkDICOMModel* model, const QModelIndex& imageIndex,
+                    const QModelIndex& sourceIndex, const QString& text);
+
+  QStandardItemModel Model;
+  QString DatabaseDirectory;
+  QPersistentModelIndex CurrentSelectedModel;
+  QPointer<ctkDICOMThumbnailService> ThumbnailService;
+  /// Series having thumbnails displayed
+  QStringList DisplayedSeries;
+};
+
+//----------------------------------------------------------------------------
+// ctkDICOMThumbnailViewPrivate methods
+
+//----------------------------------------------------------------------------
+ctkDICOMThumbnailViewPrivate::ctkDICOMThumbnailViewPrivate(ctkDICOMThumbnailView& object)
+  : q_ptr(&object)
+{
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailViewPrivate::init()
+{
+  Q_Q(ctkDICOMThumbnailView);
+  q->setModel(&this->Model);
+  QObject::connect(q->selectionModel(), SIGNAL(currentChanged(QModelIndex,QModelIndex)),
+                   q, SLOT(onCurrentChanged(QModelIndex)));
+  QObject::connect(q, SIGNAL(doubleClicked(QModelIndex)),
+                   q, SLOT(onDoubleClicked(QModelIndex)));
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailViewPrivate::addPatientThumbnails(ctkDICOMModel* model,
+                                                        const QModelIndex& patientIndex)
+{
+  model->fetchMore(patientIndex);
+  const int studyCount = model->rowCount(patientIndex);
+  for (int i = 0; i < studyCount; ++i)
+    {
+    QModelIndex studyIndex = patientIndex.child(i, 0);
+    QModelIndex seriesIndex = studyIndex.child(0, 0);
+    model->fetchMore(seriesIndex);
+    const int imageCount = model->rowCount(seriesIndex);
+    QModelIndex imageIndex = seriesIndex.child(imageCount/2, 0);
+    this->addThumbnail(model, imageIndex, studyIndex,
+                       model->data(studyIndex, Qt::DisplayRole).toString());
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailViewPrivate::addStudyThumbnails(ctkDICOMModel* model,
+                                                      const QModelIndex& studyIndex)
+{
+  model->fetchMore(studyIndex);
+  const int seriesCount = model->rowCount(studyIndex);
+  for (int i = 0; i < seriesCount; ++i)
+    {
+    QModelIndex seriesIndex = studyIndex.child(i, 0);
+    model->fetchMore(seriesIndex);
+    const int imageCount = model->rowCount(seriesIndex);
+    QModelIndex imageIndex = seriesIndex.child(imageCount/2, 0);
+    this->addThumbnail(model, imageIndex, seriesIndex,
+                       model->data(seriesIndex, Qt::DisplayRole).toString());
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailViewPrivate::addSeriesThumbnails(ctkDICOMModel* model,
+                                                       const QModelIndex& seriesIndex)
+{
+  model->fetchMore(seriesIndex);
+  const int imageCount = model->rowCount(seriesIndex);
+  for (int i = 0; i < imageCount; ++i)
+    {
+    QModelIndex imageIndex = seriesIndex.child(i, 0);
+    this->addThumbnail(model, imageIndex, imageIndex, QString("Image %1").arg(i));
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailViewPrivate::addThumbnail(ctkDICOMModel* model,
+                                                const QModelIndex& imageIndex,
+                                                const QModelIndex& sourceIndex,
+                                                const QString& text)
+{
+  QModelIndex seriesIndex = imageIndex.parent();
+  QModelIndex studyIndex = seriesIndex.parent();
+  QString seriesInstanceUID = model->data(seriesIndex, ctkDICOMModel::UIDRole).toString();
+  QString thumbnailPath = this->DatabaseDirectory +
+                          "/thumbs/" + model->data(studyIndex, ctkDICOMModel::UIDRole).toString() + "/" +
+                          seriesInstanceUID + "/" +
+                          model->data(imageIndex, ctkDICOMModel::UIDRole).toString() + ".png";
+  if (!this->DisplayedSeries.contains(seriesInstanceUID))
+    {
+    this->DisplayedSeries << seriesInstanceUID;
+    }
+
+  // The file is not checked here, a missing thumbnail is painted as a
+  // placeholder until the thumbnail service has rendered it.
+  QStandardItem* item = new QStandardItem(text);
+  item->setEditable(false);
+  item->setData(thumbnailPath, ctkThumbnailView::ThumbnailPathRole);
+  QVariant var;
+  var.setValue(QPersistentModelIndex(sourceIndex));
+  item->setData(var, ctkDICOMThumbnailView::SourceIndexRole);
+  this->Model.appendRow(item);
+}
+
+//----------------------------------------------------------------------------
+// ctkDICOMThumbnailView methods
+
+//----------------------------------------------------------------------------
+ctkDICOMThumbnailView::ctkDICOMThumbnailView(QWidget* parentWidget)
+  : Superclass(parentWidget)
+  , d_ptr(new ctkDICOMThumbnailViewPrivate(*this))
+{
+  Q_D(ctkDICOMThumbnailView);
+  d->init();
+}
+
+//----------------------------------------------------------------------------
+ctkDICOMThumbnailView::~ctkDICOMThumbnailView()
+{
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailView::setDatabaseDirectory(const QString& directory)
+{
+  Q_D(ctkDICOMThumbnailView);
+  d->DatabaseDirectory = directory;
+}
+
+//----------------------------------------------------------------------------
+QString ctkDICOMThumbnailView::databaseDirectory()const
+{
+  Q_D(const ctkDICOMThumbnailView);
+  return d->DatabaseDirectory;
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailView::setThumbnailService(ctkDICOMThumbnailService* service)
+{
+  Q_D(ctkDICOMThumbnailView);
+  if (d->ThumbnailService == service)
+    {
+    return;
+    }
+  if (d->ThumbnailService)
+    {
+    disconnect(d->ThumbnailService, SIGNAL(thumbnailGenerated(QString,QString)),
+               this, SLOT(onThumbnailGenerated(QString,QString)));
+    }
+  d->ThumbnailService = service;
+  if (service)
+    {
+    connect(service, SIGNAL(thumbnailGenerated(QString,QString)),
+            this, SLOT(onThumbnailGenerated(QString,QString)));
+    }
+}
+
+//----------------------------------------------------------------------------
+ctkDICOMThumbnailService* ctkDICOMThumbnailView::thumbnailService() const
+{
+  Q_D(const ctkDICOMThumbnailView);
+  return d->ThumbnailService;
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailView::onThumbnailGenerated(const QString& seriesInstanceUID,
+                                                 const QString& thumbnailPath)
+{
+  Q_D(ctkDICOMThumbnailView);
+  if (!d->DisplayedSeries.contains(seriesInstanceUID))
+    {
+    return;
+    }
+  this->reloadThumbnail(thumbnailPath);
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailView::selectThumbnailFromIndex(const QModelIndex& index)
+{
+  Q_D(ctkDICOMThumbnailView);
+  if (!d->CurrentSelectedModel.isValid() || index.parent() != d->CurrentSelectedModel)
+    {
+    return;
+    }
+  const int count = d->Model.rowCount();
+  for (int i = 0; i < count; ++i)
+    {
+    QModelIndex thumbnailIndex = d->Model.index(i, 0);
+    if (thumbnailIndex.data(SourceIndexRole).value<QPersistentModelIndex>() == index)
+      {
+      this->setCurrentIndex(thumbnailIndex);
+      this->scrollTo(thumbnailIndex);
+      return;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailView::addThumbnails(const QModelIndex& index)
+{
+  Q_D(ctkDICOMThumbnailView);
+
+  d->Model.clear();
+  d->DisplayedSeries.clear();
+  d->CurrentSelectedModel = QModelIndex();
+
+  ctkDICOMModel* model = const_cast<ctkDICOMModel*>(
+    qobject_cast<const ctkDICOMModel*>(index.model()));
+  if (model)
+    {
+    QModelIndex index0 = index.sibling(index.row(), 0);
+    d->CurrentSelectedModel = index0;
+
+    QVariant type = model->data(index0, ctkDICOMModel::TypeRole);
+    if (type == static_cast<int>(ctkDICOMModel::PatientType))
+      {
+      d->addPatientThumbnails(model, index0);
+      }
+    else if (type == static_cast<int>(ctkDICOMModel::StudyType))
+      {
+      d->addStudyThumbnails(model, index0);
+      }
+    else if (type == static_cast<int>(ctkDICOMModel::SeriesType))
+      {
+      d->addSeriesThumbnails(model, index0);
+      }
+    }
+
+  if (d->ThumbnailService)
+    {
+    d->ThumbnailService->setPrioritySeries(d->DisplayedSeries);
+    }
+
+  if (d->Model.rowCount() > 0)
+    {
+    this->setCurrentIndex(d->Model.index(0, 0));
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailView::onCurrentChanged(const QModelIndex& current)
+{
+  if (!current.isValid())
+    {
+    return;
+    }
+  emit this->thumbnailSelected(current.data(SourceIndexRole).value<QPersistentModelIndex>());
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailView::onDoubleClicked(const QModelIndex& index)
+{
+  emit this->thumbnailDoubleClicked(index.data(SourceIndexRole).value<QPersistentModelIndex>());
+}
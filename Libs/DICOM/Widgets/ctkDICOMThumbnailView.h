@@ -0,0 +1,88 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkDICOMThumbnailView_h
+#define __ctkDICOMThumbnailView_h
+
+#include "ctkDICOMWidgetsExport.h"
+#include "ctkThumbnailView.h"
+
+class ctkDICOMThumbnailViewPrivate;
+class ctkDICOMThumbnailService;
+
+/// \ingroup DICOM_Widgets
+///
+/// Displays the thumbnails of the studies of a patient, the series of a
+/// study or the images of a series of a ctkDICOMModel.
+/// Contrary to ctkDICOMThumbnailListWidget, the thumbnails are read
+/// asynchronously and only when they are visible, which makes it suitable
+/// for series of thousands of images.
+class CTK_DICOM_WIDGETS_EXPORT ctkDICOMThumbnailView : public ctkThumbnailView
+{
+  Q_OBJECT
+public:
+  typedef ctkThumbnailView Superclass;
+
+  enum
+  {
+    /// A role for getting the ctkDICOMModel index of the patient, study,
+    /// series or image a thumbnail stands for, as a QPersistentModelIndex.
+    SourceIndexRole = ThumbnailPathRole + 1
+  };
+
+  explicit ctkDICOMThumbnailView(QWidget* parent=0);
+  virtual ~ctkDICOMThumbnailView();
+
+  void setDatabaseDirectory(const QString& directory);
+  QString databaseDirectory()const;
+
+  /// Select the thumbnail of the ctkDICOMModel index, if displayed.
+  void selectThumbnailFromIndex(const QModelIndex& index);
+
+  /// If set, the thumbnails are reloaded when the service has rendered
+  /// them and the displayed series are rendered first by the service.
+  void setThumbnailService(ctkDICOMThumbnailService* service);
+  ctkDICOMThumbnailService* thumbnailService() const;
+
+public Q_SLOTS:
+  /// Display the thumbnails of the children of a patient, study or series
+  /// index of a ctkDICOMModel.
+  void addThumbnails(const QModelIndex& index);
+
+Q_SIGNALS:
+  /// Emitted with the ctkDICOMModel index of the selected thumbnail.
+  void thumbnailSelected(const QModelIndex& sourceIndex);
+  /// Emitted with the ctkDICOMModel index of the double-clicked thumbnail.
+  void thumbnailDoubleClicked(const QModelIndex& sourceIndex);
+
+protected Q_SLOTS:
+  void onThumbnailGenerated(const QString& seriesInstanceUID, const QString& thumbnailPath);
+  void onCurrentChanged(const QModelIndex& current);
+  void onDoubleClicked(const QModelIndex& index);
+
+protected:
+  QScopedPointer<ctkDICOMThumbnailViewPrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(ctkDICOMThumbnailView);
+  Q_DISABLE_COPY(ctkDICOMThumbnailView);
+};
+
+#endif
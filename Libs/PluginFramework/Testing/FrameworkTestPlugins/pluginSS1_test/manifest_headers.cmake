@@ -0,0 +1,9 @@
+set(Plugin-ActivationPolicy "eager")
+set(Plugin-Name "pluginSS1")
+set(Plugin-Version "1.0.0")
+set(Plugin-Description "Test plugin for the start scheduler, started after a delay, required by pluginSS2_test")
+set(Plugin-Vendor "CommonTK")
+set(Plugin-ContactAddress "http://www.commontk.org")
+set(Plugin-Category "test")
+set(Custom-Headers "Test-StartDelay")
+set(Test-StartDelay "200")
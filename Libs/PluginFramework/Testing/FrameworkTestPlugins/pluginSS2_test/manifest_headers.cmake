@@ -0,0 +1,10 @@
+set(Plugin-ActivationPolicy "eager")
+set(Plugin-Name "pluginSS2")
+set(Plugin-Version "1.0.0")
+set(Plugin-Description "Test plugin for the start scheduler, requires pluginSS1_test, activated in the thread starting the framework")
+set(Plugin-Vendor "CommonTK")
+set(Plugin-ContactAddress "http://www.commontk.org")
+set(Plugin-Category "test")
+set(Require-Plugin pluginSS1.test)
+set(Custom-Headers "Plugin-ActivationThread")
+set(Plugin-ActivationThread "main")
@@ -0,0 +1,82 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkTestPluginSS3Activator_p.h"
+
+#include <ctkException.h>
+#include <ctkPlugin.h>
+#include <ctkPluginConstants.h>
+#include <ctkPluginContext.h>
+
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtPlugin>
+
+//----------------------------------------------------------------------------
+void ctkTestPluginSS3Activator::start(ctkPluginContext* context)
+{
+  QHash<QString, QString> headers = context->getPlugin()->getHeaders();
+  if (headers.contains("Test-StartFailure"))
+  {
+    throw ctkRuntimeException(headers.value("Test-StartFailure"));
+  }
+
+  const int delay = headers.value("Test-StartDelay").toInt();
+  if (delay > 0)
+  {
+    // Leave time to the plugins requiring this one to be wrongly started
+    QMutex mutex;
+    QWaitCondition condition;
+    QMutexLocker l(&mutex);
+    condition.wait(&mutex, delay);
+  }
+
+  bool requirementsActive = true;
+  QStringList requirements = headers.value(ctkPluginConstants::REQUIRE_PLUGIN).split(',', QString::SkipEmptyParts);
+  foreach(QString requirement, requirements)
+  {
+    const QString symbolicName = requirement.section(';', 0, 0).trimmed();
+    foreach(QSharedPointer<ctkPlugin> plugin, context->getPlugins())
+    {
+      if (plugin->getSymbolicName() == symbolicName && plugin->getState() != ctkPlugin::ACTIVE)
+      {
+        requirementsActive = false;
+      }
+    }
+  }
+
+  ctkDictionary props;
+  props.insert("requirementsActive", requirementsActive);
+  props.insert("activationThread", static_cast<qulonglong>(reinterpret_cast<quintptr>(QThread::currentThread())));
+  context->registerService(this->metaObject()->className(), this, props);
+}
+
+//----------------------------------------------------------------------------
+void ctkTestPluginSS3Activator::stop(ctkPluginContext* context)
+{
+  Q_UNUSED(context)
+}
+
+#if QT_VERSION < QT_VERSION_CHECK(5,0,0)
+Q_EXPORT_PLUGIN2(pluginSS3_test, ctkTestPluginSS3Activator)
+#endif
@@ -0,0 +1,52 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKTESTPLUGINSS3ACTIVATOR_P_H
+#define CTKTESTPLUGINSS3ACTIVATOR_P_H
+
+#include <ctkPluginActivator.h>
+
+/**
+ * Registers itself under its class name, with service properties telling
+ * whether the plugins it requires were active when it was started and the
+ * thread it was started in.
+ *
+ * The Test-StartDelay manifest header delays the start by the given number
+ * of milliseconds and the Test-StartFailure header makes the start fail
+ * with the given message.
+ */
+class ctkTestPluginSS3Activator :
+    public QObject, public ctkPluginActivator
+{
+  Q_OBJECT
+  Q_INTERFACES(ctkPluginActivator)
+#ifdef HAVE_QT5
+  Q_PLUGIN_METADATA(IID "pluginSS3_test")
+#endif
+
+public:
+
+  void start(ctkPluginContext* context);
+  void stop(ctkPluginContext* context);
+
+}; // ctkTestPluginSS3Activator
+
+#endif // CTKTESTPLUGINSS3ACTIVATOR_P_H
@@ -0,0 +1,9 @@
+set(Plugin-ActivationPolicy "eager")
+set(Plugin-Name "pluginSS3")
+set(Plugin-Version "1.0.0")
+set(Plugin-Description "Test plugin for the start scheduler, activator always failing, required by pluginSS4_test")
+set(Plugin-Vendor "CommonTK")
+set(Plugin-ContactAddress "http://www.commontk.org")
+set(Plugin-Category "test")
+set(Custom-Headers "Test-StartFailure")
+set(Test-StartFailure "pluginSS3_test always fails to start")
@@ -0,0 +1,8 @@
+set(Plugin-ActivationPolicy "eager")
+set(Plugin-Name "pluginSS4")
+set(Plugin-Version "1.0.0")
+set(Plugin-Description "Test plugin for the start scheduler, requires the failing pluginSS3_test")
+set(Plugin-Vendor "CommonTK")
+set(Plugin-ContactAddress "http://www.commontk.org")
+set(Plugin-Category "test")
+set(Require-Plugin pluginSS3.test)
@@ -0,0 +1,8 @@
+set(Plugin-ActivationPolicy "eager")
+set(Plugin-Name "pluginSS5")
+set(Plugin-Version "1.0.0")
+set(Plugin-Description "Test plugin for the start scheduler, requires pluginSS6_test, which requires it")
+set(Plugin-Vendor "CommonTK")
+set(Plugin-ContactAddress "http://www.commontk.org")
+set(Plugin-Category "test")
+set(Require-Plugin pluginSS6.test)
@@ -30,6 +30,8 @@
 
 #include <QTest>
 #include <QDebug>
+#include <QRunnable>
+#include <QThreadPool>
 
 
 //----------------------------------------------------------------------------
@@ -43,6 +45,67 @@ void TestEventHandler::handleEvent(const ctkEvent& )
   counter++;
 }
 
+//----------------------------------------------------------------------------
+OrderCheckingEventHandler::OrderCheckingEventHandler()
+  : received(0), outOfOrder(0)
+{}
+
+//----------------------------------------------------------------------------
+void OrderCheckingEventHandler::handleEvent(const ctkEvent& event)
+{
+  int thread = event.getProperty("thread").toInt();
+  int sequence = event.getProperty("sequence").toInt();
+  QMutexLocker l(&mutex);
+  if (lastSequence.value(thread, -1) != sequence - 1)
+  {
+    ++outOfOrder;
+  }
+  lastSequence.insert(thread, sequence);
+  ++received;
+}
+
+//----------------------------------------------------------------------------
+int OrderCheckingEventHandler::getReceived()
+{
+  QMutexLocker l(&mutex);
+  return received;
+}
+
+//----------------------------------------------------------------------------
+int OrderCheckingEventHandler::getOutOfOrder()
+{
+  QMutexLocker l(&mutex);
+  return outOfOrder;
+}
+
+namespace {
+
+class PostEventsRunnable : public QRunnable
+{
+public:
+  PostEventsRunnable(ctkEventAdmin* eventAdmin, int thread, int nEvents)
+    : eventAdmin(eventAdmin), thread(thread), nEvents(nEvents)
+  {}
+
+  void run()
+  {
+    for (int i = 0; i < nEvents; ++i)
+    {
+      ctkDictionary props;
+      props.insert("thread", thread);
+      props.insert("sequence", i);
+      eventAdmin->postEvent(ctkEvent("org/contention/progress", props));
+    }
+  }
+
+private:
+  ctkEventAdmin* eventAdmin;
+  int thread;
+  int nEvents;
+};
+
+}
+
 //----------------------------------------------------------------------------
 ctkEventAdminPerfTestSuite::ctkEventAdminPerfTestSuite(ctkPluginContext *context, int pluginId)
   : pc(context)
@@ -51,6 +114,8 @@ ctkEventAdminPerfTestSuite::ctkEventAdminPerfTestSuite(ctkPluginContext *context
   , nHandlers(40)
   , nEvent1Handled(0)
   , nEvent2Handled(0)
+  , nManyHandlers(1000)
+  , nManyEventsHandled(0)
   , eventAdmin(0)
 {
 }
@@ -83,6 +148,20 @@ void ctkEventAdminPerfTestSuite::addHandlers()
   }
 }
 
+//----------------------------------------------------------------------------
+void ctkEventAdminPerfTestSuite::addManyHandlers()
+{
+  qDebug() << "Adding" << nManyHandlers << "event handlers with distinct topics";
+  for (int i = 0; i < nManyHandlers; ++i)
+  {
+    TestEventHandler* h = new TestEventHandler(nManyEventsHandled);
+    handlers.push_back(h);
+    ctkDictionary props;
+    props.insert(ctkEventConstants::EVENT_TOPIC, QString("org/many/%1/progress").arg(i));
+    handlerRegistrations.push_back(pc->registerService<ctkEventHandler>(h, props));
+  }
+}
+
 //----------------------------------------------------------------------------
 void ctkEventAdminPerfTestSuite::removeHandlers()
 {
@@ -172,6 +251,69 @@ void ctkEventAdminPerfTestSuite::testPostEvents()
   QTest::qWait(10000);
 }
 
+//----------------------------------------------------------------------------
+void ctkEventAdminPerfTestSuite::testSendEventsManyHandlers()
+{
+  addManyHandlers();
+
+  // Each event matches exactly one of the handlers
+  int nEvents = 20 * nSendEvents;
+  QTime t;
+  t.start();
+  for (int i = 0; i < nEvents; ++i)
+  {
+    ctkEvent event(QString("org/many/%1/progress").arg(i % nManyHandlers));
+    eventAdmin->sendEvent(event);
+  }
+  int ms = t.elapsed();
+  QCOMPARE(nManyEventsHandled, nEvents);
+  qDebug() << "Sending" << nEvents << "synchronous events to" << nManyHandlers
+           << "handlers took" << ms << "ms ("
+           << (ms > 0 ? nEvents * 1000 / ms : nEvents * 1000) << "events/s)";
+}
+
+//----------------------------------------------------------------------------
+void ctkEventAdminPerfTestSuite::testPostEventsFromManyThreads()
+{
+  OrderCheckingEventHandler* handler = new OrderCheckingEventHandler();
+  handlers.push_back(handler);
+  ctkDictionary props;
+  props.insert(ctkEventConstants::EVENT_TOPIC, "org/contention/*");
+  handlerRegistrations.push_back(pc->registerService<ctkEventHandler>(handler, props));
+
+  const int nThreads = 8;
+  const int nEventsPerThread = 5 * nSendEvents;
+  const int nEvents = nThreads * nEventsPerThread;
+
+  QTime t;
+  t.start();
+  QThreadPool posters;
+  posters.setMaxThreadCount(nThreads);
+  for (int i = 0; i < nThreads; ++i)
+  {
+    posters.start(new PostEventsRunnable(eventAdmin, i, nEventsPerThread));
+  }
+  posters.waitForDone();
+  int postMs = t.elapsed();
+
+  // wait for the asynchronous delivery of all the events
+  while (handler->getReceived() < nEvents && t.elapsed() < 60000)
+  {
+    QTest::qWait(10);
+  }
+  int ms = t.elapsed();
+
+  QString dispatcher = pc->getProperty("org.commontk.eventadmin.AsyncDispatcher").toString();
+  qDebug() << "Posting" << nEvents << "asynchronous events from" << nThreads
+           << "threads with the" << (dispatcher.isEmpty() ? QString("pooled") : dispatcher)
+           << "dispatcher took" << postMs << "ms, delivering them took" << ms << "ms ("
+           << (ms > 0 ? nEvents * 1000 / ms : nEvents * 1000) << "events/s)";
+
+  QCOMPARE(handler->getReceived(), nEvents);
+  // events posted from one thread are delivered in order
+  QCOMPARE(handler->getOutOfOrder(), 0);
+}
+
 //----------------------------------------------------------------------------
 void ctkEventAdminPerfTestSuite::cleanupTestCase()
 {
@@ -29,6 +29,8 @@
 #include <ctkServiceRegistration.h>
 
 #include <QDebug>
+#include <QHash>
+#include <QMutex>
 
 struct ctkEventAdmin;
 
@@ -48,6 +50,9 @@ private:
   int nEvent1Handled;
   int nEvent2Handled;
 
+  int nManyHandlers;
+  int nManyEventsHandled;
+
   ctkEventAdmin* eventAdmin;
 
   QList<ctkEventHandler*> handlers;
@@ -60,6 +65,7 @@ public:
 private:
 
   void addHandlers();
+  void addManyHandlers();
   void removeHandlers();
 
   void sendEvents();
@@ -70,6 +76,8 @@ private Q_SLOTS:
   void initTestCase();
   void testSendEvents();
   void testPostEvents();
+  void testSendEventsManyHandlers();
+  void testPostEventsFromManyThreads();
   void cleanupTestCase();
 };
 
@@ -84,4 +92,20 @@ public:
   void handleEvent(const ctkEvent& );
 };
 
+class OrderCheckingEventHandler : public QObject, public ctkEventHandler
+{
+  Q_OBJECT
+  Q_INTERFACES(ctkEventHandler)
+private:
+  QMutex mutex;
+  QHash<int, int> lastSequence;
+  int received;
+  int outOfOrder;
+public:
+  OrderCheckingEventHandler();
+  void handleEvent(const ctkEvent& event);
+  int getReceived();
+  int getOutOfOrder();
+};
+
 #endif // CTKEAPERFTESTSUITE_P_H
@@ -0,0 +1,195 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#include "ctkEADeliveryModeTestSuite_p.h"
+
+#include <ctkPluginContext.h>
+
+#include <service/event/ctkEventAdmin.h>
+#include <service/event/ctkEventConstants.h>
+
+#include <QCoreApplication>
+#include <QTest>
+#include <QTime>
+
+//----------------------------------------------------------------------------
+void ctkEADeliveryModeTestHelper::handleEvent(const ctkEvent& event)
+{
+  QMutexLocker l(&mutex);
+  events.push_back(event);
+}
+
+//----------------------------------------------------------------------------
+void ctkEADeliveryModeTestHelper::handleEvents(const QList<ctkEvent>& batch)
+{
+  QMutexLocker l(&mutex);
+  events.append(batch);
+  batchSizes.push_back(batch.size());
+}
+
+//----------------------------------------------------------------------------
+QList<ctkEvent> ctkEADeliveryModeTestHelper::receivedEvents() const
+{
+  QMutexLocker l(&mutex);
+  return events;
+}
+
+//----------------------------------------------------------------------------
+QList<int> ctkEADeliveryModeTestHelper::receivedBatchSizes() const
+{
+  QMutexLocker l(&mutex);
+  return batchSizes;
+}
+
+//----------------------------------------------------------------------------
+bool ctkEADeliveryModeTestHelper::waitForEvents(int count, int timeout) const
+{
+  QTime time;
+  time.start();
+  while (receivedEvents().size() < count)
+  {
+    if (time.elapsed() > timeout) return false;
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+ctkEADeliveryModeTestSuite::ctkEADeliveryModeTestSuite(
+  ctkPluginContext* pc, long eventPluginId)
+  : context(pc), eventPluginId(eventPluginId), eventAdmin(0)
+{
+
+}
+
+//----------------------------------------------------------------------------
+void ctkEADeliveryModeTestSuite::init()
+{
+  context->getPlugin(eventPluginId)->start();
+  reference = context->getServiceReference<ctkEventAdmin>();
+  eventAdmin = context->getService<ctkEventAdmin>(reference);
+}
+
+//----------------------------------------------------------------------------
+void ctkEADeliveryModeTestSuite::cleanup()
+{
+  context->ungetService(reference);
+  context->getPlugin(eventPluginId)->stop();
+}
+
+//----------------------------------------------------------------------------
+void ctkEADeliveryModeTestSuite::testBatchDelivery()
+{
+  ctkDictionary properties;
+  properties.insert(ctkEventConstants::EVENT_TOPIC, "org/commontk/eatest/batch");
+  properties.insert(ctkEventConstants::EVENT_DELIVERY, ctkEventConstants::DELIVERY_BATCH);
+  properties.insert(ctkEventConstants::DELIVERY_BATCH_SIZE, 10);
+  ctkEADeliveryModeTestHelper handler;
+  qlonglong id = eventAdmin->subscribeSlot(&handler, SLOT(handleEvents(QList<ctkEvent>)), properties);
+
+  for (int i = 0; i < 25; ++i)
+  {
+    ctkDictionary eventProps;
+    eventProps.insert("index", i);
+    eventAdmin->sendEvent(ctkEvent("org/commontk/eatest/batch", eventProps));
+  }
+
+  QVERIFY2(handler.receivedEvents().isEmpty(), "Batched events were delivered synchronously");
+  QVERIFY2(handler.waitForEvents(25), "Did not receive all batched events");
+
+  QList<ctkEvent> events = handler.receivedEvents();
+  QCOMPARE(events.size(), 25);
+  for (int i = 0; i < events.size(); ++i)
+  {
+    QCOMPARE(events[i].getProperty("index").toInt(), i);
+  }
+  foreach(int size, handler.receivedBatchSizes())
+  {
+    QVERIFY(size > 0 && size <= 10);
+  }
+  QVERIFY(handler.receivedBatchSizes().size() >= 3);
+
+  eventAdmin->unsubscribeSlot(id);
+}
+
+//----------------------------------------------------------------------------
+void ctkEADeliveryModeTestSuite::testBatchDeliveryTimeout()
+{
+  ctkDictionary properties;
+  properties.insert(ctkEventConstants::EVENT_TOPIC, "org/commontk/eatest/batch");
+  properties.insert(ctkEventConstants::EVENT_DELIVERY, ctkEventConstants::DELIVERY_BATCH);
+  properties.insert(ctkEventConstants::DELIVERY_BATCH_SIZE, 1000);
+  properties.insert(ctkEventConstants::DELIVERY_BATCH_TIMEOUT, 100);
+  ctkEADeliveryModeTestHelper handler;
+  qlonglong id = eventAdmin->subscribeSlot(&handler, SLOT(handleEvents(QList<ctkEvent>)), properties);
+
+  for (int i = 0; i < 5; ++i)
+  {
+    eventAdmin->sendEvent(ctkEvent("org/commontk/eatest/batch"));
+  }
+
+  QVERIFY2(handler.waitForEvents(5), "Partial batch not delivered after the batch timeout");
+  QCOMPARE(handler.receivedBatchSizes(), QList<int>() << 5);
+
+  eventAdmin->unsubscribeSlot(id);
+}
+
+//----------------------------------------------------------------------------
+void ctkEADeliveryModeTestSuite::testCoalesceDelivery()
+{
+  ctkDictionary properties;
+  properties.insert(ctkEventConstants::EVENT_TOPIC, "org/commontk/eatest/coalesce/*");
+  properties.insert(ctkEventConstants::EVENT_DELIVERY, ctkEventConstants::DELIVERY_COALESCE);
+  properties.insert(ctkEventConstants::DELIVERY_COALESCE_KEY, "source");
+  ctkEADeliveryModeTestHelper handler;
+  qlonglong id = eventAdmin->subscribeSlot(&handler, SLOT(handleEvent(ctkEvent)), properties);
+
+  for (int value = 0; value < 100; ++value)
+  {
+    for (int source = 0; source < 3; ++source)
+    {
+      ctkDictionary eventProps;
+      eventProps.insert("source", source);
+      eventProps.insert("value", value);
+      eventAdmin->sendEvent(ctkEvent("org/commontk/eatest/coalesce/progress", eventProps));
+    }
+  }
+  ctkDictionary eventProps;
+  eventProps.insert("value", 100);
+  eventAdmin->sendEvent(ctkEvent("org/commontk/eatest/coalesce/cursor", eventProps));
+
+  QVERIFY2(handler.waitForEvents(4), "Did not receive the coalesced events");
+  // Let a wrongly queued extra delivery come in
+  QCoreApplication::processEvents();
+
+  QList<ctkEvent> events = handler.receivedEvents();
+  QCOMPARE(events.size(), 4);
+  for (int source = 0; source < 3; ++source)
+  {
+    QCOMPARE(events[source].getTopic(), QString("org/commontk/eatest/coalesce/progress"));
+    QCOMPARE(events[source].getProperty("source").toInt(), source);
+    QCOMPARE(events[source].getProperty("value").toInt(), 99);
+  }
+  QCOMPARE(events[3].getTopic(), QString("org/commontk/eatest/coalesce/cursor"));
+
+  eventAdmin->unsubscribeSlot(id);
+}
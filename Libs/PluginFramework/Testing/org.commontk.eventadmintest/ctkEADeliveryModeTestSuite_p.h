@@ -0,0 +1,108 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKEADELIVERYMODETESTSUITE_P_H
+#define CTKEADELIVERYMODETESTSUITE_P_H
+
+#include <QObject>
+#include <QMutex>
+
+#include <ctkServiceReference.h>
+#include <ctkTestSuiteInterface.h>
+
+#include <service/event/ctkEvent.h>
+
+class ctkPluginContext;
+struct ctkEventAdmin;
+
+class ctkEADeliveryModeTestHelper : public QObject
+{
+  Q_OBJECT
+
+private:
+
+  mutable QMutex mutex;
+  QList<ctkEvent> events;
+  QList<int> batchSizes;
+
+public Q_SLOTS:
+
+  void handleEvent(const ctkEvent& event);
+
+  void handleEvents(const QList<ctkEvent>& events);
+
+public:
+
+  QList<ctkEvent> receivedEvents() const;
+
+  QList<int> receivedBatchSizes() const;
+
+  /*
+   * Processes the events of the current thread until <code>count</code>
+   * events were received or <code>timeout</code> milliseconds elapsed.
+   */
+  bool waitForEvents(int count, int timeout = 5000) const;
+
+};
+
+
+class ctkEADeliveryModeTestSuite : public QObject,
+    public ctkTestSuiteInterface
+{
+  Q_OBJECT
+  Q_INTERFACES(ctkTestSuiteInterface)
+
+public:
+
+  ctkEADeliveryModeTestSuite(ctkPluginContext* pc, long eventPluginId);
+
+private Q_SLOTS:
+
+  void init();
+  void cleanup();
+
+  /*
+   * Ensures events sent to a slot subscribed with the "batch" delivery
+   * quality are received in order, in batches bounded by the batch size.
+   */
+  void testBatchDelivery();
+
+  /*
+   * Ensures a partial batch is delivered once the batch timeout elapsed.
+   */
+  void testBatchDeliveryTimeout();
+
+  /*
+   * Ensures a slot subscribed with the "coalesce" delivery quality only
+   * receives the latest event for each coalescing key.
+   */
+  void testCoalesceDelivery();
+
+private:
+
+  ctkPluginContext* context;
+  long eventPluginId;
+  ctkEventAdmin* eventAdmin;
+  ctkServiceReference reference;
+};
+
+#endif // CTKEADELIVERYMODETESTSUITE_P_H
@@ -52,6 +52,7 @@ private:
   QObject* scenario2TestSuite;
   QObject* scenario3TestSuite;
   QObject* scenario4TestSuite;
+  QObject* deliveryModeTestSuite;
 };
 
 #endif // CTKEVENTADMINTESTACTIVATOR_H
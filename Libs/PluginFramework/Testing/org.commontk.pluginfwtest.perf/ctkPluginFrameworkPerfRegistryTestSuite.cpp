@@ -24,12 +24,16 @@
 
 #include <ctkPluginContext.h>
 #include <ctkHighPrecisionTimer.h>
+#include <ctkLDAPSearchFilter.h>
 
 #undef REGISTERED
 #include <ctkServiceEvent.h>
 
 #include <QTest>
 #include <QDebug>
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QThreadPool>
 
 //----------------------------------------------------------------------------
 ctkPluginFrameworkPerfRegistryTestSuite::ctkPluginFrameworkPerfRegistryTestSuite(ctkPluginContext* context)
@@ -40,6 +44,7 @@ ctkPluginFrameworkPerfRegistryTestSuite::ctkPluginFrameworkPerfRegistryTestSuite
   , nRegistered(0)
   , nUnregistering(0)
   , nModified(0)
+  , nLookups(10000)
 {
   this->setObjectName("ctkPluginFrameworkPerfRegistryTestSuite");
 }
@@ -74,6 +79,130 @@ void ctkPluginFrameworkPerfRegistryTestSuite::cleanupTestCase()
   listeners.clear();
 }
 
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkPerfRegistryTestSuite::testRegisterServicesWithFilteredListeners()
+{
+  qDebug() << "Register services with an increasing number of listeners"
+           << "filtering on other service classes, and check that only the"
+           << "matching listener gets REGISTERED events";
+
+  const int n = 100;
+  const int listenerCounts[] = { 0, 100, 1000, 5000 };
+
+  ctkServiceListener* matching = new ctkServiceListener(this);
+  pc->connectServiceListener(matching, "serviceChanged",
+                             QString("(&(objectclass=%1)(perf.service.value>=0))")
+                             .arg(qobject_interface_iid<IPerfTestService*>()));
+
+  QList<ctkServiceListener*> others;
+  for (unsigned int c = 0; c < sizeof(listenerCounts) / sizeof(listenerCounts[0]); ++c)
+  {
+    while (others.size() < listenerCounts[c])
+    {
+      ctkServiceListener* l = new ctkServiceListener(this);
+      others.push_back(l);
+      pc->connectServiceListener(l, "serviceChanged",
+                                 QString("(&(objectclass=org.commontk.test.OtherService%1)(perf.service.value>=0))")
+                                 .arg(others.size()));
+    }
+
+    nRegistered = 0;
+    QList<QObject*> filteredServices;
+    QList<ctkServiceRegistration> filteredRegs;
+    for (int i = 0; i < n; i++)
+    {
+      filteredServices.push_back(new PerfTestService());
+    }
+
+    ctkHighPrecisionTimer t;
+    t.start();
+    for (int i = 0; i < n; i++)
+    {
+      ctkDictionary props;
+      props.insert("perf.service.value", i+1);
+      filteredRegs.push_back(pc->registerService<IPerfTestService>(filteredServices[i], props));
+    }
+    qint64 us = t.elapsedMicro();
+    log() << "registering" << n << "services with" << others.size()
+          << "non matching listeners took" << us << "us";
+    QCOMPARE(nRegistered, n);
+
+    foreach (ctkServiceRegistration reg, filteredRegs)
+    {
+      reg.unregister();
+    }
+    qDeleteAll(filteredServices);
+  }
+
+  pc->disconnectServiceListener(matching, "serviceChanged");
+  delete matching;
+  foreach (ctkServiceListener* l, others)
+  {
+    pc->disconnectServiceListener(l, "serviceChanged");
+    delete l;
+  }
+
+  nRegistered = 0;
+  nUnregistering = 0;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkPerfRegistryTestSuite::testFilterEvaluation()
+{
+  qDebug() << "Evaluate typical filters against the properties of a service";
+
+  const int n = 100000;
+
+  ctkDictionary props;
+  props.insert("service.pid", "my.service.42");
+  props.insert("service.ranking", 10);
+  props.insert("perf.service.value", 43);
+  props.insert("perf.disabled", false);
+  props.insert("perf.description", "Perf Test Service");
+
+  PerfTestService service;
+  ctkServiceRegistration reg = pc->registerService<IPerfTestService>(&service, props);
+  ctkServiceReference ref = reg.getReference();
+
+  QList<QPair<QString, bool> > filters;
+  filters << qMakePair(QString("(service.pid=my.service.42)"), true)
+          << qMakePair(QString("(&(service.pid=my.service.42)(perf.service.value>=0))"), true)
+          << qMakePair(QString("(|(perf.service.value=42)(perf.service.value=43))"), true)
+          << qMakePair(QString("(&(service.pid=my.service.*)(!(perf.disabled=true)))"), true)
+          << qMakePair(QString("(&(service.ranking=10)(perf.description~=PerfTestService))"), true)
+          << qMakePair(QString("(&(service.pid=other.service)(perf.service.value>=0))"), false)
+          << qMakePair(QString("(&(service.pid=my.service.42)(perf.missing=*))"), false);
+
+  for (int f = 0; f < filters.size(); ++f)
+  {
+    ctkLDAPSearchFilter filter(filters[f].first);
+
+    int matchedRef = 0;
+    ctkHighPrecisionTimer t;
+    t.start();
+    for (int i = 0; i < n; i++)
+    {
+      if (filter.match(ref)) ++matchedRef;
+    }
+    qint64 refUs = t.elapsedMicro();
+
+    int matchedDict = 0;
+    t.start();
+    for (int i = 0; i < n; i++)
+    {
+      if (filter.match(props)) ++matchedDict;
+    }
+    qint64 dictUs = t.elapsedMicro();
+
+    log() << n << "evaluations of" << filters[f].first << "took" << refUs
+          << "us on a service reference," << dictUs << "us on a dictionary";
+    QCOMPARE(matchedRef, filters[f].second ? n : 0);
+    QCOMPARE(matchedDict, filters[f].second ? n : 0);
+  }
+
+  reg.unregister();
+}
+
 //----------------------------------------------------------------------------
 void ctkPluginFrameworkPerfRegistryTestSuite::testAddListeners()
 {
@@ -136,6 +265,94 @@ void ctkPluginFrameworkPerfRegistryTestSuite::registerServices(int n)
   }
 }
 
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkPerfRegistryTestSuite::testServiceLookups()
+{
+  qDebug() << "Look up services by service.pid, and check that each lookup"
+           << "returns exactly one service";
+
+  ctkHighPrecisionTimer t;
+  t.start();
+  int found = lookupServices(nLookups);
+  int ms = t.elapsedMilli();
+  log() << nLookups << "lookups took" << ms << "ms";
+  QCOMPARE(found, nLookups);
+
+  // Filters without class name
+  ctkHighPrecisionTimer t2;
+  t2.start();
+  int foundWithoutClass = 0;
+  for (int i = 0; i < nLookups; i++)
+  {
+    QString filter = QString("(&(service.pid=my.service.%1)(perf.service.value>=0))")
+        .arg(i % nServices);
+    foundWithoutClass += pc->getServiceReferences(QString(), filter).size();
+  }
+  ms = t2.elapsedMilli();
+  log() << nLookups << "lookups without class name took" << ms << "ms";
+  QCOMPARE(foundWithoutClass, nLookups);
+}
+
+//----------------------------------------------------------------------------
+int ctkPluginFrameworkPerfRegistryTestSuite::lookupServices(int n)
+{
+  int found = 0;
+  for (int i = 0; i < n; i++)
+  {
+    QString filter = QString("(service.pid=my.service.%1)").arg(i % nServices);
+    found += pc->getServiceReferences<IPerfTestService>(filter).size();
+  }
+  return found;
+}
+
+namespace {
+
+class ctkServiceLookupRunnable : public QRunnable
+{
+public:
+  ctkServiceLookupRunnable(ctkPluginContext* pc, int nServices, int nLookups, QAtomicInt* found)
+    : pc(pc), nServices(nServices), nLookups(nLookups), found(found)
+  {}
+
+  void run()
+  {
+    for (int i = 0; i < nLookups; i++)
+    {
+      QString filter = QString("(service.pid=my.service.%1)").arg(i % nServices);
+      found->fetchAndAddOrdered(pc->getServiceReferences<IPerfTestService>(filter).size());
+    }
+  }
+
+private:
+  ctkPluginContext* pc;
+  int nServices;
+  int nLookups;
+  QAtomicInt* found;
+};
+
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkPerfRegistryTestSuite::testConcurrentServiceLookups()
+{
+  int nThreads = 4;
+  qDebug() << "Look up services from" << nThreads << "threads";
+
+  QAtomicInt found(0);
+  QThreadPool pool;
+  pool.setMaxThreadCount(nThreads);
+  ctkHighPrecisionTimer t;
+  t.start();
+  for (int i = 0; i < nThreads; i++)
+  {
+    pool.start(new ctkServiceLookupRunnable(pc, nServices, nLookups / nThreads, &found));
+  }
+  pool.waitForDone();
+  int ms = t.elapsedMilli();
+  log() << nLookups << "lookups from" << nThreads << "threads took" << ms << "ms";
+  QCOMPARE(found.fetchAndAddOrdered(0), nThreads * (nLookups / nThreads));
+}
+
 //----------------------------------------------------------------------------
 void ctkPluginFrameworkPerfRegistryTestSuite::testModifyServices()
 {
@@ -49,6 +49,8 @@ private:
   int nUnregistering;
   int nModified;
 
+  int nLookups;
+
   QList<ctkServiceRegistration> regs;
   QList<ctkServiceListener*> listeners;
   QList<QObject*> services;
@@ -68,6 +70,7 @@ private:
 
   void addListeners(int n);
   void registerServices(int n);
+  int lookupServices(int n);
   void modifyServices();
   void unregisterServices();
 
@@ -76,9 +79,15 @@ private Q_SLOTS:
   void initTestCase();
   void cleanupTestCase();
 
+  void testRegisterServicesWithFilteredListeners();
+  void testFilterEvaluation();
+
   void testAddListeners();
   void testRegisterServices();
 
+  void testServiceLookups();
+  void testConcurrentServiceLookups();
+
   void testModifyServices();
   void testUnregisterServices();
 };
@@ -20,12 +20,80 @@
 =============================================================================*/
 
 #include <QCoreApplication>
+#include <QDebug>
+#include <QDirIterator>
 
-
+#include <ctkHighPrecisionTimer.h>
 #include <ctkPluginConstants.h>
+#include <ctkPluginContext.h>
+#include <ctkPluginException.h>
+#include <ctkPluginFramework.h>
+#include <ctkPluginFrameworkFactory.h>
 
 #include "ctkPluginFrameworkTestRunner.h"
 
+//----------------------------------------------------------------------------
+static void measureStartup(ctkProperties fwProps, const QString& pluginDir, const QString& resourceStorage)
+{
+  fwProps.insert(ctkPluginConstants::FRAMEWORK_STORAGE_CLEAN, ctkPluginConstants::FRAMEWORK_STORAGE_CLEAN_ONFIRSTINIT);
+  fwProps.insert(ctkPluginConstants::FRAMEWORK_PLUGIN_RESOURCES, resourceStorage);
+
+  QStringList libFilter;
+  libFilter << "*.dll" << "*.so" << "*.dylib";
+
+  // First launch: the plug-ins are installed into an empty storage
+  ctkHighPrecisionTimer t;
+  t.start();
+  int nPlugins = 0;
+  {
+    ctkPluginFrameworkFactory fwFactory(fwProps);
+    QSharedPointer<ctkPluginFramework> framework = fwFactory.getFramework();
+    framework->start();
+
+    QDirIterator dirIter(pluginDir, libFilter, QDir::Files);
+    while(dirIter.hasNext())
+    {
+      try
+      {
+        framework->getPluginContext()->installPlugin(QUrl::fromLocalFile(dirIter.next()));
+        ++nPlugins;
+      }
+      catch (const ctkPluginException& e)
+      {
+        qWarning() << e.what();
+      }
+    }
+    framework->stop();
+    framework->waitForStop(0);
+  }
+  int installMs = t.elapsedMilli();
+
+  // Second launch: the plug-ins are restored from the storage
+  fwProps.remove(ctkPluginConstants::FRAMEWORK_STORAGE_CLEAN);
+  t.start();
+  int restoreMs = 0;
+  {
+    ctkPluginFrameworkFactory fwFactory(fwProps);
+    QSharedPointer<ctkPluginFramework> framework = fwFactory.getFramework();
+    framework->start();
+    restoreMs = t.elapsedMilli();
+
+    // Read the manifest and list the root entries of every plug-in
+    foreach(QSharedPointer<ctkPlugin> plugin, framework->getPluginContext()->getPlugins())
+    {
+      plugin->getResource("META-INF/MANIFEST.MF");
+      plugin->getResourceList("/");
+    }
+    framework->stop();
+    framework->waitForStop(0);
+  }
+  int resourcesMs = t.elapsedMilli() - restoreMs;
+
+  qDebug() << "Resource storage" << resourceStorage << ":" << nPlugins << "plug-ins installed in"
+           << installMs << "ms, restored in" << restoreMs << "ms, resources read in"
+           << resourcesMs << "ms";
+}
+
 
 int main(int argc, char** argv)
 {
@@ -56,6 +124,11 @@ int main(int argc, char** argv)
   fwProps.insert(ctkPluginConstants::FRAMEWORK_PLUGIN_LOAD_HINTS, QVariant::fromValue<QLibrary::LoadHints>(QLibrary::ExportExternalSymbolsHint));
 #endif
 
+  // Compare the start-up times of the resource storage modes. All the
+  // frameworks share the same storage area, which is cleaned on first init.
+  measureStartup(fwProps, pluginDir, ctkPluginConstants::FRAMEWORK_PLUGIN_RESOURCES_COPY);
+  measureStartup(fwProps, pluginDir, ctkPluginConstants::FRAMEWORK_PLUGIN_RESOURCES_LAZY);
+
   testRunner.init(fwProps);
   return testRunner.run(argc, argv);
 }
@@ -24,6 +24,8 @@
 #include "ctkPluginFrameworkTestSuite_p.h"
 #include "ctkServiceListenerTestSuite_p.h"
 #include "ctkServiceTrackerTestSuite_p.h"
+#include "ctkPluginStartSchedulerTestSuite_p.h"
+#include "ctkPluginFrameworkTracerTestSuite_p.h"
 
 #include <ctkPluginContext.h>
 #include <ctkPluginConstants.h>
@@ -50,6 +52,16 @@ void ctkPluginFrameworkTestActivator::start(ctkPluginContext* context)
   props.clear();
   props.insert(ctkPluginConstants::SERVICE_PID, serviceTrackerTestSuite->metaObject()->className());
   context->registerService<ctkTestSuiteInterface>(serviceTrackerTestSuite, props);
+
+  startSchedulerTestSuite = new ctkPluginStartSchedulerTestSuite(context);
+  props.clear();
+  props.insert(ctkPluginConstants::SERVICE_PID, startSchedulerTestSuite->metaObject()->className());
+  context->registerService<ctkTestSuiteInterface>(startSchedulerTestSuite, props);
+
+  tracerTestSuite = new ctkPluginFrameworkTracerTestSuite(context);
+  props.clear();
+  props.insert(ctkPluginConstants::SERVICE_PID, tracerTestSuite->metaObject()->className());
+  context->registerService<ctkTestSuiteInterface>(tracerTestSuite, props);
 }
 
 //----------------------------------------------------------------------------
@@ -60,6 +72,8 @@ void ctkPluginFrameworkTestActivator::stop(ctkPluginContext* context)
   delete frameworkTestSuite;
   delete serviceListenerTestSuite;
   delete serviceTrackerTestSuite;
+  delete startSchedulerTestSuite;
+  delete tracerTestSuite;
 }
 
 #if QT_VERSION < QT_VERSION_CHECK(5,0,0)
@@ -45,6 +45,8 @@ private:
   QObject* frameworkTestSuite;
   QObject* serviceListenerTestSuite;
   QObject* serviceTrackerTestSuite;
+  QObject* startSchedulerTestSuite;
+  QObject* tracerTestSuite;
 };
 
 #endif // CTKPLUGINFRAMEWORKTESTACTIVATOR_H
@@ -0,0 +1,204 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#include "ctkPluginFrameworkTracerTestSuite_p.h"
+
+#include <ctkPlugin.h>
+#include <ctkPluginConstants.h>
+#include <ctkPluginContext.h>
+#include <ctkPluginFramework.h>
+#include <ctkPluginFrameworkFactory.h>
+
+#include <ctkPluginFrameworkTestUtil.h>
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QTest>
+
+#if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#endif
+
+namespace {
+
+struct TraceSpan
+{
+  QString category;
+  QString name;
+  QString target;
+  qint64 begin;
+  qint64 end;
+};
+
+#if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
+//----------------------------------------------------------------------------
+// Read the complete events of a Chrome trace, in the order of the file
+bool readTrace(const QString& fileName, QList<TraceSpan>& spans)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    return false;
+  }
+  QJsonParseError error;
+  QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+  if (error.error != QJsonParseError::NoError || !doc.isObject() ||
+      !doc.object().value("traceEvents").isArray())
+  {
+    qWarning() << "Invalid trace" << fileName << ":" << error.errorString();
+    return false;
+  }
+
+  foreach(const QJsonValue& value, doc.object().value("traceEvents").toArray())
+  {
+    QJsonObject event = value.toObject();
+    if (event.value("ph").toString() != "X") continue;
+    if (!event.contains("ts") || !event.contains("dur") || !event.contains("pid") ||
+        !event.contains("tid") || event.value("dur").toDouble() < 0)
+    {
+      qWarning() << "Invalid trace event" << event;
+      return false;
+    }
+    TraceSpan span;
+    span.category = event.value("cat").toString();
+    span.name = event.value("name").toString();
+    span.target = event.value("args").toObject().value("target").toString();
+    span.begin = static_cast<qint64>(event.value("ts").toDouble());
+    span.end = span.begin + static_cast<qint64>(event.value("dur").toDouble());
+    spans.push_back(span);
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool containsSpan(const QList<TraceSpan>& spans, const QString& category,
+                  const QString& name, const QString& target = QString())
+{
+  foreach(const TraceSpan& span, spans)
+  {
+    if (span.category == category && span.name == name &&
+        (target.isEmpty() || span.target == target))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+#endif
+
+}
+
+//----------------------------------------------------------------------------
+ctkPluginFrameworkTracerTestSuite::ctkPluginFrameworkTracerTestSuite(ctkPluginContext* pc)
+  : pc(pc)
+{
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkTracerTestSuite::startPluginsAndExportTrace(ctkProperties fwProps,
+                                                                    const QString& traceFile)
+{
+  fwProps.insert(ctkPluginConstants::FRAMEWORK_STORAGE, QDir::temp().filePath("ctkPluginFrameworkTracerTestSuite"));
+  fwProps.insert(ctkPluginConstants::FRAMEWORK_STORAGE_CLEAN, ctkPluginConstants::FRAMEWORK_STORAGE_CLEAN_ONFIRSTINIT);
+  fwProps.insert(ctkPluginConstants::FRAMEWORK_TRACE, true);
+  fwProps.insert("pluginfw.testDir", pc->getProperty("pluginfw.testDir"));
+
+  ctkPluginFrameworkFactory fwFactory(fwProps);
+  QSharedPointer<ctkPluginFramework> framework = fwFactory.getFramework();
+  framework->start();
+
+  QStringList plugins;
+  plugins << "pluginA_test" << "pluginSL1_test" << "pluginSL4_test";
+  foreach(const QString& plugin, plugins)
+  {
+    ctkPluginFrameworkTestUtil::installPlugin(framework->getPluginContext(), plugin)->start();
+  }
+
+  QVERIFY(framework->exportTrace(traceFile));
+  framework->stop();
+  framework->waitForStop(0);
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkTracerTestSuite::testExportTrace()
+{
+#if QT_VERSION < QT_VERSION_CHECK(5,0,0)
+  QSKIP("Parsing the JSON trace requires Qt 5", SkipAll);
+#else
+  const QString traceFile = QDir::temp().filePath("ctkPluginFrameworkTracerTestSuite.json");
+  startPluginsAndExportTrace(ctkProperties(), traceFile);
+  if (QTest::currentTestFailed()) return;
+
+  QList<TraceSpan> spans;
+  QVERIFY(readTrace(traceFile, spans));
+  QFile::remove(traceFile);
+
+  QVERIFY(containsSpan(spans, "framework", "init"));
+  QStringList symbolicNames;
+  symbolicNames << "pluginA.test" << "pluginSL1.test" << "pluginSL4.test";
+  foreach(const QString& symbolicName, symbolicNames)
+  {
+    QVERIFY2(containsSpan(spans, "plugin", "resolve", symbolicName), qPrintable(symbolicName));
+    QVERIFY2(containsSpan(spans, "plugin", "load", symbolicName), qPrintable(symbolicName));
+    QVERIFY2(containsSpan(spans, "plugin", "activate", symbolicName), qPrintable(symbolicName));
+    QVERIFY2(containsSpan(spans, "listener", "pluginChanged", symbolicName), qPrintable(symbolicName));
+  }
+  QVERIFY(containsSpan(spans, "service", "registerService"));
+#endif
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkTracerTestSuite::testRingBufferWrap()
+{
+#if QT_VERSION < QT_VERSION_CHECK(5,0,0)
+  QSKIP("Parsing the JSON trace requires Qt 5", SkipAll);
+#else
+  const int bufferSize = 8;
+  const QString traceFile = QDir::temp().filePath("ctkPluginFrameworkTracerTestSuite.json");
+  ctkProperties fwProps;
+  fwProps.insert(ctkPluginConstants::FRAMEWORK_TRACE_BUFFER_SIZE, bufferSize);
+  startPluginsAndExportTrace(fwProps, traceFile);
+  if (QTest::currentTestFailed()) return;
+
+  QList<TraceSpan> spans;
+  QVERIFY(readTrace(traceFile, spans));
+  QFile::remove(traceFile);
+
+  // Starting three plugins records many more spans than the buffer holds
+  QCOMPARE(spans.size(), bufferSize);
+  QVERIFY(!containsSpan(spans, "framework", "init"));
+
+  // The spans are recorded when they end, all in this thread
+  for (int i = 1; i < spans.size(); ++i)
+  {
+    QVERIFY2(spans[i - 1].end <= spans[i].end,
+             qPrintable(QString("span %1 (%2) ends after span %3 (%4)")
+                        .arg(i - 1).arg(spans[i - 1].name).arg(i).arg(spans[i].name)));
+  }
+
+  // The last started plugin is among the most recent spans
+  QVERIFY(containsSpan(spans, "plugin", "activate", "pluginSL4.test"));
+#endif
+}
@@ -0,0 +1,71 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKPLUGINFRAMEWORKTRACERTESTSUITE_P_H
+#define CTKPLUGINFRAMEWORKTRACERTESTSUITE_P_H
+
+#include <QObject>
+
+#include <ctkPluginFramework_global.h>
+
+#include <ctkTestSuiteInterface.h>
+
+class ctkPluginContext;
+
+/**
+ * Starts frameworks with the ctkPluginConstants::FRAMEWORK_TRACE property
+ * set and checks the exported Chrome trace.
+ */
+class ctkPluginFrameworkTracerTestSuite : public QObject,
+                                          public ctkTestSuiteInterface
+{
+  Q_OBJECT
+  Q_INTERFACES(ctkTestSuiteInterface)
+
+public:
+
+  ctkPluginFrameworkTracerTestSuite(ctkPluginContext* pc);
+
+private Q_SLOTS:
+
+  // test functions
+
+  // The spans of the framework initialization and of the plugin starts
+  // are exported
+  void testExportTrace();
+
+  // Once the ring buffer is full, the most recent spans are exported
+  // from the oldest to the most recent
+  void testRingBufferWrap();
+
+private:
+
+  /**
+   * Start a framework with tracing enabled, start a few plugins in it and
+   * export the trace to the given file.
+   */
+  void startPluginsAndExportTrace(ctkProperties fwProps, const QString& traceFile);
+
+  ctkPluginContext* pc;
+};
+
+#endif // CTKPLUGINFRAMEWORKTRACERTESTSUITE_P_H
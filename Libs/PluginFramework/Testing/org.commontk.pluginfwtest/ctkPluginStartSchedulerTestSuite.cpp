@@ -0,0 +1,198 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#include "ctkPluginStartSchedulerTestSuite_p.h"
+
+#include <ctkPlugin.h>
+#include <ctkPluginConstants.h>
+#include <ctkPluginContext.h>
+#include <ctkPluginException.h>
+#include <ctkPluginFramework.h>
+#include <ctkPluginFrameworkFactory.h>
+
+#include <ctkPluginFrameworkTestUtil.h>
+
+#include <QDir>
+#include <QTest>
+#include <QThread>
+
+//----------------------------------------------------------------------------
+ctkPluginStartSchedulerTestSuite::ctkPluginStartSchedulerTestSuite(ctkPluginContext* pc)
+  : pc(pc)
+{
+}
+
+//----------------------------------------------------------------------------
+ctkPluginStartSchedulerTestSuite::~ctkPluginStartSchedulerTestSuite()
+{
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartSchedulerTestSuite::initTestCase()
+{
+  ctkProperties fwProps;
+  fwProps.insert(ctkPluginConstants::FRAMEWORK_STORAGE, QDir::temp().filePath("ctkPluginStartSchedulerTestSuite"));
+  fwProps.insert(ctkPluginConstants::FRAMEWORK_STORAGE_CLEAN, ctkPluginConstants::FRAMEWORK_STORAGE_CLEAN_ONFIRSTINIT);
+  fwProps.insert(ctkPluginConstants::FRAMEWORK_PLUGIN_ACTIVATION_THREADS, 4);
+  fwProps.insert("pluginfw.testDir", pc->getProperty("pluginfw.testDir"));
+
+  // First launch: install the plugins and record their autostart setting
+  {
+    ctkPluginFrameworkFactory fwFactory(fwProps);
+    QSharedPointer<ctkPluginFramework> fw = fwFactory.getFramework();
+    fw->start();
+    for (int i = 1; i <= 6; ++i)
+    {
+      QSharedPointer<ctkPlugin> plugin =
+          ctkPluginFrameworkTestUtil::installPlugin(fw->getPluginContext(), QString("pluginSS%1_test").arg(i));
+      QVERIFY(plugin);
+      try
+      {
+        plugin->start(0);
+      }
+      catch (const ctkPluginException&)
+      {
+        // pluginSS3_test and pluginSS4_test fail to start
+      }
+    }
+    fw->stop();
+    fw->waitForStop(0);
+  }
+
+  // Second launch: the framework starts the plugins concurrently
+  fwProps.remove(ctkPluginConstants::FRAMEWORK_STORAGE_CLEAN);
+  fwFactory.reset(new ctkPluginFrameworkFactory(fwProps));
+  framework = fwFactory->getFramework();
+  framework->init();
+  QVERIFY(framework->getPluginContext()->connectFrameworkListener(
+            this, SLOT(frameworkListener(ctkPluginFrameworkEvent)), Qt::DirectConnection));
+  framework->start();
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartSchedulerTestSuite::cleanupTestCase()
+{
+  if (framework)
+  {
+    framework->stop();
+    framework->waitForStop(0);
+  }
+  framework.clear();
+  fwFactory.reset();
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartSchedulerTestSuite::testRequiredPluginsFirst()
+{
+  QCOMPARE(getPlugin("pluginSS1.test")->getState(), ctkPlugin::ACTIVE);
+  QCOMPARE(getPlugin("pluginSS2.test")->getState(), ctkPlugin::ACTIVE);
+
+  // pluginSS1_test takes some time to start, pluginSS2_test must have waited
+  ctkServiceReference ref = getActivatorReference(2);
+  QVERIFY(ref);
+  QVERIFY2(ref.getProperty("requirementsActive").toBool(),
+           "pluginSS2_test was started before pluginSS1_test");
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartSchedulerTestSuite::testMainActivationThread()
+{
+  const qulonglong startThread = static_cast<qulonglong>(reinterpret_cast<quintptr>(QThread::currentThread()));
+
+  ctkServiceReference ref = getActivatorReference(2);
+  QVERIFY(ref);
+  QCOMPARE(ref.getProperty("activationThread").toULongLong(), startThread);
+
+  // Other activators run on the thread pool
+  ref = getActivatorReference(1);
+  QVERIFY(ref);
+  QVERIFY(ref.getProperty("activationThread").toULongLong() != startThread);
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartSchedulerTestSuite::testFailurePropagation()
+{
+  QVERIFY(getPlugin("pluginSS3.test")->getState() != ctkPlugin::ACTIVE);
+  QVERIFY(hasError("pluginSS3.test"));
+
+  // The activator of the dependent plugin is not run, the failure is reported
+  QVERIFY(getPlugin("pluginSS4.test")->getState() != ctkPlugin::ACTIVE);
+  QVERIFY(!getActivatorReference(4));
+  QVERIFY(hasError("pluginSS4.test"));
+
+  QVERIFY(!hasError("pluginSS1.test"));
+  QVERIFY(!hasError("pluginSS2.test"));
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartSchedulerTestSuite::testRequirementCycle()
+{
+  QCOMPARE(getPlugin("pluginSS5.test")->getState(), ctkPlugin::ACTIVE);
+  QCOMPARE(getPlugin("pluginSS6.test")->getState(), ctkPlugin::ACTIVE);
+  QVERIFY(getActivatorReference(5));
+  QVERIFY(getActivatorReference(6));
+  QVERIFY(!hasError("pluginSS5.test"));
+  QVERIFY(!hasError("pluginSS6.test"));
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartSchedulerTestSuite::frameworkListener(const ctkPluginFrameworkEvent& fwEvent)
+{
+  QMutexLocker l(&frameworkEventsMutex);
+  frameworkEvents.push_back(fwEvent);
+  qDebug() << "FrameworkEvent:" << fwEvent;
+}
+
+//----------------------------------------------------------------------------
+QSharedPointer<ctkPlugin> ctkPluginStartSchedulerTestSuite::getPlugin(const QString& symbolicName) const
+{
+  foreach(QSharedPointer<ctkPlugin> plugin, framework->getPluginContext()->getPlugins())
+  {
+    if (plugin->getSymbolicName() == symbolicName)
+    {
+      return plugin;
+    }
+  }
+  throw ctkPluginException(QString("No plugin %1 installed").arg(symbolicName));
+}
+
+//----------------------------------------------------------------------------
+ctkServiceReference ctkPluginStartSchedulerTestSuite::getActivatorReference(int plugin) const
+{
+  return framework->getPluginContext()->getServiceReference(
+        QString("ctkTestPluginSS%1Activator").arg(plugin));
+}
+
+//----------------------------------------------------------------------------
+bool ctkPluginStartSchedulerTestSuite::hasError(const QString& symbolicName) const
+{
+  QMutexLocker l(&frameworkEventsMutex);
+  foreach(const ctkPluginFrameworkEvent& fwEvent, frameworkEvents)
+  {
+    if (fwEvent.getType() == ctkPluginFrameworkEvent::PLUGIN_ERROR &&
+        fwEvent.getPlugin()->getSymbolicName() == symbolicName)
+    {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,100 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKPLUGINSTARTSCHEDULERTESTSUITE_P_H
+#define CTKPLUGINSTARTSCHEDULERTESTSUITE_P_H
+
+#include <QMutex>
+#include <QObject>
+#include <QScopedPointer>
+#include <QSharedPointer>
+
+#include <ctkPluginFrameworkEvent.h>
+#include <ctkServiceReference.h>
+
+#include <ctkTestSuiteInterface.h>
+
+class ctkPlugin;
+class ctkPluginContext;
+class ctkPluginFramework;
+class ctkPluginFrameworkFactory;
+
+/**
+ * Starts a framework with the pluginSS*_test plugins and
+ * the ctkPluginConstants::FRAMEWORK_PLUGIN_ACTIVATION_THREADS property set,
+ * so that they are started concurrently.
+ */
+class ctkPluginStartSchedulerTestSuite : public QObject,
+                                         public ctkTestSuiteInterface
+{
+  Q_OBJECT
+  Q_INTERFACES(ctkTestSuiteInterface)
+
+public:
+
+  ctkPluginStartSchedulerTestSuite(ctkPluginContext* pc);
+  ~ctkPluginStartSchedulerTestSuite();
+
+protected Q_SLOTS:
+
+  void frameworkListener(const ctkPluginFrameworkEvent& fwEvent);
+
+private Q_SLOTS:
+
+  void initTestCase();
+  void cleanupTestCase();
+
+  // test functions
+
+  // A plugin is activated once the plugins it requires are active
+  void testRequiredPluginsFirst();
+
+  // Plugin-ActivationThread: main activators run in the thread starting
+  // the framework
+  void testMainActivationThread();
+
+  // A plugin requiring a plugin failing to start is not activated
+  void testFailurePropagation();
+
+  // Plugins requiring each other are started one after the other
+  void testRequirementCycle();
+
+private:
+
+  QSharedPointer<ctkPlugin> getPlugin(const QString& symbolicName) const;
+
+  // Reference to the service registered by the activator of the test plugin
+  ctkServiceReference getActivatorReference(int plugin) const;
+
+  // True if a PLUGIN_ERROR framework event was sent for the plugin
+  bool hasError(const QString& symbolicName) const;
+
+  ctkPluginContext* pc;
+
+  QScopedPointer<ctkPluginFrameworkFactory> fwFactory;
+  QSharedPointer<ctkPluginFramework> framework;
+
+  mutable QMutex frameworkEventsMutex;
+  QList<ctkPluginFrameworkEvent> frameworkEvents;
+};
+
+#endif // CTKPLUGINSTARTSCHEDULERTESTSUITE_P_H
@@ -88,6 +88,40 @@ public:
 
 };
 
+/**
+ * A compiled expression is a flat array of instructions, in prefix order.
+ * The operands of simple expressions are prepared for the comparisons and
+ * the attribute names are interned.
+ */
+struct ctkLDAPExpr::Instruction
+{
+  Instruction()
+    : op(0), size(1), keyId(-1), wildcard(false), matchAll(false),
+      isInteger(false), integer(0), boolean(-1)
+  {
+  }
+
+  int op;
+  //! Number of instructions of the expression, this one included
+  int size;
+
+  //! Interned attribute name, see ctkServiceProperties::keyId()
+  int keyId;
+  QString attrName;
+  QString attrValue;
+  //! attrValue without spaces and in lower case, for APPROX
+  QString approxValue;
+  //! True if attrValue contains a wildcard
+  bool wildcard;
+  //! True if the expression is a presence test
+  bool matchAll;
+  //! True if attrValue is the string representation of integer
+  bool isInteger;
+  qlonglong integer;
+  //! 1 if attrValue is "true", 0 if it is "false", -1 otherwise
+  int boolean;
+};
+
 /**
 \brief LDAP Expression Data
 \date 19 May 2010
@@ -111,7 +145,7 @@ public:
   ctkLDAPExprData( const ctkLDAPExprData& other )
     : QSharedData(other), m_operator(other.m_operator),
     m_args(other.m_args), m_attrName(other.m_attrName),
-    m_attrValue(other.m_attrValue)
+    m_attrValue(other.m_attrValue), m_program(other.m_program)
   {
   }
 
@@ -123,6 +157,8 @@ public:
   QString m_attrName;
   //!
   QString m_attrValue;
+  //! Compiled form, only set for parsed filters
+  QVector<ctkLDAPExpr::Instruction> m_program;
 };
 
 //----------------------------------------------------------------------------
@@ -151,7 +187,12 @@ ctkLDAPExpr::ctkLDAPExpr( const QString &filter )
     ps.error(GARBAGE + " '" + ps.rest() + "'");
   }
 
+  QVector<Instruction> program;
+  expr.compile(program);
+
   d = expr.d;
+  expr = ctkLDAPExpr();
+  d->m_program = program;
 }
 
 //----------------------------------------------------------------------------
@@ -186,13 +227,19 @@ ctkLDAPExpr::~ctkLDAPExpr()
 
 //----------------------------------------------------------------------------
 bool ctkLDAPExpr::getMatchedObjectClasses(QSet<QString>& objClasses) const
+{
+  return this->getMatchedValues(ctkPluginConstants::OBJECTCLASS, objClasses);
+}
+
+//----------------------------------------------------------------------------
+bool ctkLDAPExpr::getMatchedValues(const QString& attrName, QSet<QString>& values) const
 {
   if (d->m_operator == EQ)
   {
-    if (d->m_attrName.compare(ctkPluginConstants::OBJECTCLASS, Qt::CaseInsensitive) == 0 &&
+    if (d->m_attrName.compare(attrName, Qt::CaseInsensitive) == 0 &&
       d->m_attrValue.indexOf(WILDCARD) < 0) 
     {
-      objClasses.insert( d->m_attrValue );
+      values.insert( d->m_attrValue );
       return true;
     }
     return false;
@@ -200,24 +247,26 @@ bool ctkLDAPExpr::getMatchedObjectClasses(QSet<QString>& objClasses) const
   else if (d->m_operator == AND) 
   {
     bool result = false;
+    QSet<QString> matched;
     for (int i = 0; i < d->m_args.size( ); i++)
     {
       QSet<QString> r;
-      if(d->m_args[i].getMatchedObjectClasses(r))
+      if(d->m_args[i].getMatchedValues(attrName, r))
       {
-        result = true;
-        if (objClasses.empty())
+        if (!result)
         {
-          objClasses = r;
+          matched = r;
         }
         else
         {
-          // if AND op and classes in several operands,
+          // if AND op and values in several operands,
           // then only the intersection is possible.
-          objClasses.intersect(r);
+          matched.intersect(r);
         }
+        result = true;
       }
     }
+    values += matched;
     return result;
   }
   else if (d->m_operator == OR)
@@ -225,13 +274,13 @@ bool ctkLDAPExpr::getMatchedObjectClasses(QSet<QString>& objClasses) const
     for (int i = 0; i < d->m_args.length( ); i++)
     {
       QSet<QString> r;
-      if (d->m_args[i].getMatchedObjectClasses(r))
+      if (d->m_args[i].getMatchedValues(attrName, r))
       {
-        objClasses += r;
+        values += r;
       }
       else
       {
-        objClasses.clear();
+        values.clear();
         return false;
       }
     }
@@ -283,6 +332,11 @@ bool ctkLDAPExpr::query( const QString &filter, const ctkDictionary &pd )
 //----------------------------------------------------------------------------
 bool ctkLDAPExpr::evaluate( const ctkServiceProperties &p, bool matchCase ) const
 {
+  if (!d->m_program.isEmpty())
+  {
+    return evaluateCompiled(d->m_program.constData(), p, matchCase);
+  }
+
   if ((d->m_operator & SIMPLE) != 0) {
     // try case sensitive match first
     int index = p.findCaseSensitive(d->m_attrName);
@@ -383,6 +437,153 @@ bool ctkLDAPExpr::compare( const QVariant &obj, int op, const QString &s ) const
   return false;
 }
 
+//----------------------------------------------------------------------------
+void ctkLDAPExpr::compile(QVector<Instruction>& program) const
+{
+  const int index = program.size();
+  program.push_back(Instruction());
+  program[index].op = d->m_operator;
+
+  if ((d->m_operator & SIMPLE) != 0)
+  {
+    Instruction& ins = program[index];
+    ins.keyId = ctkServiceProperties::keyId(d->m_attrName);
+    ins.attrName = d->m_attrName;
+    ins.attrValue = d->m_attrValue;
+    ins.wildcard = d->m_attrValue.indexOf(WILDCARD) >= 0;
+    ins.matchAll = d->m_operator == EQ && d->m_attrValue == WILDCARD_QString;
+    if (d->m_operator == APPROX)
+    {
+      ins.approxValue = fixupString(d->m_attrValue);
+    }
+    bool ok = false;
+    ins.integer = d->m_attrValue.toLongLong(&ok);
+    ins.isInteger = ok && QString::number(ins.integer) == d->m_attrValue;
+    if (d->m_attrValue == "true")
+    {
+      ins.boolean = 1;
+    }
+    else if (d->m_attrValue == "false")
+    {
+      ins.boolean = 0;
+    }
+  }
+  else
+  {
+    for (int i = 0; i < d->m_args.size(); ++i)
+    {
+      d->m_args[i].compile(program);
+    }
+    program[index].size = program.size() - index;
+  }
+}
+
+//----------------------------------------------------------------------------
+bool ctkLDAPExpr::evaluateCompiled(const Instruction* ins, const ctkServiceProperties& p,
+                                   bool matchCase) const
+{
+  switch (ins->op)
+  {
+  case AND:
+  {
+    const Instruction* end = ins + ins->size;
+    for (const Instruction* arg = ins + 1; arg < end; arg += arg->size)
+    {
+      if (!evaluateCompiled(arg, p, matchCase))
+        return false;
+    }
+    return true;
+  }
+  case OR:
+  {
+    const Instruction* end = ins + ins->size;
+    for (const Instruction* arg = ins + 1; arg < end; arg += arg->size)
+    {
+      if (evaluateCompiled(arg, p, matchCase))
+        return true;
+    }
+    return false;
+  }
+  case NOT:
+    return !evaluateCompiled(ins + 1, p, matchCase);
+  default:
+  {
+    // Keys only differing in case cannot be in the same properties, so
+    // the case insensitive match is the case sensitive one if any.
+    int index = matchCase ? p.findCaseSensitive(ins->attrName) : p.find(ins->keyId);
+    return index < 0 ? false : compare(p.value(index), *ins);
+  }
+  }
+}
+
+//----------------------------------------------------------------------------
+bool ctkLDAPExpr::compare(const QVariant& obj, const Instruction& ins) const
+{
+  if (obj.isNull())
+    return false;
+  if (ins.matchAll)
+    return true;
+
+  // Fast paths giving the same result as compare(obj, ins.op, ins.attrValue)
+  switch (obj.type())
+  {
+  case QVariant::String:
+  {
+    const QString& s = *static_cast<const QString*>(obj.constData());
+    switch (ins.op)
+    {
+    case LE:
+      return s.compare(ins.attrValue) <= 0;
+    case GE:
+      return s.compare(ins.attrValue) >= 0;
+    case EQ:
+      return ins.wildcard ? patSubstr(s, ins.attrValue) : s == ins.attrValue;
+    case APPROX:
+      return approxEquals(s, ins.approxValue);
+    default:
+      return false;
+    }
+  }
+  case QVariant::Int:
+  case QVariant::UInt:
+  case QVariant::LongLong:
+    // Integers are compared by their string representation
+    if (ins.op == EQ && ins.isInteger)
+    {
+      return obj.toLongLong() == ins.integer;
+    }
+    break;
+  case QVariant::Bool:
+    if (ins.op == EQ && ins.boolean >= 0)
+    {
+      return obj.toBool() == (ins.boolean == 1);
+    }
+    break;
+  default:
+    break;
+  }
+  return compare(obj, ins.op, ins.attrValue);
+}
+
+//----------------------------------------------------------------------------
+bool ctkLDAPExpr::approxEquals(const QString& s, const QString& fixedUpValue)
+{
+  // Same as fixupString(s) == fixedUpValue, without allocation
+  int j = 0;
+  for (int i = 0; i < s.length(); ++i)
+  {
+    QChar c = s.at(i);
+    if (c.isSpace())
+      continue;
+    if (c.isUpper())
+      c = c.toLower();
+    if (j >= fixedUpValue.length() || fixedUpValue.at(j) != c)
+      return false;
+    ++j;
+  }
+  return j == fixedUpValue.length();
+}
+
 //----------------------------------------------------------------------------
 bool ctkLDAPExpr::compareString( const QString &s1, int op, const QString &s2 )
 {
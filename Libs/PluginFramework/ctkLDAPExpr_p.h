@@ -84,6 +84,19 @@ public:
    */
   bool getMatchedObjectClasses(QSet<QString>& objClasses) const;
 
+  /**
+   * Get the set of values the attribute <code>attrName</code> must be equal
+   * to for this LDAP expression to match, in the same way as
+   * getMatchedObjectClasses(). The attribute name is matched case
+   * insensitively.
+   *
+   * \param attrName The attribute name.
+   * \param values The set of matched values will be added to values.
+   * \return If the set cannot be determined, <code>false</code> is returned,
+   *         <code>true</code> otherwise.
+   */
+  bool getMatchedValues(const QString& attrName, QSet<QString>& values) const;
+
   /**
    * Checks if this LDAP expression is "simple". The definition of
    * a simple filter is:
@@ -134,6 +147,26 @@ private:
 
   class ParseState;
 
+  friend class ctkLDAPExprData;
+
+  /**
+   * An element of the compiled form of an expression. The sub-expressions
+   * of an expression directly follow it.
+   */
+  struct Instruction;
+
+  //! Append the compiled form of this expression to program.
+  void compile(QVector<Instruction>& program) const;
+
+  //! Evaluate the compiled expression starting at ins.
+  bool evaluateCompiled(const Instruction* ins, const ctkServiceProperties& p, bool matchCase) const;
+
+  //! Compare a property value to the value of a compiled simple expression.
+  bool compare(const QVariant& obj, const Instruction& ins) const;
+
+  //!
+  static bool approxEquals(const QString& s, const QString& fixedUpValue);
+
   //!
   ctkLDAPExpr(int op, const QList<ctkLDAPExpr> &args);
 
@@ -81,7 +81,10 @@ void ctkPlugin::start(const StartOptions& options)
   // activation.
 
   //TODO 1: If activating or deactivating, wait a litle
-  // we don't use mutliple threads to start plugins for now
+  // Plugins may be started from several threads by ctkPluginStartScheduler,
+  // which starts a plugin only once the plugins it requires are finished
+  // and never starts the same plugin from two threads. Concurrent calls for
+  // the same plugin from other code are not handled yet.
   //waitOnActivation(lock, "ctkPlugin::start", false);
 
   //2: start() is idempotent, i.e., nothing to do when already started
@@ -800,6 +800,7 @@ protected:
   friend class ctkPluginFrameworkPrivate;
   friend class ctkPluginFrameworkContext;
   friend class ctkPlugins;
+  friend class ctkPluginStartScheduler;
   friend class ctkServiceReferencePrivate;
 
   // Do NOT change this to QScopedPointer<ctkPluginPrivate>!
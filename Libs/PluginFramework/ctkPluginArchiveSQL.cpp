@@ -34,7 +34,7 @@ ctkPluginArchiveSQL::ctkPluginArchiveSQL(ctkPluginStorageSQL* pluginStorage,
                                          const QUrl& pluginLocation, const QString& localPluginPath,
                                          int pluginId, int startLevel, const QDateTime& lastModified,
                                          int autostartSetting)
-  : key(-1), autostartSetting(autostartSetting), id(pluginId), generation(0)
+  : key(-1), lazyResources(false), autostartSetting(autostartSetting), id(pluginId), generation(0)
   , startLevel(startLevel), lastModified(lastModified), location(pluginLocation)
   , localPluginPath(localPluginPath), storage(pluginStorage)
 {
@@ -43,7 +43,7 @@ ctkPluginArchiveSQL::ctkPluginArchiveSQL(ctkPluginStorageSQL* pluginStorage,
 //----------------------------------------------------------------------------
 ctkPluginArchiveSQL::ctkPluginArchiveSQL(QSharedPointer<ctkPluginArchiveSQL> old, int generation,
                                          const QUrl &pluginLocation, const QString &localPluginPath)
-  : key(-1), autostartSetting(old->autostartSetting), id(old->id), generation(generation)
+  : key(-1), lazyResources(false), autostartSetting(old->autostartSetting), id(old->id), generation(generation)
   , startLevel(0), location(pluginLocation), localPluginPath(localPluginPath)
   , storage(old->storage)
 {
@@ -101,6 +101,10 @@ QByteArray ctkPluginArchiveSQL::getPluginResource(const QString& component) cons
 {
   try
   {
+    if (lazyResources)
+    {
+      return storage->getLibraryResource(key, localPluginPath, component);
+    }
     return storage->getPluginResource(key, component);
   }
   catch (const ctkPluginDatabaseException& exc)
@@ -115,6 +119,10 @@ QStringList ctkPluginArchiveSQL::findResourcesPath(const QString& path) const
 {
   try
   {
+    if (lazyResources)
+    {
+      return storage->findIndexedResourcesPath(key, localPluginPath, path);
+    }
     return storage->findResourcesPath(key, path);
   }
   catch (const ctkPluginDatabaseException& exc)
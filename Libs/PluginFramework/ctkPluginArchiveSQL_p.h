@@ -110,7 +110,8 @@ public:
 
   /**
    * Get a Qt resource as a byte array from a plugin. The resource
-   * is cached and may be aquired even if the plugin is not active.
+   * is cached (or read from the plugin library if the resources are
+   * stored lazily) and may be aquired even if the plugin is not active.
    *
    * @param component Resource to get the byte array from.
    * @return QByteArray to the entry (empty if it doesn't exist).
@@ -188,6 +189,12 @@ public:
 
   int key;
 
+  /**
+   * \c true if only the manifest and the resource paths of the plugin
+   * are stored in the database.
+   */
+  bool lazyResources;
+
 private:
 
   int autostartSetting;
@@ -31,6 +31,14 @@ const QString ctkPluginConstants::FRAMEWORK_STORAGE_CLEAN = "org.commontk.plugin
 const QString ctkPluginConstants::FRAMEWORK_STORAGE_CLEAN_ONFIRSTINIT = "onFirstInit";
 const QString ctkPluginConstants::FRAMEWORK_PLUGIN_LOAD_HINTS = "org.commontk.pluginfw.loadhints";
 const QString ctkPluginConstants::FRAMEWORK_PRELOAD_LIBRARIES = "org.commontk.pluginfw.preloadlibs";
+const QString ctkPluginConstants::FRAMEWORK_PLUGIN_RESOURCES = "org.commontk.pluginfw.resources";
+const QString ctkPluginConstants::FRAMEWORK_PLUGIN_RESOURCES_COPY = "copy";
+const QString ctkPluginConstants::FRAMEWORK_PLUGIN_RESOURCES_LAZY = "lazy";
+const QString ctkPluginConstants::FRAMEWORK_PLUGIN_ACTIVATION_THREADS = "org.commontk.pluginfw.activation.threads";
+const QString ctkPluginConstants::FRAMEWORK_TRACE = "org.commontk.pluginfw.trace";
+const QString ctkPluginConstants::FRAMEWORK_TRACE_BUFFER_SIZE = "org.commontk.pluginfw.trace.buffersize";
+const QString ctkPluginConstants::FRAMEWORK_TRACE_FILE = "org.commontk.pluginfw.trace.file";
+const QString ctkPluginConstants::FRAMEWORK_SERVICE_INDEXED_PROPERTIES = "org.commontk.pluginfw.service.indexedproperties";
 
 const QString ctkPluginConstants::PLUGIN_SYMBOLICNAME = "Plugin-SymbolicName";
 const QString ctkPluginConstants::PLUGIN_COPYRIGHT = "Plugin-Copyright";
@@ -43,10 +51,12 @@ const QString ctkPluginConstants::REQUIRE_PLUGIN = "Require-Plugin";
 const QString ctkPluginConstants::PLUGIN_VERSION_ATTRIBUTE = "plugin-version";
 const QString ctkPluginConstants::PLUGIN_VERSION = "Plugin-Version";
 const QString ctkPluginConstants::PLUGIN_ACTIVATIONPOLICY = "Plugin-ActivationPolicy";
+const QString ctkPluginConstants::PLUGIN_ACTIVATIONTHREAD = "Plugin-ActivationThread";
 const QString ctkPluginConstants::PLUGIN_UPDATELOCATION = "Plugin-UpdateLocation";
 
 const QString ctkPluginConstants::ACTIVATION_EAGER = "eager";
 const QString ctkPluginConstants::ACTIVATION_LAZY = "lazy";
+const QString ctkPluginConstants::ACTIVATIONTHREAD_MAIN = "main";
 
 const QString ctkPluginConstants::RESOLUTION_DIRECTIVE = "resolution";
 const QString ctkPluginConstants::RESOLUTION_MANDATORY = "mandatory";
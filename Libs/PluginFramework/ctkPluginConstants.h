@@ -122,6 +122,103 @@ struct CTK_PLUGINFW_EXPORT ctkPluginConstants {
    */
   static const QString FRAMEWORK_PRELOAD_LIBRARIES; // = "org.commontk.pluginfw.preloadlibs"
 
+  /**
+   * Specifies how the framework stores the Qt resources of installed plug-ins.
+   * The value of this property must be a QString, either
+   * FRAMEWORK_PLUGIN_RESOURCES_COPY or FRAMEWORK_PLUGIN_RESOURCES_LAZY.
+   * If this property is not set, the resources are copied.
+   *
+   * @see #FRAMEWORK_PLUGIN_RESOURCES_COPY
+   * @see #FRAMEWORK_PLUGIN_RESOURCES_LAZY
+   */
+  static const QString FRAMEWORK_PLUGIN_RESOURCES; // = "org.commontk.pluginfw.resources"
+
+  /**
+   * Specifies that the content of all the Qt resources of a plug-in is copied
+   * into the plug-in database when the plug-in is installed. Resources are then
+   * available without loading the plug-in library again.
+   */
+  static const QString FRAMEWORK_PLUGIN_RESOURCES_COPY; // = "copy"
+
+  /**
+   * Specifies that only the manifest and the list of the Qt resources of a
+   * plug-in are stored in the plug-in database. The content of a resource is
+   * read from the plug-in library, which is loaded the first time a resource
+   * is requested. If a copy of the manifest named after the plug-in library
+   * with an additional ".MF" suffix exists and is newer than the library, the
+   * library is not loaded when the plug-in is installed.
+   */
+  static const QString FRAMEWORK_PLUGIN_RESOURCES_LAZY; // = "lazy"
+
+  /**
+   * Specifies the number of threads used to start the plug-ins when the
+   * framework is launched. The value of this property must be an integer.
+   * If it is greater than one, the plug-ins of each start level are started
+   * concurrently: the plug-in libraries are loaded and the activators are
+   * run on a thread pool, a plug-in being started only after the plug-ins it
+   * requires. Activators of plug-ins having the
+   * PLUGIN_ACTIVATIONTHREAD manifest header set to ACTIVATIONTHREAD_MAIN are
+   * always run in the thread starting the framework. If this property is not
+   * set, the plug-ins are started one after the other.
+   * <p>
+   * QObject instances created by an activator run on the thread pool belong
+   * to a pool thread, which has no event loop: they do not receive queued
+   * signals, timer or other events. Only the activator itself is moved to
+   * the thread starting the framework. Plug-ins creating such objects when
+   * they are started should set PLUGIN_ACTIVATIONTHREAD to
+   * ACTIVATIONTHREAD_MAIN, or move the objects to another thread.
+   *
+   * @see #PLUGIN_ACTIVATIONTHREAD
+   */
+  static const QString FRAMEWORK_PLUGIN_ACTIVATION_THREADS; // = "org.commontk.pluginfw.activation.threads"
+
+  /**
+   * Enables the recording of a timeline of the framework activity. The
+   * value of this property must be a boolean. If it is <code>true</code>,
+   * the framework records the time spent loading plug-in libraries, reading
+   * manifests, resolving and activating plug-ins, registering services and
+   * calling the listeners, together with the thread doing the work. The
+   * timeline can be exported in the Chrome trace event format with
+   * ctkPluginFramework::exportTrace().
+   *
+   * @see #FRAMEWORK_TRACE_BUFFER_SIZE
+   * @see #FRAMEWORK_TRACE_FILE
+   */
+  static const QString FRAMEWORK_TRACE; // = "org.commontk.pluginfw.trace"
+
+  /**
+   * Specifies the maximum number of trace events kept in memory. The value
+   * of this property must be an integer. When the limit is reached, the
+   * oldest events are discarded. If this property is not set, 65536 events
+   * are kept.
+   */
+  static const QString FRAMEWORK_TRACE_BUFFER_SIZE; // = "org.commontk.pluginfw.trace.buffersize"
+
+  /**
+   * Specifies the file the trace events are exported to when the framework
+   * is shut down. The value of this property must be a QString. Setting
+   * this property enables the tracing.
+   *
+   * @see #FRAMEWORK_TRACE
+   */
+  static const QString FRAMEWORK_TRACE_FILE; // = "org.commontk.pluginfw.trace.file"
+
+  /**
+   * Specifies service property keys for which the framework maintains an
+   * index of the registered services. Service lookups whose filter requires
+   * one of these properties to be equal to a value, for example
+   * <code>(&(objectclass=ctkEventHandler)(service.pid=myPid))</code>,
+   * only evaluate the filter against the services having this value instead
+   * of all services. The value of this property must be either of type
+   * QString or QStringList. SERVICE_PID is always indexed.
+   * <p>
+   * Service listeners are indexed the same way: the filter of a listener
+   * requiring one of these properties, OBJECTCLASS or SERVICE_ID to be
+   * equal to a value is only evaluated for the service events of the
+   * services having this value.
+   */
+  static const QString FRAMEWORK_SERVICE_INDEXED_PROPERTIES; // = "org.commontk.pluginfw.service.indexedproperties"
+
   /**
    * Manifest header identifying the plugin's symbolic name.
    *
@@ -239,6 +336,18 @@ struct CTK_PLUGINFW_EXPORT ctkPluginConstants {
    */
   static const QString PLUGIN_ACTIVATIONPOLICY; // = "Plugin-ActivationPolicy"
 
+  /**
+   * Manifest header identifying the thread the plugin's activator must be
+   * run in, when the plugins are started concurrently.
+   * <p>
+   * The attribute value may be retrieved from the <code>QHash</code>
+   * object returned by the <code>Plugin::getHeaders()</code> method.
+   *
+   * @see #ACTIVATIONTHREAD_MAIN
+   * @see #FRAMEWORK_PLUGIN_ACTIVATION_THREADS
+   */
+  static const QString PLUGIN_ACTIVATIONTHREAD; // = "Plugin-ActivationThread"
+
   /**
    * Manifest header identifying the location from which a new plugin version
    * is obtained during a plugin update operation.
@@ -288,6 +397,20 @@ struct CTK_PLUGINFW_EXPORT ctkPluginConstants {
    */
   static const QString ACTIVATION_LAZY; // = "lazy"
 
+  /**
+   * Plugin activation thread declaring the plugin's activator must be run in
+   * the thread starting the framework, for example because it creates
+   * widgets or QObject instances relying on the main event loop. The plugin
+   * library may still be loaded in another thread.
+   *
+   * <pre>
+   *       Plugin-ActivationThread: main
+   * </pre>
+   *
+   * @see #PLUGIN_ACTIVATIONTHREAD
+   */
+  static const QString ACTIVATIONTHREAD_MAIN; // = "main"
+
   /**
    * Manifest header directive identifying the resolution type in the
    * Require-Plugin manifest header. The default value is
@@ -25,6 +25,7 @@
 #include "ctkPluginFramework.h"
 #include "ctkPluginFramework_p.h"
 #include "ctkPluginFrameworkContext_p.h"
+#include "ctkPluginStartScheduler_p.h"
 
 #include "service/event/ctkEvent.h"
 
@@ -36,6 +37,7 @@ ctkPluginFramework::ctkPluginFramework()
   qRegisterMetaType<ctkPluginEvent>("ctkPluginEvent");
   qRegisterMetaType<ctkServiceEvent>("ctkServiceEvent");
   qRegisterMetaType<ctkEvent>("ctkEvent");
+  qRegisterMetaType<QList<ctkEvent> >("QList<ctkEvent>");
   qRegisterMetaType<ctkProperties>("ctkProperties");
   qRegisterMetaType<ctkDictionary>("ctkDictionary");
   qRegisterMetaType<ctkServiceReference>("ctkServiceReference");
@@ -123,26 +125,22 @@ void ctkPluginFramework::start(const ctkPlugin::StartOptions& options)
   d->activate(d->pluginContext.data());
 
   // Start plugins according to their autostart setting.
+  ctkPluginStartScheduler scheduler(d->fwCtx);
   QStringListIterator i(pluginsToStart);
   while (i.hasNext())
   {
     QSharedPointer<ctkPlugin> plugin = d->fwCtx->plugins->getPlugin(i.next());
-    try {
-      const int autostartSetting = plugin->d_func()->archive->getAutostartSetting();
-      // Launch must not change the autostart setting of a plugin
-      StartOptions option = ctkPlugin::START_TRANSIENT;
-      if (ctkPlugin::START_ACTIVATION_POLICY == autostartSetting)
-      {
-        // Transient start according to the plugins activation policy.
-        option |= ctkPlugin::START_ACTIVATION_POLICY;
-      }
-      plugin->start(option);
-    }
-    catch (const ctkPluginException& pe)
+    const int autostartSetting = plugin->d_func()->archive->getAutostartSetting();
+    // Launch must not change the autostart setting of a plugin
+    StartOptions option = ctkPlugin::START_TRANSIENT;
+    if (ctkPlugin::START_ACTIVATION_POLICY == autostartSetting)
     {
-      d->fwCtx->listeners.frameworkError(plugin, pe);
+      // Transient start according to the plugins activation policy.
+      option |= ctkPlugin::START_ACTIVATION_POLICY;
     }
+    scheduler.addPlugin(plugin.data(), option);
   }
+  scheduler.start();
 
   {
     ctkPluginPrivate::Locker sync(&d->lock);
@@ -216,3 +214,14 @@ QHash<QString, QString> ctkPluginFramework::getHeaders()
   Q_D(ctkPluginFramework);
   return d->systemHeaders;
 }
+
+//----------------------------------------------------------------------------
+bool ctkPluginFramework::exportTrace(const QString& fileName) const
+{
+  Q_D(const ctkPluginFramework);
+  if (!d->fwCtx->tracer.isEnabled())
+  {
+    return false;
+  }
+  return d->fwCtx->tracer.exportTrace(fileName);
+}
@@ -190,6 +190,18 @@ public:
    */
   QByteArray getResource(const QString& path) const;
 
+  /**
+   * Write the activity recorded by this %ctkPluginFramework to a file, in the
+   * Chrome trace event format. The activity is only recorded if the
+   * ctkPluginConstants::FRAMEWORK_TRACE or
+   * ctkPluginConstants::FRAMEWORK_TRACE_FILE framework property is set.
+   *
+   * @param fileName The file to write.
+   * @return <code>false</code> if tracing is disabled or the file could
+   *         not be written.
+   */
+  bool exportTrace(const QString& fileName) const;
+
 protected:
 
   friend class ctkPluginFrameworkContext;
@@ -41,7 +41,7 @@ int ctkPluginFrameworkContext::globalId = 1;
 ctkPluginFrameworkContext::ctkPluginFrameworkContext()
   : plugins(0), listeners(this), services(0), systemPlugin(new ctkPluginFramework()),
     storage(0), firstInit(true), props(ctkPluginFrameworkProperties::getProperties()),
-    initialized(false)
+    tracer(props), initialized(false)
 {
   {
     QMutexLocker lock(&globalFwLock);
@@ -72,6 +72,8 @@ void ctkPluginFrameworkContext::initProperties()
 //----------------------------------------------------------------------------
 void ctkPluginFrameworkContext::init()
 {
+  ctkPluginFrameworkTraceSpan span(tracer, "framework", "init");
+
   log() << "initializing";
 
   if (debug.framework)
@@ -158,6 +160,7 @@ void ctkPluginFrameworkContext::init()
   ctkPluginFrameworkPrivate* const systemPluginPrivate = systemPlugin->d_func();
   systemPluginPrivate->initSystemPlugin();
 
+  listeners.init();
   storage = new ctkPluginStorageSQL(this);
   dataStorage = ctkPluginFrameworkUtil::getFileStorage(this, "data");
   services = new ctkServices(this);
@@ -199,6 +202,18 @@ void ctkPluginFrameworkContext::uninit()
   delete services;
   services = 0;
 
+  if (tracer.isEnabled() && !tracer.getTraceFile().isEmpty())
+  {
+    if (tracer.exportTrace(tracer.getTraceFile()))
+    {
+      log() << "Trace written to" << tracer.getTraceFile();
+    }
+    else
+    {
+      qWarning() << "Writing the framework trace to" << tracer.getTraceFile() << "failed";
+    }
+  }
+
   initialized = false;
 }
 
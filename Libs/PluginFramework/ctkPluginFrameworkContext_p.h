@@ -32,6 +32,7 @@
 #include "ctkPlugins_p.h"
 #include "ctkPluginFrameworkListeners_p.h"
 #include "ctkPluginFrameworkDebug_p.h"
+#include "ctkPluginFrameworkTracer_p.h"
 
 
 class ctkPlugin;
@@ -103,6 +104,11 @@ public:
    */
   ctkPluginFrameworkDebug debug;
 
+  /**
+   * Timeline of the framework activity.
+   */
+  ctkPluginFrameworkTracer tracer;
+
   /**
    * Contruct a framework context
    *
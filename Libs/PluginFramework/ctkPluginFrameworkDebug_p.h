@@ -93,6 +93,13 @@ public:
   static QString OPTION_DEBUG_RESOLVE;
   bool resolve;
 
+  /**
+   * Report the resolve, load and activation times of the
+   * plug-ins started when the framework is launched
+   */
+  static QString OPTION_DEBUG_STARTUP;
+  bool startup;
+
 };
 
 #endif // CTKPLUGINFRAMEWORKDEBUG_P_H
@@ -26,6 +26,7 @@
 #include "ctkPluginContext.h"
 #include "ctkPluginException.h"
 #include "ctkPlugin_p.h"
+#include "ctkPluginStartScheduler_p.h"
 #include "ctkDefaultApplicationLauncher_p.h"
 #include "ctkLocationManager_p.h"
 #include "ctkBasicLocation_p.h"
@@ -354,6 +355,21 @@ public:
       this->resolvePlugin(plugin);
     }
 
+    if (startEntries.isEmpty()) return;
+
+    // Start the plug-ins concurrently if requested by the framework
+    // properties. Start failures are then reported as framework errors.
+    ctkPluginStartScheduler scheduler(startEntries.front()->d_func()->fwCtx);
+    if (scheduler.getThreadCount() > 1)
+    {
+      foreach(QSharedPointer<ctkPlugin> plugin, startEntries)
+      {
+        scheduler.addPlugin(plugin.data(), startOptions);
+      }
+      scheduler.start();
+      return;
+    }
+
     foreach(QSharedPointer<ctkPlugin> plugin, startEntries)
     {
       plugin->start(startOptions);
@@ -48,6 +48,28 @@ ctkPluginFrameworkListeners::ctkPluginFrameworkListeners(ctkPluginFrameworkConte
   }
 }
 
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkListeners::init()
+{
+  QMutexLocker lock(&mutex); Q_UNUSED(lock)
+  filteredServiceKeys = hashedServiceKeys;
+  filteredCache.clear();
+  QVariant indexed = pluginFw->props.value(
+        ctkPluginConstants::FRAMEWORK_SERVICE_INDEXED_PROPERTIES);
+  foreach (const QString& key, indexed.toStringList())
+  {
+    QString lowerKey = key.trimmed().toLower();
+    if (!lowerKey.isEmpty() && !filteredServiceKeys.contains(lowerKey))
+    {
+      filteredServiceKeys << lowerKey;
+    }
+  }
+  for (int i = 0; i < filteredServiceKeys.size(); ++i)
+  {
+    filteredCache.push_back(QHash<QString, QList<ctkServiceSlotEntry> >());
+  }
+}
+
 //----------------------------------------------------------------------------
 void ctkPluginFrameworkListeners::addServiceSlot(
     QSharedPointer<ctkPlugin> plugin, QObject* receiver,
@@ -127,10 +149,32 @@ QSet<ctkServiceSlotEntry> ctkPluginFrameworkListeners::getMatchingServiceSlots(
     }
   }
 
+  // Check the listeners whose filter requires a property value
+  // of this service
+  QSet<ctkServiceSlotEntry> candidates;
+  for (int i = 0; i < filteredServiceKeys.size(); ++i)
+  {
+    if (filteredCache[i].isEmpty()) continue;
+    QVariant value = sr.d_func()->getProperty(filteredServiceKeys[i], lockProps);
+    if (value.isValid())
+    {
+      addFilteredCandidates(candidates, i, value);
+    }
+  }
+  foreach (const ctkServiceSlotEntry& sse, candidates)
+  {
+    ++n;
+    if (sse.getLDAPExpr().evaluate(sr.d_func()->getProperties(), false))
+    {
+      set.insert(sse);
+    }
+  }
+
   if (pluginFw->debug.ldap)
   {
     qDebug() << "Added" << set.size() << "out of" << n
-      << "listeners with complicated filters";
+      << "listeners with complicated filters," << candidates.size()
+      << "of them found in the filtered listener index";
   }
 
   // Check the cache
@@ -171,6 +215,8 @@ void ctkPluginFrameworkListeners::emitFrameworkEvent(const ctkPluginFrameworkEve
 //----------------------------------------------------------------------------
 void ctkPluginFrameworkListeners::emitPluginChanged(const ctkPluginEvent& event)
 {
+  ctkPluginFrameworkTraceSpan span(pluginFw->tracer, "listener", "pluginChanged",
+                                   pluginFw->tracer.isEnabled() ? event.getPlugin() : QSharedPointer<ctkPlugin>());
   emit pluginChangedDirect(event);
 
   if (!(event.getType() == ctkPluginEvent::STARTING ||
@@ -216,6 +262,8 @@ void ctkPluginFrameworkListeners::serviceChanged(
     try
     {
       ++n;
+      ctkPluginFrameworkTraceSpan span(pluginFw->tracer, "listener", "serviceChanged",
+                                       pluginFw->tracer.isEnabled() ? l.getPlugin() : QSharedPointer<ctkPlugin>());
       l.invokeSlot(evt);
     }
     catch (const ctkException& pe)
@@ -260,6 +308,19 @@ void ctkPluginFrameworkListeners::removeFromCache(const ctkServiceSlotEntry& sse
       }
     }
   }
+  else if (sse.getFilteredKey() >= 0)
+  {
+    QHash<QString, QList<ctkServiceSlotEntry> >& keymap = filteredCache[sse.getFilteredKey()];
+    foreach (const QString& value, sse.getFilteredValues())
+    {
+      QList<ctkServiceSlotEntry>& sses = keymap[value];
+      sses.removeAll(sse);
+      if (sses.isEmpty())
+      {
+        keymap.remove(value);
+      }
+    }
+  }
   else
   {
     complicatedListeners.removeAll(sse);
@@ -290,7 +351,7 @@ void ctkPluginFrameworkListeners::checkSimple(const ctkServiceSlotEntry& sse)
         }
       }
     }
-    else
+    else if (!checkFiltered(sse))
     {
       if (pluginFw->debug.ldap)
       {
@@ -301,6 +362,43 @@ void ctkPluginFrameworkListeners::checkSimple(const ctkServiceSlotEntry& sse)
   }
 }
 
+//----------------------------------------------------------------------------
+bool ctkPluginFrameworkListeners::checkFiltered(const ctkServiceSlotEntry& sse)
+{
+  // Use the key with the fewest required values
+  int best = -1;
+  QSet<QString> bestValues;
+  for (int i = 0; i < filteredServiceKeys.size(); ++i)
+  {
+    QSet<QString> values;
+    if (sse.getLDAPExpr().getMatchedValues(filteredServiceKeys[i], values) &&
+        (best < 0 || values.size() < bestValues.size()))
+    {
+      best = i;
+      bestValues = values;
+    }
+  }
+  if (best < 0)
+  {
+    return false;
+  }
+
+  ctkServiceSlotEntry entry(sse);
+  entry.setFilteredKey(best);
+  entry.getFilteredValues() = bestValues.toList();
+  foreach (const QString& value, bestValues)
+  {
+    filteredCache[best][value].push_back(entry);
+  }
+
+  if (pluginFw->debug.ldap)
+  {
+    qDebug() << "## DEBUG: Filter" << sse.getFilter() << "indexed by"
+             << filteredServiceKeys[best] << bestValues.size() << "values";
+  }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 void ctkPluginFrameworkListeners::addToSet(QSet<ctkServiceSlotEntry>& set,
                                            int cache_ix, const QString& val)
@@ -325,3 +423,39 @@ void ctkPluginFrameworkListeners::addToSet(QSet<ctkServiceSlotEntry>& set,
     }
   }
 }
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkListeners::addFilteredCandidates(QSet<ctkServiceSlotEntry>& candidates,
+                                                        int key_ix, const QVariant& value)
+{
+  const QHash<QString, QList<ctkServiceSlotEntry> >& keymap = filteredCache[key_ix];
+  if (value.type() == QVariant::String || value.type() == QVariant::StringList ||
+      key_ix == SERVICE_ID_IX)
+  {
+    QStringList values = key_ix == SERVICE_ID_IX ? QStringList(QString::number(value.toLongLong()))
+                                                 : value.toStringList();
+    foreach (const QString& v, values)
+    {
+      QHash<QString, QList<ctkServiceSlotEntry> >::const_iterator it = keymap.find(v);
+      if (it != keymap.end())
+      {
+        foreach (const ctkServiceSlotEntry& sse, it.value())
+        {
+          candidates.insert(sse);
+        }
+      }
+    }
+  }
+  else
+  {
+    // The value is compared to the filter values according to its type,
+    // all the listeners indexed by this key may match.
+    foreach (const QList<ctkServiceSlotEntry>& sses, keymap)
+    {
+      foreach (const ctkServiceSlotEntry& sse, sses)
+      {
+        candidates.insert(sse);
+      }
+    }
+  }
+}
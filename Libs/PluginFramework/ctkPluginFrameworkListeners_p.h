@@ -45,6 +45,12 @@ public:
 
   ctkPluginFrameworkListeners(ctkPluginFrameworkContext* pluginFw);
 
+  /**
+   * Read the indexed service property keys from the framework properties.
+   * Called by ctkPluginFrameworkContext::init(), when no slot is connected.
+   */
+  void init();
+
   /**
    * Add a slot receiving service envents with filter to the current framework.
    * If no filter is wanted, call with a null filter.
@@ -124,6 +130,18 @@ private:
   // Service listeners with "simple" filters are cached
   QList<QHash<QString, QList<ctkServiceSlotEntry> > > cache;
 
+  /**
+   * Lower case keys of the service properties used to index the
+   * listeners whose filter is not simple: the keys of the simple filter
+   * cache and the keys given by
+   * ctkPluginConstants::FRAMEWORK_SERVICE_INDEXED_PROPERTIES.
+   */
+  QStringList filteredServiceKeys;
+
+  // Service listeners with filters requiring a property value, indexed
+  // by property key index and value
+  QList<QHash<QString, QList<ctkServiceSlotEntry> > > filteredCache;
+
   QSet<ctkServiceSlotEntry> serviceSet;
 
   ctkPluginFrameworkContext* pluginFw;
@@ -140,11 +158,27 @@ private:
    */
   void checkSimple(const ctkServiceSlotEntry& sse);
 
+  /**
+   * Checks if the specified service slot's filter requires one of the
+   * properties in filteredServiceKeys to have given values, and if so
+   * adds it to the filtered listener index.
+   *
+   * @return <code>true</code> if the service slot was indexed.
+   */
+  bool checkFiltered(const ctkServiceSlotEntry& sse);
+
   /**
    * Add all members of the specified list to the specified set.
    */
   void addToSet(QSet<ctkServiceSlotEntry>& set, int cache_ix, const QString& val);
 
+  /**
+   * Add the listeners of the filtered listener index which may match
+   * the given value of the property key at index key_ix.
+   */
+  void addFilteredCandidates(QSet<ctkServiceSlotEntry>& candidates, int key_ix,
+                             const QVariant& value);
+
   /**
    * The unsynchronized version of removeServiceSlot().
    */
@@ -0,0 +1,226 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkPluginFrameworkTracer_p.h"
+
+#include "ctkPlugin.h"
+#include "ctkPluginConstants.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include <QThread>
+
+//----------------------------------------------------------------------------
+static QString ctkTraceJsonString(const QString& str)
+{
+  QString res("\"");
+  res.reserve(str.size() + 2);
+  for (int i = 0; i < str.size(); ++i)
+  {
+    const QChar c = str.at(i);
+    switch (c.unicode())
+    {
+    case '"': res += "\\\""; break;
+    case '\\': res += "\\\\"; break;
+    case '\n': res += "\\n"; break;
+    case '\r': res += "\\r"; break;
+    case '\t': res += "\\t"; break;
+    default:
+      if (c.unicode() < 0x20)
+      {
+        res += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+      }
+      else
+      {
+        res += c;
+      }
+    }
+  }
+  res += '"';
+  return res;
+}
+
+//----------------------------------------------------------------------------
+ctkPluginFrameworkTracer::Event::Event()
+  : category(0), name(0), begin(0), duration(0), thread(0)
+{
+}
+
+//----------------------------------------------------------------------------
+ctkPluginFrameworkTracer::ctkPluginFrameworkTracer(const ctkProperties& props)
+  : enabled(false), next(0), full(false)
+{
+  traceFile = props.value(ctkPluginConstants::FRAMEWORK_TRACE_FILE).toString();
+  enabled = props.value(ctkPluginConstants::FRAMEWORK_TRACE).toBool() || !traceFile.isEmpty();
+  if (enabled)
+  {
+    bool ok = false;
+    int size = props.value(ctkPluginConstants::FRAMEWORK_TRACE_BUFFER_SIZE).toInt(&ok);
+    buffer.resize(ok && size > 0 ? size : 65536);
+  }
+  clock.start();
+}
+
+//----------------------------------------------------------------------------
+bool ctkPluginFrameworkTracer::isEnabled() const
+{
+  return enabled;
+}
+
+//----------------------------------------------------------------------------
+qint64 ctkPluginFrameworkTracer::now() const
+{
+  return clock.elapsedMicro();
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkTracer::addSpan(const char* category, const char* name,
+                                       const QString& target, qint64 begin)
+{
+  if (!enabled) return;
+
+  Event event;
+  event.category = category;
+  event.name = name;
+  event.target = target;
+  event.begin = begin;
+  event.duration = now() - begin;
+  event.thread = QThread::currentThreadId();
+
+  QMutexLocker l(&lock);
+  buffer[next] = event;
+  if (++next == buffer.size())
+  {
+    next = 0;
+    full = true;
+  }
+}
+
+//----------------------------------------------------------------------------
+QList<ctkPluginFrameworkTracer::Event> ctkPluginFrameworkTracer::getEvents() const
+{
+  QMutexLocker l(&lock);
+  QList<Event> events;
+  if (full)
+  {
+    for (int i = next; i < buffer.size(); ++i)
+    {
+      events.push_back(buffer[i]);
+    }
+  }
+  for (int i = 0; i < next; ++i)
+  {
+    events.push_back(buffer[i]);
+  }
+  return events;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkTracer::clear()
+{
+  QMutexLocker l(&lock);
+  next = 0;
+  full = false;
+}
+
+//----------------------------------------------------------------------------
+QString ctkPluginFrameworkTracer::getTraceFile() const
+{
+  return traceFile;
+}
+
+//----------------------------------------------------------------------------
+bool ctkPluginFrameworkTracer::exportTrace(QIODevice* device) const
+{
+  QList<Event> events = getEvents();
+  const qint64 pid = QCoreApplication::applicationPid();
+
+  QTextStream out(device);
+  out.setCodec("UTF-8");
+  out << "{\"traceEvents\":[\n";
+  out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+      << ",\"args\":{\"name\":\"ctkPluginFramework\"}}";
+  foreach(const Event& event, events)
+  {
+    out << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+        << "\",\"ph\":\"X\",\"ts\":" << event.begin << ",\"dur\":" << event.duration
+        << ",\"pid\":" << pid << ",\"tid\":" << reinterpret_cast<quintptr>(event.thread);
+    if (!event.target.isEmpty())
+    {
+      out << ",\"args\":{\"target\":" << ctkTraceJsonString(event.target) << "}";
+    }
+    out << "}";
+  }
+  out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  out.flush();
+
+  return out.status() == QTextStream::Ok;
+}
+
+//----------------------------------------------------------------------------
+bool ctkPluginFrameworkTracer::exportTrace(const QString& fileName) const
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    return false;
+  }
+  return exportTrace(&file);
+}
+
+//----------------------------------------------------------------------------
+ctkPluginFrameworkTraceSpan::ctkPluginFrameworkTraceSpan(ctkPluginFrameworkTracer& tracer,
+                                                         const char* category, const char* name,
+                                                         const QString& target)
+  : tracer(tracer), category(category), name(name), begin(0)
+{
+  if (tracer.isEnabled())
+  {
+    this->target = target;
+    begin = tracer.now();
+  }
+}
+
+//----------------------------------------------------------------------------
+ctkPluginFrameworkTraceSpan::ctkPluginFrameworkTraceSpan(ctkPluginFrameworkTracer& tracer,
+                                                         const char* category, const char* name,
+                                                         const QSharedPointer<ctkPlugin>& plugin)
+  : tracer(tracer), category(category), name(name), begin(0)
+{
+  if (tracer.isEnabled())
+  {
+    if (plugin)
+    {
+      target = plugin->getSymbolicName();
+    }
+    begin = tracer.now();
+  }
+}
+
+//----------------------------------------------------------------------------
+ctkPluginFrameworkTraceSpan::~ctkPluginFrameworkTraceSpan()
+{
+  if (tracer.isEnabled())
+  {
+    tracer.addSpan(category, name, target, begin);
+  }
+}
@@ -0,0 +1,156 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKPLUGINFRAMEWORKTRACER_P_H
+#define CTKPLUGINFRAMEWORKTRACER_P_H
+
+#include "ctkPluginFramework_global.h"
+
+#include <ctkHighPrecisionTimer.h>
+
+#include <QMutex>
+#include <QSharedPointer>
+#include <QVector>
+
+class QIODevice;
+
+class ctkPlugin;
+
+/**
+ * \ingroup PluginFramework
+ *
+ * Records the time spans of the framework activity in a fixed size ring
+ * buffer and exports them in the Chrome trace event format, which can be
+ * loaded in chrome://tracing or Perfetto.
+ *
+ * Tracing is enabled by the ctkPluginConstants::FRAMEWORK_TRACE and
+ * ctkPluginConstants::FRAMEWORK_TRACE_FILE framework properties. When it
+ * is disabled, recording a span only costs a boolean test.
+ *
+ * @remarks This class is thread safe.
+ */
+class ctkPluginFrameworkTracer
+{
+
+public:
+
+  /**
+   * A recorded span. Times are in microseconds, relative to the
+   * creation of the tracer.
+   */
+  struct Event
+  {
+    Event();
+
+    const char* category;
+    const char* name;
+    /** What the span applies to, for example a plugin symbolic name */
+    QString target;
+    qint64 begin;
+    qint64 duration;
+    Qt::HANDLE thread;
+  };
+
+  ctkPluginFrameworkTracer(const ctkProperties& props);
+
+  bool isEnabled() const;
+
+  /**
+   * Current time in microseconds, on the clock of the recorded spans.
+   */
+  qint64 now() const;
+
+  /**
+   * Record a span which began at the given time and ends now, in the
+   * current thread. The category and name must be string literals.
+   */
+  void addSpan(const char* category, const char* name, const QString& target, qint64 begin);
+
+  /**
+   * Get the recorded spans, from the oldest to the most recent.
+   */
+  QList<Event> getEvents() const;
+
+  void clear();
+
+  /**
+   * Get the file the spans are exported to on shutdown, as
+   * specified by the framework properties.
+   */
+  QString getTraceFile() const;
+
+  /**
+   * Write the recorded spans as a Chrome trace event JSON document.
+   *
+   * @return <code>false</code> if the device could not be written.
+   */
+  bool exportTrace(QIODevice* device) const;
+
+  bool exportTrace(const QString& fileName) const;
+
+private:
+
+  bool enabled;
+  QString traceFile;
+
+  mutable QMutex lock;
+  QVector<Event> buffer;
+  int next;
+  bool full;
+
+  mutable ctkHighPrecisionTimer clock;
+};
+
+/**
+ * \ingroup PluginFramework
+ *
+ * Records the span of its lifetime with a ctkPluginFrameworkTracer.
+ *
+ * A target which has to be computed should only be computed if the tracer
+ * is enabled, for example
+ * <code>tracer.isEnabled() ? QString::number(level) : QString()</code>.
+ */
+class ctkPluginFrameworkTraceSpan
+{
+
+public:
+
+  ctkPluginFrameworkTraceSpan(ctkPluginFrameworkTracer& tracer, const char* category,
+                              const char* name, const QString& target = QString());
+
+  /**
+   * Use the symbolic name of the plugin as the target of the span.
+   */
+  ctkPluginFrameworkTraceSpan(ctkPluginFrameworkTracer& tracer, const char* category,
+                              const char* name, const QSharedPointer<ctkPlugin>& plugin);
+
+  ~ctkPluginFrameworkTraceSpan();
+
+private:
+
+  ctkPluginFrameworkTracer& tracer;
+  const char* category;
+  const char* name;
+  QString target;
+  qint64 begin;
+};
+
+#endif // CTKPLUGINFRAMEWORKTRACER_P_H
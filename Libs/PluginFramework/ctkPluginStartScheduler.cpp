@@ -0,0 +1,488 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkPluginStartScheduler_p.h"
+
+#include "ctkPlugin_p.h"
+#include "ctkPluginArchive_p.h"
+#include "ctkPluginConstants.h"
+#include "ctkPluginException.h"
+#include "ctkPluginFrameworkContext_p.h"
+#include "ctkPlugins_p.h"
+#include "ctkRequirePlugin_p.h"
+
+#include <ctkHighPrecisionTimer.h>
+
+#include <QDebug>
+#include <QMap>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <stdexcept>
+
+//----------------------------------------------------------------------------
+struct ctkPluginStartScheduler::Node
+{
+  Node(ctkPlugin* plugin, ctkPluginPrivate* pp, const ctkPlugin::StartOptions& options)
+    : plugin(plugin), pp(pp), options(options), assigned(false), started(false), finished(false)
+    , activate(true), mainThread(false), required(false), unfinishedRequirements(0), error(0)
+  {
+    timing.pluginId = pp->id;
+    timing.symbolicName = pp->symbolicName;
+    timing.startLevel = pp->getStartLevel();
+  }
+
+  ~Node()
+  {
+    delete error;
+  }
+
+  ctkPlugin* plugin;
+  ctkPluginPrivate* pp;
+  ctkPlugin::StartOptions options;
+
+  /** True if the node was added to the nodes of a start level */
+  bool assigned;
+  bool started;
+  bool finished;
+
+  /** True if starting the plugin runs its activator */
+  bool activate;
+  bool mainThread;
+
+  /** True if the plugin is required by another node */
+  bool required;
+  int unfinishedRequirements;
+  QList<Node*> dependents;
+  QString failedRequirement;
+
+  ctkException* error;
+  Timing timing;
+};
+
+//----------------------------------------------------------------------------
+class ctkPluginStartScheduler::Task : public QRunnable
+{
+public:
+
+  Task(ctkPluginStartScheduler* scheduler, Node* node)
+    : scheduler(scheduler), node(node)
+  {
+  }
+
+  void run()
+  {
+    scheduler->run(node);
+  }
+
+private:
+
+  ctkPluginStartScheduler* scheduler;
+  Node* node;
+};
+
+//----------------------------------------------------------------------------
+ctkPluginStartScheduler::Timing::Timing()
+  : pluginId(-1), startLevel(0), resolveTime(0), loadTime(0), activateTime(0), thread(0)
+{
+}
+
+//----------------------------------------------------------------------------
+ctkPluginStartScheduler::ctkPluginStartScheduler(ctkPluginFrameworkContext* fwCtx)
+  : fwCtx(fwCtx), threadCount(0), threadPool(0), runningTasks(0), mainThread(QThread::currentThread())
+{
+  threadCount = fwCtx->props.value(ctkPluginConstants::FRAMEWORK_PLUGIN_ACTIVATION_THREADS).toInt();
+}
+
+//----------------------------------------------------------------------------
+ctkPluginStartScheduler::~ctkPluginStartScheduler()
+{
+  qDeleteAll(nodes);
+}
+
+//----------------------------------------------------------------------------
+int ctkPluginStartScheduler::getThreadCount() const
+{
+  return threadCount;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartScheduler::addPlugin(ctkPlugin* plugin, const ctkPlugin::StartOptions& options)
+{
+  if (nodeByPlugin.contains(plugin)) return;
+
+  Node* node = new Node(plugin, plugin->d_func(), options);
+  nodes.push_back(node);
+  nodeByPlugin.insert(plugin, node);
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartScheduler::start()
+{
+  timings.clear();
+
+  {
+    ctkPluginFrameworkTraceSpan span(fwCtx->tracer, "framework", "startPlugins");
+    if (threadCount > 1)
+    {
+      startConcurrently();
+    }
+    else
+    {
+      startSequentially();
+    }
+  }
+
+  if (fwCtx->debug.startup)
+  {
+    reportTimings();
+  }
+}
+
+//----------------------------------------------------------------------------
+QList<ctkPluginStartScheduler::Timing> ctkPluginStartScheduler::getTimings() const
+{
+  return timings;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartScheduler::startSequentially()
+{
+  foreach(Node* node, nodes)
+  {
+    try
+    {
+      resolve(node);
+      activate(node);
+    }
+    catch (const ctkPluginException& pe)
+    {
+      fwCtx->listeners.frameworkError(node->pp->q_func(), pe);
+    }
+    node->finished = true;
+    timings.push_back(node->timing);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartScheduler::startConcurrently()
+{
+  // Resolve first, in this thread, since resolving is not thread-safe
+  foreach(Node* node, nodes)
+  {
+    resolve(node);
+  }
+
+  // Group the plugins by start level, keeping the order they were added in
+  QMap<int, QList<Node*> > levels;
+  foreach(Node* node, nodes)
+  {
+    levels[node->timing.startLevel].push_back(node);
+  }
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(threadCount);
+  threadPool = &pool;
+
+  QMapIterator<int, QList<Node*> > levelIter(levels);
+  while (levelIter.hasNext())
+  {
+    QList<Node*> levelNodes;
+    foreach(Node* node, levelIter.next().value())
+    {
+      if (!node->assigned)
+      {
+        node->assigned = true;
+        levelNodes.push_back(node);
+      }
+    }
+
+    // levelNodes grows while the required plugins are added
+    for (int i = 0; i < levelNodes.size(); ++i)
+    {
+      addRequiredNodes(levelNodes[i], levelNodes);
+    }
+
+    ctkPluginFrameworkTraceSpan span(fwCtx->tracer, "framework", "startLevel",
+                                     fwCtx->tracer.isEnabled() ? QString::number(levelIter.key()) : QString());
+    startLevel(levelNodes);
+  }
+
+  threadPool = 0;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartScheduler::addRequiredNodes(Node* node, QList<Node*>& levelNodes)
+{
+  foreach(ctkRequirePlugin* pr, node->pp->require)
+  {
+    // Same choice as ctkPluginPrivate::startDependencies(). If no plugin
+    // matches, starting the node fails or the requirement is optional.
+    QList<ctkPlugin*> pl = fwCtx->plugins->getPlugins(pr->name, pr->pluginRange);
+    if (pl.isEmpty()) continue;
+
+    ctkPlugin* requiredPlugin = pl.front();
+    Node* required = nodeByPlugin.value(requiredPlugin);
+    if (required == 0)
+    {
+      if (requiredPlugin->getState() == ctkPlugin::ACTIVE) continue;
+
+      // Required plugins are activated without changing their autostart setting
+      required = new Node(requiredPlugin, requiredPlugin->d_func(), ctkPlugin::START_TRANSIENT);
+      nodes.push_back(required);
+      nodeByPlugin.insert(requiredPlugin, required);
+      resolve(required);
+    }
+    if (required == node) continue;
+
+    required->required = true;
+    if (required->finished)
+    {
+      // Started with a lower start level
+      if (required->error && node->failedRequirement.isEmpty())
+      {
+        node->failedRequirement = required->timing.symbolicName;
+      }
+      continue;
+    }
+
+    if (!required->assigned)
+    {
+      required->assigned = true;
+      levelNodes.push_back(required);
+    }
+    required->dependents.push_back(node);
+    ++node->unfinishedRequirements;
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartScheduler::startLevel(const QList<Node*>& levelNodes)
+{
+  QList<Node*> ready;
+  foreach(Node* node, levelNodes)
+  {
+    // A lazily activated plugin is only marked as STARTING, unless
+    // another plugin requires it.
+    node->activate = !(node->options & ctkPlugin::START_ACTIVATION_POLICY) ||
+        node->pp->eagerActivation || node->required;
+    node->mainThread = node->pp->archive &&
+        node->pp->archive->getAttribute(ctkPluginConstants::PLUGIN_ACTIVATIONTHREAD) == ctkPluginConstants::ACTIVATIONTHREAD_MAIN;
+    if (node->unfinishedRequirements == 0)
+    {
+      ready.push_back(node);
+    }
+  }
+
+  int pending = levelNodes.size();
+  while (pending > 0)
+  {
+    while (!ready.isEmpty())
+    {
+      Node* node = ready.takeFirst();
+      node->started = true;
+      if (!node->failedRequirement.isEmpty() && node->activate)
+      {
+        node->error = new ctkPluginException(QString("Required plugin %1 failed to start").arg(node->failedRequirement),
+                                             ctkPluginException::ACTIVATOR_ERROR);
+        finish(node, ready);
+        --pending;
+      }
+      else if (!node->activate || node->pp->state == ctkPlugin::INSTALLED)
+      {
+        // Nothing to load, or the plugin could not be resolved and
+        // start() only reports the resolve failure.
+        tryActivate(node);
+        finish(node, ready);
+        --pending;
+      }
+      else
+      {
+        ++runningTasks;
+        threadPool->start(new Task(this, node));
+      }
+    }
+
+    if (pending == 0) break;
+
+    if (runningTasks == 0)
+    {
+      // The remaining plugins require each other. Start them in the
+      // order they were added, the activation of a plugin starting
+      // the plugins it requires as in the sequential case.
+      foreach(Node* node, levelNodes)
+      {
+        if (!node->started)
+        {
+          node->unfinishedRequirements = 0;
+          ready.push_back(node);
+          break;
+        }
+      }
+      continue;
+    }
+
+    Node* node = 0;
+    {
+      QMutexLocker l(&lock);
+      while (finishedNodes.isEmpty())
+      {
+        taskFinished.wait(&lock);
+      }
+      node = finishedNodes.dequeue();
+    }
+    --runningTasks;
+
+    if (node->mainThread)
+    {
+      // The library was loaded by the task
+      tryActivate(node);
+    }
+    finish(node, ready);
+    --pending;
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartScheduler::run(Node* node)
+{
+  load(node);
+  if (!node->mainThread)
+  {
+    tryActivate(node);
+
+    // Objects created by the activator live in this thread, which has
+    // no event loop. At least give the activator back to the main thread.
+    QObject* instance = node->pp->pluginLoader.instance();
+    if (instance && instance->thread() == QThread::currentThread())
+    {
+      instance->moveToThread(mainThread);
+    }
+  }
+
+  QMutexLocker l(&lock);
+  finishedNodes.enqueue(node);
+  taskFinished.wakeOne();
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartScheduler::resolve(Node* node)
+{
+  ctkHighPrecisionTimer timer;
+  timer.start();
+  node->pp->getUpdatedState();
+  node->timing.resolveTime = timer.elapsedMicro();
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartScheduler::load(Node* node)
+{
+  // A failure is reported by the activation
+  ctkPluginFrameworkTraceSpan span(fwCtx->tracer, "plugin", "load", node->timing.symbolicName);
+  ctkHighPrecisionTimer timer;
+  timer.start();
+  node->pp->pluginLoader.load();
+  node->timing.loadTime = timer.elapsedMicro();
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartScheduler::activate(Node* node)
+{
+  ctkHighPrecisionTimer timer;
+  timer.start();
+  node->timing.thread = QThread::currentThreadId();
+  try
+  {
+    node->plugin->start(node->options);
+    if (node->required && node->plugin->getState() != ctkPlugin::ACTIVE)
+    {
+      // Activate now what ctkPluginPrivate::startDependencies() would
+      // activate when starting the plugins requiring it.
+      node->plugin->start(ctkPlugin::START_TRANSIENT);
+    }
+  }
+  catch (...)
+  {
+    node->timing.activateTime = timer.elapsedMicro();
+    throw;
+  }
+  node->timing.activateTime = timer.elapsedMicro();
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartScheduler::tryActivate(Node* node)
+{
+  try
+  {
+    activate(node);
+  }
+  catch (const ctkException& e)
+  {
+    node->error = e.clone();
+  }
+  catch (const std::exception& e)
+  {
+    node->error = new ctkPluginException(QString("ctkPlugin start failed: ") + e.what(),
+                                         ctkPluginException::ACTIVATOR_ERROR);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartScheduler::finish(Node* node, QList<Node*>& ready)
+{
+  node->finished = true;
+  timings.push_back(node->timing);
+
+  if (node->error)
+  {
+    fwCtx->listeners.frameworkError(node->pp->q_func(), *node->error);
+  }
+
+  foreach(Node* dependent, node->dependents)
+  {
+    if (node->error && dependent->failedRequirement.isEmpty())
+    {
+      dependent->failedRequirement = node->timing.symbolicName;
+    }
+    if (--dependent->unfinishedRequirements == 0 && !dependent->started)
+    {
+      ready.push_back(dependent);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartScheduler::reportTimings() const
+{
+  qint64 total = 0;
+  foreach(const Timing& timing, timings)
+  {
+    qDebug() << "Started plugin #" << timing.pluginId << timing.symbolicName
+             << "start level" << timing.startLevel
+             << "resolve" << timing.resolveTime << "us,"
+             << "load" << timing.loadTime << "us,"
+             << "activate" << timing.activateTime << "us,"
+             << "thread" << timing.thread;
+    total += timing.resolveTime + timing.loadTime + timing.activateTime;
+  }
+  qDebug() << "Started" << timings.size() << "plugins with" << (threadCount > 1 ? threadCount : 1)
+           << "threads, cumulated start time" << total << "us";
+}
@@ -0,0 +1,166 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKPLUGINSTARTSCHEDULER_P_H
+#define CTKPLUGINSTARTSCHEDULER_P_H
+
+#include "ctkPlugin.h"
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+// CTK class forward declarations
+class ctkException;
+class ctkPluginFrameworkContext;
+class ctkPluginPrivate;
+
+/**
+ * \ingroup PluginFramework
+ *
+ * Starts a set of plugins, one start level after the other.
+ *
+ * If the framework property
+ * ctkPluginConstants::FRAMEWORK_PLUGIN_ACTIVATION_THREADS is greater than
+ * one, the plugins of a start level are started concurrently on a thread
+ * pool. The plugins required by a plugin (Require-Plugin header) are
+ * added to the set if needed and are always activated before it. The
+ * plugin libraries are loaded on the thread pool, the activators of plugins
+ * declaring ctkPluginConstants::ACTIVATIONTHREAD_MAIN are then run in the
+ * thread calling start(). Otherwise, the plugins are started one after the
+ * other in the order they were added.
+ *
+ * Objects created by the activators run on the thread pool keep the affinity
+ * of a pool thread, which has no event loop. Only the activator instance
+ * (pluginLoader.instance()) is moved to the thread calling start().
+ *
+ * The plugin start failures are reported as framework errors.
+ */
+class ctkPluginStartScheduler
+{
+
+public:
+
+  /**
+   * Durations, in microseconds, of the start steps of a plugin.
+   */
+  struct Timing
+  {
+    Timing();
+
+    long pluginId;
+    QString symbolicName;
+    int startLevel;
+    qint64 resolveTime;
+    qint64 loadTime;
+    qint64 activateTime;
+    /** Thread the activator was run in */
+    Qt::HANDLE thread;
+  };
+
+  ctkPluginStartScheduler(ctkPluginFrameworkContext* fwCtx);
+
+  ~ctkPluginStartScheduler();
+
+  /**
+   * Number of threads used to start the plugins, as specified by
+   * the framework properties.
+   */
+  int getThreadCount() const;
+
+  /**
+   * Add a plugin to start with the given options.
+   */
+  void addPlugin(ctkPlugin* plugin, const ctkPlugin::StartOptions& options);
+
+  /**
+   * Start all the added plugins and return when they are all
+   * started or failed to start.
+   */
+  void start();
+
+  /**
+   * Get the timings of the plugins started by the last call to start(),
+   * in the order their start was finished.
+   */
+  QList<Timing> getTimings() const;
+
+private:
+
+  struct Node;
+  class Task;
+
+  void startSequentially();
+
+  void startConcurrently();
+
+  /**
+   * Add the nodes of the plugins required by the given node and
+   * not active yet to the nodes of the current start level.
+   */
+  void addRequiredNodes(Node* node, QList<Node*>& levelNodes);
+
+  void startLevel(const QList<Node*>& levelNodes);
+
+  /**
+   * Called by the tasks of the thread pool.
+   */
+  void run(Node* node);
+
+  void resolve(Node* node);
+
+  void load(Node* node);
+
+  void activate(Node* node);
+
+  /**
+   * Activates the node, keeping a copy of the exception on failure.
+   */
+  void tryActivate(Node* node);
+
+  void finish(Node* node, QList<Node*>& ready);
+
+  void reportTimings() const;
+
+  ctkPluginFrameworkContext* fwCtx;
+
+  int threadCount;
+
+  QList<Node*> nodes;
+  QHash<ctkPlugin*, Node*> nodeByPlugin;
+
+  QList<Timing> timings;
+
+  QThreadPool* threadPool;
+
+  QMutex lock;
+  QWaitCondition taskFinished;
+  QQueue<Node*> finishedNodes;
+  int runningTasks;
+
+  QThread* mainThread;
+};
+
+#endif // CTKPLUGINSTARTSCHEDULER_P_H
@@ -36,6 +36,8 @@
 //database table names
 #define PLUGINS_TABLE "Plugins"
 #define PLUGIN_RESOURCES_TABLE "PluginResources"
+#define PLUGIN_MANIFESTS_TABLE "PluginManifests"
+#define PLUGIN_RESOURCE_INDEX_TABLE "PluginResourceIndex"
 
 //----------------------------------------------------------------------------
 enum TBindIndexes
@@ -47,16 +49,21 @@ enum TBindIndexes
   EBindIndex4,
   EBindIndex5,
   EBindIndex6,
-  EBindIndex7
+  EBindIndex7,
+  EBindIndex8
 };
 
 //----------------------------------------------------------------------------
 ctkPluginStorageSQL::ctkPluginStorageSQL(ctkPluginFrameworkContext *framework)
   : m_isDatabaseOpen(false)
   , m_inTransaction(false)
+  , m_lazyResources(false)
   , m_framework(framework)
   , m_nextFreeId(-1)
 {
+  m_lazyResources = framework->props.value(ctkPluginConstants::FRAMEWORK_PLUGIN_RESOURCES).toString()
+      == ctkPluginConstants::FRAMEWORK_PLUGIN_RESOURCES_LAZY;
+
   // See if we have a storage database
   m_databasePath = ctkPluginFrameworkUtil::getFileStorage(framework, "").absoluteFilePath("plugins.db");
 
@@ -170,6 +177,10 @@ void ctkPluginStorageSQL::open()
     }
   }
 
+  // The lazy resource tables were added later, create them without
+  // dropping the data of existing databases
+  createLazyResourceTables();
+
   // silently remove any plugin marked as uninstalled
   cleanupDB();
 
@@ -415,33 +426,46 @@ void ctkPluginStorageSQL::insertArchive(QSharedPointer<ctkPluginArchiveSQL> pa,
   QFileInfo fileInfo(pa->getLibLocation());
   QString libTimestamp = getStringFromQDateTime(fileInfo.lastModified());
 
-  QString resourcePrefix = fileInfo.baseName();
-  if (resourcePrefix.startsWith("lib"))
+  QString resourcePrefix = getResourcePrefix(pa->getLibLocation());
+
+  // In lazy mode, avoid loading the plugin if a copy of its manifest
+  // is available. Otherwise, load the plugin and read the resources
+
+  QByteArray manifest;
+  if (m_lazyResources)
   {
-    resourcePrefix = resourcePrefix.mid(3);
+    manifest = readManifestFile(pa->getLibLocation());
   }
-  resourcePrefix.replace("_", ".");
-  resourcePrefix = QString(":/") + resourcePrefix + "/";
-
-  // Load the plugin and cache the resources
 
   QPluginLoader pluginLoader;
-  pluginLoader.setLoadHints(getPluginLoadHints());
-  pluginLoader.setFileName(pa->getLibLocation());
-  if (!pluginLoader.load())
+  bool pluginLoaded = false;
+  if (manifest.isEmpty())
   {
-    ctkPluginException exc(QString("The plugin \"%1\" could not be loaded: %2").arg(pa->getLibLocation())
-                           .arg(pluginLoader.errorString()));
-    throw exc;
-  }
+    pluginLoader.setLoadHints(getPluginLoadHints());
+    pluginLoader.setFileName(pa->getLibLocation());
+    ctkPluginFrameworkTraceSpan span(m_framework->tracer, "storage", "load",
+                                     m_framework->tracer.isEnabled() ? pa->getLibLocation() : QString());
+    if (!pluginLoader.load())
+    {
+      ctkPluginException exc(QString("The plugin \"%1\" could not be loaded: %2").arg(pa->getLibLocation())
+                             .arg(pluginLoader.errorString()));
+      throw exc;
+    }
+    pluginLoaded = true;
 
-  QFile manifestResource(resourcePrefix + "META-INF/MANIFEST.MF");
-  manifestResource.open(QIODevice::ReadOnly);
-  QByteArray manifest = manifestResource.readAll();
-  manifestResource.close();
+    QFile manifestResource(resourcePrefix + "META-INF/MANIFEST.MF");
+    manifestResource.open(QIODevice::ReadOnly);
+    manifest = manifestResource.readAll();
+    manifestResource.close();
+  }
 
   // Finally, complete the ctkPluginArchive information by reading the MANIFEST.MF resource
-  pa->readManifest(manifest);
+  {
+    ctkPluginFrameworkTraceSpan span(m_framework->tracer, "storage", "readManifest",
+                                     m_framework->tracer.isEnabled() ? pa->getLibLocation() : QString());
+    pa->readManifest(manifest);
+  }
+  pa->lazyResources = m_lazyResources;
 
   // Assemble the data for the sql records
 
@@ -467,28 +491,104 @@ void ctkPluginStorageSQL::insertArchive(QSharedPointer<ctkPluginArchiveSQL> pa,
 
   pa->key = query->lastInsertId().toInt();
 
-  // Write the plug-in resource data into the database
+  if (m_lazyResources)
+  {
+    // Only keep the manifest and, if the plugin was loaded, the resource paths
+    statement = "INSERT INTO " PLUGIN_MANIFESTS_TABLE " (K,Manifest) VALUES(?,?)";
+    bindValues.clear();
+    bindValues << pa->key;
+    bindValues << manifest;
+
+    executeQuery(query, statement, bindValues);
+
+    if (pluginLoaded)
+    {
+      insertResourceIndex(pa->key, resourcePrefix, query);
+    }
+  }
+  else
+  {
+    // Write the plug-in resource data into the database
+    foreach(const QString& resourcePath, getResourcePaths(resourcePrefix))
+    {
+      QFile resourceFile(resourcePrefix + resourcePath.mid(1));
+      resourceFile.open(QIODevice::ReadOnly);
+      QByteArray resourceData = resourceFile.readAll();
+      resourceFile.close();
+
+      statement = "INSERT INTO " PLUGIN_RESOURCES_TABLE " (K,ResourcePath,Resource) VALUES(?,?,?)";
+      bindValues.clear();
+      bindValues << pa->key;
+      bindValues << resourcePath;
+      bindValues << resourceData;
+
+      executeQuery(query, statement, bindValues);
+    }
+  }
+
+  if (pluginLoaded)
+  {
+    pluginLoader.unload();
+  }
+}
+
+//----------------------------------------------------------------------------
+QString ctkPluginStorageSQL::getResourcePrefix(const QString& libLocation)
+{
+  QString resourcePrefix = QFileInfo(libLocation).baseName();
+  if (resourcePrefix.startsWith("lib"))
+  {
+    resourcePrefix = resourcePrefix.mid(3);
+  }
+  resourcePrefix.replace("_", ".");
+  return QString(":/") + resourcePrefix + "/";
+}
+
+//----------------------------------------------------------------------------
+QStringList ctkPluginStorageSQL::getResourcePaths(const QString& resourcePrefix)
+{
+  QStringList resourcePaths;
   QDirIterator dirIter(resourcePrefix, QDirIterator::Subdirectories);
   while (dirIter.hasNext())
   {
     QString resourcePath = dirIter.next();
     if (QFileInfo(resourcePath).isDir()) continue;
 
-    QFile resourceFile(resourcePath);
-    resourceFile.open(QIODevice::ReadOnly);
-    QByteArray resourceData = resourceFile.readAll();
-    resourceFile.close();
+    resourcePaths << resourcePath.mid(resourcePrefix.size()-1);
+  }
+  return resourcePaths;
+}
 
-    statement = "INSERT INTO " PLUGIN_RESOURCES_TABLE " (K,ResourcePath,Resource) VALUES(?,?,?)";
-    bindValues.clear();
-    bindValues << pa->key;
-    bindValues << resourcePath.mid(resourcePrefix.size()-1);
-    bindValues << resourceData;
+//----------------------------------------------------------------------------
+QByteArray ctkPluginStorageSQL::readManifestFile(const QString& libLocation)
+{
+  QFileInfo libInfo(libLocation);
+  QFileInfo manifestInfo(libInfo.absoluteFilePath() + ".MF");
+  if (!manifestInfo.exists() || manifestInfo.lastModified() < libInfo.lastModified())
+  {
+    return QByteArray();
+  }
 
-    executeQuery(query, statement, bindValues);
+  QFile manifestFile(manifestInfo.absoluteFilePath());
+  if (!manifestFile.open(QIODevice::ReadOnly))
+  {
+    return QByteArray();
   }
+  return manifestFile.readAll();
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStorageSQL::insertResourceIndex(int key, const QString& resourcePrefix, QSqlQuery* query) const
+{
+  QString statement = "INSERT INTO " PLUGIN_RESOURCE_INDEX_TABLE " (K,ResourcePath) VALUES(?,?)";
+  foreach(const QString& resourcePath, getResourcePaths(resourcePrefix))
+  {
+    QList<QVariant> bindValues;
+    bindValues << key;
+    bindValues << resourcePath;
 
-  pluginLoader.unload();
+    executeQuery(query, statement, bindValues);
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -595,6 +695,8 @@ void ctkPluginStorageSQL::removeArchiveFromDB(ctkPluginArchiveSQL* pa, QSqlQuery
   bindValues.append(pa->key);
 
   executeQuery(query, statement, bindValues);
+
+  releaseResourceLibrary(pa->key);
 }
 
 QList<QSharedPointer<ctkPluginArchive> > ctkPluginStorageSQL::getAllPluginArchives() const
@@ -665,10 +767,61 @@ void ctkPluginStorageSQL::setAutostartSetting(int key, int autostart)
 
 //----------------------------------------------------------------------------
 QStringList ctkPluginStorageSQL::findResourcesPath(int archiveKey, const QString& path) const
+{
+  return findResourcesPath(PLUGIN_RESOURCES_TABLE, archiveKey, path);
+}
+
+//----------------------------------------------------------------------------
+QStringList ctkPluginStorageSQL::findIndexedResourcesPath(int archiveKey, const QString& libLocation,
+                                                          const QString& path) const
 {
   checkConnection();
 
-  QString statement = "SELECT SUBSTR(ResourcePath,?) FROM PluginResources WHERE K=? AND SUBSTR(ResourcePath,1,?)=?";
+  QSqlDatabase database = QSqlDatabase::database(m_connectionName);
+  QSqlQuery query(database);
+
+  QString statement = "SELECT 1 FROM " PLUGIN_RESOURCE_INDEX_TABLE " WHERE K=? LIMIT 1";
+  QList<QVariant> bindValues;
+  bindValues.append(archiveKey);
+
+  executeQuery(&query, statement, bindValues);
+  bool indexed = query.next();
+  query.finish();
+  query.clear();
+
+  if (!indexed)
+  {
+    // The plugin was installed without being loaded, create its
+    // resource index now. Every plugin has at least a MANIFEST.MF
+    // resource, so the index is never empty once it is created.
+    QMutexLocker lock(&m_resourceLibrariesLock);
+    if (getResourceLibrary(archiveKey, libLocation) == 0)
+    {
+      return QStringList();
+    }
+
+    beginTransaction(&query, Write);
+    try
+    {
+      insertResourceIndex(archiveKey, getResourcePrefix(libLocation), &query);
+    }
+    catch (...)
+    {
+      rollbackTransaction(&query);
+      throw;
+    }
+    commitTransaction(&query);
+  }
+
+  return findResourcesPath(PLUGIN_RESOURCE_INDEX_TABLE, archiveKey, path);
+}
+
+//----------------------------------------------------------------------------
+QStringList ctkPluginStorageSQL::findResourcesPath(const QString& table, int archiveKey, const QString& path) const
+{
+  checkConnection();
+
+  QString statement = QString("SELECT SUBSTR(ResourcePath,?) FROM %1 WHERE K=? AND SUBSTR(ResourcePath,1,?)=?").arg(table);
 
   QString resourcePath = path.startsWith('/') ? path : QString("/") + path;
   if (!resourcePath.endsWith('/'))
@@ -766,6 +919,16 @@ void ctkPluginStorageSQL::executeQuery(QSqlQuery *query, const QString &statemen
 //----------------------------------------------------------------------------
 void ctkPluginStorageSQL::close()
 {
+  {
+    QMutexLocker lock(&m_resourceLibrariesLock);
+    foreach(QLibrary* lib, m_resourceLibraries)
+    {
+      lib->unload();
+      delete lib;
+    }
+    m_resourceLibraries.clear();
+  }
+
   if (m_isDatabaseOpen)
   {
     QSqlDatabase database = QSqlDatabase::database(m_connectionName, false);
@@ -831,6 +994,55 @@ QByteArray ctkPluginStorageSQL::getPluginResource(int key, const QString& res) c
   return QByteArray();
 }
 
+//----------------------------------------------------------------------------
+QByteArray ctkPluginStorageSQL::getLibraryResource(int key, const QString& libLocation, const QString& res) const
+{
+  QMutexLocker lock(&m_resourceLibrariesLock);
+  if (getResourceLibrary(key, libLocation) == 0)
+  {
+    return QByteArray();
+  }
+
+  QString resourcePath = res.startsWith('/') ? res.mid(1) : res;
+  QFile resourceFile(getResourcePrefix(libLocation) + resourcePath);
+  if (!resourceFile.open(QIODevice::ReadOnly))
+  {
+    return QByteArray();
+  }
+  return resourceFile.readAll();
+}
+
+//----------------------------------------------------------------------------
+QLibrary* ctkPluginStorageSQL::getResourceLibrary(int key, const QString& libLocation) const
+{
+  QLibrary* lib = m_resourceLibraries.value(key);
+  if (lib == 0)
+  {
+    lib = new QLibrary(libLocation);
+    lib->setLoadHints(getPluginLoadHints());
+    if (!lib->load())
+    {
+      qWarning() << "Loading the resources of plugin" << libLocation << "failed:" << lib->errorString();
+      delete lib;
+      return 0;
+    }
+    m_resourceLibraries.insert(key, lib);
+  }
+  return lib;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStorageSQL::releaseResourceLibrary(int key)
+{
+  QMutexLocker lock(&m_resourceLibrariesLock);
+  QLibrary* lib = m_resourceLibraries.take(key);
+  if (lib != 0)
+  {
+    lib->unload();
+    delete lib;
+  }
+}
+
 //----------------------------------------------------------------------------
 void ctkPluginStorageSQL::createTables()
 {
@@ -889,6 +1101,37 @@ void ctkPluginStorageSQL::createTables()
 
 }
 
+//----------------------------------------------------------------------------
+void ctkPluginStorageSQL::createLazyResourceTables()
+{
+  QSqlDatabase database = QSqlDatabase::database(m_connectionName);
+  QSqlQuery query(database);
+
+  beginTransaction(&query, Write);
+
+  try
+  {
+    QString statement = "CREATE TABLE IF NOT EXISTS " PLUGIN_MANIFESTS_TABLE " ("
+                        "K INTEGER NOT NULL,"
+                        "Manifest BLOB NOT NULL,"
+                        "FOREIGN KEY(K) REFERENCES " PLUGINS_TABLE "(K) ON DELETE CASCADE)";
+    executeQuery(&query, statement);
+
+    statement = "CREATE TABLE IF NOT EXISTS " PLUGIN_RESOURCE_INDEX_TABLE " ("
+                "K INTEGER NOT NULL,"
+                "ResourcePath TEXT NOT NULL,"
+                "FOREIGN KEY(K) REFERENCES " PLUGINS_TABLE "(K) ON DELETE CASCADE)";
+    executeQuery(&query, statement);
+  }
+  catch (...)
+  {
+    rollbackTransaction(&query);
+    throw;
+  }
+
+  commitTransaction(&query);
+}
+
 //----------------------------------------------------------------------------
 bool ctkPluginStorageSQL::checkTables() const
 {
@@ -1005,7 +1248,7 @@ void ctkPluginStorageSQL::checkConnection() const
 }
 
 //----------------------------------------------------------------------------
-void ctkPluginStorageSQL::beginTransaction(QSqlQuery *query, TransactionType type)
+void ctkPluginStorageSQL::beginTransaction(QSqlQuery *query, TransactionType type) const
 {
   bool success;
   if (type == Read)
@@ -1033,7 +1276,7 @@ void ctkPluginStorageSQL::beginTransaction(QSqlQuery *query, TransactionType typ
 }
 
 //----------------------------------------------------------------------------
-void ctkPluginStorageSQL::commitTransaction(QSqlQuery *query)
+void ctkPluginStorageSQL::commitTransaction(QSqlQuery *query) const
 {
   Q_ASSERT(query != 0);
   query->finish();
@@ -1046,7 +1289,7 @@ void ctkPluginStorageSQL::commitTransaction(QSqlQuery *query)
 }
 
 //----------------------------------------------------------------------------
-void ctkPluginStorageSQL::rollbackTransaction(QSqlQuery *query)
+void ctkPluginStorageSQL::rollbackTransaction(QSqlQuery *query) const
 {
   Q_ASSERT(query !=0);
   query->finish();
@@ -1065,9 +1308,10 @@ void ctkPluginStorageSQL::restorePluginArchives()
   checkConnection();
 
   QSqlQuery query(QSqlDatabase::database(m_connectionName));
-  QString statement = "SELECT ID, Location, LocalPath, StartLevel, LastModified, AutoStart, K, MAX(Generation)"
-                      " FROM " PLUGINS_TABLE " WHERE StartLevel != -2 GROUP BY ID"
-                      " ORDER BY ID";
+  QString statement = "SELECT P.ID, P.Location, P.LocalPath, P.StartLevel, P.LastModified, P.AutoStart, P.K, MAX(P.Generation), M.Manifest"
+                      " FROM " PLUGINS_TABLE " P LEFT JOIN " PLUGIN_MANIFESTS_TABLE " M ON P.K=M.K"
+                      " WHERE P.StartLevel != -2 GROUP BY P.ID"
+                      " ORDER BY P.ID";
 
   executeQuery(&query, statement);
 
@@ -1092,7 +1336,13 @@ void ctkPluginStorageSQL::restorePluginArchives()
       QSharedPointer<ctkPluginArchiveSQL> pa(new ctkPluginArchiveSQL(this, location, localPath, id,
                                                                      startLevel, lastModified, autoStart));
       pa->key = query.value(EBindIndex6).toInt();
-      pa->readManifest();
+      // Plugins installed with lazy resources have their manifest in a separate table
+      const QVariant manifest = query.value(EBindIndex8);
+      pa->lazyResources = !manifest.isNull();
+      {
+        ctkPluginFrameworkTraceSpan span(m_framework->tracer, "storage", "readManifest", localPath);
+        pa->readManifest(pa->lazyResources ? manifest.toByteArray() : QByteArray());
+      }
       m_archives.append(pa);
     }
     catch (const ctkPluginException& exc)
@@ -157,6 +157,33 @@ public:
    */
   QStringList findResourcesPath(int archiveKey, const QString& path) const;
 
+  /**
+   * Get a Qt resource from a plugin library. The library is loaded the
+   * first time one of its resources is requested and stays loaded until
+   * the plugin archive is removed or the database is closed.
+   *
+   * @param key The database key of the plugin archive
+   * @param libLocation The path to the plugin library
+   * @param res The path to the resource in the plugin
+   * @return The byte array of the resource
+   */
+  QByteArray getLibraryResource(int key, const QString& libLocation, const QString& res) const;
+
+  /**
+   * Get a list of resource entries under the given path, using the resource
+   * index of a plugin archive whose resources are stored lazily. If the index
+   * was not created when the plugin was installed, the plugin library is
+   * loaded and the index is created first.
+   *
+   * @param archiveKey The database key of the plugin archive
+   * @param libLocation The path to the plugin library
+   * @param path A resource path relative to the plugin specific resource prefix.
+   * @return A QStringList containing the indexed resource entries.
+   *
+   * @throws ctkPluginDatabaseException
+   */
+  QStringList findIndexedResourcesPath(int archiveKey, const QString& libLocation, const QString& path) const;
+
   /**
    * Persist the start level
    *
@@ -247,6 +274,14 @@ private:
    * @throws ctkPluginDatabaseException
    */
   void createTables();
+
+  /**
+   * Helper method that creates the tables used by the lazy resource
+   * storage, if they do not exist yet.
+   *
+   * @throws ctkPluginDatabaseException
+   */
+  void createLazyResourceTables();
   bool dropTables();
 
   /**
@@ -284,6 +319,51 @@ private:
 
   void removeArchiveFromDB(ctkPluginArchiveSQL *pa, QSqlQuery *query);
 
+  /**
+   * Returns the prefix of the Qt resources of the given plugin library.
+   */
+  static QString getResourcePrefix(const QString& libLocation);
+
+  /**
+   * Returns the paths, relative to \a resourcePrefix, of all the files
+   * under the given resource prefix.
+   */
+  static QStringList getResourcePaths(const QString& resourcePrefix);
+
+  /**
+   * Reads the copy of the manifest stored next to the plugin library.
+   * Returns an empty byte array if there is no such file or if it is
+   * older than the library.
+   */
+  static QByteArray readManifestFile(const QString& libLocation);
+
+  /**
+   * Inserts the paths of the Qt resources of a loaded plugin library
+   * into the resource index.
+   *
+   * @throws ctkPluginDatabaseException
+   */
+  void insertResourceIndex(int key, const QString& resourcePrefix, QSqlQuery* query) const;
+
+  /**
+   * Get a list of resource entries under the given path from the
+   * given resource table.
+   *
+   * @throws ctkPluginDatabaseException
+   */
+  QStringList findResourcesPath(const QString& table, int archiveKey, const QString& path) const;
+
+  /**
+   * Loads the plugin library serving the resources of the archive with
+   * the given key. Must be called with m_resourceLibrariesLock held.
+   */
+  QLibrary* getResourceLibrary(int key, const QString& libLocation) const;
+
+  /**
+   * Unloads the library serving the resources of the archive with the given key.
+   */
+  void releaseResourceLibrary(int key);
+
   /**
    * Helper function that executes the sql query specified in \a statement.
    * It is assumed that the \a statement uses positional placeholders and
@@ -302,21 +382,21 @@ private:
    *
    * @throws ctkPluginDatabaseException
    */
-  void beginTransaction(QSqlQuery* query, TransactionType);
+  void beginTransaction(QSqlQuery* query, TransactionType) const;
 
   /**
    * Commits a transaction
    *
    * @throws ctkPluginDatabaseException
    */
-  void commitTransaction(QSqlQuery* query);
+  void commitTransaction(QSqlQuery* query) const;
 
   /**
    * Rolls back a transaction
    *
    * @throws ctkPluginDatabaseException
    */
-  void rollbackTransaction(QSqlQuery* query);
+  void rollbackTransaction(QSqlQuery* query) const;
 
   /**
    * Returns a string representation of a QDateTime instance.
@@ -334,6 +414,18 @@ private:
   bool m_isDatabaseOpen;
   bool m_inTransaction;
 
+  /**
+   * \c true if the plugin resources are stored lazily.
+   */
+  bool m_lazyResources;
+
+  /**
+   * Plugin libraries loaded to serve lazily stored resources,
+   * indexed by the database key of the plugin archive.
+   */
+  mutable QHash<int, QLibrary*> m_resourceLibraries;
+  mutable QMutex m_resourceLibrariesLock;
+
   QMutex m_archivesLock;
 
   /**
@@ -191,7 +191,10 @@ ctkPlugin::State ctkPluginPrivate::getUpdatedState_unlocked()
       if (state == ctkPlugin::INSTALLED)
       {
         operation.fetchAndStoreOrdered(RESOLVING);
-        fwCtx->resolvePlugin(this);
+        {
+          ctkPluginFrameworkTraceSpan span(fwCtx->tracer, "plugin", "resolve", symbolicName);
+          fwCtx->resolvePlugin(this);
+        }
         state = ctkPlugin::RESOLVED;
         // TODO plugin threading
         //bundleThread().bundleChanged(new BundleEvent(BundleEvent.RESOLVED, this));
@@ -725,7 +728,10 @@ ctkPluginException* ctkPluginPrivate::start0()
 
   ctkPluginException::Type error_type = ctkPluginException::MANIFEST_ERROR;
   try {
-    pluginLoader.load();
+    {
+      ctkPluginFrameworkTraceSpan span(fwCtx->tracer, "plugin", "load", symbolicName);
+      pluginLoader.load();
+    }
     if (!pluginLoader.isLoaded())
     {
       error_type = ctkPluginException::ACTIVATOR_ERROR;
@@ -733,14 +739,17 @@ ctkPluginException* ctkPluginPrivate::start0()
                                ctkPluginException::ACTIVATOR_ERROR);
     }
 
-    pluginActivator = qobject_cast<ctkPluginActivator*>(pluginLoader.instance());
-    if (!pluginActivator)
     {
-      throw ctkPluginException(QString("Creating ctkPluginActivator instance from %1 failed: %2").arg(pluginLoader.fileName()).arg(pluginLoader.errorString()),
-                               ctkPluginException::ACTIVATOR_ERROR);
-    }
+      ctkPluginFrameworkTraceSpan span(fwCtx->tracer, "plugin", "activate", symbolicName);
+      pluginActivator = qobject_cast<ctkPluginActivator*>(pluginLoader.instance());
+      if (!pluginActivator)
+      {
+        throw ctkPluginException(QString("Creating ctkPluginActivator instance from %1 failed: %2").arg(pluginLoader.fileName()).arg(pluginLoader.errorString()),
+                                 ctkPluginException::ACTIVATOR_ERROR);
+      }
 
-    pluginActivator->start(pluginContext.data());
+      pluginActivator->start(pluginContext.data());
+    }
 
     if (state != ctkPlugin::STARTING)
     {
@@ -23,13 +23,23 @@ limitations under the License.
 
 #include <ctkException.h>
 
+#include <QHash>
+#include <QReadWriteLock>
+
+// Interned property keys. The keys are added as they are given and
+// lower case, to avoid converting the known keys.
+static QReadWriteLock ctkServicePropertyKeysLock;
+static QHash<QString, int> ctkServicePropertyKeys;
+static int ctkServicePropertyKeysCount = 0;
+
 //----------------------------------------------------------------------------
 ctkServiceProperties::ctkServiceProperties(const ctkProperties& props)
 {
   for(ctkProperties::ConstIterator i = props.begin(), end = props.end();
       i != end; ++i)
   {
-    if (find(i.key()) != -1)
+    int id = keyId(i.key());
+    if (find(id) != -1)
     {
       QString msg("ctkProperties object contains case variants of the key: ");
       msg += i.key();
@@ -37,9 +47,39 @@ ctkServiceProperties::ctkServiceProperties(const ctkProperties& props)
     }
     ks.append(i.key());
     vs.append(i.value());
+    ids.append(id);
   }
 }
 
+//----------------------------------------------------------------------------
+int ctkServiceProperties::keyId(const QString& key)
+{
+  {
+    QReadLocker l(&ctkServicePropertyKeysLock);
+    QHash<QString, int>::const_iterator it = ctkServicePropertyKeys.find(key);
+    if (it != ctkServicePropertyKeys.end())
+    {
+      return it.value();
+    }
+  }
+
+  QWriteLocker l(&ctkServicePropertyKeysLock);
+  const QString lowerKey = key.toLower();
+  QHash<QString, int>::const_iterator it = ctkServicePropertyKeys.find(lowerKey);
+  int id = 0;
+  if (it != ctkServicePropertyKeys.end())
+  {
+    id = it.value();
+  }
+  else
+  {
+    id = ctkServicePropertyKeysCount++;
+    ctkServicePropertyKeys.insert(lowerKey, id);
+  }
+  ctkServicePropertyKeys.insert(key, id);
+  return id;
+}
+
 //----------------------------------------------------------------------------
 QVariant ctkServiceProperties::value(const QString &key) const
 {
@@ -86,3 +126,14 @@ int ctkServiceProperties::findCaseSensitive(const QString &key) const
   }
   return -1;
 }
+
+//----------------------------------------------------------------------------
+int ctkServiceProperties::find(int keyId) const
+{
+  for (int i = 0; i < ids.size(); ++i)
+  {
+    if (ids[i] == keyId)
+      return i;
+  }
+  return -1;
+}
@@ -34,6 +34,7 @@ private:
 
   QVarLengthArray<QString,10> ks;
   QVarLengthArray<QVariant,10> vs;
+  QVarLengthArray<int,10> ids;
 
   QMap<QString, QVariant> map;
 
@@ -47,6 +48,19 @@ public:
   int find(const QString& key) const;
   int findCaseSensitive(const QString& key) const;
 
+  /**
+   * Find a key by its interned id, ignoring case.
+   *
+   * @see keyId()
+   */
+  int find(int keyId) const;
+
+  /**
+   * Get the interned id of a property key. Keys only differing
+   * in case have the same id.
+   */
+  static int keyId(const QString& key);
+
   QStringList keys() const;
 
 };
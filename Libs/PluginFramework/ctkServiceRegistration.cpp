@@ -116,16 +116,12 @@ void ctkServiceRegistration::setProperties(const ctkDictionary& props)
     if (d->available)
     {
       // NYI! Optimize the MODIFIED_ENDMATCH code
-      int old_rank = d->properties.value(ctkPluginConstants::SERVICE_RANKING).toInt();
       before = d->plugin->fwCtx->listeners.getMatchingServiceSlots(d->reference, false);
       QStringList classes = d->properties.value(ctkPluginConstants::OBJECTCLASS).toStringList();
       qlonglong sid = d->properties.value(ctkPluginConstants::SERVICE_ID).toLongLong();
-      d->properties = ctkServices::createServiceProperties(props, classes, sid);
-      int new_rank = d->properties.value(ctkPluginConstants::SERVICE_RANKING).toInt();
-      if (old_rank != new_rank)
-      {
-        d->plugin->fwCtx->services->updateServiceRegistrationOrder(*this, classes);
-      }
+      // Also updates the property indexes and the ranking order
+      d->plugin->fwCtx->services->updateServiceRegistrationProperties(
+            *this, ctkServices::createServiceProperties(props, classes, sid));
     }
     else
     {
@@ -38,7 +38,7 @@ public:
                           const char* slot)
     : plugin(p), receiver(receiver),
       slot(slot), removed(false),
-      hashValue(0)
+      filtered_key(-1), hashValue(0)
   {
 
   }
@@ -64,6 +64,17 @@ public:
    */
   ctkLDAPExpr::LocalCache local_cache;
 
+  /**
+   * Filters which are not simple but require a service property to
+   * be equal to one of a set of values are indexed by these values. The
+   * filter is then only evaluated for the services having one of them.
+   * <code>filtered_key</code> is the index of the property key, or -1 if
+   * the filter is not indexed this way, and <code>filtered_values</code>
+   * are the values.
+   */
+  int filtered_key;
+  QStringList filtered_values;
+
   ctkLDAPExpr ldap;
   QSharedPointer<ctkPlugin> plugin;
   QObject* receiver;
@@ -170,6 +181,24 @@ ctkLDAPExpr::LocalCache& ctkServiceSlotEntry::getLocalCache() const
   return d->local_cache;
 }
 
+//----------------------------------------------------------------------------
+int ctkServiceSlotEntry::getFilteredKey() const
+{
+  return d->filtered_key;
+}
+
+//----------------------------------------------------------------------------
+void ctkServiceSlotEntry::setFilteredKey(int keyIndex)
+{
+  d->filtered_key = keyIndex;
+}
+
+//----------------------------------------------------------------------------
+QStringList& ctkServiceSlotEntry::getFilteredValues() const
+{
+  return d->filtered_values;
+}
+
 //----------------------------------------------------------------------------
 uint qHash(const ctkServiceSlotEntry& serviceSlot)
 {
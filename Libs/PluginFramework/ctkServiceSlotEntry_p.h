@@ -78,6 +78,10 @@ public:
 
   ctkLDAPExpr::LocalCache& getLocalCache() const;
 
+  int getFilteredKey() const;
+  void setFilteredKey(int keyIndex);
+  QStringList& getFilteredValues() const;
+
 private:
 
   friend uint qHash(const ctkServiceSlotEntry& serviceSlot);
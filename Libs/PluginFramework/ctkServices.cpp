@@ -23,6 +23,8 @@
 
 #include <QStringListIterator>
 #include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
 #include <QBuffer>
 
 #include <algorithm>
@@ -32,7 +34,6 @@
 #include "ctkPluginFrameworkContext_p.h"
 #include "ctkServiceException.h"
 #include "ctkServiceRegistration_p.h"
-#include "ctkLDAPExpr_p.h"
 
 //----------------------------------------------------------------------------
 struct ServiceRegistrationComparator
@@ -63,9 +64,20 @@ ctkDictionary ctkServices::createServiceProperties(const ctkDictionary& in,
 
 //----------------------------------------------------------------------------
 ctkServices::ctkServices(ctkPluginFrameworkContext* fwCtx)
-  : mutex(), framework(fwCtx)
+  : rwLock(), framework(fwCtx)
 {
-
+  indexedProperties << ctkPluginConstants::SERVICE_PID.toLower();
+  QVariant indexed = fwCtx->props.value(ctkPluginConstants::FRAMEWORK_SERVICE_INDEXED_PROPERTIES);
+  foreach (const QString& key, indexed.toStringList())
+  {
+    QString lowerKey = key.trimmed().toLower();
+    // objectclass lookups use classServices
+    if (!lowerKey.isEmpty() && lowerKey != ctkPluginConstants::OBJECTCLASS &&
+        !indexedProperties.contains(lowerKey))
+    {
+      indexedProperties << lowerKey;
+    }
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -79,6 +91,8 @@ void ctkServices::clear()
 {
   services.clear();
   classServices.clear();
+  propertyIndex.clear();
+  unindexedServices.clear();
   framework = 0;
 }
 
@@ -113,10 +127,13 @@ ctkServiceRegistration ctkServices::registerService(ctkPluginPrivate* plugin,
     }
   }
 
+  ctkPluginFrameworkTraceSpan span(plugin->fwCtx->tracer, "service", "registerService",
+                                   plugin->fwCtx->tracer.isEnabled() ? classes.join(",") : QString());
+
   ctkServiceRegistration res(plugin, service,
                              createServiceProperties(properties, classes));
   {
-    QMutexLocker lock(&mutex);
+    QWriteLocker lock(&rwLock);
     services.insert(res, classes);
     for (QStringListIterator i(classes); i.hasNext(); )
     {
@@ -126,6 +143,7 @@ ctkServiceRegistration ctkServices::registerService(ctkPluginPrivate* plugin,
           std::lower_bound(s.begin(), s.end(), res, ServiceRegistrationComparator());
       s.insert(ip, res);
     }
+    addToPropertyIndex_unlocked(res);
   }
 
   ctkServiceReference r = res.getReference();
@@ -139,7 +157,14 @@ ctkServiceRegistration ctkServices::registerService(ctkPluginPrivate* plugin,
 void ctkServices::updateServiceRegistrationOrder(const ctkServiceRegistration& sr,
                                               const QStringList& classes)
 {
-  QMutexLocker lock(&mutex);
+  QWriteLocker lock(&rwLock);
+  updateServiceRegistrationOrder_unlocked(sr, classes);
+}
+
+//----------------------------------------------------------------------------
+void ctkServices::updateServiceRegistrationOrder_unlocked(const ctkServiceRegistration& sr,
+                                                       const QStringList& classes)
+{
   for (QStringListIterator i(classes); i.hasNext(); )
   {
     QList<ctkServiceRegistration>& s = classServices[i.next()];
@@ -148,6 +173,23 @@ void ctkServices::updateServiceRegistrationOrder(const ctkServiceRegistration& s
   }
 }
 
+//----------------------------------------------------------------------------
+void ctkServices::updateServiceRegistrationProperties(ctkServiceRegistration& sr,
+                                                   const ctkDictionary& properties)
+{
+  QWriteLocker lock(&rwLock);
+  ctkServiceRegistrationPrivate* d = sr.d_func();
+  int old_rank = d->properties.value(ctkPluginConstants::SERVICE_RANKING).toInt();
+  removeFromPropertyIndex_unlocked(sr);
+  d->properties = properties;
+  addToPropertyIndex_unlocked(sr);
+  int new_rank = d->properties.value(ctkPluginConstants::SERVICE_RANKING).toInt();
+  if (old_rank != new_rank)
+  {
+    updateServiceRegistrationOrder_unlocked(sr, services.value(sr));
+  }
+}
+
 //----------------------------------------------------------------------------
 bool ctkServices::checkServiceClass(QObject* service, const QString& cls) const
 {
@@ -157,14 +199,14 @@ bool ctkServices::checkServiceClass(QObject* service, const QString& cls) const
 //----------------------------------------------------------------------------
 QList<ctkServiceRegistration> ctkServices::get(const QString& clazz) const
 {
-  QMutexLocker lock(&mutex);
+  QReadLocker lock(&rwLock);
   return classServices.value(clazz);
 }
 
 //----------------------------------------------------------------------------
 ctkServiceReference ctkServices::get(ctkPluginPrivate* plugin, const QString& clazz) const
 {
-  QMutexLocker lock(&mutex);
+  QReadLocker lock(&rwLock);
   try {
     QList<ctkServiceReference> srs = get_unlocked(clazz, QString(), plugin);
     if (framework->debug.service_reference)
@@ -186,7 +228,7 @@ ctkServiceReference ctkServices::get(ctkPluginPrivate* plugin, const QString& cl
 QList<ctkServiceReference> ctkServices::get(const QString& clazz, const QString& filter,
                                             ctkPluginPrivate* plugin) const
 {
-  QMutexLocker lock(&mutex);
+  QReadLocker lock(&rwLock);
   return get_unlocked(clazz, filter, plugin);
 }
 
@@ -196,81 +238,201 @@ QList<ctkServiceReference> ctkServices::get_unlocked(const QString& clazz, const
 {
   Q_UNUSED(plugin)
 
-  QListIterator<ctkServiceRegistration>* s = 0;
   QList<ctkServiceRegistration> v;
   ctkLDAPExpr ldap;
+  if (!filter.isEmpty())
+  {
+    ldap = compileFilter(filter);
+  }
   if (clazz.isEmpty())
   {
-    if (!filter.isEmpty())
+    if (filter.isEmpty() || !getIndexedCandidates_unlocked(ldap, v))
+    {
+      v = services.keys();
+    }
+  }
+  else
+  {
+    v = classServices.value(clazz);
+    if (v.isEmpty())
+    {
+      return QList<ctkServiceReference>();
+    }
+    QList<ctkServiceRegistration> candidates;
+    if (!filter.isEmpty() && getIndexedCandidates_unlocked(ldap, candidates) &&
+        candidates.size() < v.size())
     {
-      ldap = ctkLDAPExpr(filter);
-      QSet<QString> matched;
-      if (ldap.getMatchedObjectClasses(matched))
+      v.clear();
+      foreach (const ctkServiceRegistration& sr, candidates)
       {
-        v.clear();
-        foreach (QString className, matched)
+        if (services.value(sr).contains(clazz))
         {
-          const QList<ctkServiceRegistration>& cl = classServices[className];
-          v += cl;
-        }
-        if (!v.isEmpty())
-        {
-          s = new QListIterator<ctkServiceRegistration>(v);
-        }
-        else
-        {
-          return QList<ctkServiceReference>();
+          v.push_back(sr);
         }
       }
-      else
-      {
-        s = new QListIterator<ctkServiceRegistration>(services.keys());
-      }
     }
-    else
+  }
+
+  QList<ctkServiceReference> res;
+  for (QListIterator<ctkServiceRegistration> s(v); s.hasNext(); )
+  {
+    const ctkServiceRegistration& sr = s.next();
+    if (filter.isEmpty() || ldap.evaluate(sr.d_func()->properties, false))
     {
-      s = new QListIterator<ctkServiceRegistration>(services.keys());
+      res.push_back(sr.getReference());
     }
   }
-  else
+
+  return res;
+}
+
+//----------------------------------------------------------------------------
+ctkLDAPExpr ctkServices::compileFilter(const QString& filter) const
+{
   {
-    QList<ctkServiceRegistration> v = classServices.value(clazz);
-    if (!v.isEmpty())
+    QMutexLocker lock(&filterCacheMutex);
+    QHash<QString, ctkLDAPExpr>::const_iterator it = filterCache.find(filter);
+    if (it != filterCache.end())
     {
-      s = new QListIterator<ctkServiceRegistration>(v);
+      return it.value();
     }
-    else
+  }
+
+  // Throws for invalid filters, which are not cached
+  ctkLDAPExpr ldap(filter);
+
+  QMutexLocker lock(&filterCacheMutex);
+  // Filters are usually a small set of constant strings, don't let
+  // generated ones grow the cache forever
+  if (filterCache.size() >= 1024)
+  {
+    filterCache.clear();
+  }
+  filterCache.insert(filter, ldap);
+  return ldap;
+}
+
+//----------------------------------------------------------------------------
+bool ctkServices::getIndexedCandidates_unlocked(const ctkLDAPExpr& ldap,
+                                                QList<ctkServiceRegistration>& candidates) const
+{
+  bool indexed = false;
+  QSet<ctkServiceRegistration> best;
+
+  QSet<QString> matched;
+  if (ldap.getMatchedObjectClasses(matched))
+  {
+    indexed = true;
+    foreach (const QString& className, matched)
     {
-      return QList<ctkServiceReference>();
+      foreach (const ctkServiceRegistration& sr, classServices.value(className))
+      {
+        best.insert(sr);
+      }
     }
-    if (!filter.isEmpty())
+  }
+
+  // Use the most selective of the indexes that apply
+  foreach (const QString& key, indexedProperties)
+  {
+    QSet<QString> values;
+    if (!ldap.getMatchedValues(key, values))
     {
-      ldap = ctkLDAPExpr(filter);
+      continue;
+    }
+    const QHash<QString, QList<ctkServiceRegistration> > keyIndex = propertyIndex.value(key);
+    QSet<ctkServiceRegistration> current = unindexedServices.value(key).toSet();
+    foreach (const QString& value, values)
+    {
+      foreach (const ctkServiceRegistration& sr, keyIndex.value(value))
+      {
+        current.insert(sr);
+      }
+    }
+    if (!indexed || current.size() < best.size())
+    {
+      best = current;
+      indexed = true;
     }
   }
 
-  QList<ctkServiceReference> res;
-  while (s->hasNext())
+  if (indexed)
   {
-    ctkServiceRegistration sr = s->next();
-    ctkServiceReference sri = sr.getReference();
+    candidates = best.toList();
+    // keep the ranking order
+    std::sort(candidates.begin(), candidates.end(), ServiceRegistrationComparator());
+  }
+  return indexed;
+}
 
-    if (filter.isEmpty() || ldap.evaluate(sr.d_func()->properties, false))
+//----------------------------------------------------------------------------
+void ctkServices::addToPropertyIndex_unlocked(const ctkServiceRegistration& sr)
+{
+  const ctkServiceProperties& props = sr.d_func()->properties;
+  foreach (const QString& key, indexedProperties)
+  {
+    int index = props.find(key);
+    if (index < 0)
     {
-      res.push_back(sri);
+      continue;
+    }
+    QVariant value = props.value(index);
+    if (value.type() == QVariant::String || value.type() == QVariant::StringList)
+    {
+      QHash<QString, QList<ctkServiceRegistration> >& keyIndex = propertyIndex[key];
+      foreach (const QString& v, value.toStringList().toSet())
+      {
+        keyIndex[v].push_back(sr);
+      }
+    }
+    else
+    {
+      unindexedServices[key].push_back(sr);
     }
   }
+}
 
-  delete s;
-
-  return res;
+//----------------------------------------------------------------------------
+void ctkServices::removeFromPropertyIndex_unlocked(const ctkServiceRegistration& sr)
+{
+  const ctkServiceProperties& props = sr.d_func()->properties;
+  foreach (const QString& key, indexedProperties)
+  {
+    int index = props.find(key);
+    if (index < 0)
+    {
+      continue;
+    }
+    QVariant value = props.value(index);
+    if (value.type() == QVariant::String || value.type() == QVariant::StringList)
+    {
+      QHash<QString, QList<ctkServiceRegistration> >& keyIndex = propertyIndex[key];
+      foreach (const QString& v, value.toStringList())
+      {
+        QHash<QString, QList<ctkServiceRegistration> >::iterator it = keyIndex.find(v);
+        if (it != keyIndex.end())
+        {
+          it.value().removeAll(sr);
+          if (it.value().isEmpty())
+          {
+            keyIndex.erase(it);
+          }
+        }
+      }
+    }
+    else
+    {
+      unindexedServices[key].removeAll(sr);
+    }
+  }
 }
 
 //----------------------------------------------------------------------------
 void ctkServices::removeServiceRegistration(const ctkServiceRegistration& sr)
 {
-  QMutexLocker lock(&mutex);
+  QWriteLocker lock(&rwLock);
 
+  removeFromPropertyIndex_unlocked(sr);
   QStringList classes = sr.d_func()->properties.value(ctkPluginConstants::OBJECTCLASS).toStringList();
   services.remove(sr);
   for (QStringListIterator i(classes); i.hasNext(); )
@@ -291,7 +453,7 @@ void ctkServices::removeServiceRegistration(const ctkServiceRegistration& sr)
 //----------------------------------------------------------------------------
 QList<ctkServiceRegistration> ctkServices::getRegisteredByPlugin(ctkPluginPrivate* p) const
 {
-  QMutexLocker lock(&mutex);
+  QReadLocker lock(&rwLock);
 
   QList<ctkServiceRegistration> res;
   for (QHashIterator<ctkServiceRegistration, QStringList> i(services); i.hasNext(); )
@@ -308,7 +470,7 @@ QList<ctkServiceRegistration> ctkServices::getRegisteredByPlugin(ctkPluginPrivat
 //----------------------------------------------------------------------------
 QList<ctkServiceRegistration> ctkServices::getUsedByPlugin(QSharedPointer<ctkPlugin> p) const
 {
-  QMutexLocker lock(&mutex);
+  QReadLocker lock(&rwLock);
 
   QList<ctkServiceRegistration> res;
   for (QHashIterator<ctkServiceRegistration, QStringList> i(services); i.hasNext(); )
@@ -26,8 +26,10 @@
 #include <QHash>
 #include <QObject>
 #include <QMutex>
+#include <QReadWriteLock>
 #include <QStringList>
 
+#include "ctkLDAPExpr_p.h"
 #include "ctkPlugin_p.h"
 #include "ctkServiceRegistration.h"
 
@@ -41,7 +43,11 @@ class ctkServices {
 
 public:
 
-  mutable QMutex mutex;
+  /**
+   * Protects the registration tables. Lookups only need read access,
+   * so that concurrent lookups don't serialize.
+   */
+  mutable QReadWriteLock rwLock;
 
   /**
    * Creates a new ctkDictionary object containing <code>in</code>
@@ -70,6 +76,26 @@ public:
    */
   QHash<QString, QList<ctkServiceRegistration> > classServices;
 
+  /**
+   * Lower case keys of the indexed service properties.
+   *
+   * @see ctkPluginConstants::FRAMEWORK_SERVICE_INDEXED_PROPERTIES
+   */
+  QStringList indexedProperties;
+
+  /**
+   * Mapping of indexed property key to property value to the registered
+   * services having this value.
+   */
+  QHash<QString, QHash<QString, QList<ctkServiceRegistration> > > propertyIndex;
+
+  /**
+   * Mapping of indexed property key to the registered services whose value
+   * for this key is not a string or string list. They are candidates of
+   * any lookup on this key.
+   */
+  QHash<QString, QList<ctkServiceRegistration> > unindexedServices;
+
 
   ctkPluginFrameworkContext* framework;
 
@@ -111,6 +137,17 @@ public:
                                       const QStringList& classes);
 
 
+  /**
+   * Replace the properties of a registered service, updating the
+   * property indexes and the ranking order.
+   *
+   * @param sr The ctkServiceRegistration object.
+   * @param properties The new service properties.
+   */
+  void updateServiceRegistrationProperties(ctkServiceRegistration& sr,
+                                           const ctkDictionary& properties);
+
+
   /**
    * Checks that a given service object is an instance of the given
    * class name.
@@ -184,6 +221,33 @@ private:
   QList<ctkServiceReference> get_unlocked(const QString& clazz, const QString& filter,
                                           ctkPluginPrivate* plugin) const;
 
+  /**
+   * Return the parsed LDAP expression of a filter, parsing it only the
+   * first time the filter is seen.
+   *
+   * @exception ctkInvalidArgumentException If the filter is invalid.
+   */
+  ctkLDAPExpr compileFilter(const QString& filter) const;
+
+  /**
+   * Get the services that may match a filter using the property indexes.
+   *
+   * @return <code>false</code> if no index applies to the filter.
+   */
+  bool getIndexedCandidates_unlocked(const ctkLDAPExpr& ldap,
+                                     QList<ctkServiceRegistration>& candidates) const;
+
+  void addToPropertyIndex_unlocked(const ctkServiceRegistration& sr);
+  void removeFromPropertyIndex_unlocked(const ctkServiceRegistration& sr);
+  void updateServiceRegistrationOrder_unlocked(const ctkServiceRegistration& sr,
+                                               const QStringList& classes);
+
+  mutable QMutex filterCacheMutex;
+  /**
+   * Parsed LDAP expressions of the filters used so far.
+   */
+  mutable QHash<QString, ctkLDAPExpr> filterCache;
+
 };
 
 
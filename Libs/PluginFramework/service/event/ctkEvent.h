@@ -137,5 +137,6 @@ public:
 };
 
 Q_DECLARE_METATYPE(ctkEvent)
+Q_DECLARE_METATYPE(QList<ctkEvent>)
 
 #endif // CTKEVENT_H
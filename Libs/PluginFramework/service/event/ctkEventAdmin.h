@@ -134,6 +134,18 @@ struct ctkEventAdmin
    * expression. If the filter is an error, then the Event Admin service
    * should log a warning and further ignore the registered slot.
    *
+   * High-rate topics can be subscribed with the ctkEventConstants::EVENT_DELIVERY
+   * property set to ctkEventConstants::DELIVERY_BATCH or
+   * ctkEventConstants::DELIVERY_COALESCE. With batched delivery, the slot must take
+   * a <code>QList<ctkEvent></code> argument and receives the events in batches
+   * bounded by the ctkEventConstants::DELIVERY_BATCH_SIZE and
+   * ctkEventConstants::DELIVERY_BATCH_TIMEOUT properties. With coalesced delivery,
+   * events not yet handled are replaced by newer events with the same topic and
+   * ctkEventConstants::DELIVERY_COALESCE_KEY property value. In both modes, the
+   * pending events are flushed by the thread which called <code>subscribeSlot()</code>
+   * and which therefore must run an event loop. The delivery mode is fixed when
+   * the slot is subscribed.
+   *
    * @param subscriber The owner of the slot.
    * @param member The slot in normalized form.
    * @param properties A map containing topics and a filter expression.
@@ -28,6 +28,11 @@ const QString ctkEventConstants::EVENT_FILTER = "event.filter";
 const QString ctkEventConstants::EVENT_DELIVERY = "event.delivery";
 const QString ctkEventConstants::DELIVERY_ASYNC_ORDERED = "async.ordered";
 const QString ctkEventConstants::DELIVERY_ASYNC_UNORDERED = "async.unordered";
+const QString ctkEventConstants::DELIVERY_BATCH = "batch";
+const QString ctkEventConstants::DELIVERY_COALESCE = "coalesce";
+const QString ctkEventConstants::DELIVERY_BATCH_SIZE = "event.delivery.batch.size";
+const QString ctkEventConstants::DELIVERY_BATCH_TIMEOUT = "event.delivery.batch.timeout";
+const QString ctkEventConstants::DELIVERY_COALESCE_KEY = "event.delivery.coalesce.key";
 
 const QString ctkEventConstants::PLUGIN_SYMBOLICNAME = "plugin.symbolicName";
 const QString ctkEventConstants::PLUGIN_ID = "plugin.id";
@@ -91,6 +91,8 @@ struct CTK_PLUGINFW_EXPORT ctkEventConstants {
    *
    * @see #DELIVERY_ASYNC_ORDERED
    * @see #DELIVERY_ASYNC_UNORDERED
+   * @see #DELIVERY_BATCH
+   * @see #DELIVERY_COALESCE
    */
   static const QString EVENT_DELIVERY; // = "event.delivery"
 
@@ -125,6 +127,73 @@ struct CTK_PLUGINFW_EXPORT ctkEventConstants {
    */
   static const QString DELIVERY_ASYNC_UNORDERED; // = "async.unordered"
 
+  /**
+   * Event Handler delivery quality value specifying that a subscribed slot
+   * wants to receive events in batches instead of one call per event.
+   * <p>
+   * The slot must take a <code>QList<ctkEvent></code> argument. The events
+   * are accumulated in publishing order and the slot is called once at most
+   * {@link #DELIVERY_BATCH_SIZE} events have been accumulated or
+   * {@link #DELIVERY_BATCH_TIMEOUT} milliseconds after the first event of the
+   * batch was received, whichever comes first.
+   * <p>
+   * Batched delivery is always deferred: <code>sendEvent()</code> does not
+   * block until the batch containing the event has been handled.
+   * If both this value and {@link #DELIVERY_COALESCE} are specified, this
+   * value takes precedence.
+   *
+   * @see #EVENT_DELIVERY
+   * @see ctkEventAdmin::subscribeSlot()
+   */
+  static const QString DELIVERY_BATCH; // = "batch"
+
+  /**
+   * Event Handler delivery quality value specifying that a subscribed slot
+   * is only interested in the latest value of an event.
+   * <p>
+   * Events received while the slot has not been called yet replace the
+   * pending event with the same topic (and the same value of the
+   * {@link #DELIVERY_COALESCE_KEY} event property, if specified). The slot
+   * is called once per pending event, in the order in which the topic keys
+   * were first seen, and never has more than one call queued in the
+   * receiving thread. This is useful for high-rate topics like progress or
+   * cursor position updates.
+   * <p>
+   * Coalesced delivery is always deferred: <code>sendEvent()</code> does not
+   * block until the event has been handled.
+   *
+   * @see #EVENT_DELIVERY
+   * @see ctkEventAdmin::subscribeSlot()
+   */
+  static const QString DELIVERY_COALESCE; // = "coalesce"
+
+  /**
+   * Registration property (named <code>event.delivery.batch.size</code>)
+   * specifying the maximum number of events delivered in one batch to a
+   * slot subscribed with the {@link #DELIVERY_BATCH} delivery quality.
+   * The value must be a positive integer; the default is 100.
+   */
+  static const QString DELIVERY_BATCH_SIZE; // = "event.delivery.batch.size"
+
+  /**
+   * Registration property (named <code>event.delivery.batch.timeout</code>)
+   * specifying the maximum number of milliseconds an event is held back
+   * before a partial batch is delivered to a slot subscribed with the
+   * {@link #DELIVERY_BATCH} delivery quality. With the default value of 0,
+   * partial batches are delivered as soon as the thread of the subscriber
+   * processes its events.
+   */
+  static const QString DELIVERY_BATCH_TIMEOUT; // = "event.delivery.batch.timeout"
+
+  /**
+   * Registration property (named <code>event.delivery.coalesce.key</code>)
+   * naming an event property which, together with the event topic,
+   * identifies the events replacing each other for a slot subscribed with
+   * the {@link #DELIVERY_COALESCE} delivery quality. If not specified,
+   * events are coalesced by topic only.
+   */
+  static const QString DELIVERY_COALESCE_KEY; // = "event.delivery.coalesce.key"
+
   /**
    * The Plugin Symbolic Name of the plugin relevant to the event. The type of
    * the value for this event property is <code>QString</code>.
@@ -0,0 +1,132 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QTime>
+#include <QTimer>
+#include <QVector>
+
+// CTK includes
+#include "ctkQImageView.h"
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+//-----------------------------------------------------------------------------
+// Check the scalar slices and report the latency of the window/level and
+// cursor interactions on a 2048x2048 16-bit slice.
+int ctkQImageViewTest1(int argc, char * argv [] )
+{
+  QApplication app(argc, argv);
+
+  const int size = 2048;
+  QVector<short> ct(size * size);
+  for (int y = 0; y < size; ++y)
+    {
+    for (int x = 0; x < size; ++x)
+      {
+      ct[y * size + x] = static_cast<short>((x + y) % 4096 - 1024);
+      }
+    }
+
+  ctkQImageView view;
+  view.resize(512, 512);
+  view.show();
+  view.addImage(ct.constData(), size, size);
+
+  if (view.numberOfSlices() != 1
+      || view.intensityWindow() != 4095
+      || view.intensityLevel() != 1023.5)
+    {
+    std::cerr << "Line " << __LINE__ << " - Unexpected default window/level: "
+              << view.intensityWindow() << "/" << view.intensityLevel() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  view.setPosition(10, 20);
+  if (view.positionValue() != ct[20 * size + 10])
+    {
+    std::cerr << "Line " << __LINE__ << " - Unexpected value: "
+              << view.positionValue() << " expected " << ct[20 * size + 10] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QVector<float> pet(size * size);
+  for (int i = 0; i < pet.size(); ++i)
+    {
+    pet[i] = static_cast<float>(i % 1000) * 0.01f;
+    }
+  view.addImage(pet.constData(), size, size);
+  view.setSliceNumber(1);
+  view.setPosition(10, 20);
+  double expected = pet[20 * size + 10];
+  if (std::fabs(view.positionValue() - expected) > 9.99 / 65535 ||
+      view.intensityWindow() != static_cast<double>(pet[999]))
+    {
+    std::cerr << "Line " << __LINE__ << " - Unexpected value: "
+              << view.positionValue() << " expected " << expected << std::endl;
+    return EXIT_FAILURE;
+    }
+  view.setSliceNumber(0);
+
+  const int frames = 100;
+  QTime time;
+
+  // Each window/level change renders the viewport
+  time.start();
+  for (int i = 0; i < frames; ++i)
+    {
+    view.setIntensityWindowLevel(400 + i, 40 + i);
+    }
+  int windowLevelTime = time.elapsed();
+
+  // Moving the cursor reuses the rendered viewport
+  time.start();
+  for (int i = 0; i < frames; ++i)
+    {
+    view.setPosition(100 + i, 100 + i);
+    }
+  int positionTime = time.elapsed();
+
+  // Zooming renders only the visible region
+  view.setZoom(4);
+  time.start();
+  for (int i = 0; i < frames; ++i)
+    {
+    view.setIntensityWindowLevel(400 - i, 40 - i);
+    }
+  int zoomedWindowLevelTime = time.elapsed();
+
+  std::cout << "ctkQImageView " << size << "x" << size << " 16-bit slice, "
+            << "per frame: window/level " << static_cast<double>(windowLevelTime) / frames << " ms, "
+            << "cursor " << static_cast<double>(positionTime) / frames << " ms, "
+            << "zoomed window/level " << static_cast<double>(zoomedWindowLevelTime) / frames << " ms"
+            << std::endl;
+
+  if (argc < 2 || QString(argv[1]) != "-I")
+    {
+    QTimer::singleShot(200, &app, SLOT(quit()));
+    }
+
+  return app.exec();
+}
@@ -0,0 +1,199 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QColor>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QPixmap>
+#include <QSignalSpy>
+#include <QStandardItemModel>
+#include <QTime>
+#include <QTimer>
+
+// CTK includes
+#include "ctkThumbnailListWidget.h"
+#include "ctkThumbnailView.h"
+#include "ctkTest.h"
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+bool waitFor(const QSignalSpy& spy, int count, int timeout)
+{
+  QTime time;
+  time.start();
+  while (spy.count() < count && time.elapsed() < timeout)
+    {
+    QTest::qWait(5);
+    }
+  return spy.count() >= count;
+}
+
+//-----------------------------------------------------------------------------
+void removeImages(const QDir& dir, const QStringList& paths)
+{
+  foreach(const QString& path, paths)
+    {
+    QFile::remove(path);
+    }
+  dir.rmdir(dir.absolutePath());
+}
+}
+
+//-----------------------------------------------------------------------------
+// Compare the time to the first thumbnail and the memory used by the
+// ctkThumbnailListWidget and the ctkThumbnailView for a large series.
+int ctkThumbnailViewTest1(int argc, char * argv [] )
+{
+  QApplication app(argc, argv);
+
+  const int imageCount = 1000;
+  QDir dir(QDir::tempPath() + "/ctkThumbnailViewTest1");
+  dir.mkpath(dir.absolutePath());
+  QStringList paths;
+  QImage image(512, 384, QImage::Format_RGB32);
+  for (int i = 0; i < imageCount; ++i)
+    {
+    image.fill(QColor::fromHsv(i % 360, 255, 255).rgb());
+    QString path = dir.absoluteFilePath(QString("image%1.png").arg(i));
+    if (!image.save(path))
+      {
+      std::cerr << "Line " << __LINE__ << " - Failed to write " << qPrintable(path) << std::endl;
+      removeImages(dir, paths);
+      return EXIT_FAILURE;
+      }
+    paths << path;
+    }
+
+  QTime time;
+
+  // ctkThumbnailListWidget: one widget and one full size pixmap per image
+  {
+  time.start();
+  QList<QPixmap> pixmaps;
+  qint64 pixmapBytes = 0;
+  foreach(const QString& path, paths)
+    {
+    QPixmap pixmap(path);
+    pixmapBytes += static_cast<qint64>(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+    pixmaps << pixmap;
+    }
+  ctkThumbnailListWidget listWidget;
+  listWidget.addThumbnails(pixmaps);
+  listWidget.show();
+  QApplication::processEvents();
+  std::cout << "ctkThumbnailListWidget: first thumbnail after " << time.elapsed() << " ms, "
+            << imageCount << " widgets, " << pixmapBytes / 1024 << " KB of pixmaps" << std::endl;
+  }
+
+  // ctkThumbnailView: only the visible thumbnails are read
+  QStandardItemModel model;
+  foreach(const QString& path, paths)
+    {
+    QStandardItem* item = new QStandardItem(QFileInfo(path).fileName());
+    item->setData(path, ctkThumbnailView::ThumbnailPathRole);
+    model.appendRow(item);
+    }
+
+  ctkThumbnailView view;
+  if (view.thumbnailSize() != QSize(128, 128))
+    {
+    std::cerr << "Line " << __LINE__ << " - Unexpected default thumbnail size" << std::endl;
+    removeImages(dir, paths);
+    return EXIT_FAILURE;
+    }
+  view.setCacheLimit(16 * 1024);
+  if (view.cacheLimit() != 16 * 1024)
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to set the cache limit" << std::endl;
+    removeImages(dir, paths);
+    return EXIT_FAILURE;
+    }
+  view.setModel(&model);
+  view.resize(800, 600);
+  QSignalSpy spy(&view, SIGNAL(thumbnailLoaded(QString)));
+
+  time.start();
+  view.show();
+  if (!waitFor(spy, 1, 10000))
+    {
+    std::cerr << "Line " << __LINE__ << " - No thumbnail loaded" << std::endl;
+    removeImages(dir, paths);
+    return EXIT_FAILURE;
+    }
+  int firstThumbnailTime = time.elapsed();
+  while (view.pendingThumbnailCount() > 0 && time.elapsed() < 10000)
+    {
+    QTest::qWait(5);
+    }
+  std::cout << "ctkThumbnailView: first thumbnail after " << firstThumbnailTime << " ms, "
+            << "viewport loaded after " << time.elapsed() << " ms, "
+            << spy.count() << " thumbnails, " << view.cacheSize() << " KB of pixmaps" << std::endl;
+
+  QPixmap firstThumbnail = view.thumbnail(paths.first());
+  if (spy.count() >= imageCount
+      || firstThumbnail.isNull()
+      || firstThumbnail.width() > 128 || firstThumbnail.height() > 128)
+    {
+    std::cerr << "Line " << __LINE__ << " - Unexpected thumbnails: "
+              << spy.count() << " loaded, first one "
+              << firstThumbnail.width() << "x" << firstThumbnail.height() << std::endl;
+    removeImages(dir, paths);
+    return EXIT_FAILURE;
+    }
+
+  // The thumbnails scrolled into the viewport are loaded
+  view.scrollToBottom();
+  time.start();
+  while (view.thumbnail(paths.last()).isNull() && time.elapsed() < 10000)
+    {
+    QTest::qWait(5);
+    }
+  if (view.thumbnail(paths.last()).isNull())
+    {
+    std::cerr << "Line " << __LINE__ << " - Last thumbnail not loaded" << std::endl;
+    removeImages(dir, paths);
+    return EXIT_FAILURE;
+    }
+  if (view.cacheSize() > view.cacheLimit())
+    {
+    std::cerr << "Line " << __LINE__ << " - Cache limit exceeded: "
+              << view.cacheSize() << " KB" << std::endl;
+    removeImages(dir, paths);
+    return EXIT_FAILURE;
+    }
+
+  removeImages(dir, paths);
+
+  if (argc < 2 || QString(argv[1]) != "-I")
+    {
+    QTimer::singleShot(200, &app, SLOT(quit()));
+    }
+
+  return app.exec();
+}
@@ -371,6 +371,11 @@ void ctkErrorLogModel::addEntry(const QDateTime& currentDateTime, const QString&
   fileLogText.replace("%{category}", context.Category);
   fileLogText.replace("%{msg}", context.Message);
   d->FileLogger.logMessage(fileLogText.trimmed());
+  if (logLevel == ctkErrorLogLevel::Fatal)
+    {
+    // The application is about to abort
+    d->FileLogger.flush();
+    }
 
   emit this->entryAdded(logLevel);
 }
@@ -546,6 +551,20 @@ void ctkErrorLogModel::setFileLoggingEnabled(bool value)
   d->FileLogger.setEnabled(value);
 }
 
+// --------------------------------------------------------------------------
+bool ctkErrorLogModel::fileLoggingBuffered()const
+{
+  Q_D(const ctkErrorLogModel);
+  return d->FileLogger.mode() == ctkFileLogger::BufferedMode;
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogModel::setFileLoggingBuffered(bool value)
+{
+  Q_D(ctkErrorLogModel);
+  d->FileLogger.setMode(value ? ctkFileLogger::BufferedMode : ctkFileLogger::SynchronousMode);
+}
+
 // --------------------------------------------------------------------------
 QString ctkErrorLogModel::fileLoggingPattern()const
 {
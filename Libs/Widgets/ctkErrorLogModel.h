@@ -45,6 +45,7 @@ class CTK_WIDGETS_EXPORT ctkErrorLogModel : public QSortFilterProxyModel
   Q_PROPERTY(QString filePath READ filePath WRITE  setFilePath)
   Q_PROPERTY(int numberOfFilesToKeep READ numberOfFilesToKeep WRITE  setNumberOfFilesToKeep)
   Q_PROPERTY(bool fileLoggingEnabled READ fileLoggingEnabled WRITE  setFileLoggingEnabled)
+  Q_PROPERTY(bool fileLoggingBuffered READ fileLoggingBuffered WRITE  setFileLoggingBuffered)
   Q_PROPERTY(QString fileLoggingPattern READ fileLoggingPattern WRITE setFileLoggingPattern)
 public:
   typedef QSortFilterProxyModel Superclass;
@@ -115,6 +116,12 @@ public:
   bool fileLoggingEnabled()const;
   void setFileLoggingEnabled(bool value);
 
+  /// If true, the file logger writes from a background thread.
+  /// Default is false.
+  /// \sa ctkFileLogger::BufferedMode
+  bool fileLoggingBuffered()const;
+  void setFileLoggingBuffered(bool value);
+
   QString fileLoggingPattern()const;
   void setFileLoggingPattern(const QString& value);
 
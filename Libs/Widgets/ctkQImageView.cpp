@@ -35,8 +35,51 @@
 #include <QColor>
 #include <QTextEdit>
 #include <QDialog>
+#include <QVector>
 
 #include <cmath>
+#include <limits>
+
+//--------------------------------------------------------------------------
+namespace
+{
+
+/// Maps the samples of the visible region of a slice through the lookup
+/// table into an 8-bit image, taking one sample per output pixel: the cost
+/// is proportional to the viewport and not to the slice size.
+void ctkQImageViewApplyLut( const quint16* data, int dataWidth,
+  const QVector<int>& columns, const QVector<int>& rows,
+  const uchar* lut, QImage& output )
+{
+  const int outWidth = columns.size();
+  const int* cols = columns.constData();
+  for( int j = 0; j < rows.size(); ++j )
+    {
+    const quint16* src = data + rows[ j ] * dataWidth;
+    uchar* dst = output.scanLine( j );
+    for( int i = 0; i < outWidth; ++i )
+      {
+      dst[ i ] = lut[ src[ cols[ i ] ] ];
+      }
+    }
+}
+
+/// Index of the samples of [start, start+size) taken for each of the
+/// count output pixels, in reverse order if flipped.
+QVector<int> ctkQImageViewSampleIndices( int start, int size, int count,
+  bool flip )
+{
+  QVector<int> indices( count );
+  for( int i = 0; i < count; ++i )
+    {
+    int offset = static_cast<int>(
+      ( 2 * static_cast<qint64>(i) + 1 ) * size / ( 2 * count ) );
+    indices[ i ] = flip ? start + size - 1 - offset : start + offset;
+    }
+  return indices;
+}
+
+}
 
 //--------------------------------------------------------------------------
 class ctkQImageViewPrivate
@@ -54,6 +97,54 @@ public:
 
   void init();
 
+  /// A slice is either a color QImage or scalar intensities stored as
+  /// 16-bit samples, intensity = sample * Scale + Offset.
+  struct Slice
+  {
+    Slice();
+
+    bool isScalar() const;
+    double intensity( int x, int y ) const;
+
+    QImage Image;
+    QVector< quint16 > Data;
+    int Width;
+    int Height;
+    double XSpacing;
+    double YSpacing;
+    double Scale;
+    double Offset;
+    double Min;
+    double Max;
+  };
+
+  /// What the cached viewport was rendered from.
+  struct RenderKey
+  {
+    RenderKey();
+
+    bool operator==( const RenderKey& other ) const;
+
+    int SliceNumber;
+    QRect Source;
+    QSize Output;
+    bool FlipXAxis;
+    bool FlipYAxis;
+    bool InvertImage;
+    double IntensityWindow;
+    double IntensityLevel;
+  };
+
+  void addSlice( const Slice& slice );
+
+  /// Recompute the lookup table if the window/level, the inversion or the
+  /// sample mapping of the slice changed.
+  void updateLut( const Slice& slice );
+
+  /// Render the visible region of the current slice into RenderedPixmap,
+  /// unless it is cached.
+  void renderViewport();
+
   QLabel * Window;
 
   double Zoom;
@@ -72,7 +163,7 @@ public:
   bool FlipYAxis;
   bool TransposeXY;
 
-  QList< QImage > ImageList;
+  QList< Slice > SliceList;
 
   QPixmap TmpImage;
   int     TmpXMin;
@@ -80,6 +171,19 @@ public:
   int     TmpYMin;
   int     TmpYMax;
 
+  QVector< uchar > Lut;
+  bool    LutValid;
+  double  LutWindow;
+  double  LutLevel;
+  bool    LutInvert;
+  double  LutScale;
+  double  LutOffset;
+
+  QImage  Rendered;
+  QPixmap RenderedPixmap;
+  RenderKey RenderedKey;
+  QVector< QRgb > GrayColorTable;
+
   bool   InvertImage;
 
   int    MouseLastX;
@@ -97,6 +201,51 @@ public:
   
 };
 
+//--------------------------------------------------------------------------
+ctkQImageViewPrivate::Slice::Slice()
+  : Width( 0 ), Height( 0 ), XSpacing( 1 ), YSpacing( 1 ),
+    Scale( 1 ), Offset( 0 ), Min( 0 ), Max( 0 )
+{
+}
+
+//--------------------------------------------------------------------------
+bool ctkQImageViewPrivate::Slice::isScalar() const
+{
+  return this->Image.isNull();
+}
+
+//--------------------------------------------------------------------------
+double ctkQImageViewPrivate::Slice::intensity( int x, int y ) const
+{
+  if( this->isScalar() )
+    {
+    return this->Data[ y * this->Width + x ] * this->Scale + this->Offset;
+    }
+  QColor vc( this->Image.pixel( x, y ) );
+  return vc.value();
+}
+
+//--------------------------------------------------------------------------
+ctkQImageViewPrivate::RenderKey::RenderKey()
+  : SliceNumber( -1 ), FlipXAxis( false ), FlipYAxis( false ),
+    InvertImage( false ), IntensityWindow( 0 ), IntensityLevel( 0 )
+{
+}
+
+//--------------------------------------------------------------------------
+bool ctkQImageViewPrivate::RenderKey::operator==(
+  const RenderKey& other ) const
+{
+  return this->SliceNumber == other.SliceNumber
+    && this->Source == other.Source
+    && this->Output == other.Output
+    && this->FlipXAxis == other.FlipXAxis
+    && this->FlipYAxis == other.FlipYAxis
+    && this->InvertImage == other.InvertImage
+    && this->IntensityWindow == other.IntensityWindow
+    && this->IntensityLevel == other.IntensityLevel;
+}
+
 //--------------------------------------------------------------------------
 ctkQImageViewPrivate::ctkQImageViewPrivate(
   ctkQImageView& object )
@@ -137,13 +286,27 @@ void ctkQImageViewPrivate::init()
   this->FlipYAxis = false;
   this->TransposeXY = false;
 
-  this->ImageList.clear();
+  this->SliceList.clear();
 
   this->TmpXMin = 0;
   this->TmpXMax = 0;
   this->TmpYMin = 0;
   this->TmpYMax = 0;
 
+  this->Lut.resize( 65536 );
+  this->LutValid = false;
+  this->LutWindow = 0;
+  this->LutLevel = 0;
+  this->LutInvert = false;
+  this->LutScale = 1;
+  this->LutOffset = 0;
+
+  this->GrayColorTable.resize( 256 );
+  for( int i = 0; i < 256; ++i )
+    {
+    this->GrayColorTable[ i ] = qRgb( i, i, i );
+    }
+
   this->MouseLastX = 0;
   this->MouseLastY = 0;
   this->MouseLastZoom = 0;
@@ -174,17 +337,148 @@ double ctkQImageViewPrivate::clamp( double x, double xMin,
 void ctkQImageViewPrivate::fitImageRectangle( double x0,
   double x1, double y0, double y1 )
 {
-  if( this->SliceNumber >= 0 && this->SliceNumber < this->ImageList.size() )
+  if( this->SliceNumber >= 0 && this->SliceNumber < this->SliceList.size() )
     {
     this->TmpXMin = this->clamp( x0, 0,
-      this->ImageList[ this->SliceNumber ].width() );
+      this->SliceList[ this->SliceNumber ].Width );
     this->TmpXMax = this->clamp( x1, this->TmpXMin,
-      this->ImageList[ this->SliceNumber ].width() );
+      this->SliceList[ this->SliceNumber ].Width );
     this->TmpYMin = this->clamp( y0, 0,
-      this->ImageList[ this->SliceNumber ].height() );
+      this->SliceList[ this->SliceNumber ].Height );
     this->TmpYMax = this->clamp( y1, this->TmpYMin,
-      this->ImageList[ this->SliceNumber ].height() );
+      this->SliceList[ this->SliceNumber ].Height );
+    }
+}
+
+//--------------------------------------------------------------------------
+void ctkQImageViewPrivate::addSlice( const Slice& slice )
+{
+  Q_Q( ctkQImageView );
+  this->SliceList.push_back( slice );
+  this->RenderedKey = RenderKey();
+  this->TmpXMin = 0;
+  this->TmpXMax = slice.Width;
+  this->TmpYMin = 0;
+  this->TmpYMax = slice.Height;
+  if( slice.isScalar() )
+    {
+    this->IntensityMin = slice.Min;
+    this->IntensityMax = slice.Max;
+    q->setIntensityWindowLevel( slice.Max - slice.Min,
+      ( slice.Max + slice.Min ) / 2 );
+    }
+  q->update( true, false );
+  q->setCenter( slice.Width/2.0, slice.Height/2.0 );
+}
+
+//--------------------------------------------------------------------------
+void ctkQImageViewPrivate::updateLut( const Slice& slice )
+{
+  if( this->LutValid
+    && this->LutWindow == this->IntensityWindow
+    && this->LutLevel == this->IntensityLevel
+    && this->LutInvert == this->InvertImage
+    && this->LutScale == slice.Scale
+    && this->LutOffset == slice.Offset )
+    {
+    return;
+    }
+  this->LutValid = true;
+  this->LutWindow = this->IntensityWindow;
+  this->LutLevel = this->IntensityLevel;
+  this->LutInvert = this->InvertImage;
+  this->LutScale = slice.Scale;
+  this->LutOffset = slice.Offset;
+
+  const double lower = this->IntensityLevel - this->IntensityWindow / 2;
+  const double window = this->IntensityWindow;
+  uchar* lut = this->Lut.data();
+  for( int i = 0; i < 65536; ++i )
+    {
+    double value = i * slice.Scale + slice.Offset;
+    int gray;
+    if( window > 0 )
+      {
+      gray = static_cast<int>(
+        this->clamp( ( value - lower ) / window * 255.0 + 0.5, 0, 255 ) );
+      }
+    else
+      {
+      gray = value < this->IntensityLevel ? 0 : 255;
+      }
+    lut[ i ] = static_cast<uchar>( this->InvertImage ? 255 - gray : gray );
+    }
+}
+
+//--------------------------------------------------------------------------
+void ctkQImageViewPrivate::renderViewport()
+{
+  const Slice& slice = this->SliceList[ this->SliceNumber ];
+  QRect source( this->TmpXMin, this->TmpYMin,
+    this->TmpXMax - this->TmpXMin, this->TmpYMax - this->TmpYMin );
+  source &= QRect( 0, 0, slice.Width, slice.Height );
+
+  RenderKey key;
+  key.SliceNumber = this->SliceNumber;
+  key.Source = source;
+  key.FlipXAxis = this->FlipXAxis;
+  key.FlipYAxis = this->FlipYAxis;
+  key.InvertImage = this->InvertImage;
+  if( slice.isScalar() )
+    {
+    // No need to render more samples than the viewport displays
+    key.Output = QSize( qMin( source.width(), this->TmpImage.width() ),
+      qMin( source.height(), this->TmpImage.height() ) );
+    key.IntensityWindow = this->IntensityWindow;
+    key.IntensityLevel = this->IntensityLevel;
+    }
+  else
+    {
+    key.Output = source.size();
+    }
+  if( key == this->RenderedKey && !this->RenderedPixmap.isNull() )
+    {
+    return;
     }
+  this->RenderedKey = key;
+
+  if( key.Output.isEmpty() )
+    {
+    this->RenderedPixmap = QPixmap();
+    return;
+    }
+
+  if( slice.isScalar() )
+    {
+    this->updateLut( slice );
+    if( this->Rendered.size() != key.Output
+      || this->Rendered.format() != QImage::Format_Indexed8 )
+      {
+      this->Rendered = QImage( key.Output, QImage::Format_Indexed8 );
+      this->Rendered.setColorTable( this->GrayColorTable );
+      }
+    ctkQImageViewApplyLut( slice.Data.constData(), slice.Width,
+      ctkQImageViewSampleIndices( source.x(), source.width(),
+        key.Output.width(), this->FlipXAxis ),
+      ctkQImageViewSampleIndices( source.y(), source.height(),
+        key.Output.height(), this->FlipYAxis ),
+      this->Lut.constData(), this->Rendered );
+    }
+  else
+    {
+    // Only the visible region of color slices is copied
+    this->Rendered = slice.Image.copy( source );
+    if( this->FlipXAxis || this->FlipYAxis )
+      {
+      this->Rendered = this->Rendered.mirrored( this->FlipXAxis,
+        this->FlipYAxis );
+      }
+    if( this->InvertImage )
+      {
+      this->Rendered.invertPixels();
+      }
+    }
+  this->RenderedPixmap = QPixmap::fromImage( this->Rendered );
 }
 
 
@@ -218,27 +512,134 @@ ctkQImageView::~ctkQImageView()
 void ctkQImageView::addImage( const QImage & image )
 {
   Q_D( ctkQImageView );
-  d->ImageList.push_back( image );
-  d->TmpXMin = 0;
-  d->TmpXMax = image.width();
-  d->TmpYMin = 0;
-  d->TmpYMax = image.height();
+  ctkQImageViewPrivate::Slice slice;
+  slice.Width = image.width();
+  slice.Height = image.height();
+  if( image.dotsPerMeterX() > 0 && image.dotsPerMeterY() > 0 )
+    {
+    slice.XSpacing = 1000.0 / image.dotsPerMeterX();
+    slice.YSpacing = 1000.0 / image.dotsPerMeterY();
+    }
   if( image.isGrayscale() )
     {
-    d->IntensityMin = 0;
-    d->IntensityMax = image.colorCount();
-    this->setIntensityWindowLevel(
-      image.colorCount(), image.colorCount()/2 );
+    // Gray levels go through the window/level lookup table
+    QImage rgb = image.convertToFormat( QImage::Format_RGB32 );
+    slice.Data.resize( slice.Width * slice.Height );
+    quint16* data = slice.Data.data();
+    for( int y = 0; y < slice.Height; ++y )
+      {
+      const QRgb* line = reinterpret_cast< const QRgb* >( rgb.scanLine( y ) );
+      for( int x = 0; x < slice.Width; ++x )
+        {
+        *data++ = static_cast< quint16 >( qGray( line[ x ] ) );
+        }
+      }
+    slice.Min = 0;
+    slice.Max = 255;
+    }
+  else
+    {
+    slice.Image = image;
+    }
+  d->addSlice( slice );
+}
+
+// -------------------------------------------------------------------------
+void ctkQImageView::addImage( const unsigned short* buffer, int width,
+  int height )
+{
+  Q_D( ctkQImageView );
+  ctkQImageViewPrivate::Slice slice;
+  slice.Width = width;
+  slice.Height = height;
+  slice.Data.resize( width * height );
+  quint16 minValue = std::numeric_limits< quint16 >::max();
+  quint16 maxValue = 0;
+  quint16* data = slice.Data.data();
+  for( int i = 0; i < slice.Data.size(); ++i )
+    {
+    data[ i ] = buffer[ i ];
+    minValue = qMin( minValue, data[ i ] );
+    maxValue = qMax( maxValue, data[ i ] );
+    }
+  slice.Min = slice.Data.isEmpty() ? 0 : minValue;
+  slice.Max = slice.Data.isEmpty() ? 0 : maxValue;
+  d->addSlice( slice );
+}
+
+// -------------------------------------------------------------------------
+void ctkQImageView::addImage( const short* buffer, int width, int height )
+{
+  Q_D( ctkQImageView );
+  ctkQImageViewPrivate::Slice slice;
+  slice.Width = width;
+  slice.Height = height;
+  slice.Offset = -32768;
+  slice.Data.resize( width * height );
+  short minValue = std::numeric_limits< short >::max();
+  short maxValue = std::numeric_limits< short >::min();
+  quint16* data = slice.Data.data();
+  for( int i = 0; i < slice.Data.size(); ++i )
+    {
+    data[ i ] = static_cast< quint16 >( buffer[ i ] + 32768 );
+    minValue = qMin( minValue, buffer[ i ] );
+    maxValue = qMax( maxValue, buffer[ i ] );
     }
-  this->update( true, false );
-  this->setCenter( image.width()/2.0, image.height()/2.0 );
+  slice.Min = slice.Data.isEmpty() ? 0 : minValue;
+  slice.Max = slice.Data.isEmpty() ? 0 : maxValue;
+  d->addSlice( slice );
+}
+
+// -------------------------------------------------------------------------
+void ctkQImageView::addImage( const float* buffer, int width, int height )
+{
+  Q_D( ctkQImageView );
+  ctkQImageViewPrivate::Slice slice;
+  slice.Width = width;
+  slice.Height = height;
+  const int size = width * height;
+  float minValue = std::numeric_limits< float >::max();
+  float maxValue = -std::numeric_limits< float >::max();
+  for( int i = 0; i < size; ++i )
+    {
+    // NaN fail both comparisons
+    if( buffer[ i ] < minValue )
+      {
+      minValue = buffer[ i ];
+      }
+    if( buffer[ i ] > maxValue )
+      {
+      maxValue = buffer[ i ];
+      }
+    }
+  if( minValue > maxValue )
+    {
+    minValue = maxValue = 0;
+    }
+  slice.Min = minValue;
+  slice.Max = maxValue;
+  slice.Offset = minValue;
+  slice.Scale = maxValue > minValue ?
+    ( static_cast< double >( maxValue ) - minValue ) / 65535 : 1;
+  slice.Data.resize( size );
+  quint16* data = slice.Data.data();
+  for( int i = 0; i < size; ++i )
+    {
+    double sample = ( buffer[ i ] - slice.Offset ) / slice.Scale + 0.5;
+    data[ i ] = sample >= 0 && sample <= 65535 ?
+      static_cast< quint16 >( sample ) : 0;
+    }
+  d->addSlice( slice );
 }
 
 // -------------------------------------------------------------------------
 void ctkQImageView::clearImages( void )
 {
   Q_D( ctkQImageView );
-  d->ImageList.clear();
+  d->SliceList.clear();
+  d->RenderedKey = ctkQImageViewPrivate::RenderKey();
+  d->RenderedPixmap = QPixmap();
+  d->Rendered = QImage();
   this->update( true, true );
 }
 
@@ -246,9 +647,9 @@ void ctkQImageView::clearImages( void )
 double ctkQImageView::xSpacing( void )
 {
   Q_D( ctkQImageView );
-  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
+  if( d->SliceNumber >= 0 && d->SliceNumber < d->SliceList.size() )
     {
-    return( 1000.0 / d->ImageList[ d->SliceNumber ].dotsPerMeterX() );
+    return d->SliceList[ d->SliceNumber ].XSpacing;
     }
   else
     {
@@ -260,9 +661,9 @@ double ctkQImageView::xSpacing( void )
 double ctkQImageView::ySpacing( void )
 {
   Q_D( ctkQImageView );
-  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
+  if( d->SliceNumber >= 0 && d->SliceNumber < d->SliceList.size() )
     {
-    return( 1000.0 / d->ImageList[ d->SliceNumber ].dotsPerMeterY() );
+    return d->SliceList[ d->SliceNumber ].YSpacing;
     }
   else
     {
@@ -307,11 +708,10 @@ double ctkQImageView::slicePosition( void )
 double ctkQImageView::positionValue( void )
 {
   Q_D( ctkQImageView );
-  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
+  if( d->SliceNumber >= 0 && d->SliceNumber < d->SliceList.size() )
     {
-    QColor vc( d->ImageList[ d->SliceNumber ].pixel( d->PositionX,
-      d->PositionY ) );
-    return vc.value();
+    return d->SliceList[ d->SliceNumber ].intensity( d->PositionX,
+      d->PositionY );
     }
   return 0;
 }
@@ -334,7 +734,7 @@ double ctkQImageView::yCenter( void )
 void ctkQImageView::setSliceNumber( int slicenum )
 {
   Q_D( ctkQImageView );
-  if( slicenum >= 0 && slicenum < d->ImageList.size() 
+  if( slicenum >= 0 && slicenum < d->SliceList.size() 
     && slicenum != d->SliceNumber )
     {
     d->SliceNumber = slicenum;
@@ -351,7 +751,7 @@ void ctkQImageView::setSliceNumber( int slicenum )
 int ctkQImageView::sliceNumber( void ) const
 {
   Q_D( const ctkQImageView );
-  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
+  if( d->SliceNumber >= 0 && d->SliceNumber < d->SliceList.size() )
     {
     return d->SliceNumber;
     }
@@ -472,17 +872,17 @@ bool ctkQImageView::transposeXY( void ) const
 void ctkQImageView::setCenter( double x, double y )
 {
   Q_D( ctkQImageView );
-  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
+  if( d->SliceNumber >= 0 && d->SliceNumber < d->SliceList.size() )
     {
 	  int tmpXRange = d->TmpXMax - d->TmpXMin;
-    if( tmpXRange > d->ImageList[ d->SliceNumber ].width() )
+    if( tmpXRange > d->SliceList[ d->SliceNumber ].Width )
       {
-      tmpXRange = d->ImageList[ d->SliceNumber ].width();
+      tmpXRange = d->SliceList[ d->SliceNumber ].Width;
       }
     int tmpYRange = d->TmpYMax - d->TmpYMin;
-    if( tmpYRange > d->ImageList[ d->SliceNumber ].height() )
+    if( tmpYRange > d->SliceList[ d->SliceNumber ].Height )
       {
-      tmpYRange = d->ImageList[ d->SliceNumber ].height();
+      tmpYRange = d->SliceList[ d->SliceNumber ].Height;
       }
   
     int xMin2 = static_cast<int>(x) - tmpXRange/2.0;
@@ -491,9 +891,9 @@ void ctkQImageView::setCenter( double x, double y )
       xMin2 = 0;
       }
     int xMax2 = xMin2 + tmpXRange;
-    if( xMax2 > d->ImageList[ d->SliceNumber ].width() )
+    if( xMax2 > d->SliceList[ d->SliceNumber ].Width )
       {
-      xMax2 = d->ImageList[ d->SliceNumber ].width();
+      xMax2 = d->SliceList[ d->SliceNumber ].Width;
       xMin2 = xMax2 - tmpXRange;
       }
     int yMin2 = static_cast<int>(y) - tmpYRange/2.0;
@@ -502,9 +902,9 @@ void ctkQImageView::setCenter( double x, double y )
       yMin2 = 0;
       }
     int yMax2 = yMin2 + tmpYRange;
-    if( yMax2 > d->ImageList[ d->SliceNumber ].height() )
+    if( yMax2 > d->SliceList[ d->SliceNumber ].Height )
       {
-      yMax2 = d->ImageList[ d->SliceNumber ].height();
+      yMax2 = d->SliceList[ d->SliceNumber ].Height;
       yMin2 = yMax2 - tmpYRange;
       }
     d->fitImageRectangle( xMin2, xMax2, yMin2, yMax2 );
@@ -523,9 +923,9 @@ void ctkQImageView::setCenter( double x, double y )
 void ctkQImageView::setPosition( double x, double y )
 {
   Q_D( ctkQImageView );
-  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() 
-    && x >= 0 && y >= 0 && x < d->ImageList[ d->SliceNumber ].width()
-    && y < d->ImageList[ d->SliceNumber ].height() )
+  if( d->SliceNumber >= 0 && d->SliceNumber < d->SliceList.size() 
+    && x >= 0 && y >= 0 && x < d->SliceList[ d->SliceNumber ].Width
+    && y < d->SliceList[ d->SliceNumber ].Height )
     {
     d->PositionX = x;
     d->PositionY = y;
@@ -542,7 +942,7 @@ void ctkQImageView::setPosition( double x, double y )
 double ctkQImageView::zoom( void )
 {
   Q_D( ctkQImageView );
-  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
+  if( d->SliceNumber >= 0 && d->SliceNumber < d->SliceList.size() )
     {
     return d->Zoom;
     }
@@ -553,23 +953,23 @@ double ctkQImageView::zoom( void )
 void ctkQImageView::setZoom( double factor )
 {
   Q_D( ctkQImageView );
-  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
+  if( d->SliceNumber >= 0 && d->SliceNumber < d->SliceList.size() )
     {
-    const QImage * img = & d->ImageList[ d->SliceNumber ];
-    if( factor < 2.0 / img->width() )
+    const ctkQImageViewPrivate::Slice * img = & d->SliceList[ d->SliceNumber ];
+    if( factor < 2.0 / img->Width )
       {
-      factor = 2.0 / img->width();
+      factor = 2.0 / img->Width;
       }
-    if( factor > img->width()/2.0 )
+    if( factor > img->Width/2.0 )
       {
-      factor = img->width()/2.0;
+      factor = img->Width/2.0;
       }
     d->Zoom = factor;
 
     double cx = d->CenterX;
     double cy = d->CenterY;
-    double x2 = img->width() / factor;
-    double y2 = img->height() / factor;
+    double x2 = img->Width / factor;
+    double y2 = img->Height / factor;
 	  
     int xMin2 = static_cast<int>(cx) - x2 / 2.0;
     if( xMin2 < 0 )
@@ -577,9 +977,9 @@ void ctkQImageView::setZoom( double factor )
       xMin2 = 0;
       }
     int xMax2 = xMin2 + x2;
-    if( xMax2 > d->ImageList[ d->SliceNumber ].width() )
+    if( xMax2 > d->SliceList[ d->SliceNumber ].Width )
       {
-      xMax2 = d->ImageList[ d->SliceNumber ].width();
+      xMax2 = d->SliceList[ d->SliceNumber ].Width;
       xMin2 = xMax2 - x2;
       }
     int yMin2 = static_cast<int>(cy) - y2 / 2.0;
@@ -588,9 +988,9 @@ void ctkQImageView::setZoom( double factor )
       yMin2 = 0;
       }
     int yMax2 = yMin2 + y2;
-    if( yMax2 > d->ImageList[ d->SliceNumber ].height() )
+    if( yMax2 > d->SliceList[ d->SliceNumber ].Height )
       {
-      yMax2 = d->ImageList[ d->SliceNumber ].height();
+      yMax2 = d->SliceList[ d->SliceNumber ].Height;
       yMin2 = yMax2 - y2;
       }
     d->fitImageRectangle( xMin2, xMax2, yMin2, yMax2 );
@@ -604,7 +1004,7 @@ void ctkQImageView::reset( )
 {
   Q_D( ctkQImageView );
 
-  if( d->ImageList.size() > 0 )
+  if( d->SliceList.size() > 0 )
     {
     if( d->SliceNumber < 0 )
       {
@@ -614,10 +1014,10 @@ void ctkQImageView::reset( )
 
   this->setZoom( 1 );
 
-  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
+  if( d->SliceNumber >= 0 && d->SliceNumber < d->SliceList.size() )
     {
-    this->setCenter( d->ImageList[ d->SliceNumber ].width()/2,
-      d->ImageList[ d->SliceNumber ].height()/2 );
+    this->setCenter( d->SliceList[ d->SliceNumber ].Width/2,
+      d->SliceList[ d->SliceNumber ].Height/2 );
     }
 }
 
@@ -626,7 +1026,7 @@ void ctkQImageView::keyPressEvent( QKeyEvent * event )
 {
   Q_D( ctkQImageView );
 
-  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
+  if( d->SliceNumber >= 0 && d->SliceNumber < d->SliceList.size() )
     {
     switch( event->key() )
       {
@@ -725,7 +1125,7 @@ void ctkQImageView::keyPressEvent( QKeyEvent * event )
 void ctkQImageView::mousePressEvent( QMouseEvent * event )
 {
   Q_D( ctkQImageView );
-  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
+  if( d->SliceNumber >= 0 && d->SliceNumber < d->SliceList.size() )
     {
     switch( event->button() )
       {
@@ -788,7 +1188,7 @@ void ctkQImageView::mouseReleaseEvent( QMouseEvent * event )
 void ctkQImageView::mouseMoveEvent( QMouseEvent * event )
 {
   Q_D( ctkQImageView );
-  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
+  if( d->SliceNumber >= 0 && d->SliceNumber < d->SliceList.size() )
     {
     if( d->MouseLeftDragging )
       {
@@ -892,9 +1292,9 @@ void ctkQImageView::update( bool zoomChanged,
   bool sizeChanged )
 {
   Q_D( ctkQImageView );
-  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
+  if( d->SliceNumber >= 0 && d->SliceNumber < d->SliceList.size() )
     {
-    const QImage * img = & ( d->ImageList[ d->SliceNumber ] );
+    const ctkQImageViewPrivate::Slice * img = & ( d->SliceList[ d->SliceNumber ] );
     if( zoomChanged || sizeChanged )
       {
       if( this->width() > 0 &&  this->height() > 0 
@@ -908,7 +1308,7 @@ void ctkQImageView::update( bool zoomChanged,
         if( screenAspectRatio > tmpAspectRatio )
           {
           int extraTmpYAbove = d->TmpYMin;
-          int extraTmpYBelow = img->height() - d->TmpYMax;
+          int extraTmpYBelow = img->Height - d->TmpYMax;
           int extraTmpYNeeded = tmpXRange * screenAspectRatio 
             - tmpYRange;
           int minExtra = extraTmpYAbove;
@@ -932,14 +1332,14 @@ void ctkQImageView::update( bool zoomChanged,
               }
             else
               {
-              d->TmpYMax = img->height();
+              d->TmpYMax = img->Height;
               d->TmpYMin -= extraTmpYNeeded - extraTmpYBelow;
               }
             }
           else
             {
             d->TmpYMin = 0;
-            d->TmpYMax = img->height();
+            d->TmpYMax = img->Height;
             }
           d->TmpImage = QPixmap( this->width(),
             static_cast<unsigned int>( 
@@ -950,7 +1350,7 @@ void ctkQImageView::update( bool zoomChanged,
         else if(screenAspectRatio < tmpAspectRatio)
           {
           int extraTmpXLeft = d->TmpXMin;
-          int extraTmpXRight = img->width() - d->TmpXMax;
+          int extraTmpXRight = img->Width - d->TmpXMax;
           int extraTmpXNeeded = static_cast<double>(tmpYRange) 
             / screenAspectRatio - tmpXRange;
           int minExtra = extraTmpXLeft;
@@ -974,14 +1374,14 @@ void ctkQImageView::update( bool zoomChanged,
               }
             else
               {
-              d->TmpXMax = img->width();
+              d->TmpXMax = img->Width;
               d->TmpXMin -= extraTmpXNeeded - extraTmpXRight;
               }
             }
            else
             {
             d->TmpXMin = 0;
-            d->TmpXMax = img->width();
+            d->TmpXMax = img->Width;
             }
           d->TmpImage = QPixmap( static_cast<unsigned int>( this->height()
             / ( static_cast<double>(d->TmpYMax - d->TmpYMin) 
@@ -998,30 +1398,15 @@ void ctkQImageView::update( bool zoomChanged,
     if( d->TmpImage.width() > 0 &&  d->TmpImage.height() > 0)
       {
       QRectF target( 0, 0, d->TmpImage.width(), d->TmpImage.height() );
-      double sourceX = d->TmpXMin;
-      double sourceY = d->TmpYMin;
-      double sourceW = d->TmpXMax - d->TmpXMin;
-      double sourceH = d->TmpYMax - d->TmpYMin;
+      // The rendered region is cached, moving the cursor only redraws the
+      // annotations.
+      d->renderViewport();
       QPainter painter( &(d->TmpImage) );
-      QImage tmpI = *img;
-      if( d->InvertImage )
+      if( !d->RenderedPixmap.isNull() )
         {
-        tmpI.invertPixels();
-        }
-      if( d->FlipXAxis || d->FlipYAxis )
-        {
-        tmpI = tmpI.mirrored( d->FlipXAxis, d->FlipYAxis );
-        if( d->FlipXAxis )
-          {
-          sourceX = tmpI.width() - (d->TmpXMax - d->TmpXMin) - d->TmpXMin;
-          }
-        if( d->FlipYAxis )
-          {
-          sourceY = tmpI.height() - (d->TmpYMax - d->TmpYMin) - d->TmpYMin;
-          }
+        painter.drawPixmap( target, d->RenderedPixmap,
+          QRectF( d->RenderedPixmap.rect() ) );
         }
-      QRectF source( sourceX, sourceY, sourceW, sourceH );
-      painter.drawPixmap( target, QPixmap::fromImage( tmpI ), source );
 
       //if( ! sizeChanged )
         {
@@ -1047,7 +1432,7 @@ void ctkQImageView::update( bool zoomChanged,
           QRectF spaceBound = painter.boundingRect( pointRect, textFlags,
             "X" );
     
-          if( img->isGrayscale() )
+          if( img->isScalar() )
             {
             QString intString = "Intensity Range = ";
             intString.append( QString::number( d->IntensityMin,
@@ -1100,13 +1485,13 @@ void ctkQImageView::update( bool zoomChanged,
     
           QString dimString = "Size = ";
           dimString.append( 
-            QString::number( d->ImageList[ d->SliceNumber ].width() ) );
+            QString::number( d->SliceList[ d->SliceNumber ].Width ) );
           dimString.append( ", " );
           dimString.append( 
-            QString::number( d->ImageList[ d->SliceNumber ].height() ) );
+            QString::number( d->SliceList[ d->SliceNumber ].Height ) );
           dimString.append( ", " );
           dimString.append( 
-            QString::number( d->ImageList.size() ) );
+            QString::number( d->SliceList.size() ) );
           QRectF dimBound = painter.boundingRect( pointRect, textFlags,
             dimString );
           QRectF dimRect( 
@@ -77,8 +77,18 @@ public:
 
   double zoom( void );
 
+  /// Add a slice of scalar intensities, the buffer of \a width x \a height
+  /// values is copied. The slices are displayed through a lookup table
+  /// computed from the intensity window/level, floating point slices are
+  /// quantized to 65536 levels of their range.
+  void addImage( const unsigned short* buffer, int width, int height );
+  void addImage( const short* buffer, int width, int height );
+  void addImage( const float* buffer, int width, int height );
+
 public Q_SLOTS:
 
+  /// Add a slice. Grayscale images are displayed through the intensity
+  /// window/level like the scalar slices.
   void addImage( const QImage & image );
   void clearImages( void );
 
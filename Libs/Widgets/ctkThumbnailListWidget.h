@@ -31,6 +31,8 @@ class ctkThumbnailListWidgetPrivate;
 class ctkThumbnailLabel;
 
 /// \ingroup Widgets
+/// Displays the thumbnails with a ctkThumbnailLabel each. For large numbers
+/// of images, see ctkThumbnailView which only paints the visible ones.
 class CTK_WIDGETS_EXPORT ctkThumbnailListWidget : public QWidget
 {
   Q_OBJECT
@@ -0,0 +1,387 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCache>
+#include <QImage>
+#include <QImageReader>
+#include <QPainter>
+#include <QPixmap>
+#include <QRunnable>
+#include <QSet>
+#include <QStringList>
+#include <QStyle>
+#include <QStyledItemDelegate>
+#include <QThread>
+#include <QThreadPool>
+
+// CTK includes
+#include "ctkThumbnailView.h"
+
+namespace
+{
+const int ThumbnailMargin = 4;
+}
+
+//----------------------------------------------------------------------------
+class ctkThumbnailViewPrivate
+{
+  Q_DECLARE_PUBLIC(ctkThumbnailView);
+protected:
+  ctkThumbnailView* const q_ptr;
+
+public:
+  ctkThumbnailViewPrivate(ctkThumbnailView& object);
+
+  void init();
+
+  /// Queue the image file unless it is cached, queued, being read or could
+  /// not be read.
+  void requestThumbnail(const QString& path);
+  /// Read the queued image files while threads are available.
+  void startTasks();
+
+  void _q_onThumbnailLoaded(const QString& path, const QImage& image, const QSize& size);
+
+  QSize ThumbnailSize;
+  QCache<QString, QPixmap> Cache;
+  QThreadPool ThreadPool;
+
+  /// Image files to read, in the order their cells were painted.
+  QStringList PendingPaths;
+  QSet<QString> LoadingPaths;
+  QSet<QString> FailedPaths;
+};
+
+//----------------------------------------------------------------------------
+/// Reads an image file scaled to the thumbnail size in a thread of the pool.
+class ctkThumbnailViewTask : public QRunnable
+{
+public:
+  ctkThumbnailViewTask(ctkThumbnailView* view, const QString& path, const QSize& size)
+    : View(view), Path(path), Size(size)
+  {
+  }
+
+  virtual void run()
+  {
+    QImageReader reader(this->Path);
+    QSize imageSize = reader.size();
+    if (imageSize.isValid())
+      {
+      // Let the image handler decode at the thumbnail size when it can
+      reader.setScaledSize(imageSize.scaled(this->Size, Qt::KeepAspectRatio));
+      }
+    QImage image = reader.read();
+    if (!image.isNull() && !imageSize.isValid())
+      {
+      image = image.scaled(this->Size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+      }
+    // The view waits for the tasks to be done before being destroyed
+    QMetaObject::invokeMethod(this->View, "_q_onThumbnailLoaded", Qt::QueuedConnection,
+                              Q_ARG(QString, this->Path), Q_ARG(QImage, image),
+                              Q_ARG(QSize, this->Size));
+  }
+
+protected:
+  ctkThumbnailView* View;
+  QString Path;
+  QSize Size;
+};
+
+//----------------------------------------------------------------------------
+/// Paints the cached thumbnail of an item and its label underneath, or
+/// requests the thumbnail and paints a frame if it is not loaded yet.
+class ctkThumbnailViewDelegate : public QStyledItemDelegate
+{
+public:
+  ctkThumbnailViewDelegate(ctkThumbnailViewPrivate* view, QWidget* parent)
+    : QStyledItemDelegate(parent), View(view), Widget(parent)
+  {
+  }
+
+  virtual QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index)const
+  {
+    Q_UNUSED(index);
+    return QSize(this->View->ThumbnailSize.width() + 2 * ThumbnailMargin,
+                 this->View->ThumbnailSize.height() + option.fontMetrics.height()
+                 + 3 * ThumbnailMargin);
+  }
+
+  virtual void paint(QPainter* painter, const QStyleOptionViewItem& option,
+                     const QModelIndex& index)const
+  {
+    this->Widget->style()->drawPrimitive(QStyle::PE_PanelItemViewItem, &option, painter, this->Widget);
+
+    QRect thumbnailRect(QPoint(0, 0), this->View->ThumbnailSize);
+    thumbnailRect.moveCenter(QPoint(option.rect.center().x(),
+                                    option.rect.top() + ThumbnailMargin
+                                    + this->View->ThumbnailSize.height() / 2));
+
+    QString path = index.data(ctkThumbnailView::ThumbnailPathRole).toString();
+    QPixmap* pixmap = path.isEmpty() ? 0 : this->View->Cache.object(path);
+    if (pixmap)
+      {
+      QRect pixmapRect(QPoint(0, 0), pixmap->size());
+      pixmapRect.moveCenter(thumbnailRect.center());
+      painter->drawPixmap(pixmapRect, *pixmap);
+      }
+    else
+      {
+      this->View->requestThumbnail(path);
+      painter->save();
+      painter->setPen(option.palette.color(QPalette::Mid));
+      painter->drawRect(thumbnailRect.adjusted(0, 0, -1, -1));
+      painter->restore();
+      }
+
+    QString label = index.data(Qt::DisplayRole).toString();
+    if (!label.isEmpty())
+      {
+      QRect textRect(option.rect.left() + ThumbnailMargin,
+                     thumbnailRect.bottom() + ThumbnailMargin,
+                     option.rect.width() - 2 * ThumbnailMargin,
+                     option.fontMetrics.height());
+      QPalette::ColorGroup group = (option.state & QStyle::State_Enabled) ?
+        QPalette::Normal : QPalette::Disabled;
+      QPalette::ColorRole role = (option.state & QStyle::State_Selected) ?
+        QPalette::HighlightedText : QPalette::Text;
+      painter->save();
+      painter->setPen(option.palette.color(group, role));
+      painter->drawText(textRect, Qt::AlignHCenter | Qt::AlignTop,
+                        option.fontMetrics.elidedText(label, Qt::ElideMiddle, textRect.width()));
+      painter->restore();
+      }
+  }
+
+protected:
+  ctkThumbnailViewPrivate* View;
+  QWidget* Widget;
+};
+
+#include "moc_ctkThumbnailView.cpp"
+
+//----------------------------------------------------------------------------
+ctkThumbnailViewPrivate::ctkThumbnailViewPrivate(ctkThumbnailView& object)
+  : q_ptr(&object)
+  , ThumbnailSize(128, 128)
+{
+}
+
+//----------------------------------------------------------------------------
+void ctkThumbnailViewPrivate::init()
+{
+  Q_Q(ctkThumbnailView);
+  this->Cache.setMaxCost(50 * 1024);
+  this->ThreadPool.setMaxThreadCount(QThread::idealThreadCount());
+
+  q->setViewMode(QListView::IconMode);
+  q->setMovement(QListView::Static);
+  q->setResizeMode(QListView::Adjust);
+  q->setLayoutMode(QListView::Batched);
+  q->setUniformItemSizes(true);
+  q->setSelectionMode(QAbstractItemView::SingleSelection);
+  q->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+  q->setItemDelegate(new ctkThumbnailViewDelegate(this, q));
+}
+
+//----------------------------------------------------------------------------
+void ctkThumbnailViewPrivate::requestThumbnail(const QString& path)
+{
+  if (path.isEmpty()
+      || this->Cache.contains(path)
+      || this->LoadingPaths.contains(path)
+      || this->FailedPaths.contains(path)
+      || this->PendingPaths.contains(path))
+    {
+    return;
+    }
+  this->PendingPaths.append(path);
+  this->startTasks();
+}
+
+//----------------------------------------------------------------------------
+void ctkThumbnailViewPrivate::startTasks()
+{
+  Q_Q(ctkThumbnailView);
+  // Only as many tasks as threads are given to the pool, the other files
+  // stay in PendingPaths to be discarded when the viewport scrolls away.
+  while (!this->PendingPaths.isEmpty()
+         && this->LoadingPaths.count() < this->ThreadPool.maxThreadCount())
+    {
+    QString path = this->PendingPaths.takeFirst();
+    this->LoadingPaths.insert(path);
+    this->ThreadPool.start(new ctkThumbnailViewTask(q, path, this->ThumbnailSize));
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkThumbnailViewPrivate::_q_onThumbnailLoaded(const QString& path, const QImage& image,
+                                                   const QSize& size)
+{
+  Q_Q(ctkThumbnailView);
+  this->LoadingPaths.remove(path);
+  // Images read before the thumbnail size changed are requested again
+  // when their cell is repainted.
+  bool upToDate = (size == this->ThumbnailSize);
+  if (upToDate)
+    {
+    if (image.isNull())
+      {
+      this->FailedPaths.insert(path);
+      }
+    else
+      {
+      int cost = qMax(1, image.bytesPerLine() * image.height() / 1024);
+      if (!this->Cache.insert(path, new QPixmap(QPixmap::fromImage(image)), cost))
+        {
+        // Larger than the cache, don't read it over and over.
+        this->FailedPaths.insert(path);
+        }
+      }
+    }
+  this->startTasks();
+  q->viewport()->update();
+  if (upToDate)
+    {
+    emit q->thumbnailLoaded(path);
+    }
+}
+
+//----------------------------------------------------------------------------
+ctkThumbnailView::ctkThumbnailView(QWidget* parentWidget)
+  : Superclass(parentWidget)
+  , d_ptr(new ctkThumbnailViewPrivate(*this))
+{
+  Q_D(ctkThumbnailView);
+  d->init();
+}
+
+//----------------------------------------------------------------------------
+ctkThumbnailView::~ctkThumbnailView()
+{
+  Q_D(ctkThumbnailView);
+  d->PendingPaths.clear();
+  d->ThreadPool.waitForDone();
+}
+
+//----------------------------------------------------------------------------
+QSize ctkThumbnailView::thumbnailSize()const
+{
+  Q_D(const ctkThumbnailView);
+  return d->ThumbnailSize;
+}
+
+//----------------------------------------------------------------------------
+void ctkThumbnailView::setThumbnailSize(QSize size)
+{
+  Q_D(ctkThumbnailView);
+  if (size == d->ThumbnailSize || !size.isValid())
+    {
+    return;
+    }
+  d->ThumbnailSize = size;
+  d->Cache.clear();
+  d->PendingPaths.clear();
+  d->FailedPaths.clear();
+  // The delegate size hint changed
+  this->scheduleDelayedItemsLayout();
+  this->viewport()->update();
+}
+
+//----------------------------------------------------------------------------
+void ctkThumbnailView::setCacheLimit(int kilobytes)
+{
+  Q_D(ctkThumbnailView);
+  d->Cache.setMaxCost(kilobytes);
+}
+
+//----------------------------------------------------------------------------
+int ctkThumbnailView::cacheLimit()const
+{
+  Q_D(const ctkThumbnailView);
+  return d->Cache.maxCost();
+}
+
+//----------------------------------------------------------------------------
+int ctkThumbnailView::cacheSize()const
+{
+  Q_D(const ctkThumbnailView);
+  return d->Cache.totalCost();
+}
+
+//----------------------------------------------------------------------------
+void ctkThumbnailView::setMaxThreadCount(int count)
+{
+  Q_D(ctkThumbnailView);
+  d->ThreadPool.setMaxThreadCount(qMax(1, count));
+  d->startTasks();
+}
+
+//----------------------------------------------------------------------------
+int ctkThumbnailView::maxThreadCount()const
+{
+  Q_D(const ctkThumbnailView);
+  return d->ThreadPool.maxThreadCount();
+}
+
+//----------------------------------------------------------------------------
+QPixmap ctkThumbnailView::thumbnail(const QString& path)const
+{
+  Q_D(const ctkThumbnailView);
+  QPixmap* pixmap = d->Cache.object(path);
+  return pixmap ? *pixmap : QPixmap();
+}
+
+//----------------------------------------------------------------------------
+int ctkThumbnailView::pendingThumbnailCount()const
+{
+  Q_D(const ctkThumbnailView);
+  return d->PendingPaths.count() + d->LoadingPaths.count();
+}
+
+//----------------------------------------------------------------------------
+void ctkThumbnailView::reloadThumbnail(const QString& path)
+{
+  Q_D(ctkThumbnailView);
+  d->Cache.remove(path);
+  d->FailedPaths.remove(path);
+  this->viewport()->update();
+}
+
+//----------------------------------------------------------------------------
+void ctkThumbnailView::clearThumbnails()
+{
+  Q_D(ctkThumbnailView);
+  d->Cache.clear();
+  d->PendingPaths.clear();
+  d->FailedPaths.clear();
+  this->viewport()->update();
+}
+
+//----------------------------------------------------------------------------
+void ctkThumbnailView::scrollContentsBy(int dx, int dy)
+{
+  Q_D(ctkThumbnailView);
+  // The files of the cells scrolled out of the viewport are not read, the
+  // repaint requests the files of the cells scrolled in.
+  d->PendingPaths.clear();
+  this->Superclass::scrollContentsBy(dx, dy);
+}
@@ -0,0 +1,116 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkThumbnailView_h
+#define __ctkThumbnailView_h
+
+// Qt includes
+#include <QListView>
+class QImage;
+
+// CTK includes
+#include "ctkWidgetsExport.h"
+class ctkThumbnailViewPrivate;
+
+/// \ingroup Widgets
+///
+/// \brief The ctkThumbnailView displays the image files of a model as a grid
+/// of thumbnails.
+///
+/// Unlike ctkThumbnailListWidget, which creates a widget and loads a pixmap
+/// for every thumbnail, ctkThumbnailView only paints the visible cells of the
+/// model. The image file of an item is given by its ThumbnailPathRole data
+/// and its label by its Qt::DisplayRole data.
+/// The image files are read and scaled on a thread pool the first time their
+/// cell is painted, the cells of the viewport being loaded first, and the
+/// thumbnails are kept in a cache of limited size.
+/// \sa ctkThumbnailListWidget
+class CTK_WIDGETS_EXPORT ctkThumbnailView : public QListView
+{
+  Q_OBJECT
+  Q_PROPERTY(QSize thumbnailSize READ thumbnailSize WRITE setThumbnailSize)
+  Q_PROPERTY(int cacheLimit READ cacheLimit WRITE setCacheLimit)
+  Q_PROPERTY(int maxThreadCount READ maxThreadCount WRITE setMaxThreadCount)
+public:
+  typedef QListView Superclass;
+
+  enum
+  {
+    /// A role for getting the path of the image file from the items of the model.
+    ThumbnailPathRole = Qt::UserRole + 1
+  };
+
+  explicit ctkThumbnailView(QWidget* parent=0);
+  virtual ~ctkThumbnailView();
+
+  /// Size the images are scaled to, keeping their aspect ratio.
+  /// 128x128 by default.
+  QSize thumbnailSize()const;
+
+  /// Maximum size, in kilobytes, of the cached thumbnails.
+  /// It should be large enough to hold the thumbnails of the viewport.
+  /// 51200 (50MB) by default.
+  void setCacheLimit(int kilobytes);
+  int cacheLimit()const;
+
+  /// Size, in kilobytes, of the cached thumbnails.
+  int cacheSize()const;
+
+  /// Maximum number of threads reading the image files.
+  /// QThread::idealThreadCount() by default.
+  void setMaxThreadCount(int count);
+  int maxThreadCount()const;
+
+  /// Return the cached thumbnail of the image file or a null pixmap if it
+  /// is not loaded.
+  QPixmap thumbnail(const QString& path)const;
+
+  /// Number of image files waiting to be read or being read.
+  int pendingThumbnailCount()const;
+
+public Q_SLOTS:
+  void setThumbnailSize(QSize size);
+
+  /// Discard the cached thumbnail of the image file, it is read again the
+  /// next time its cell is painted. To be called when the file has changed
+  /// or has been created.
+  void reloadThumbnail(const QString& path);
+
+  /// Discard all the cached thumbnails.
+  void clearThumbnails();
+
+Q_SIGNALS:
+  /// Emitted when the image file has been read, thumbnail(path) is null if
+  /// it could not be read.
+  void thumbnailLoaded(const QString& path);
+
+protected:
+  QScopedPointer<ctkThumbnailViewPrivate> d_ptr;
+
+  virtual void scrollContentsBy(int dx, int dy);
+
+private:
+  Q_DECLARE_PRIVATE(ctkThumbnailView);
+  Q_DISABLE_COPY(ctkThumbnailView);
+
+  Q_PRIVATE_SLOT(d_func(), void _q_onThumbnailLoaded(const QString& path, const QImage& image, const QSize& size))
+};
+
+#endif
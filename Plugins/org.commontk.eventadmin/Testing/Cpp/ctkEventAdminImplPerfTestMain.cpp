@@ -65,6 +65,13 @@ int main(int argc, char** argv)
 
   fwProps.insert("org.commontk.eventadmin.ThreadPoolSize", 10);
 
+  // Allows comparing the asynchronous dispatch backends
+  QByteArray asyncDispatcher = qgetenv("CTK_EVENTADMIN_ASYNC_DISPATCHER");
+  if (!asyncDispatcher.isEmpty())
+  {
+    fwProps.insert("org.commontk.eventadmin.AsyncDispatcher", QString(asyncDispatcher));
+  }
+
   testRunner.init(fwProps);
   return testRunner.run(argc, argv);
 }
@@ -42,10 +42,11 @@ const QString ctkEAConfiguration::PROP_TIMEOUT = "org.commontk.eventadmin.Timeou
 const QString ctkEAConfiguration::PROP_REQUIRE_TOPIC = "org.commontk.eventadmin.RequireTopic";
 const QString ctkEAConfiguration::PROP_IGNORE_TIMEOUT = "org.commontk.eventadmin.IgnoreTimeout";
 const QString ctkEAConfiguration::PROP_LOG_LEVEL = "org.commontk.eventadmin.LogLevel";
+const QString ctkEAConfiguration::PROP_ASYNC_DISPATCHER = "org.commontk.eventadmin.AsyncDispatcher";
 
 
 ctkEAConfiguration::ctkEAConfiguration(ctkPluginContext* pluginContext )
-  : pluginContext(pluginContext), sync_pool(0), async_pool(0), admin(0)
+  : pluginContext(pluginContext), sync_pool(0), async_pool(0), async_executor(0), admin(0)
 {
   // default configuration
   configure(ctkDictionary());
@@ -137,6 +138,10 @@ void ctkEAConfiguration::configure(const ctkDictionary& config )
                               pluginContext->getProperty(PROP_LOG_LEVEL),
                               ctkLogService::LOG_WARNING, // default log level is WARNING
                               ctkLogService::LOG_ERROR);
+
+    // The backend delivering asynchronous events - "pooled" (the default) or
+    // "workstealing".
+    asyncDispatcher = pluginContext->getProperty(PROP_ASYNC_DISPATCHER).toString();
   }
   else
   {
@@ -159,6 +164,17 @@ void ctkEAConfiguration::configure(const ctkDictionary& config )
                               config.value(PROP_LOG_LEVEL),
                               ctkLogService::LOG_WARNING, // default log level is WARNING
                               ctkLogService::LOG_ERROR);
+    asyncDispatcher = config.value(PROP_ASYNC_DISPATCHER).toString();
+  }
+  asyncDispatcher = asyncDispatcher.trimmed().toLower();
+  if (asyncDispatcher != "workstealing")
+  {
+    if (!asyncDispatcher.isEmpty() && asyncDispatcher != "pooled")
+    {
+      CTK_WARN(ctkEventAdminActivator::getLogService())
+          << "Unknown value for property:" << PROP_ASYNC_DISPATCHER << " - Using default: pooled";
+    }
+    asyncDispatcher = "pooled";
   }
   // a timeout less or equals to 100 means : disable timeout
   if (timeout <= 100)
@@ -193,9 +209,19 @@ void ctkEAConfiguration::destroy()
   if (admin)
   {
     admin->stop();
+    // deliver the events already posted while the admin is still alive
+    if (async_executor)
+    {
+      async_executor->close();
+    }
     delete admin;
     admin = 0;
   }
+  if (async_executor)
+  {
+    delete async_executor;
+    async_executor = 0;
+  }
   if (async_pool)
   {
     async_pool->close();
@@ -222,6 +248,8 @@ void ctkEAConfiguration::startOrUpdate()
       << PROP_TIMEOUT << "=" << timeout;
   CTK_DEBUG(ctkEventAdminActivator::getLogService())
       << PROP_REQUIRE_TOPIC << "=" << requireTopic;
+  CTK_DEBUG(ctkEventAdminActivator::getLogService())
+      << PROP_ASYNC_DISPATCHER << "=" << asyncDispatcher;
 
   ctkEventAdminService::TopicHandlerFiltersInterface* topicHandlerFilters =
       new ctkEventAdminService::TopicHandlerFilters(
@@ -258,14 +286,24 @@ void ctkEAConfiguration::startOrUpdate()
   // for a given event. Additionally, it keeps a list of blacklisted handlers.
   // Note that blacklisting is deactivated by selecting a different scheduler
   // below (and not in this HandlerTasks object!)
+  // The handler index tracks the ctkEventHandler services by topic, so that
+  // the framework is not queried for each event.
   ctkEventAdminService::HandlerTasksInterface* handlerTasks =
       new ctkEventAdminService::BlacklistingHandlerTasks(
-        pluginContext, new ctkEventAdminService::BlackList(), topicHandlerFilters, filters);
+        pluginContext, new ctkEventAdminService::BlackList(), topicHandlerFilters, filters,
+        new ctkEAHandlerIndex(pluginContext, requireTopic));
 
   if (admin == 0)
   {
+    // The work-stealing executor replaces the asynchronous thread pool for
+    // the delivery of posted events, using as many worker threads.
+    if (asyncDispatcher == "workstealing")
+    {
+      async_executor = new ctkEAWorkStealingExecutor(asyncThreadPoolSize);
+    }
+
     admin = new ctkEventAdminService(pluginContext, handlerTasks, sync_pool, async_pool,
-                                     timeout, ignoreTimeout);
+                                     timeout, ignoreTimeout, async_executor);
 
     // Finally, adapt the outside events to our kind of events as per spec
     adaptEvents(admin);
@@ -280,6 +318,11 @@ void ctkEAConfiguration::startOrUpdate()
   }
   else
   {
+    if ((async_executor != 0) != (asyncDispatcher == "workstealing"))
+    {
+      CTK_WARN(ctkEventAdminActivator::getLogService())
+          << PROP_ASYNC_DISPATCHER << " is only read when the event admin is started";
+    }
     admin->update(handlerTasks, timeout, ignoreTimeout);
   }
 
@@ -89,6 +89,19 @@ class ctkEAAbstractAdapter;
  * pure optimization!
  * The value is a list of strings (separated by comma) which is assumed to define
  * exact class names.
+ * </p>
+ * <p>
+ * <p>
+ *      <tt>org.commontk.eventadmin.AsyncDispatcher</tt> - The backend delivering
+ *          asynchronous events.
+ * </p>
+ * Either <tt>pooled</tt> (the default) or <tt>workstealing</tt>. The pooled backend
+ * hands the events of each posting thread to a thread of the asynchronous thread
+ * pool. The work-stealing backend runs them on a fixed set of worker threads which
+ * share the load without taking locks, which scales better when many threads post
+ * events concurrently. Both deliver the events posted from one thread in order.
+ * This property is only read when the event admin is started.
+ * </p>
  *
  * These properties are read at startup and serve as a default configuration.
  * If a configuration admin is configured, the event admin can be configured
@@ -110,6 +123,7 @@ public:
   static const QString PROP_REQUIRE_TOPIC; // = "org.commontk.eventadmin.RequireTopic"
   static const QString PROP_IGNORE_TIMEOUT; // = "org.commontk.eventadmin.IgnoreTimeout"
   static const QString PROP_LOG_LEVEL; // = "org.commontk.eventadmin.LogLevel"
+  static const QString PROP_ASYNC_DISPATCHER; // = "org.commontk.eventadmin.AsyncDispatcher"
 
 private:
 
@@ -130,10 +144,16 @@ private:
 
   int logLevel;
 
+  QString asyncDispatcher;
+
   // The thread pool used - this is a member because we need to close it on stop
   ctkEADefaultThreadPool* sync_pool;
   ctkEADefaultThreadPool* async_pool;
 
+  // The executor used for asynchronous events instead of async_pool, if the
+  // work-stealing dispatcher is configured
+  ctkEAWorkStealingExecutor* async_executor;
+
   // The actual implementation of the service - this is a member because we need to
   // close it on stop. Note, security is not part of this implementation but is
   // added via a decorator in the start method (this is the wrapped object without
@@ -21,13 +21,14 @@
 
 
 #include "dispatch/ctkEADefaultThreadPool_p.h"
+#include "dispatch/ctkEAWorkStealingExecutor_p.h"
 
 
 template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
 ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::ctkEventAdminImpl(
   HandlerTasksInterface* managers, ctkEADefaultThreadPool* syncPool,
   ctkEADefaultThreadPool* asyncPool, int timeout,
-  const QStringList& ignoreTimeout)
+  const QStringList& ignoreTimeout, ctkEAWorkStealingExecutor* asyncExecutor)
   : managers(managers)
 {
   checkNull(managers, "Managers");
@@ -38,7 +39,7 @@ ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::ctkEventAdmi
                                      (timeout > 100 ? timeout : 0),
                                      ignoreTimeout);
 
-  postManager = new AsyncDeliverTasks(asyncPool, sendManager);
+  postManager = new AsyncDeliverTasks(asyncPool, sendManager, asyncExecutor);
 }
 
 template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
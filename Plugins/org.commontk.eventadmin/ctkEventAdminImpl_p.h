@@ -28,6 +28,7 @@
 #include "dispatch/ctkEASyncMasterThread_p.h"
 
 class ctkEADefaultThreadPool;
+class ctkEAWorkStealingExecutor;
 
 /**
  * This is the actual implementation of the OSGi R4 Event Admin Service (see the
@@ -98,12 +99,15 @@ public:
    * @param managers The factory used to determine applicable <tt>ctkEventHandler</tt>
    * @param syncPool The synchronous thread pool
    * @param asyncPool The asynchronous thread pool
+   * @param asyncExecutor The executor for asynchronous events, or null to
+   *        use the asynchronous thread pool
    */
   ctkEventAdminImpl(HandlerTasksInterface* managers,
                     ctkEADefaultThreadPool* syncPool,
                     ctkEADefaultThreadPool* asyncPool,
                     int timeout,
-                    const QStringList& ignoreTimeout);
+                    const QStringList& ignoreTimeout,
+                    ctkEAWorkStealingExecutor* asyncExecutor = 0);
 
   ~ctkEventAdminImpl();
 
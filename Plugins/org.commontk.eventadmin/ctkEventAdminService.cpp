@@ -31,8 +31,9 @@ ctkEventAdminService::ctkEventAdminService(ctkPluginContext* context,
                                            ctkEADefaultThreadPool* syncPool,
                                            ctkEADefaultThreadPool* asyncPool,
                                            int timeout,
-                                           const QStringList& ignoreTimeout)
-  : impl(managers, syncPool, asyncPool, timeout, ignoreTimeout),
+                                           const QStringList& ignoreTimeout,
+                                           ctkEAWorkStealingExecutor* asyncExecutor)
+  : impl(managers, syncPool, asyncPool, timeout, ignoreTimeout, asyncExecutor),
     context(context)
 {
 
@@ -161,8 +162,15 @@ qlonglong ctkEventAdminService::subscribeSlot(const QObject* subscriber, const c
     throw ctkInvalidArgumentException("connection type invalid");
   }
 
-  ctkEASlotHandler* handler = new ctkEASlotHandler();
-  connect(handler, SIGNAL(eventOccured(ctkEvent)), subscriber, member, type);
+  ctkEASlotHandler* handler = new ctkEASlotHandler(properties);
+  if (handler->getDeliveryMode() == ctkEASlotHandler::BatchDelivery)
+  {
+    connect(handler, SIGNAL(eventsOccured(QList<ctkEvent>)), subscriber, member, type);
+  }
+  else
+  {
+    connect(handler, SIGNAL(eventOccured(ctkEvent)), subscriber, member, type);
+  }
   ctkServiceRegistration reg = context->registerService<ctkEventHandler>(handler, properties);
   handler->reg = reg;
   qlonglong id = reg.getReference().getProperty(ctkPluginConstants::SERVICE_ID).toLongLong();
@@ -80,7 +80,8 @@ public:
                        ctkEADefaultThreadPool* syncPool,
                        ctkEADefaultThreadPool* asyncPool,
                        int timeout,
-                       const QStringList& ignoreTimeout);
+                       const QStringList& ignoreTimeout,
+                       ctkEAWorkStealingExecutor* asyncExecutor = 0);
 
   ~ctkEventAdminService();
 
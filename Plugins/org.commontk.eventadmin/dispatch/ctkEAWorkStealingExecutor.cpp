@@ -0,0 +1,583 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkEAWorkStealingExecutor_p.h"
+
+#include "ctkEAInterruptibleThread_p.h"
+
+#include <ctkEventAdminActivator_p.h>
+
+#include <QThread>
+
+#include <stdexcept>
+
+namespace {
+
+// Positions of the queues below wrap around, avoid signed overflow
+inline int ctkEAWrappingAdd(int position, int value)
+{
+  return static_cast<int>(static_cast<unsigned int>(position) + static_cast<unsigned int>(value));
+}
+
+// Number of tasks of a lane run in a row before giving other lanes a chance
+const int LANE_BATCH_SIZE = 16;
+
+// Number of unsuccessful lookups for work before a worker goes to sleep
+const int IDLE_SPIN_COUNT = 64;
+
+}
+
+/**
+ * The tasks submitted from one thread. Any thread can push, only the worker
+ * the lane is scheduled on pops (unbounded multiple producers / single
+ * consumer linked queue).
+ */
+class ctkEAWorkStealingExecutor::Lane
+{
+
+public:
+
+  // Number of tasks pushed and not run yet. The thread making it go from
+  // 0 to 1 schedules the lane.
+  QAtomicInt pending;
+
+  Lane()
+  {
+    Node* stub = new Node(0);
+    head.fetchAndStoreRelaxed(stub);
+    tail = stub;
+  }
+
+  ~Lane()
+  {
+    while (pop()) {}
+    delete tail;
+  }
+
+  void push(ctkEARunnable* task)
+  {
+    Node* node = new Node(task);
+    Node* previous = head.fetchAndStoreOrdered(node);
+    previous->next.fetchAndStoreRelease(node);
+  }
+
+  ctkEARunnable* pop()
+  {
+    Node* next = tail->next.fetchAndAddAcquire(0);
+    if (next == 0)
+    {
+      return 0;
+    }
+    ctkEARunnable* task = next->task;
+    delete tail;
+    tail = next;
+    return task;
+  }
+
+private:
+
+  struct Node
+  {
+    Node(ctkEARunnable* task) : task(task) {}
+    ctkEARunnable* task;
+    QAtomicPointer<Node> next;
+  };
+
+  QAtomicPointer<Node> head;
+  Node* tail;
+};
+
+/**
+ * The lane used by a submitting thread. Deleted by QThreadStorage when the
+ * thread finishes, which releases the slot of the lane table.
+ */
+class ctkEAWorkStealingExecutor::LaneOwner
+{
+
+public:
+
+  LaneSlot* const slot;
+  Lane* const lane;
+
+  LaneOwner(LaneSlot* slot, Lane* lane)
+    : slot(slot), lane(lane)
+  {}
+
+  ~LaneOwner()
+  {
+    if (slot)
+    {
+      slot->used.fetchAndStoreRelease(0);
+    }
+  }
+};
+
+/**
+ * The lanes scheduled on a worker. The owning worker pushes and pops at the
+ * bottom, other workers steal from the top (Chase-Lev deque with a fixed
+ * capacity).
+ */
+class ctkEAWorkStealingExecutor::LaneDeque
+{
+
+public:
+
+  enum { CAPACITY = 1024 };
+
+  /**
+   * Only called by the owner. Return false if the deque is full.
+   */
+  bool push(Lane* lane)
+  {
+    int b = bottom.fetchAndAddOrdered(0);
+    int t = top.fetchAndAddAcquire(0);
+    if (ctkEAWrappingAdd(b, -t) >= CAPACITY)
+    {
+      return false;
+    }
+    slots[b & (CAPACITY - 1)].fetchAndStoreRelease(lane);
+    bottom.fetchAndStoreOrdered(ctkEAWrappingAdd(b, 1));
+    return true;
+  }
+
+  /**
+   * Only called by the owner.
+   */
+  Lane* pop()
+  {
+    int b = ctkEAWrappingAdd(bottom.fetchAndAddOrdered(0), -1);
+    bottom.fetchAndStoreOrdered(b);
+    int t = top.fetchAndAddOrdered(0);
+    int size = ctkEAWrappingAdd(b, -t);
+    if (size < 0)
+    {
+      bottom.fetchAndStoreOrdered(ctkEAWrappingAdd(b, 1));
+      return 0;
+    }
+    Lane* lane = slots[b & (CAPACITY - 1)].fetchAndAddAcquire(0);
+    if (size > 0)
+    {
+      return lane;
+    }
+    // Last lane, race against the thieves
+    if (!top.testAndSetOrdered(t, ctkEAWrappingAdd(t, 1)))
+    {
+      lane = 0;
+    }
+    bottom.fetchAndStoreOrdered(ctkEAWrappingAdd(b, 1));
+    return lane;
+  }
+
+  /**
+   * Called by any worker but the owner.
+   */
+  Lane* steal()
+  {
+    int t = top.fetchAndAddOrdered(0);
+    int b = bottom.fetchAndAddOrdered(0);
+    if (ctkEAWrappingAdd(b, -t) <= 0)
+    {
+      return 0;
+    }
+    Lane* lane = slots[t & (CAPACITY - 1)].fetchAndAddAcquire(0);
+    if (!top.testAndSetOrdered(t, ctkEAWrappingAdd(t, 1)))
+    {
+      return 0;
+    }
+    return lane;
+  }
+
+private:
+
+  QAtomicInt top;
+  QAtomicInt bottom;
+  QAtomicPointer<Lane> slots[CAPACITY];
+};
+
+/**
+ * The lanes scheduled from threads which are not workers (bounded multiple
+ * producers / multiple consumers queue). Each cell has a sequence number
+ * telling whether it is free for the producer owning the position or
+ * filled for the consumer owning the position.
+ */
+class ctkEAWorkStealingExecutor::LaneQueue
+{
+
+public:
+
+  enum { CAPACITY = 4096 };
+
+  LaneQueue()
+  {
+    for (int i = 0; i < CAPACITY; ++i)
+    {
+      cells[i].sequence.fetchAndStoreRelaxed(i);
+    }
+  }
+
+  bool tryPush(Lane* lane)
+  {
+    int position = enqueuePosition.fetchAndAddRelaxed(0);
+    Cell* cell = 0;
+    while (true)
+    {
+      cell = &cells[position & (CAPACITY - 1)];
+      int diff = ctkEAWrappingAdd(cell->sequence.fetchAndAddAcquire(0), -position);
+      if (diff == 0)
+      {
+        if (enqueuePosition.testAndSetRelaxed(position, ctkEAWrappingAdd(position, 1)))
+        {
+          break;
+        }
+      }
+      else if (diff < 0)
+      {
+        return false;
+      }
+      position = enqueuePosition.fetchAndAddRelaxed(0);
+    }
+    cell->lane = lane;
+    cell->sequence.fetchAndStoreRelease(ctkEAWrappingAdd(position, 1));
+    return true;
+  }
+
+  Lane* tryPop()
+  {
+    int position = dequeuePosition.fetchAndAddRelaxed(0);
+    Cell* cell = 0;
+    while (true)
+    {
+      cell = &cells[position & (CAPACITY - 1)];
+      int diff = ctkEAWrappingAdd(cell->sequence.fetchAndAddAcquire(0),
+                                  -ctkEAWrappingAdd(position, 1));
+      if (diff == 0)
+      {
+        if (dequeuePosition.testAndSetRelaxed(position, ctkEAWrappingAdd(position, 1)))
+        {
+          break;
+        }
+      }
+      else if (diff < 0)
+      {
+        return 0;
+      }
+      position = dequeuePosition.fetchAndAddRelaxed(0);
+    }
+    Lane* lane = cell->lane;
+    cell->sequence.fetchAndStoreRelease(ctkEAWrappingAdd(position, CAPACITY));
+    return lane;
+  }
+
+  bool isEmpty()
+  {
+    int position = dequeuePosition.fetchAndAddOrdered(0);
+    Cell* cell = &cells[position & (CAPACITY - 1)];
+    return cell->sequence.fetchAndAddOrdered(0) != ctkEAWrappingAdd(position, 1);
+  }
+
+private:
+
+  struct Cell
+  {
+    Cell() : lane(0) {}
+    QAtomicInt sequence;
+    Lane* lane;
+  };
+
+  Cell cells[CAPACITY];
+  QAtomicInt enqueuePosition;
+  QAtomicInt dequeuePosition;
+};
+
+/**
+ * A worker thread. It runs the lanes of its own deque first, then the ones
+ * of the injection queue and finally steals from the other workers.
+ */
+class ctkEAWorkStealingExecutor::Worker : public QThread
+{
+
+public:
+
+  ctkEAWorkStealingExecutor* const executor;
+  const int index;
+  LaneDeque deque;
+
+  Worker(ctkEAWorkStealingExecutor* executor, int index)
+    : executor(executor), index(index)
+  {}
+
+  void schedule(Lane* lane)
+  {
+    if (!deque.push(lane))
+    {
+      while (!executor->injectionQueue->tryPush(lane))
+      {
+        QThread::yieldCurrentThread();
+      }
+    }
+    executor->wakeWorker();
+  }
+
+protected:
+
+  void run()
+  {
+    int idleCount = 0;
+    while (true)
+    {
+      Lane* lane = findLane();
+      if (lane)
+      {
+        idleCount = 0;
+        runLane(lane);
+        continue;
+      }
+
+      if (executor->closing.fetchAndAddOrdered(0) &&
+          executor->pendingTasks.fetchAndAddOrdered(0) == 0)
+      {
+        break;
+      }
+
+      if (++idleCount < IDLE_SPIN_COUNT)
+      {
+        QThread::yieldCurrentThread();
+        continue;
+      }
+
+      idleCount = 0;
+      QMutexLocker l(&executor->sleepMutex);
+      executor->sleepingWorkers.fetchAndAddOrdered(1);
+      if (executor->injectionQueue->isEmpty() && !executor->closing.fetchAndAddOrdered(0))
+      {
+        // the timeout only matters for lanes left in the deque of a busy worker
+        executor->sleepCondition.wait(&executor->sleepMutex, 100);
+      }
+      executor->sleepingWorkers.fetchAndAddOrdered(-1);
+    }
+  }
+
+private:
+
+  Lane* findLane()
+  {
+    Lane* lane = deque.pop();
+    if (lane == 0)
+    {
+      lane = executor->injectionQueue->tryPop();
+    }
+    const int workerCount = executor->workers.size();
+    for (int i = 1; lane == 0 && i < workerCount; ++i)
+    {
+      lane = executor->workers.at((index + i) % workerCount)->deque.steal();
+    }
+    return lane;
+  }
+
+  void runLane(Lane* lane)
+  {
+    for (int i = 0; i < LANE_BATCH_SIZE; ++i)
+    {
+      ctkEARunnable* task = lane->pop();
+      while (task == 0)
+      {
+        // the submitting thread is still linking the task
+        QThread::yieldCurrentThread();
+        task = lane->pop();
+      }
+      ctkEAWorkStealingExecutor::runTask(task);
+      executor->pendingTasks.fetchAndAddOrdered(-1);
+      if (lane->pending.fetchAndAddOrdered(-1) == 1)
+      {
+        // the lane is empty, the next submission reschedules it
+        return;
+      }
+    }
+    // more tasks are pending, let other lanes run first
+    schedule(lane);
+  }
+};
+
+ctkEAWorkStealingExecutor::ctkEAWorkStealingExecutor(int workerCount)
+  : injectionQueue(new LaneQueue())
+{
+  if (workerCount < 1)
+  {
+    workerCount = 1;
+  }
+  for (int i = 0; i < workerCount; ++i)
+  {
+    workers.push_back(new Worker(this, i));
+  }
+  foreach(Worker* worker, workers)
+  {
+    worker->start();
+  }
+}
+
+ctkEAWorkStealingExecutor::~ctkEAWorkStealingExecutor()
+{
+  close();
+  qDeleteAll(workers);
+  // QThreadStorage does not delete the lane owners of the threads still
+  // running once it is destroyed, so they never release a deleted slot
+  for (int i = 0; i < LANE_TABLE_SIZE; ++i)
+  {
+    delete laneTable[i].lane.fetchAndAddOrdered(0);
+  }
+  for (int i = 0; i < OVERFLOW_LANE_COUNT; ++i)
+  {
+    delete overflowLanes[i].fetchAndAddOrdered(0);
+  }
+  delete injectionQueue;
+}
+
+void ctkEAWorkStealingExecutor::execute(ctkEARunnable* task)
+{
+  ++task->ref;
+  // Count the task before looking at closing: a worker only exits once it
+  // has seen closing set and no pending task, so either it sees this task
+  // or the task is run here
+  pendingTasks.fetchAndAddOrdered(1);
+  if (closing.fetchAndAddOrdered(0))
+  {
+    pendingTasks.fetchAndAddOrdered(-1);
+    runTask(task);
+    return;
+  }
+
+  Lane* lane = getLane();
+  lane->push(task);
+  if (lane->pending.fetchAndAddOrdered(1) == 0)
+  {
+    schedule(lane);
+  }
+}
+
+void ctkEAWorkStealingExecutor::close()
+{
+  if (!closing.testAndSetOrdered(0, 1))
+  {
+    return;
+  }
+  {
+    QMutexLocker l(&sleepMutex);
+    sleepCondition.wakeAll();
+  }
+  foreach(Worker* worker, workers)
+  {
+    worker->wait();
+  }
+}
+
+int ctkEAWorkStealingExecutor::getWorkerCount() const
+{
+  return workers.size();
+}
+
+ctkEAWorkStealingExecutor::Lane* ctkEAWorkStealingExecutor::getLane()
+{
+  LaneOwner* owner = laneOwners.localData();
+  if (owner)
+  {
+    return owner->lane;
+  }
+
+  // Claim a free slot, starting at the hash of the thread. A released slot
+  // keeps its lane: the tasks left by its previous thread run first.
+  const uint hash = qHash(QThread::currentThread());
+  for (int i = 0; i < LANE_TABLE_SIZE && owner == 0; ++i)
+  {
+    LaneSlot& slot = laneTable[(hash + i) % LANE_TABLE_SIZE];
+    if (slot.used.fetchAndAddAcquire(0) == 0 && slot.used.testAndSetOrdered(0, 1))
+    {
+      Lane* lane = slot.lane.fetchAndAddAcquire(0);
+      if (lane == 0)
+      {
+        lane = new Lane();
+        slot.lane.fetchAndStoreRelease(lane);
+      }
+      owner = new LaneOwner(&slot, lane);
+    }
+  }
+
+  if (owner == 0)
+  {
+    QAtomicPointer<Lane>& overflowLane = overflowLanes[hash % OVERFLOW_LANE_COUNT];
+    Lane* lane = overflowLane.fetchAndAddAcquire(0);
+    if (lane == 0)
+    {
+      Lane* newLane = new Lane();
+      if (overflowLane.testAndSetOrdered(0, newLane))
+      {
+        lane = newLane;
+      }
+      else
+      {
+        delete newLane;
+        lane = overflowLane.fetchAndAddAcquire(0);
+      }
+    }
+    owner = new LaneOwner(0, lane);
+  }
+
+  laneOwners.setLocalData(owner);
+  return owner->lane;
+}
+
+void ctkEAWorkStealingExecutor::schedule(Lane* lane)
+{
+  Worker* worker = dynamic_cast<Worker*>(QThread::currentThread());
+  if (worker && worker->executor == this)
+  {
+    worker->schedule(lane);
+    return;
+  }
+  while (!injectionQueue->tryPush(lane))
+  {
+    QThread::yieldCurrentThread();
+  }
+  wakeWorker();
+}
+
+void ctkEAWorkStealingExecutor::wakeWorker()
+{
+  if (sleepingWorkers.fetchAndAddOrdered(0) > 0)
+  {
+    QMutexLocker l(&sleepMutex);
+    sleepCondition.wakeOne();
+  }
+}
+
+void ctkEAWorkStealingExecutor::runTask(ctkEARunnable* task)
+{
+  try
+  {
+    task->run();
+  }
+  catch (const std::exception& e)
+  {
+    CTK_WARN_EXC(ctkEventAdminActivator::getLogService(), &e)
+        << "Exception: " << e.what();
+  }
+  const bool autoDelete = task->autoDelete();
+  if (autoDelete && !--task->ref) delete task;
+}
@@ -0,0 +1,129 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKEAWORKSTEALINGEXECUTOR_P_H
+#define CTKEAWORKSTEALINGEXECUTOR_P_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QThreadStorage>
+#include <QWaitCondition>
+
+class ctkEARunnable;
+
+/**
+ * An executor running tasks on a fixed set of worker threads, without taking
+ * a lock on the dispatch path.
+ *
+ * Tasks executed from the same thread are queued in a lane owned by that
+ * thread and are run one after the other, in the order they were submitted.
+ * Lanes of different threads are run concurrently. A lane with pending tasks
+ * is scheduled on exactly one worker at a time: each worker keeps the lanes
+ * it is responsible for in its own lock-free deque and idle workers steal
+ * lanes from the deques of busy ones. Lanes becoming busy from a thread that
+ * is not a worker are handed to the workers through a shared lock-free
+ * injection queue.
+ *
+ * Workers spin briefly and then sleep on a wait condition when there is no
+ * work; the condition is only signaled if some worker is actually sleeping.
+ */
+class ctkEAWorkStealingExecutor
+{
+
+public:
+
+  /**
+   * Create the executor and start \a workerCount worker threads.
+   */
+  ctkEAWorkStealingExecutor(int workerCount);
+
+  /**
+   * Calls close().
+   */
+  ~ctkEAWorkStealingExecutor();
+
+  /**
+   * Execute the task in one of the worker threads. Tasks executed from
+   * the same thread are run in order. Once the executor is closed, the task
+   * is run in the calling thread.
+   *
+   * @param task The task to execute
+   */
+  void execute(ctkEARunnable* task);
+
+  /**
+   * Run the pending tasks and stop the worker threads.
+   */
+  void close();
+
+  /**
+   * The number of worker threads.
+   */
+  int getWorkerCount() const;
+
+private:
+
+  class Lane;
+  class LaneDeque;
+  class LaneQueue;
+  class LaneOwner;
+  class Worker;
+
+  struct LaneSlot
+  {
+    QAtomicInt used;
+    QAtomicPointer<Lane> lane;
+  };
+
+  enum { LANE_TABLE_SIZE = 256, OVERFLOW_LANE_COUNT = 64 };
+
+  // Lanes of the submitting threads, in a table whose slots are claimed
+  // without locks. A slot is released when its thread finishes and its lane,
+  // possibly still holding tasks of that thread, is reused by the next thread
+  // claiming the slot. Only when more than LANE_TABLE_SIZE submitting threads
+  // are alive at the same time do the other ones share a fixed number of
+  // lanes selected by their hash: the tasks of a thread still run in order
+  // and the memory used does not grow with the number of threads.
+  LaneSlot laneTable[LANE_TABLE_SIZE];
+  QAtomicPointer<Lane> overflowLanes[OVERFLOW_LANE_COUNT];
+
+  // Lane of the current thread, released when the thread finishes
+  QThreadStorage<LaneOwner*> laneOwners;
+
+  LaneQueue* injectionQueue;
+  QList<Worker*> workers;
+
+  QAtomicInt pendingTasks;
+  QAtomicInt closing;
+
+  QMutex sleepMutex;
+  QWaitCondition sleepCondition;
+  QAtomicInt sleepingWorkers;
+
+  Lane* getLane();
+  void schedule(Lane* lane);
+  void wakeWorker();
+
+  static void runTask(ctkEARunnable* task);
+};
+
+#endif // CTKEAWORKSTEALINGEXECUTOR_P_H
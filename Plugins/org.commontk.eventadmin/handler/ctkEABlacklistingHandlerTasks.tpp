@@ -25,9 +25,11 @@ ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilters, Filters>::
 ctkEABlacklistingHandlerTasks(ctkPluginContext* context,
                               ctkEABlackList<BlackList>* blackList,
                               ctkEATopicHandlerFilters<TopicHandlerFilters>* topicHandlerFilters,
-                              ctkEAFilters<Filters>* filters)
+                              ctkEAFilters<Filters>* filters,
+                              ctkEAHandlerIndex* handlerIndex)
   : blackList(blackList), context(context),
-    topicHandlerFilters(topicHandlerFilters), filters(filters)
+    topicHandlerFilters(topicHandlerFilters), filters(filters),
+    handlerIndex(handlerIndex)
 {
   checkNull(context, "Context");
   checkNull(blackList, "BlackList");
@@ -39,6 +41,7 @@ template<class BlackList, class TopicHandlerFilters, class Filters>
 ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilters, Filters>::
 ~ctkEABlacklistingHandlerTasks()
 {
+  delete handlerIndex;
   delete filters;
   delete topicHandlerFilters;
   delete blackList;
@@ -49,6 +52,11 @@ QList<ctkEAHandlerTask<ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilt
 ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilters, Filters>::
 createHandlerTasks(const ctkEvent& event)
 {
+  if (handlerIndex)
+  {
+    return createIndexedHandlerTasks(event);
+  }
+
   QList<ctkEAHandlerTask<Self> > result;
   QList<ctkServiceReference> handlerRefs;
 
@@ -94,6 +102,40 @@ createHandlerTasks(const ctkEvent& event)
   return result;
 }
 
+template<class BlackList, class TopicHandlerFilters, class Filters>
+QList<ctkEAHandlerTask<ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilters, Filters> > >
+ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilters, Filters>::
+createIndexedHandlerTasks(const ctkEvent& event)
+{
+  QList<ctkEAHandlerTask<Self> > result;
+
+  QList<ctkEAHandlerIndex::Handler> handlers = handlerIndex->getHandlers(event.getTopic());
+  for (int i = 0; i < handlers.size(); ++i)
+  {
+    const ctkEAHandlerIndex::Handler& handler = handlers.at(i);
+    const ctkServiceReference& ref = handler.reference;
+    if (blackList->contains(ref))
+    {
+      continue;
+    }
+
+    if (!handler.validFilter)
+    {
+      CTK_WARN_SR(ctkEventAdminActivator::getLogService(), ref)
+          << "Invalid EVENT_FILTER - Blacklisting ServiceReference ["
+          << ref << " | Plugin(" << ref.getPlugin() << ")]";
+
+      blackList->add(ref);
+    }
+    else if (!handler.hasFilter || event.matches(handler.filter))
+    {
+      result.push_back(ctkEAHandlerTask<Self>(ref, event, this));
+    }
+  }
+
+  return result;
+}
+
 template<class BlackList, class TopicHandlerFilters, class Filters>
 void
 ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilters, Filters>::
@@ -33,6 +33,7 @@
 #include "ctkEATopicHandlerFilters_p.h"
 #include "ctkEAFilters_p.h"
 #include "ctkEABlackList_p.h"
+#include "ctkEAHandlerIndex_p.h"
 
 /**
  * This class is an implementation of the ctkEAHandlerTasks interface that does provide
@@ -42,6 +43,9 @@
  * query for each sent event. In order to do this, an ldap-filter is created that
  * will match applicable <tt>ctkEventHandler</tt> references. In order to ease some of
  * the overhead pains of this approach some light caching is going on.
+ *
+ * If a <tt>ctkEAHandlerIndex</tt> is given, the applicable handlers are looked up
+ * in the index instead, which keeps track of the handlers while they come and go.
  */
 template<class BlackList, class TopicHandlerFilters, class Filters>
 class ctkEABlacklistingHandlerTasks :
@@ -67,6 +71,10 @@ private:
   // event handler is interested in a particular event
   ctkEAFilters<Filters>* filters;
 
+  // Used instead of the two factories above to determine the applicable event
+  // handlers and their filters, if not null
+  ctkEAHandlerIndex* handlerIndex;
+
 public:
 
   /**
@@ -76,11 +84,14 @@ public:
    * @param blackList The set to use for keeping track of blacklisted references
    * @param topicHandlerFilters The factory for topic handler filters
    * @param filters The factory for <tt>ctkLDAPSearchFilter</tt> objects
+   * @param handlerIndex The index of event handlers by topic, or null to query
+   *        the framework for each event
    */
   ctkEABlacklistingHandlerTasks(ctkPluginContext* context,
                                 ctkEABlackList<BlackList>* blackList,
                                 ctkEATopicHandlerFilters<TopicHandlerFilters>* topicHandlerFilters,
-                                ctkEAFilters<Filters>* filters);
+                                ctkEAFilters<Filters>* filters,
+                                ctkEAHandlerIndex* handlerIndex = 0);
 
   ~ctkEABlacklistingHandlerTasks();
 
@@ -152,6 +163,11 @@ private:
 
   NullEventHandler nullEventHandler;
 
+  /*
+   * Determine the handlers of the event from the handler index.
+   */
+  QList<ctkEAHandlerTask<Self> > createIndexedHandlerTasks(const ctkEvent& event);
+
   /*
    * This is a utility method that will throw a <tt>ctkInvalidArgumentException</tt>
    * in case that the given object is null. The message will be of the form name +
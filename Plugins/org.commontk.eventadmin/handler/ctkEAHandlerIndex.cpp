@@ -0,0 +1,216 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkEAHandlerIndex_p.h"
+
+#include <ctkException.h>
+#include <ctkPluginConstants.h>
+#include <ctkPluginContext.h>
+#include <ctkServiceEvent.h>
+#include <service/event/ctkEventConstants.h>
+#include <service/event/ctkEventHandler.h>
+
+#include <algorithm>
+
+ctkEAHandlerIndex::Node::~Node()
+{
+  qDeleteAll(children);
+}
+
+ctkEAHandlerIndex::ctkEAHandlerIndex(ctkPluginContext* context, bool requireTopic)
+  : context(context), requireTopic(requireTopic)
+{
+  if (context == 0)
+  {
+    throw ctkInvalidArgumentException("Context may not be null");
+  }
+
+  // Listen first, so that no handler registered in between is missed
+  const QString clazz = qobject_interface_iid<ctkEventHandler*>();
+  context->connectServiceListener(this, "serviceChanged",
+                                  QString("(") + ctkPluginConstants::OBJECTCLASS + "=" + clazz + ")");
+
+  QList<ctkServiceReference> refs = context->getServiceReferences(clazz);
+  QWriteLocker l(&lock);
+  foreach(ctkServiceReference ref, refs)
+  {
+    if (!handlers.contains(ref.getProperty(ctkPluginConstants::SERVICE_ID).toLongLong()))
+    {
+      addHandler_unlocked(ref);
+    }
+  }
+}
+
+ctkEAHandlerIndex::~ctkEAHandlerIndex()
+{
+  try
+  {
+    context->disconnectServiceListener(this, "serviceChanged");
+  }
+  catch (const ctkIllegalStateException&)
+  {
+    // the plugin context is no longer valid, the listener is already gone
+  }
+}
+
+QList<ctkEAHandlerIndex::Handler> ctkEAHandlerIndex::getHandlers(const QString& topic) const
+{
+  QList<Handler> result;
+
+  QReadLocker l(&lock);
+
+  // walk down the trie: for topic=org/commontk/TEST, collect the handlers
+  // of "*", "org/*", "org/commontk/*" and "org/commontk/TEST"
+  QList<qlonglong> ids = root.wildcard;
+  const Node* node = &root;
+  QStringList tokens = topic.split('/');
+  for (int i = 0; i < tokens.size() && node; ++i)
+  {
+    node = node->children.value(tokens.at(i));
+    if (node)
+    {
+      ids += (i < tokens.size() - 1) ? node->wildcard : node->exact;
+    }
+  }
+
+  std::sort(ids.begin(), ids.end());
+  qlonglong previousId = -1;
+  foreach(qlonglong id, ids)
+  {
+    if (id != previousId)
+    {
+      result.push_back(handlers.value(id));
+      previousId = id;
+    }
+  }
+  return result;
+}
+
+void ctkEAHandlerIndex::serviceChanged(const ctkServiceEvent& event)
+{
+  ctkServiceReference ref = event.getServiceReference();
+  qlonglong serviceId = ref.getProperty(ctkPluginConstants::SERVICE_ID).toLongLong();
+
+  QWriteLocker l(&lock);
+  switch (event.getType())
+  {
+  case ctkServiceEvent::REGISTERED:
+    addHandler_unlocked(ref);
+    break;
+  case ctkServiceEvent::MODIFIED:
+    removeHandler_unlocked(serviceId);
+    addHandler_unlocked(ref);
+    break;
+  case ctkServiceEvent::MODIFIED_ENDMATCH:
+  case ctkServiceEvent::UNREGISTERING:
+    removeHandler_unlocked(serviceId);
+    break;
+  }
+}
+
+void ctkEAHandlerIndex::addHandler_unlocked(const ctkServiceReference& ref)
+{
+  QStringList topics;
+  QVariant topicValue = ref.getProperty(ctkEventConstants::EVENT_TOPIC);
+  if (topicValue.isValid())
+  {
+    topics = topicValue.toStringList();
+  }
+  else if (!requireTopic)
+  {
+    // handlers without a topic receive all events
+    topics << "*";
+  }
+  if (topics.isEmpty())
+  {
+    return;
+  }
+
+  Handler handler;
+  handler.reference = ref;
+  QString filter = ref.getProperty(ctkEventConstants::EVENT_FILTER).toString();
+  if (!filter.isEmpty())
+  {
+    handler.hasFilter = true;
+    try
+    {
+      handler.filter = ctkLDAPSearchFilter(filter);
+    }
+    catch (const ctkInvalidArgumentException&)
+    {
+      // reported and blacklisted when an event is delivered to the handler
+      handler.validFilter = false;
+    }
+  }
+
+  qlonglong serviceId = ref.getProperty(ctkPluginConstants::SERVICE_ID).toLongLong();
+  handlers.insert(serviceId, handler);
+  handlerTopics.insert(serviceId, topics);
+  foreach(QString topic, topics)
+  {
+    QList<qlonglong>* ids = handlerList_unlocked(topic, true);
+    if (!ids->contains(serviceId))
+    {
+      ids->push_back(serviceId);
+    }
+  }
+}
+
+void ctkEAHandlerIndex::removeHandler_unlocked(qlonglong serviceId)
+{
+  foreach(QString topic, handlerTopics.take(serviceId))
+  {
+    QList<qlonglong>* ids = handlerList_unlocked(topic, false);
+    if (ids)
+    {
+      ids->removeAll(serviceId);
+    }
+  }
+  handlers.remove(serviceId);
+}
+
+QList<qlonglong>* ctkEAHandlerIndex::handlerList_unlocked(const QString& handlerTopic, bool create)
+{
+  if (handlerTopic == "*")
+  {
+    return &root.wildcard;
+  }
+
+  bool wildcard = handlerTopic.endsWith("/*");
+  QString path = wildcard ? handlerTopic.left(handlerTopic.size() - 2) : handlerTopic;
+
+  Node* node = &root;
+  foreach(QString token, path.split('/'))
+  {
+    Node* child = node->children.value(token);
+    if (child == 0)
+    {
+      if (!create)
+      {
+        return 0;
+      }
+      child = new Node();
+      node->children.insert(token, child);
+    }
+    node = child;
+  }
+  return wildcard ? &node->wildcard : &node->exact;
+}
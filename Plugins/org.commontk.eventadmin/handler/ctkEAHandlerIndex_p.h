@@ -0,0 +1,137 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKEAHANDLERINDEX_P_H
+#define CTKEAHANDLERINDEX_P_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QReadWriteLock>
+#include <QStringList>
+
+#include <ctkServiceReference.h>
+#include <ctkLDAPSearchFilter.h>
+
+class ctkPluginContext;
+class ctkServiceEvent;
+
+/**
+ * This class keeps track of the registered <tt>ctkEventHandler</tt> services,
+ * indexed by the topics they are registered for. The index is a trie with one
+ * node per topic token: a node holds the handlers registered for the exact
+ * topic leading to it and the ones registered for the same topic followed by
+ * a "/*" wildcard. Handlers registered for "*" (or without a topic, if
+ * topics are not required) are held by the root node.
+ *
+ * The index is maintained from the REGISTERED, MODIFIED and UNREGISTERING
+ * service events, hence determining the handlers of an event is a walk down
+ * the trie instead of a query of the service registry. The
+ * <tt>ctkEventConstants::EVENT_FILTER</tt> of each handler is parsed once, when
+ * the handler is indexed.
+ *
+ * This class is thread-safe.
+ */
+class ctkEAHandlerIndex : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  /**
+   * An indexed event handler and its pre-parsed event filter.
+   */
+  struct Handler
+  {
+    Handler() : hasFilter(false), validFilter(true) {}
+
+    ctkServiceReference reference;
+
+    // false if the handler did not provide an event filter
+    bool hasFilter;
+
+    // false if the event filter could not be parsed
+    bool validFilter;
+
+    ctkLDAPSearchFilter filter;
+  };
+
+  /**
+   * The constructor of the index. It starts tracking the event handler
+   * services right away.
+   *
+   * @param context The context of the plugin
+   * @param requireTopic Whether handlers without a topic are ignored (true)
+   *        or receive all events (false)
+   */
+  ctkEAHandlerIndex(ctkPluginContext* context, bool requireTopic);
+
+  ~ctkEAHandlerIndex();
+
+  /**
+   * Get the handlers registered for topics matching the given event topic.
+   * Each handler is returned once, even if several of its topics match.
+   *
+   * @param topic The topic of an event
+   * @return The handlers to which an event with the given topic may be
+   *         delivered, ordered by service id.
+   */
+  QList<Handler> getHandlers(const QString& topic) const;
+
+protected Q_SLOTS:
+
+  void serviceChanged(const ctkServiceEvent& event);
+
+private:
+
+  struct Node
+  {
+    ~Node();
+
+    QHash<QString, Node*> children;
+
+    // Service ids of the handlers registered for this exact topic
+    QList<qlonglong> exact;
+
+    // Service ids of the handlers registered for this topic followed by "/*"
+    QList<qlonglong> wildcard;
+  };
+
+  ctkPluginContext* const context;
+  const bool requireTopic;
+
+  mutable QReadWriteLock lock;
+  Node root;
+  QHash<qlonglong, Handler> handlers;
+  QHash<qlonglong, QStringList> handlerTopics;
+
+  void addHandler_unlocked(const ctkServiceReference& ref);
+  void removeHandler_unlocked(qlonglong serviceId);
+
+  /**
+   * Return the list of service ids in which handlers registered for the
+   * given topic are stored, creating the trie nodes if \a create is true.
+   * Return 0 if the node does not exist and \a create is false.
+   */
+  QList<qlonglong>* handlerList_unlocked(const QString& handlerTopic, bool create);
+};
+
+#endif // CTKEAHANDLERINDEX_P_H
@@ -22,9 +22,39 @@
 
 #include "ctkEASlotHandler_p.h"
 
+#include <service/event/ctkEventConstants.h>
+
+#include <QTimer>
+#include <QStringList>
+
+const int ctkEASlotHandler::DEFAULT_BATCH_SIZE = 100;
+
+ctkEASlotHandler::ctkEASlotHandler(const ctkDictionary& properties)
+  : mode(getDeliveryMode(properties)), flushQueued(false),
+    batchSize(DEFAULT_BATCH_SIZE), batchTimeout(0), flushTimer(0)
+{
+  if (mode != ImmediateDelivery)
+  {
+    flushTimer = new QTimer(this);
+    flushTimer->setSingleShot(true);
+    connect(flushTimer, SIGNAL(timeout()), this, SLOT(flushEvents()));
+    configure(properties);
+  }
+}
+
+ctkEASlotHandler::DeliveryMode ctkEASlotHandler::getDeliveryMode() const
+{
+  return mode;
+}
 
 void ctkEASlotHandler::updateProperties(const ctkDictionary& properties)
 {
+  if (mode != ImmediateDelivery)
+  {
+    QMutexLocker l(&mutex);
+    configure(properties);
+  }
+
   if (reg)
   {
     reg.setProperties(properties);
@@ -33,5 +63,146 @@ void ctkEASlotHandler::updateProperties(const ctkDictionary& properties)
 
 void ctkEASlotHandler::handleEvent(const ctkEvent& event)
 {
-  emit eventOccured(event);
+  if (mode == ImmediateDelivery)
+  {
+    emit eventOccured(event);
+    return;
+  }
+
+  // Events are only emitted from flushEvents(), in the thread owning this
+  // object, so that batches keep their order and a slot publishing events
+  // itself cannot dead-lock on our mutex.
+  const char* method = 0;
+  {
+    QMutexLocker l(&mutex);
+    if (mode == BatchDelivery)
+    {
+      pendingEvents.push_back(event);
+      if (pendingEvents.size() >= batchSize || batchTimeout <= 0)
+      {
+        if (!flushQueued)
+        {
+          flushQueued = true;
+          method = "flushEvents";
+        }
+      }
+      else if (pendingEvents.size() == 1)
+      {
+        method = "startFlushTimer";
+      }
+    }
+    else
+    {
+      const QString key = getCoalesceKey(event);
+      QHash<QString, int>::const_iterator it = pendingKeys.find(key);
+      if (it != pendingKeys.end())
+      {
+        pendingEvents[it.value()] = event;
+      }
+      else
+      {
+        pendingKeys.insert(key, pendingEvents.size());
+        pendingEvents.push_back(event);
+      }
+
+      if (!flushQueued)
+      {
+        flushQueued = true;
+        method = "flushEvents";
+      }
+    }
+  }
+
+  if (method)
+  {
+    QMetaObject::invokeMethod(this, method, Qt::QueuedConnection);
+  }
+}
+
+void ctkEASlotHandler::startFlushTimer()
+{
+  int timeout = 0;
+  {
+    QMutexLocker l(&mutex);
+    if (pendingEvents.isEmpty()) return;
+    timeout = batchTimeout;
+  }
+
+  if (!flushTimer->isActive())
+  {
+    flushTimer->start(timeout);
+  }
+}
+
+void ctkEASlotHandler::flushEvents()
+{
+  QList<ctkEvent> events;
+  int size = 0;
+  {
+    QMutexLocker l(&mutex);
+    events = pendingEvents;
+    pendingEvents.clear();
+    pendingKeys.clear();
+    flushQueued = false;
+    size = batchSize;
+  }
+
+  flushTimer->stop();
+
+  if (mode == BatchDelivery)
+  {
+    // A slow receiver may let more than one batch accumulate
+    for (int i = 0; i < events.size(); i += size)
+    {
+      emit eventsOccured(events.mid(i, size));
+    }
+  }
+  else
+  {
+    foreach(const ctkEvent& event, events)
+    {
+      emit eventOccured(event);
+    }
+  }
+}
+
+ctkEASlotHandler::DeliveryMode ctkEASlotHandler::getDeliveryMode(const ctkDictionary& properties)
+{
+  const QStringList qualities = properties.value(ctkEventConstants::EVENT_DELIVERY).toStringList();
+  if (qualities.contains(ctkEventConstants::DELIVERY_BATCH))
+  {
+    return BatchDelivery;
+  }
+  if (qualities.contains(ctkEventConstants::DELIVERY_COALESCE))
+  {
+    return CoalesceDelivery;
+  }
+  return ImmediateDelivery;
+}
+
+void ctkEASlotHandler::configure(const ctkDictionary& properties)
+{
+  bool ok = false;
+  batchSize = properties.value(ctkEventConstants::DELIVERY_BATCH_SIZE).toInt(&ok);
+  if (!ok || batchSize < 1)
+  {
+    batchSize = DEFAULT_BATCH_SIZE;
+  }
+
+  batchTimeout = properties.value(ctkEventConstants::DELIVERY_BATCH_TIMEOUT).toInt(&ok);
+  if (!ok || batchTimeout < 0)
+  {
+    batchTimeout = 0;
+  }
+
+  coalesceProperty = properties.value(ctkEventConstants::DELIVERY_COALESCE_KEY).toString();
+}
+
+QString ctkEASlotHandler::getCoalesceKey(const ctkEvent& event) const
+{
+  if (coalesceProperty.isEmpty())
+  {
+    return event.getTopic();
+  }
+  return event.getTopic() + '\n' + event.getProperty(coalesceProperty).toString();
 }
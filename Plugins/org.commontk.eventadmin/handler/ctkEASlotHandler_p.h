@@ -24,10 +24,24 @@
 #define CTKEASLOTHANDLER_P_H
 
 #include <QObject>
+#include <QMutex>
+#include <QHash>
 
 #include <ctkServiceRegistration.h>
 #include <service/event/ctkEventHandler.h>
 
+class QTimer;
+
+/**
+ * Event handler service registered for each slot subscribed via
+ * ctkEventAdmin::subscribeSlot().
+ *
+ * By default, each event is forwarded by emitting eventOccured(). Slots
+ * subscribed with the ctkEventConstants::DELIVERY_BATCH or
+ * ctkEventConstants::DELIVERY_COALESCE delivery quality get their events
+ * accumulated in this object and flushed from the thread owning it, so
+ * that a burst of events results in a bounded number of queued calls.
+ */
 class ctkEASlotHandler : public QObject, public ctkEventHandler
 {
   Q_OBJECT
@@ -35,8 +49,22 @@ class ctkEASlotHandler : public QObject, public ctkEventHandler
 
 public:
 
+  enum DeliveryMode {
+    ImmediateDelivery,
+    BatchDelivery,
+    CoalesceDelivery
+  };
+
   ctkServiceRegistration reg;
 
+  ctkEASlotHandler(const ctkDictionary& properties = ctkDictionary());
+
+  /**
+   * The delivery mode requested by the properties given at
+   * construction time. It is not changed by updateProperties().
+   */
+  DeliveryMode getDeliveryMode() const;
+
   void updateProperties(const ctkDictionary& properties);
 
   void handleEvent(const ctkEvent& event);
@@ -45,6 +73,37 @@ Q_SIGNALS:
 
   void eventOccured(const ctkEvent& event);
 
+  void eventsOccured(const QList<ctkEvent>& events);
+
+private Q_SLOTS:
+
+  void startFlushTimer();
+
+  void flushEvents();
+
+private:
+
+  static const int DEFAULT_BATCH_SIZE; // = 100
+
+  static DeliveryMode getDeliveryMode(const ctkDictionary& properties);
+
+  void configure(const ctkDictionary& properties);
+
+  QString getCoalesceKey(const ctkEvent& event) const;
+
+  const DeliveryMode mode;
+
+  QMutex mutex;
+  QList<ctkEvent> pendingEvents;
+  QHash<QString, int> pendingKeys;
+  bool flushQueued;
+
+  int batchSize;
+  int batchTimeout;
+  QString coalesceProperty;
+
+  QTimer* flushTimer;
+
 };
 
 #endif // CTKEASLOTHANDLER_P_H
@@ -73,14 +73,51 @@ public:
 };
 
 template<class SyncDeliverTasks, class HandlerTask>
-ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::ctkEAAsyncDeliverTasks(ctkEADefaultThreadPool* pool, DeliverTask* deliverTask)
- : pool(pool), deliver_task(deliverTask)
+class ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::TaskBatch
+    : public ctkEARunnable
+{
+
+private:
+
+  DeliverTask* deliver_task;
+
+  QList<HandlerTask> tasks;
+
+public:
+
+  TaskBatch(DeliverTask* deliverTask, const QList<HandlerTask>& tasks)
+    : deliver_task(deliverTask), tasks(tasks)
+  {
+  }
+
+  void run()
+  {
+    // the executor runs the batches posted from one thread in order
+    foreach(HandlerTask task, tasks)
+    {
+      QList<HandlerTask> currTasks;
+      currTasks.push_back(task);
+      deliver_task->execute(currTasks);
+    }
+  }
+};
+
+template<class SyncDeliverTasks, class HandlerTask>
+ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::ctkEAAsyncDeliverTasks(ctkEADefaultThreadPool* pool, DeliverTask* deliverTask,
+                                                                              ctkEAWorkStealingExecutor* executor)
+ : pool(pool), deliver_task(deliverTask), executor(executor)
 {
 }
 
 template<class SyncDeliverTasks, class HandlerTask>
 void ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::execute(const QList<HandlerTask>& tasks)
 {
+  if (executor)
+  {
+    executor->execute(new TaskBatch(deliver_task, tasks));
+    return;
+  }
+
   QThread* currentThread = QThread::currentThread();
   TaskExecuter* executer = 0;
   {
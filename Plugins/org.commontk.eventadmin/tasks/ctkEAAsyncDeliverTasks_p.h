@@ -25,6 +25,7 @@
 
 #include "ctkEADeliverTask_p.h"
 #include <dispatch/ctkEADefaultThreadPool_p.h>
+#include <dispatch/ctkEAWorkStealingExecutor_p.h>
 
 class ctkEARunnable;
 
@@ -52,6 +53,12 @@ private:
   QHash<QThread*, ctkEARunnable*> running_threads;
   QMutex running_threads_mutex;
 
+  /**
+   * If not null, the executor used instead of the pool and the map of
+   * running threads above.
+   */
+  ctkEAWorkStealingExecutor* executor;
+
 public:
 
   /**
@@ -61,8 +68,11 @@ public:
    *        dispatching threads in case of timeout or that the asynchronous event
    *        dispatching thread is used to send a synchronous event
    * @param deliverTask The deliver tasks for dispatching the event.
+   * @param executor The executor delivering the events posted from the same
+   *        thread in order, or null to use the pool.
    */
-  ctkEAAsyncDeliverTasks(ctkEADefaultThreadPool* pool, DeliverTask* deliverTask);
+  ctkEAAsyncDeliverTasks(ctkEADefaultThreadPool* pool, DeliverTask* deliverTask,
+                         ctkEAWorkStealingExecutor* executor = 0);
 
   /**
    * This does not block an unrelated thread used to send a synchronous event.
@@ -76,6 +86,7 @@ public:
 private:
 
   class TaskExecuter;
+  class TaskBatch;
 };
 
 #include "ctkEAAsyncDeliverTasks.tpp"
@@ -0,0 +1,75 @@
+/*
+ *  ctkEventBusBinaryPeer.cpp
+ *  ctkEventBusTest
+ *
+ *  See Licence at: http://tiny.cc/QXJ4D
+ *
+ */
+
+#include <ctkNetworkConnectorBinary.h>
+#include <ctkEventBusManager.h>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTime>
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace ctkEventBus;
+
+// Send <eventCount> events carrying <payloadSize> bytes each to the local <topic>
+// of the binary server listening on <host>:<port>, then wait for their acknowledgement.
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QStringList arguments = app.arguments();
+    if(arguments.count() != 6) {
+        std::cerr << "Usage: ctkEventBusBinaryPeer <host> <port> <topic> <eventCount> <payloadSize>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    QString host = arguments.at(1);
+    unsigned int port = arguments.at(2).toUInt();
+    QString topic = arguments.at(3);
+    int eventCount = arguments.at(4).toInt();
+    int payloadSize = arguments.at(5).toInt();
+
+    QByteArray payload(payloadSize, '\0');
+    for(int i = 0; i < payloadSize; ++i) {
+        payload[i] = static_cast<char>(i % 251);
+    }
+
+    ctkNetworkConnectorBinary connector;
+    connector.createClient(host, port);
+
+    for(int i = 0; i < eventCount; ++i) {
+        QVariantList eventParameters;
+        eventParameters.append(topic);
+        eventParameters.append(ctkEventTypeLocal);
+        eventParameters.append(ctkSignatureTypeCallback);
+        eventParameters.append("receiveData(QVariantList)");
+
+        QVariantList dataParameters;
+        dataParameters.append(i);
+        dataParameters.append(payload);
+
+        ctkEventArgumentsList listToSend;
+        listToSend.append(ctkEventArgument(QVariantList, eventParameters));
+        listToSend.append(ctkEventArgument(QVariantList, dataParameters));
+        connector.send("ctk/remote/eventBus/comunication/send/binary", &listToSend);
+    }
+    connector.flush();
+
+    QTime time;
+    time.start();
+    while(connector.pendingRequests() > 0 && time.elapsed() < 60000) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+
+    if(connector.pendingRequests() > 0) {
+        std::cerr << connector.pendingRequests() << " events not acknowledged" << std::endl;
+        return EXIT_FAILURE;
+    }
+    ctkEventBusManager::instance()->shutdown();
+    return EXIT_SUCCESS;
+}
@@ -13,6 +13,8 @@
 #include <ctkEventDispatcherLocal.h>
 #include <ctkBusEvent.h>
 
+#include <QTime>
+
 using namespace ctkEventBus;
 
 //-------------------------------------------------------------------------
@@ -58,6 +60,9 @@ public Q_SLOTS:
     int setObjectValue9WithReturnValue(int v1, int v2, int v3, int v4, int v5, int v6, int v7, int v8, int v9){return v1 + v2 + v3 + v4 +v5 + v6 + v7 + v8 + v9;};
     int setObjectValue10WithReturnValue(int v1, int v2, int v3, int v4, int v5, int v6, int v7, int v8, int v9, int v10){return v1 + v2 + v3 + v4 +v5 + v6 + v7 + v8 + v9 + v10;};
 
+    /// Test slot used to count the notifications in the benchmark.
+    void incrementObjectValue(int v1, int v2){m_Var += v2 - v1;};
+
 Q_SIGNALS:
     void signalSetObjectValue0();
     void signalSetObjectValue1(int v1);
@@ -83,6 +88,8 @@ Q_SIGNALS:
     int signalSetObjectValue9WithReturnValue(int v1, int v2, int v3, int v4, int v5, int v6, int v7, int v8, int v9);
     int signalSetObjectValue10WithReturnValue(int v1, int v2, int v3, int v4, int v5, int v6, int v7, int v8, int v9, int v10);
 
+    void signalIncrementObjectValue(int v1, int v2);
+
 private:
     int m_Var; ///< Test var.
 };
@@ -132,6 +139,9 @@ private Q_SLOTS:
     /// notify event test which cover all the possibilities in terms of arguments with returned value
     void notifyEventWitReturnValueTest();
 
+    /// notify event benchmark comparing the pre-resolved signal with an invocation by name.
+    void notifyEventBenchmarkTest();
+
 private:
     testObjectCustomForDispatcherLocal *m_ObjTest; ///< Test Object var
     ctkEventDispatcherLocal *m_EventDispatcherLocal; ///< Test var.
@@ -419,5 +429,47 @@ void ctkEventDispatcherLocalTest::notifyEventWitReturnValueTest() {
     delete propCallback10;
 }
 
+void ctkEventDispatcherLocalTest::notifyEventBenchmarkTest() {
+    const int numEvents = 200000;
+    QString topic = "ctk/local/incrementObjectValue";
+
+    ctkBusEvent *propSignal = new ctkBusEvent(topic, ctkEventTypeLocal, ctkSignatureTypeSignal, m_ObjTest, "signalIncrementObjectValue(int,int)");
+    m_EventDispatcherLocal->registerSignal(*propSignal);
+    ctkBusEvent *propCallback = new ctkBusEvent(topic, ctkEventTypeLocal, ctkSignatureTypeCallback, m_ObjTest, "incrementObjectValue(int,int)");
+    m_EventDispatcherLocal->addObserver(*propCallback);
+
+    int v1 = 1, v2 = 2;
+    ctkEventArgumentsList argList;
+    argList.append(ctkEventArgument(int, v1));
+    argList.append(ctkEventArgument(int, v2));
+    ctkBusEvent notEvent(topic, ctkDictionary());
+
+    // Dispatch by name, as done before the signals were resolved at registration time.
+    int startValue = m_ObjTest->var();
+    QTime time;
+    time.start();
+    for(int i = 0; i < numEvents; ++i) {
+        QString signal_to_emit = (*propSignal)[SIGNATURE].toString().split("(")[0];
+        QMetaObject::invokeMethod(m_ObjTest, signal_to_emit.toLatin1(), argList.at(0), argList.at(1));
+    }
+    int byNameElapsed = qMax(time.elapsed(), 1);
+    QCOMPARE(m_ObjTest->var() - startValue, numEvents);
+
+    // Dispatch through the pre-resolved signal.
+    startValue = m_ObjTest->var();
+    time.restart();
+    for(int i = 0; i < numEvents; ++i) {
+        m_EventDispatcherLocal->notifyEvent(notEvent, &argList);
+    }
+    int resolvedElapsed = qMax(time.elapsed(), 1);
+    QCOMPARE(m_ObjTest->var() - startValue, numEvents);
+
+    qDebug() << "By name:" << numEvents * 1000.0 / byNameElapsed << "events/s";
+    qDebug() << "Pre-resolved:" << numEvents * 1000.0 / resolvedElapsed << "events/s";
+
+    m_EventDispatcherLocal->removeObserver(m_ObjTest, topic);
+    m_EventDispatcherLocal->removeSignal(m_ObjTest, topic);
+}
+
 CTK_REGISTER_TEST(ctkEventDispatcherLocalTest);
 #include "ctkEventDispatcherLocalTest.moc"
@@ -0,0 +1,232 @@
+/*
+ *  ctkNetworkConnectorBinaryTest.cpp
+ *  ctkNetworkConnectorBinaryTest
+ *
+ *  See Licence at: http://tiny.cc/QXJ4D
+ *
+ */
+
+#include "ctkTestSuite.h"
+#include <ctkNetworkConnectorBinary.h>
+#include <ctkEventBusManager.h>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QProcess>
+#include <QTime>
+
+using namespace ctkEventBus;
+
+//-------------------------------------------------------------------------
+/**
+ Class name: ctkObjectCustom
+ Custom object needed for testing.
+ */
+class testObjectCustomForNetworkConnectorBinary : public QObject {
+    Q_OBJECT
+
+public:
+    /// constructor.
+    testObjectCustomForNetworkConnectorBinary();
+
+    /// Reset the counters.
+    void reset();
+
+    /// Return the number of events received.
+    int receivedEvents() {return m_ReceivedEvents;}
+
+    /// Return the number of payload bytes received.
+    qint64 receivedBytes() {return m_ReceivedBytes;}
+
+    /// Return true if the events have been received in order with their payload intact.
+    bool isValid() {return m_Valid;}
+
+public Q_SLOTS:
+    /// Test slot called with the data parameters of each remote event.
+    void receiveData(QVariantList data);
+
+Q_SIGNALS:
+    void dataReceived(QVariantList data);
+
+private:
+    int m_ReceivedEvents; ///< Number of events received.
+    qint64 m_ReceivedBytes; ///< Number of payload bytes received.
+    bool m_Valid; ///< Result of the checks on the received data.
+};
+
+testObjectCustomForNetworkConnectorBinary::testObjectCustomForNetworkConnectorBinary() {
+    reset();
+}
+
+void testObjectCustomForNetworkConnectorBinary::reset() {
+    m_ReceivedEvents = 0;
+    m_ReceivedBytes = 0;
+    m_Valid = true;
+}
+
+void testObjectCustomForNetworkConnectorBinary::receiveData(QVariantList data) {
+    QByteArray payload = data.value(1).toByteArray();
+    m_Valid = m_Valid && data.value(0).toInt() == m_ReceivedEvents;
+    for(int i = 0; i < payload.size() && m_Valid; i += 4096) {
+        m_Valid = payload.at(i) == static_cast<char>(i % 251);
+    }
+    m_ReceivedBytes += payload.size();
+    ++m_ReceivedEvents;
+}
+
+
+/**
+ Class name: ctkNetworkConnectorBinaryTest
+ This class implements the test suite for ctkNetworkConnectorBinary.
+ */
+
+//! <title>
+//ctkNetworkConnectorBinary
+//! </title>
+//! <description>
+//ctkNetworkConnectorBinary provides the connection with a binary protocol
+//over a TCP socket.
+//! </description>
+
+class ctkNetworkConnectorBinaryTest : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    /// Initialize test variables
+    void initTestCase() {
+        m_EventBus = ctkEventBusManager::instance();
+        m_NetWorkConnectorBinary = new ctkEventBus::ctkNetworkConnectorBinary();
+        m_ObjectTest = new testObjectCustomForNetworkConnectorBinary();
+
+        // Local topic notified by the server side.
+        ctkRegisterLocalSignal("ctk/local/binaryTest/dataReceived", m_ObjectTest, "dataReceived(QVariantList)");
+        ctkRegisterLocalCallback("ctk/local/binaryTest/dataReceived", m_ObjectTest, "receiveData(QVariantList)");
+
+        m_NetWorkConnectorBinary->createServer(0);
+        m_NetWorkConnectorBinary->startListen();
+    }
+
+    /// Cleanup tes variables memory allocation.
+    void cleanupTestCase() {
+        delete m_NetWorkConnectorBinary;
+        if(m_ObjectTest) {
+            delete m_ObjectTest;
+            m_ObjectTest = NULL;
+        }
+        m_EventBus->shutdown();
+    }
+
+    /// Check the ctkNetworkConnectorBinary creation.
+    void ctkNetworkConnectorBinaryConstructorTest();
+
+    /// Send batches of events with large payloads to the server in the same process.
+    void ctkNetworkConnectorBinaryCommunictionTest();
+
+    /// Send events to the server from a second process.
+    void ctkNetworkConnectorBinaryTwoProcessesTest();
+
+private:
+    /// Process the events until the given number of events has been received.
+    bool waitForEvents(int count, int timeout);
+
+    ctkEventBusManager *m_EventBus; ///< event bus instance
+    ctkNetworkConnectorBinary *m_NetWorkConnectorBinary; ///< EventBus test variable instance.
+    testObjectCustomForNetworkConnectorBinary *m_ObjectTest;
+};
+
+bool ctkNetworkConnectorBinaryTest::waitForEvents(int count, int timeout) {
+    QTime time;
+    time.start();
+    while(m_ObjectTest->receivedEvents() < count && time.elapsed() < timeout) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    return m_ObjectTest->receivedEvents() == count;
+}
+
+void ctkNetworkConnectorBinaryTest::ctkNetworkConnectorBinaryConstructorTest() {
+    QVERIFY(m_NetWorkConnectorBinary != NULL);
+    QCOMPARE(m_NetWorkConnectorBinary->protocol(), QString("BINARY"));
+    QVERIFY(m_NetWorkConnectorBinary->serverPort() != 0);
+}
+
+void ctkNetworkConnectorBinaryTest::ctkNetworkConnectorBinaryCommunictionTest() {
+    const int numEvents = 1000;
+    const int payloadSize = 64 * 1024;
+    m_ObjectTest->reset();
+
+    ctkNetworkConnectorBinary client;
+    client.setMaximumBatchSize(100);
+    client.createClient("localhost", m_NetWorkConnectorBinary->serverPort());
+
+    QByteArray payload(payloadSize, '\0');
+    for(int i = 0; i < payloadSize; ++i) {
+        payload[i] = static_cast<char>(i % 251);
+    }
+
+    QTime time;
+    time.start();
+    for(int i = 0; i < numEvents; ++i) {
+        QVariantList eventParameters;
+        eventParameters.append("ctk/local/binaryTest/dataReceived");
+        eventParameters.append(ctkEventTypeLocal);
+        eventParameters.append(ctkSignatureTypeCallback);
+        eventParameters.append("receiveData(QVariantList)");
+
+        QVariantList dataParameters;
+        dataParameters.append(i);
+        dataParameters.append(payload);
+
+        ctkEventArgumentsList listToSend;
+        listToSend.append(ctkEventArgument(QVariantList, eventParameters));
+        listToSend.append(ctkEventArgument(QVariantList, dataParameters));
+        client.send("ctk/remote/eventBus/comunication/send/binary", &listToSend);
+    }
+
+    QVERIFY(waitForEvents(numEvents, 30000));
+    int elapsed = qMax(time.elapsed(), 1);
+    QVERIFY(m_ObjectTest->isValid());
+    QCOMPARE(m_ObjectTest->receivedBytes(), qint64(numEvents) * payloadSize);
+
+    // Wait for the acknowledgements.
+    while(client.pendingRequests() > 0 && time.elapsed() < 30000) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    QCOMPARE(client.pendingRequests(), 0);
+
+    qDebug() << numEvents * 1000.0 / elapsed << "events/s,"
+             << m_ObjectTest->receivedBytes() / 1024.0 / 1024.0 * 1000.0 / elapsed << "MB/s";
+}
+
+void ctkNetworkConnectorBinaryTest::ctkNetworkConnectorBinaryTwoProcessesTest() {
+    const int numEvents = 100;
+    const int payloadSize = 1024 * 1024;
+    m_ObjectTest->reset();
+
+    QString peer = QCoreApplication::applicationDirPath() + "/ctkEventBusBinaryPeer";
+    QVERIFY2(QFile::exists(peer) || QFile::exists(peer + ".exe"), "ctkEventBusBinaryPeer not found");
+
+    QStringList arguments;
+    arguments << "localhost" << QString::number(m_NetWorkConnectorBinary->serverPort())
+              << "ctk/local/binaryTest/dataReceived" << QString::number(numEvents) << QString::number(payloadSize);
+    QProcess process;
+    process.setProcessChannelMode(QProcess::ForwardedChannels);
+    process.start(peer, arguments);
+    QVERIFY(process.waitForStarted());
+
+    // The server lives in this thread: keep processing its events while the peer runs.
+    QTime time;
+    time.start();
+    while(process.state() != QProcess::NotRunning && time.elapsed() < 60000) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    QCOMPARE(process.state(), QProcess::NotRunning);
+    QCOMPARE(process.exitStatus(), QProcess::NormalExit);
+    QCOMPARE(process.exitCode(), 0);
+
+    QVERIFY(waitForEvents(numEvents, 1000));
+    QVERIFY(m_ObjectTest->isValid());
+    QCOMPARE(m_ObjectTest->receivedBytes(), qint64(numEvents) * payloadSize);
+}
+
+CTK_REGISTER_TEST(ctkNetworkConnectorBinaryTest);
+#include "ctkNetworkConnectorBinaryTest.moc"
@@ -12,6 +12,7 @@
 #include "ctkTopicRegistry.h"
 #include "ctkNetworkConnectorQtSoap.h"
 #include "ctkNetworkConnectorQXMLRPC.h"
+#include "ctkNetworkConnectorBinary.h"
 
 using namespace ctkEventBus;
 
@@ -67,6 +68,7 @@ void ctkEventBusManager::shutdown() {
 void ctkEventBusManager::initializeNetworkConnectors() {
     plugNetworkConnector("SOAP", new ctkNetworkConnectorQtSoap());
     plugNetworkConnector("XMLRPC", new ctkNetworkConnectorQXMLRPC());
+    plugNetworkConnector("BINARY", new ctkNetworkConnectorBinary());
 }
 
 bool ctkEventBusManager::addEventProperty(ctkBusEvent &props) const {
@@ -42,6 +42,7 @@ void ctkEventDispatcher::resetHashes() {
         delete i.value();
     }
     m_SignalsHash.clear();
+    m_SignalMethodsHash.clear();
 }
 
 void ctkEventDispatcher::initializeGlobalEvents() {
@@ -144,6 +145,7 @@ bool ctkEventDispatcher::removeEventItem(ctkBusEvent &props) {
                 i++;
             }
             m_SignalsHash.remove(props[TOPIC].toString()); //in signal hash the id is unique
+            m_SignalMethodsHash.remove(props[TOPIC].toString());
             m_CallbacksHash.remove(props[TOPIC].toString()); //remove also all the id associated in callback
         }
 
@@ -236,6 +238,9 @@ bool ctkEventDispatcher::removeFromHash(ctkEventsHashType *hash, const QObject *
                 }
                 disconnectItem = disconnectItem && currentDisconnetFlag;
                 if(currentDisconnetFlag) {
+                    if(hash == &m_SignalsHash) {
+                        m_SignalMethodsHash.remove(i.key());
+                    }
                     delete i.value();
                     i = hash->erase(i);
                 } else {
@@ -267,6 +272,9 @@ bool ctkEventDispatcher::removeFromHash(ctkEventsHashType *hash, const QObject *
                 }
                 disconnectItem = disconnectItem && currentDisconnetFlag;
                 if(currentDisconnetFlag) {
+                    if(hash == &m_SignalsHash) {
+                        m_SignalMethodsHash.remove(i.key());
+                    }
                     delete i.value();
                     i = hash->erase(i);
                 } else {
@@ -319,6 +327,7 @@ bool ctkEventDispatcher::registerSignal(ctkBusEvent &props) {
         // Add the new signal to the Hash.
         ctkBusEvent *dict = const_cast<ctkBusEvent *>(&props);
         this->m_SignalsHash.insert(topic, dict);
+        cacheSignalMethod(props);
         return true;
     }
 
@@ -342,6 +351,7 @@ bool ctkEventDispatcher::registerSignal(ctkBusEvent &props) {
          }
          ctkBusEvent *dict = const_cast<ctkBusEvent *>(&props);
          this->m_SignalsHash.insert(topic, dict);
+         cacheSignalMethod(props);
     }
 
     return cumulativeConnect;
@@ -351,6 +361,35 @@ bool ctkEventDispatcher::removeSignal(ctkBusEvent &props) {
     return removeEventItem(props);
 }
 
+void ctkEventDispatcher::cacheSignalMethod(ctkBusEvent &props) {
+    QString topic = props[TOPIC].toString();
+    m_SignalMethodsHash.remove(topic);
+
+    QObject *obj = props[OBJECT].value<QObject *>();
+    if(obj == NULL) {
+        return;
+    }
+
+    // Resolve the signature once, so that notifying the topic does not need to parse it again.
+    QByteArray sig = QMetaObject::normalizedSignature(props[SIGNATURE].toString().toLatin1().constData());
+    int index = obj->metaObject()->indexOfMethod(sig.constData());
+    if(index < 0) {
+        qWarning("%s", tr("Signature '%1' not found in %2 for topic '%3'").arg(QString(sig), obj->metaObject()->className(), topic).toLatin1().data());
+        return;
+    }
+
+    ctkSignalMethod signalMethod;
+    signalMethod.object = obj;
+    signalMethod.method = obj->metaObject()->method(index);
+    signalMethod.name = sig.left(sig.indexOf('('));
+    signalMethod.returnType = signalMethod.method.typeName();
+    if(signalMethod.returnType == "void") {
+        signalMethod.returnType.clear();
+    }
+    signalMethod.parameterTypes = signalMethod.method.parameterTypes();
+    m_SignalMethodsHash.insert(topic, signalMethod);
+}
+
 void ctkEventDispatcher::notifyEvent(ctkBusEvent &event_dictionary, ctkEventArgumentsList *argList, ctkGenericReturnArgument *returnArg) const {
     Q_UNUSED(event_dictionary);
     Q_UNUSED(argList);
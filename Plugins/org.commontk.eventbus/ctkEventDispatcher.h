@@ -14,6 +14,8 @@
 
 #include "ctkEventDefinitions.h"
 
+#include <QMetaMethod>
+
 namespace ctkEventBus {
 
 /**
@@ -82,6 +84,18 @@ protected:
     /// Return the signal item property associated to the given ID.
     ctkEventItemListType signalItemProperty(const QString topic) const;
 
+    /// Signal registered for a topic, resolved to its meta method at registration time.
+    struct ctkSignalMethod {
+        QObject *object; ///< Object owning the signal.
+        QMetaMethod method; ///< Meta method of the signal.
+        QByteArray name; ///< Name of the signal, without its parameters.
+        QByteArray returnType; ///< Return type name of the signal, empty for void.
+        QList<QByteArray> parameterTypes; ///< Normalized parameter type names of the signal.
+    };
+
+    /// Return the signal resolved for the given topic or NULL if no valid signal has been registered.
+    const ctkSignalMethod *signalMethod(const QString &topic) const;
+
 private:
     /// method used to check if the given object has been already registered for the given id and signature.
     bool isSignaturePresent(ctkBusEvent &props) const;
@@ -96,8 +110,12 @@ private:
     /// Remove the given object from the has passed as argument
     bool removeFromHash(ctkEventsHashType *hash, const QObject *obj, const QString topic, bool qt_disconnect = true);
 
+    /// Resolve the signal described by the given properties and cache it for its topic.
+    void cacheSignalMethod(ctkBusEvent &props);
+
     ctkEventsHashType m_CallbacksHash; ///< Callbacks' hash for receiving events like updates or refreshes.
     ctkEventsHashType m_SignalsHash; ///< Signals' hash for sending events.
+    QHash<QString, ctkSignalMethod> m_SignalMethodsHash; ///< Signals of m_SignalsHash resolved to their meta methods.
 };
 
 /////////////////////////////////////////////////////////////
@@ -108,6 +126,11 @@ inline ctkEventItemListType ctkEventDispatcher::signalItemProperty(const QString
     return m_SignalsHash.values(topic);
 }
 
+inline const ctkEventDispatcher::ctkSignalMethod *ctkEventDispatcher::signalMethod(const QString &topic) const {
+    QHash<QString, ctkSignalMethod>::const_iterator i = m_SignalMethodsHash.constFind(topic);
+    return i == m_SignalMethodsHash.constEnd() ? NULL : &i.value();
+}
+
 } // namespace ctkEventBus
 
 #endif // CTKEVENTDISPATCHER_H
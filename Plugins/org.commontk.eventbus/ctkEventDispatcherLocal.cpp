@@ -35,127 +35,53 @@ void ctkEventDispatcherLocal::initializeGlobalEvents() {
 
 void ctkEventDispatcherLocal::notifyEvent(ctkBusEvent &event_dictionary, ctkEventArgumentsList *argList, ctkGenericReturnArgument *returnArg) const {
     QString topic = event_dictionary[TOPIC].toString();
-    ctkEventItemListType items = signalItemProperty(topic);
-    ctkBusEvent *itemEventProp;
-    foreach(itemEventProp, items) {
-        if((*itemEventProp)[SIGNATURE].toString().length() != 0) {
-            QString signal_to_emit = (*itemEventProp)[SIGNATURE].toString().split("(")[0];
-            QObject *obj = (*itemEventProp)[OBJECT].value<QObject *>();
-            if(argList != NULL) {
-                if (returnArg == NULL || returnArg->data() == NULL) { //don't use return value
-                    switch (argList->count()) {
-                        case 0:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1());
-                            break;
-                        case 1:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                            argList->at(0));
-                            break;
-                        case 2:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1));
-                            break;
-                        case 3:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1), argList->at(2));
-                            break;
-                        case 4:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3));
-                            break;
-                        case 5:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4));
-                            break;
-                        case 6:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), argList->at(5));
-                            break;
-                        case 7:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), \
-                             argList->at(5), argList->at(6));
-                            break;
-                        case 8:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), \
-                             argList->at(5), argList->at(6), argList->at(7));
-                            break;
-                        case 9:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), \
-                             argList->at(5), argList->at(6), argList->at(7), argList->at(8));
-                            break;
-                        case 10:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), \
-                             argList->at(5), argList->at(6), argList->at(7), argList->at(8), argList->at(9));
-                            break;
-                        default:
-                            qWarning("%s", tr("Number of arguments not supported. Max 10 arguments").toLatin1().data());
-                    } //switch
-                 } else { //use return value
-                    switch (argList->count()) {
-                        case 0:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg);
-                            break;
-                        case 1:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg,\
-                            argList->at(0));
-                            break;
-                        case 2:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1));
-                            break;
-                        case 3:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1), argList->at(2));
-                            break;
-                        case 4:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3));
-                            break;
-                        case 5:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4));
-                            break;
-                        case 6:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), argList->at(5));
-                            break;
-                        case 7:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), \
-                             argList->at(5), argList->at(6));
-                            break;
-                        case 8:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), \
-                             argList->at(5), argList->at(6), argList->at(7));
-                            break;
-                        case 9:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), \
-                             argList->at(5), argList->at(6), argList->at(7), argList->at(8));
-                            break;
-                        case 10:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), \
-                             argList->at(5), argList->at(6), argList->at(7), argList->at(8), argList->at(9));
-                            break;
-                        default:
-                            qWarning("%s", tr("Number of arguments not supported. Max 10 arguments").toLatin1().data());
-                    } //switch
-                 }
-            } else {
-                if (returnArg == NULL || returnArg->data() == NULL) { //don't use return value
-                    this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1());
-                } else {
-                    this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg);
-                }
+    const ctkSignalMethod *signal = signalMethod(topic);
+    if(signal == NULL) {
+        return;
+    }
 
-            }
-        }
+    int argCount = argList != NULL ? argList->count() : 0;
+    if(argCount > 10) {
+        qWarning("%s", tr("Number of arguments not supported. Max 10 arguments").toLatin1().data());
+        return;
+    }
+    bool useReturnValue = returnArg != NULL && returnArg->data() != NULL;
+
+    // The signal has been resolved at registration time: if the arguments match its
+    // signature, invoke it directly instead of looking it up by name.
+    bool matchSignature = argCount == signal->parameterTypes.count() &&
+                          (!useReturnValue || signal->returnType == returnArg->name());
+    void *args[11];
+    args[0] = useReturnValue ? returnArg->data() : NULL;
+    for(int i = 0; i < argCount; ++i) {
+        const QGenericArgument &arg = argList->at(i);
+        matchSignature = matchSignature && signal->parameterTypes.at(i) == arg.name();
+        args[i + 1] = arg.data();
+    }
+
+    if(matchSignature && signal->object->thread() == QThread::currentThread()) {
+        QMetaObject::metacall(signal->object, QMetaObject::InvokeMetaMethod, signal->method.methodIndex(), args);
+        return;
     }
-}
 
+    QGenericArgument genericArgs[10];
+    for(int i = 0; i < argCount; ++i) {
+        genericArgs[i] = argList->at(i);
+    }
+
+    if(matchSignature) {
+        // Queued invocation: the argument types have been checked against the signature.
+        signal->method.invoke(signal->object, Qt::AutoConnection,
+                              useReturnValue ? *returnArg : QGenericReturnArgument(),
+                              genericArgs[0], genericArgs[1], genericArgs[2], genericArgs[3], genericArgs[4],
+                              genericArgs[5], genericArgs[6], genericArgs[7], genericArgs[8], genericArgs[9]);
+        return;
+    }
+
+    // QMetaMethod::invoke does not check the argument types: look the signal up by name
+    // so that Qt rejects mismatching arguments with a warning instead of invoking it.
+    QMetaObject::invokeMethod(signal->object, signal->name.constData(), Qt::AutoConnection,
+                              useReturnValue ? *returnArg : QGenericReturnArgument(),
+                              genericArgs[0], genericArgs[1], genericArgs[2], genericArgs[3], genericArgs[4],
+                              genericArgs[5], genericArgs[6], genericArgs[7], genericArgs[8], genericArgs[9]);
+}
@@ -0,0 +1,432 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkNetworkConnectorBinary.h"
+#include "ctkEventBusManager.h"
+
+#include <service/event/ctkEvent.h>
+
+#include <QDataStream>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+using namespace ctkEventBus;
+
+namespace {
+
+enum {
+    FRAME_REQUEST = 1,
+    FRAME_REPLY = 2
+};
+
+enum {
+    REPLY_FAIL = 0,
+    REPLY_OK = 1
+};
+
+/// Frames are prefixed by their size, as a 32 bits unsigned integer.
+const qint64 FRAME_HEADER_SIZE = sizeof(quint32);
+
+/// Larger frames are considered as a protocol error.
+const quint32 FRAME_MAXIMUM_SIZE = 64 * 1024 * 1024;
+
+/// Size of the frame type, request id and event count preceding the events of a request.
+const quint32 REQUEST_HEADER_SIZE = sizeof(quint8) + 2 * sizeof(quint32);
+
+/// Both peers must use the same serialization format, whatever their Qt version.
+const int STREAM_VERSION = QDataStream::Qt_4_6;
+
+}
+
+ctkNetworkConnectorBinary::ctkNetworkConnectorBinary() : ctkNetworkConnector(), m_Client(NULL), m_Server(NULL), m_ServerAddress(QHostAddress::LocalHost), m_ServerPort(0),
+    m_BatchCount(0), m_MaximumBatchSize(64), m_FlushScheduled(false), m_RequestId(0), m_PendingRequests(0) {
+    m_Protocol = "BINARY";
+}
+
+void ctkNetworkConnectorBinary::initializeForEventBus() {
+    ctkRegisterRemoteSignal("ctk/remote/eventBus/comunication/send/binary", this, "remoteCommunication(const QString, ctkEventArgumentsList *)");
+    ctkRegisterRemoteCallback("ctk/remote/eventBus/comunication/send/binary", this, "send(const QString, ctkEventArgumentsList *)");
+}
+
+ctkNetworkConnectorBinary::~ctkNetworkConnectorBinary() {
+    if(m_Client) {
+        flush();
+        m_Client->flush();
+        m_Client->disconnect(this);
+        delete m_Client;
+        m_Client = NULL;
+    }
+    if(m_Server) {
+        stopServer();
+    }
+}
+
+//retrieve an instance of the object
+ctkNetworkConnector *ctkNetworkConnectorBinary::clone() {
+    ctkNetworkConnectorBinary *copy = new ctkNetworkConnectorBinary();
+    copy->setMaximumBatchSize(m_MaximumBatchSize);
+    return copy;
+}
+
+unsigned int ctkNetworkConnectorBinary::serverPort() const {
+    return (m_Server && m_Server->isListening()) ? m_Server->serverPort() : 0;
+}
+
+void ctkNetworkConnectorBinary::setServerAddress(const QHostAddress &address) {
+    m_ServerAddress = address;
+}
+
+QHostAddress ctkNetworkConnectorBinary::serverAddress() const {
+    return m_ServerAddress;
+}
+
+void ctkNetworkConnectorBinary::setMaximumBatchSize(int size) {
+    m_MaximumBatchSize = qMax(1, size);
+}
+
+int ctkNetworkConnectorBinary::maximumBatchSize() const {
+    return m_MaximumBatchSize;
+}
+
+int ctkNetworkConnectorBinary::pendingRequests() const {
+    return m_PendingRequests + m_BatchCount;
+}
+
+void ctkNetworkConnectorBinary::createClient(const QString hostName, const unsigned int port) {
+    if(m_Client == NULL) {
+        m_Client = new QTcpSocket(this);
+        connect(m_Client, SIGNAL(readyRead()), this, SLOT(readFrames()));
+        connect(m_Client, SIGNAL(disconnected()), this, SLOT(socketDisconnected()));
+        connect(m_Client, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(processSocketError(QAbstractSocket::SocketError)));
+    } else {
+        m_Client->abort();
+    }
+    m_FrameSizes.remove(m_Client);
+    // Data written while connecting is buffered by the socket and sent once connected.
+    m_Client->connectToHost(hostName, port);
+    m_Client->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+}
+
+void ctkNetworkConnectorBinary::createServer(const unsigned int port) {
+    if(m_Server != NULL) {
+        if(m_ServerPort == port) {
+            return;
+        }
+        stopServer();
+    }
+    m_Server = new QTcpServer(this);
+    m_ServerPort = port;
+    connect(m_Server, SIGNAL(newConnection()), this, SLOT(acceptConnection()));
+}
+
+void ctkNetworkConnectorBinary::stopServer() {
+    foreach(QTcpSocket *socket, m_ServerConnections) {
+        socket->disconnect(this);
+        m_FrameSizes.remove(socket);
+        socket->abort();
+        socket->deleteLater();
+    }
+    m_ServerConnections.clear();
+    if(m_Server) {
+        m_Server->close();
+        delete m_Server;
+        m_Server = NULL;
+    }
+    m_ServerPort = 0;
+}
+
+void ctkNetworkConnectorBinary::startListen() {
+    if(m_Server == NULL) {
+        qWarning("%s", tr("Server can not start. Create it first, then call startListen again!!").toLatin1().data());
+        return;
+    }
+    if(m_Server->isListening()) {
+        return;
+    }
+
+    if(m_Server->listen(m_ServerAddress, m_ServerPort)) {
+        qDebug() << "Listening for binary requests on port" << m_Server->serverPort();
+    } else {
+        qDebug() << "Error listening port" << m_ServerPort << ":" << m_Server->errorString();
+    }
+}
+
+void ctkNetworkConnectorBinary::acceptConnection() {
+    while(m_Server->hasPendingConnections()) {
+        QTcpSocket *socket = m_Server->nextPendingConnection();
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readFrames()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(socketDisconnected()));
+        m_ServerConnections.append(socket);
+        // Some data may have been received before the signals were connected.
+        if(socket->bytesAvailable() > 0) {
+            QMetaObject::invokeMethod(socket, "readyRead", Qt::QueuedConnection);
+        }
+    }
+}
+
+void ctkNetworkConnectorBinary::send(const QString event_id, ctkEventArgumentsList *argList) {
+    if(m_Client == NULL) {
+        qWarning("%s", tr("Client not created, call createClient first").toLatin1().data());
+        return;
+    }
+    if(argList == NULL || argList->count() == 0) {
+        qWarning("%s", tr("Remote Dispatcher need to have at least one argument that is a QVariantList").toLatin1().data());
+        return;
+    }
+
+    int i = 0, size = argList->count();
+    for(; i < size; i++) {
+        if(qstrcmp(argList->at(i).name(), "QVariantList") != 0) {
+            qWarning("%s", tr("Remote Dispatcher need to have arguments that are QVariantList").toLatin1().data());
+            return;
+        }
+    }
+
+    // Append the event to the current batch: the lists are serialized as they are,
+    // binary data included, and only copied once into the batch.
+    const int eventOffset = m_Batch.size();
+    QDataStream stream(&m_Batch, QIODevice::WriteOnly | QIODevice::Append);
+    stream.setVersion(STREAM_VERSION);
+    stream << event_id << quint32(size);
+    for(i = 0; i < size; i++) {
+        stream << *static_cast<const QVariantList *>(argList->at(i).data());
+    }
+
+    // Frames must not exceed the size accepted by the server.
+    const quint32 eventSize = m_Batch.size() - eventOffset;
+    if(eventSize > FRAME_MAXIMUM_SIZE - REQUEST_HEADER_SIZE) {
+        m_Batch.truncate(eventOffset);
+        qWarning("%s", tr("Event %1 is too large to be sent (%2 bytes)").arg(event_id).arg(eventSize).toLatin1().data());
+        return;
+    }
+    if(quint32(m_Batch.size()) > FRAME_MAXIMUM_SIZE - REQUEST_HEADER_SIZE) {
+        // Send the previous events first, this one starts the next batch.
+        QByteArray event = m_Batch.mid(eventOffset);
+        m_Batch.truncate(eventOffset);
+        flush();
+        m_Batch = event;
+    }
+    ++m_BatchCount;
+
+    if(m_BatchCount >= m_MaximumBatchSize) {
+        flush();
+    } else if(!m_FlushScheduled) {
+        // Send the events posted during this event loop iteration together.
+        m_FlushScheduled = true;
+        QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection);
+    }
+}
+
+void ctkNetworkConnectorBinary::flush() {
+    m_FlushScheduled = false;
+    if(m_BatchCount == 0 || m_Client == NULL) {
+        return;
+    }
+
+    QByteArray header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    stream.setVersion(STREAM_VERSION);
+    stream << quint8(FRAME_REQUEST) << m_RequestId++ << quint32(m_BatchCount);
+    writeFrame(m_Client, header, m_Batch);
+
+    m_PendingRequests += m_BatchCount;
+    m_BatchCount = 0;
+    m_Batch.clear();
+}
+
+void ctkNetworkConnectorBinary::writeFrame(QTcpSocket *socket, const QByteArray &header, const QByteArray &body) {
+    QByteArray size;
+    QDataStream stream(&size, QIODevice::WriteOnly);
+    stream.setVersion(STREAM_VERSION);
+    stream << quint32(header.size() + body.size());
+    socket->write(size);
+    socket->write(header);
+    if(!body.isEmpty()) {
+        socket->write(body);
+    }
+}
+
+void ctkNetworkConnectorBinary::readFrames() {
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(QObject::sender());
+    if(socket == NULL) {
+        return;
+    }
+
+    forever {
+        quint32 frameSize = m_FrameSizes.value(socket);
+        if(frameSize == 0) {
+            if(socket->bytesAvailable() < FRAME_HEADER_SIZE) {
+                return;
+            }
+            QDataStream stream(socket);
+            stream.setVersion(STREAM_VERSION);
+            stream >> frameSize;
+            if(frameSize == 0 || frameSize > FRAME_MAXIMUM_SIZE) {
+                qWarning("%s", tr("Invalid frame size %1 received from %2, closing the connection").arg(frameSize).arg(socket->peerAddress().toString()).toLatin1().data());
+                socket->abort();
+                return;
+            }
+            m_FrameSizes.insert(socket, frameSize);
+        }
+
+        if(socket->bytesAvailable() < frameSize) {
+            return;
+        }
+        m_FrameSizes.insert(socket, 0);
+        processFrame(socket, socket->read(frameSize));
+        if(socket->state() != QAbstractSocket::ConnectedState) {
+            return;
+        }
+    }
+}
+
+void ctkNetworkConnectorBinary::processFrame(QTcpSocket *socket, const QByteArray &frame) {
+    QDataStream stream(frame);
+    stream.setVersion(STREAM_VERSION);
+    quint8 frameType = 0;
+    stream >> frameType;
+
+    switch(frameType) {
+        case FRAME_REQUEST:
+            processRequest(socket, stream);
+            break;
+        case FRAME_REPLY:
+            processReply(stream);
+            break;
+        default:
+            qWarning("%s", tr("Unknown frame type %1, closing the connection").arg(frameType).toLatin1().data());
+            socket->abort();
+    }
+}
+
+void ctkNetworkConnectorBinary::processRequest(QTcpSocket *socket, QDataStream &stream) {
+    //first argument is the list of event parameters
+    enum {
+      EVENT_PARAMETERS,
+      DATA_PARAMETERS,
+    };
+
+    enum {
+      EVENT_ID,
+      EVENT_ITEM_TYPE,
+      EVENT_SIGNATURE_TYPE,
+      EVENT_METHOD_SIGNATURE,
+    };
+
+    quint32 requestId = 0, eventCount = 0;
+    stream >> requestId >> eventCount;
+
+    QByteArray reply;
+    QDataStream replyStream(&reply, QIODevice::WriteOnly);
+    replyStream.setVersion(STREAM_VERSION);
+    replyStream << quint8(FRAME_REPLY) << requestId << eventCount;
+
+    for(quint32 e = 0; e < eventCount; ++e) {
+        QString event_id;
+        quint32 argCount = 0;
+        stream >> event_id >> argCount;
+        QList<QVariantList> parameters;
+        for(quint32 a = 0; a < argCount && stream.status() == QDataStream::Ok; ++a) {
+            QVariantList l;
+            stream >> l;
+            parameters.append(l);
+        }
+        if(stream.status() != QDataStream::Ok) {
+            qWarning("%s", tr("Corrupted request %1 received, closing the connection").arg(requestId).toLatin1().data());
+            socket->abort();
+            return;
+        }
+
+        //here eventually can be used a filter for events
+
+        //first argument regards local signal to be called.
+        QString id_name = parameters.value(EVENT_PARAMETERS).value(EVENT_ID).toString();
+
+        ctkEventArgumentsList *argList = NULL;
+        QVariantList p = parameters.value(DATA_PARAMETERS);
+        if(p.count() != 0) {
+            argList = new ctkEventArgumentsList();
+            argList->push_back(Q_ARG(QVariantList, p));
+        }
+
+        if(!id_name.isEmpty() && ctkEventBusManager::instance()->isLocalSignalPresent(id_name)) {
+            ctkBusEvent dictionary(id_name,ctkEventTypeLocal,0,NULL,"");
+            ctkEventBusManager::instance()->notifyEvent(dictionary, argList);
+            replyStream << quint8(REPLY_OK);
+        } else {
+            replyStream << quint8(REPLY_FAIL);
+        }
+        if(argList) {
+            delete argList;
+            argList = NULL;
+        }
+    }
+
+    // An observer may have closed the connection.
+    if(socket->state() == QAbstractSocket::ConnectedState) {
+        writeFrame(socket, reply);
+    }
+}
+
+void ctkNetworkConnectorBinary::processReply(QDataStream &stream) {
+    quint32 requestId = 0, eventCount = 0;
+    stream >> requestId >> eventCount;
+    for(quint32 e = 0; e < eventCount && stream.status() == QDataStream::Ok; ++e) {
+        quint8 status = REPLY_FAIL;
+        stream >> status;
+        m_PendingRequests = qMax(0, m_PendingRequests - 1);
+        if(status == REPLY_OK) {
+            ctkEventBusManager::instance()->notifyEvent("ctk/local/eventBus/remoteCommunicationDone", ctkEventTypeLocal);
+        } else {
+            qDebug("%s", tr("Event %1 of request %2 has not been dispatched by the server").arg(e).arg(requestId).toLatin1().data());
+            ctkEventBusManager::instance()->notifyEvent("ctk/local/eventBus/remoteCommunicationFailed", ctkEventTypeLocal);
+        }
+    }
+}
+
+void ctkNetworkConnectorBinary::socketDisconnected() {
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(QObject::sender());
+    if(socket == NULL) {
+        return;
+    }
+    m_FrameSizes.remove(socket);
+    if(socket == m_Client) {
+        if(m_PendingRequests > 0) {
+            // The events sent have been lost with the connection.
+            m_PendingRequests = 0;
+            ctkEventBusManager::instance()->notifyEvent("ctk/local/eventBus/remoteCommunicationFailed", ctkEventTypeLocal);
+        }
+        return;
+    }
+    m_ServerConnections.removeAll(socket);
+    socket->deleteLater();
+}
+
+void ctkNetworkConnectorBinary::processSocketError(QAbstractSocket::SocketError error) {
+    Q_UNUSED(error);
+    // Log the error.
+    qDebug("%s", tr("Socket error: %1").arg(m_Client->errorString()).toLatin1().data());
+    if(m_Client->state() != QAbstractSocket::ConnectedState) {
+        m_PendingRequests = 0;
+        ctkEventBusManager::instance()->notifyEvent("ctk/local/eventBus/remoteCommunicationFailed", ctkEventTypeLocal);
+    }
+}
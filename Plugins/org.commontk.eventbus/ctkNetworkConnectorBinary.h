@@ -0,0 +1,140 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef ctkNetworkConnectorBinary_H
+#define ctkNetworkConnectorBinary_H
+
+// include list
+#include "ctkNetworkConnector.h"
+
+#include <QAbstractSocket>
+#include <QHostAddress>
+
+class QTcpServer;
+class QTcpSocket;
+
+namespace ctkEventBus {
+
+/**
+ Class name: ctkNetworkConnectorBinary
+ This class is the implementation class for client/server objects that works over a TCP socket
+ with a binary protocol. Events are serialized with QDataStream and sent in length-prefixed frames,
+ so binary payloads (eg. QByteArray) are transferred as they are, without any text encoding.
+ The events sent during the same event loop iteration are batched into a single frame, up to
+ maximumBatchSize events and 64 MB. As for the xml-rpc connector, the first argument of an event is the list
+ of event parameters (the first one being the topic to notify on the server side) and the second
+ argument is the list of data parameters given to the local signal.
+ */
+class org_commontk_eventbus_EXPORT ctkNetworkConnectorBinary : public ctkNetworkConnector {
+    Q_OBJECT
+
+public:
+    /// object constructor.
+    ctkNetworkConnectorBinary();
+
+    /// object destructor.
+    /*virtual*/ ~ctkNetworkConnectorBinary();
+
+    /// create the unique instance of the client.
+    /*virtual*/ void createClient(const QString hostName, const unsigned int port);
+
+    /// create the unique instance of the server. If port is 0, a free port is chosen by startListen.
+    /*virtual*/ void createServer(const unsigned int port);
+
+    /// Start the server.
+    /*virtual*/ void startListen();
+
+    //retrieve an instance of the object
+    /*virtual*/ ctkNetworkConnector *clone();
+
+    /// register all the signals and slots
+    /*virtual*/ void initializeForEventBus();
+
+    /// Port the server is listening on, 0 if it is not listening.
+    unsigned int serverPort() const;
+
+    /// Address the server listens on, taken into account by the next call to startListen.
+    /// Default is QHostAddress::LocalHost, use QHostAddress::Any to accept remote clients.
+    void setServerAddress(const QHostAddress &address);
+    QHostAddress serverAddress() const;
+
+    /// Maximum number of events sent in a single frame. Default is 64.
+    void setMaximumBatchSize(int size);
+    int maximumBatchSize() const;
+
+    /// Number of events sent by the client that have not been acknowledged by the server yet.
+    int pendingRequests() const;
+
+public Q_SLOTS:
+    /// Allow to send a network request.
+    /** The event is queued and sent with the other events of the current batch. All the arguments must be QVariantList. */
+    /*virtual*/ void send(const QString event_id, ctkEventArgumentsList *argList);
+
+    /// Send the queued events without waiting for the batch to be complete.
+    void flush();
+
+private Q_SLOTS:
+    /// accept the pending connections of the server
+    void acceptConnection();
+
+    /// read the complete frames available on the socket emitting the signal
+    void readFrames();
+
+    /// release the socket emitting the signal
+    void socketDisconnected();
+
+    /// callback which manage a fault in the connection
+    void processSocketError(QAbstractSocket::SocketError error);
+
+private:
+    /// process a complete frame received on the given socket.
+    void processFrame(QTcpSocket *socket, const QByteArray &frame);
+
+    /// dispatch the events of a request frame and send the reply to the client.
+    void processRequest(QTcpSocket *socket, QDataStream &stream);
+
+    /// notify the local bus of the result of the events acknowledged by a reply frame.
+    void processReply(QDataStream &stream);
+
+    /// write a frame made of the given header and body.
+    void writeFrame(QTcpSocket *socket, const QByteArray &header, const QByteArray &body = QByteArray());
+
+    /// stop and destroy the server instance.
+    void stopServer();
+
+    QTcpSocket *m_Client; ///< socket connected to the server
+    QTcpServer *m_Server; ///< server accepting the client connections
+    QHostAddress m_ServerAddress; ///< address the server listens on
+    unsigned int m_ServerPort; ///< port given to createServer
+    QList<QTcpSocket *> m_ServerConnections; ///< sockets of the connected clients
+    QHash<QTcpSocket *, quint32> m_FrameSizes; ///< size of the frame being received on each socket, 0 while waiting for its header
+
+    QByteArray m_Batch; ///< serialized events waiting to be sent
+    int m_BatchCount; ///< number of events in m_Batch
+    int m_MaximumBatchSize; ///< maximum number of events in a frame
+    bool m_FlushScheduled; ///< true if a call to flush has been queued
+    quint32 m_RequestId; ///< id of the next request frame
+    int m_PendingRequests; ///< events sent and not acknowledged yet
+};
+
+} //namespace ctkEventBus
+
+#endif // ctkNetworkConnectorBinary_H